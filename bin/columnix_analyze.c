@@ -43,7 +43,7 @@ int main(int argc, char *argv[])
         printf(" - name: %s\n", cx_reader_column_name(reader, i));
         printf(" - type: %s\n", type_str(type));
         if (encoding)
-            printf(" - type: %s\n", encoding_str(encoding));
+            printf(" - encoding: %s\n", encoding_str(encoding));
         if (compression)
             printf(" - compression: %s (level %d)\n",
                    compression_str(compression), level);
@@ -77,6 +77,24 @@ static const char *type_str(enum cx_column_type type)
 
 static const char *encoding_str(enum cx_encoding_type type)
 {
+    switch (type) {
+        case CX_ENCODING_DICT:
+            return "DICT";
+        case CX_ENCODING_RLE:
+            return "RLE";
+        case CX_ENCODING_FOR:
+            return "FOR";
+        case CX_ENCODING_OFFSETS:
+            return "OFFSETS";
+        case CX_ENCODING_XOR:
+            return "XOR";
+        case CX_ENCODING_SPLIT:
+            return "SPLIT";
+        case CX_ENCODING_AUTO:
+            return "AUTO";
+        default:
+            break;
+    }
     return unknown_str;
 }
 
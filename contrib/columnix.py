@@ -3,10 +3,10 @@ Python bindings for columnix.
 
 Example write (Python):
 
-    from columnix import Writer, Column, I64, I32, STR, LZ4, ZSTD
+    from columnix import Writer, Column, I64, I32, STR, DICT, LZ4, ZSTD
 
     columns = [Column(I64, "timestamp", compression=LZ4),
-               Column(STR, "email", compression=ZSTD),
+               Column(STR, "email", encoding=DICT, compression=ZSTD),
                Column(I32, "id")]
 
     rows = [(1400000000000, "foo@bar.com", 23),
@@ -90,6 +90,14 @@ FLT = 3
 DBL = 4
 STR = 5
 
+DICT = 1
+RLE = 2
+FOR = 3
+OFFSETS = 4
+XOR = 5
+SPLIT = 6
+AUTO = 7
+
 LZ4 = 1
 LZ4HC = 2
 ZSTD = 3
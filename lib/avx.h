@@ -15,6 +15,11 @@ static inline __m128i cx_simd_i32_load(const int32_t *ptr)
     return _mm_loadu_si128((__m128i *)ptr);
 }
 
+static inline __m128i cx_simd_i32_add(__m128i a, __m128i b)
+{
+    return _mm_add_epi32(a, b);
+}
+
 static inline int cx_simd_i32_mask(__m128i vec)
 {
     return _mm_movemask_ps((__m128)vec);
@@ -35,6 +40,13 @@ static inline int cx_simd_i32_gt(__m128i a, __m128i b)
     return cx_simd_i32_mask(_mm_cmpgt_epi32(b, a));
 }
 
+// match low < value < high with two compares and a single mask
+static inline int cx_simd_i32_between(__m128i low, __m128i high, __m128i value)
+{
+    return cx_simd_i32_mask(_mm_and_si128(
+        _mm_cmpgt_epi32(value, low), _mm_cmpgt_epi32(high, value)));
+}
+
 static inline __m128i cx_simd_i64_set(int64_t value)
 {
     return _mm_set1_epi64x(value);
@@ -45,6 +57,11 @@ static inline __m128i cx_simd_i64_load(const int64_t *ptr)
     return _mm_loadu_si128((__m128i *)ptr);
 }
 
+static inline __m128i cx_simd_i64_add(__m128i a, __m128i b)
+{
+    return _mm_add_epi64(a, b);
+}
+
 static inline int cx_simd_i64_mask(__m128i vec)
 {
     return _mm_movemask_pd((__m128d)vec);
@@ -65,6 +82,12 @@ static inline int cx_simd_i64_gt(__m128i a, __m128i b)
     return cx_simd_i64_mask(_mm_cmpgt_epi64(b, a));
 }
 
+static inline int cx_simd_i64_between(__m128i low, __m128i high, __m128i value)
+{
+    return cx_simd_i64_mask(_mm_and_si128(
+        _mm_cmpgt_epi64(value, low), _mm_cmpgt_epi64(high, value)));
+}
+
 static inline __m128 cx_simd_flt_set(float value)
 {
     return _mm_set1_ps(value);
@@ -75,6 +98,11 @@ static inline __m128 cx_simd_flt_load(const float *ptr)
     return _mm_loadu_ps(ptr);
 }
 
+static inline __m128 cx_simd_flt_add(__m128 a, __m128 b)
+{
+    return _mm_add_ps(a, b);
+}
+
 static inline int cx_simd_flt_mask(__m128 vec)
 {
     return _mm_movemask_ps(vec);
@@ -95,6 +123,12 @@ static inline int cx_simd_flt_gt(__m128 a, __m128 b)
     return cx_simd_flt_mask(_mm_cmp_ps(b, a, _CMP_GT_OQ));
 }
 
+static inline int cx_simd_flt_between(__m128 low, __m128 high, __m128 value)
+{
+    return cx_simd_flt_mask(_mm_and_ps(_mm_cmp_ps(value, low, _CMP_GT_OQ),
+                                       _mm_cmp_ps(value, high, _CMP_LT_OQ)));
+}
+
 static inline __m128d cx_simd_dbl_set(double value)
 {
     return _mm_set1_pd(value);
@@ -105,6 +139,11 @@ static inline __m128d cx_simd_dbl_load(const double *ptr)
     return _mm_loadu_pd(ptr);
 }
 
+static inline __m128d cx_simd_dbl_add(__m128d a, __m128d b)
+{
+    return _mm_add_pd(a, b);
+}
+
 static inline int cx_simd_dbl_mask(__m128d vec)
 {
     return _mm_movemask_pd(vec);
@@ -124,3 +163,9 @@ static inline int cx_simd_dbl_gt(__m128d a, __m128d b)
 {
     return cx_simd_dbl_mask(_mm_cmp_pd(b, a, _CMP_GT_OQ));
 }
+
+static inline int cx_simd_dbl_between(__m128d low, __m128d high, __m128d value)
+{
+    return cx_simd_dbl_mask(_mm_and_pd(_mm_cmp_pd(value, low, _CMP_GT_OQ),
+                                       _mm_cmp_pd(value, high, _CMP_LT_OQ)));
+}
@@ -15,6 +15,11 @@ static inline __m256i cx_simd_i32_load(const int32_t *ptr)
     return _mm256_loadu_si256((__m256i *)ptr);
 }
 
+static inline __m256i cx_simd_i32_add(__m256i a, __m256i b)
+{
+    return _mm256_add_epi32(a, b);
+}
+
 static inline int cx_simd_i32_mask(__m256i vec)
 {
     return _mm256_movemask_ps((__m256)vec);
@@ -35,6 +40,13 @@ static inline int cx_simd_i32_gt(__m256i a, __m256i b)
     return cx_simd_i32_mask(_mm256_cmpgt_epi32(b, a));
 }
 
+// match low < value < high with two compares and a single mask
+static inline int cx_simd_i32_between(__m256i low, __m256i high, __m256i value)
+{
+    return cx_simd_i32_mask(_mm256_and_si256(
+        _mm256_cmpgt_epi32(value, low), _mm256_cmpgt_epi32(high, value)));
+}
+
 static inline __m256i cx_simd_i64_set(int64_t value)
 {
     return _mm256_set1_epi64x(value);
@@ -45,6 +57,11 @@ static inline __m256i cx_simd_i64_load(const int64_t *ptr)
     return _mm256_loadu_si256((__m256i *)ptr);
 }
 
+static inline __m256i cx_simd_i64_add(__m256i a, __m256i b)
+{
+    return _mm256_add_epi64(a, b);
+}
+
 static inline int cx_simd_i64_mask(__m256i vec)
 {
     return _mm256_movemask_pd((__m256d)vec);
@@ -65,6 +82,12 @@ static inline int cx_simd_i64_gt(__m256i a, __m256i b)
     return cx_simd_i64_mask(_mm256_cmpgt_epi64(b, a));
 }
 
+static inline int cx_simd_i64_between(__m256i low, __m256i high, __m256i value)
+{
+    return cx_simd_i64_mask(_mm256_and_si256(
+        _mm256_cmpgt_epi64(value, low), _mm256_cmpgt_epi64(high, value)));
+}
+
 static inline __m256 cx_simd_flt_set(float value)
 {
     return _mm256_set1_ps(value);
@@ -75,6 +98,11 @@ static inline __m256 cx_simd_flt_load(const float *ptr)
     return _mm256_loadu_ps(ptr);
 }
 
+static inline __m256 cx_simd_flt_add(__m256 a, __m256 b)
+{
+    return _mm256_add_ps(a, b);
+}
+
 static inline int cx_simd_flt_mask(__m256 vec)
 {
     return _mm256_movemask_ps(vec);
@@ -95,6 +123,13 @@ static inline int cx_simd_flt_gt(__m256 a, __m256 b)
     return cx_simd_flt_mask(_mm256_cmp_ps(b, a, _CMP_GT_OQ));
 }
 
+static inline int cx_simd_flt_between(__m256 low, __m256 high, __m256 value)
+{
+    return cx_simd_flt_mask(
+        _mm256_and_ps(_mm256_cmp_ps(value, low, _CMP_GT_OQ),
+                      _mm256_cmp_ps(value, high, _CMP_LT_OQ)));
+}
+
 static inline __m256d cx_simd_dbl_set(double value)
 {
     return _mm256_set1_pd(value);
@@ -105,6 +140,11 @@ static inline __m256d cx_simd_dbl_load(const double *ptr)
     return _mm256_loadu_pd(ptr);
 }
 
+static inline __m256d cx_simd_dbl_add(__m256d a, __m256d b)
+{
+    return _mm256_add_pd(a, b);
+}
+
 static inline int cx_simd_dbl_mask(__m256d vec)
 {
     return _mm256_movemask_pd(vec);
@@ -124,3 +164,10 @@ static inline int cx_simd_dbl_gt(__m256d a, __m256d b)
 {
     return cx_simd_dbl_mask(_mm256_cmp_pd(b, a, _CMP_GT_OQ));
 }
+
+static inline int cx_simd_dbl_between(__m256d low, __m256d high, __m256d value)
+{
+    return cx_simd_dbl_mask(
+        _mm256_and_pd(_mm256_cmp_pd(value, low, _CMP_GT_OQ),
+                      _mm256_cmp_pd(value, high, _CMP_LT_OQ)));
+}
@@ -15,6 +15,11 @@ static inline __m512i cx_simd_i32_load(const int32_t *ptr)
     return _mm512_loadu_si512((const void *)ptr);
 }
 
+static inline __m512i cx_simd_i32_add(__m512i a, __m512i b)
+{
+    return _mm512_add_epi32(a, b);
+}
+
 static inline int cx_simd_i32_eq(__m512i a, __m512i b)
 {
     return (int)_mm512_cmpeq_epi32_mask(a, b);
@@ -22,7 +27,7 @@ static inline int cx_simd_i32_eq(__m512i a, __m512i b)
 
 static inline int cx_simd_i32_lt(__m512i a, __m512i b)
 {
-    return (int)_mm512_cmplt_epi32_mask(a, b);
+    return (int)_mm512_cmplt_epi32_mask(b, a);
 }
 
 static inline int cx_simd_i32_gt(__m512i a, __m512i b)
@@ -30,6 +35,15 @@ static inline int cx_simd_i32_gt(__m512i a, __m512i b)
     return (int)_mm512_cmpgt_epi32_mask(b, a);
 }
 
+// match low < value < high, using the first compare as the mask of the
+// second
+static inline int cx_simd_i32_between(__m512i low, __m512i high,
+                                      __m512i value)
+{
+    return (int)_mm512_mask_cmplt_epi32_mask(
+        _mm512_cmpgt_epi32_mask(value, low), value, high);
+}
+
 static inline __m512i cx_simd_i64_set(int64_t value)
 {
     return _mm512_set1_epi64(value);
@@ -40,6 +54,11 @@ static inline __m512i cx_simd_i64_load(const int64_t *ptr)
     return _mm512_loadu_si512((const void *)ptr);
 }
 
+static inline __m512i cx_simd_i64_add(__m512i a, __m512i b)
+{
+    return _mm512_add_epi64(a, b);
+}
+
 static inline int cx_simd_i64_eq(__m512i a, __m512i b)
 {
     return (int)_mm512_cmpeq_epi64_mask(a, b);
@@ -47,7 +66,7 @@ static inline int cx_simd_i64_eq(__m512i a, __m512i b)
 
 static inline int cx_simd_i64_lt(__m512i a, __m512i b)
 {
-    return (int)_mm512_cmplt_epi64_mask(a, b);
+    return (int)_mm512_cmplt_epi64_mask(b, a);
 }
 
 static inline int cx_simd_i64_gt(__m512i a, __m512i b)
@@ -55,6 +74,13 @@ static inline int cx_simd_i64_gt(__m512i a, __m512i b)
     return (int)_mm512_cmpgt_epi64_mask(b, a);
 }
 
+static inline int cx_simd_i64_between(__m512i low, __m512i high,
+                                      __m512i value)
+{
+    return (int)_mm512_mask_cmplt_epi64_mask(
+        _mm512_cmpgt_epi64_mask(value, low), value, high);
+}
+
 static inline __m512 cx_simd_flt_set(float value)
 {
     return _mm512_set1_ps(value);
@@ -65,6 +91,11 @@ static inline __m512 cx_simd_flt_load(const float *ptr)
     return _mm512_loadu_ps(ptr);
 }
 
+static inline __m512 cx_simd_flt_add(__m512 a, __m512 b)
+{
+    return _mm512_add_ps(a, b);
+}
+
 static inline int cx_simd_flt_eq(__m512 a, __m512 b)
 {
     return (int)_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
@@ -80,6 +111,12 @@ static inline int cx_simd_flt_gt(__m512 a, __m512 b)
     return (int)_mm512_cmp_ps_mask(b, a, _CMP_GT_OQ);
 }
 
+static inline int cx_simd_flt_between(__m512 low, __m512 high, __m512 value)
+{
+    return (int)_mm512_mask_cmp_ps_mask(
+        _mm512_cmp_ps_mask(value, low, _CMP_GT_OQ), value, high, _CMP_LT_OQ);
+}
+
 static inline __m512d cx_simd_dbl_set(double value)
 {
     return _mm512_set1_pd(value);
@@ -90,6 +127,11 @@ static inline __m512d cx_simd_dbl_load(const double *ptr)
     return _mm512_loadu_pd(ptr);
 }
 
+static inline __m512d cx_simd_dbl_add(__m512d a, __m512d b)
+{
+    return _mm512_add_pd(a, b);
+}
+
 static inline int cx_simd_dbl_eq(__m512d a, __m512d b)
 {
     return (int)_mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ);
@@ -104,3 +146,10 @@ static inline int cx_simd_dbl_gt(__m512d a, __m512d b)
 {
     return (int)_mm512_cmp_pd_mask(b, a, _CMP_GT_OQ);
 }
+
+static inline int cx_simd_dbl_between(__m512d low, __m512d high,
+                                      __m512d value)
+{
+    return (int)_mm512_mask_cmp_pd_mask(
+        _mm512_cmp_pd_mask(value, low, _CMP_GT_OQ), value, high, _CMP_LT_OQ);
+}
@@ -0,0 +1,108 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "bloom.h"
+
+static const uint32_t cx_bloom_salt[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+static uint64_t cx_bloom_mix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdLLU;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53LLU;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+uint64_t cx_bloom_hash_i64(int64_t value)
+{
+    return cx_bloom_mix((uint64_t)value);
+}
+
+uint64_t cx_bloom_hash_str(const struct cx_string *string)
+{
+    uint64_t hash = 0xcbf29ce484222325LLU;
+    for (size_t i = 0; i < string->len; i++) {
+        hash ^= (unsigned char)string->ptr[i];
+        hash *= 0x100000001b3LLU;
+    }
+    return cx_bloom_mix(hash);
+}
+
+static uint32_t *cx_bloom_block(const void *bloom, size_t size, uint64_t hash)
+{
+    uint64_t block_count = size / CX_BLOOM_BLOCK_SIZE;
+    uint64_t block = ((hash >> 32) * block_count) >> 32;
+    return (uint32_t *)bloom + block * (CX_BLOOM_BLOCK_SIZE / 4);
+}
+
+static void cx_bloom_insert(void *bloom, size_t size, uint64_t hash)
+{
+    uint32_t *block = cx_bloom_block(bloom, size, hash);
+    for (size_t i = 0; i < 8; i++)
+        block[i] |= (uint32_t)1 << (((uint32_t)hash * cx_bloom_salt[i]) >> 27);
+}
+
+bool cx_bloom_contains(const void *bloom, size_t size, uint64_t hash)
+{
+    const uint32_t *block = cx_bloom_block(bloom, size, hash);
+    for (size_t i = 0; i < 8; i++) {
+        uint32_t bit = (uint32_t)1
+                       << (((uint32_t)hash * cx_bloom_salt[i]) >> 27);
+        if (!(block[i] & bit))
+            return false;
+    }
+    return true;
+}
+
+void *cx_bloom_new(const struct cx_column *column, size_t *size)
+{
+    enum cx_column_type type = cx_column_type(column);
+    if (type != CX_COLUMN_I32 && type != CX_COLUMN_I64 &&
+        type != CX_COLUMN_STR)
+        return NULL;
+    size_t bits = cx_column_count(column) * CX_BLOOM_BITS_PER_VALUE;
+    size_t block_bits = CX_BLOOM_BLOCK_SIZE * 8;
+    size_t block_count = (bits + block_bits - 1) / block_bits;
+    if (!block_count)
+        block_count = 1;
+    size_t bloom_size = block_count * CX_BLOOM_BLOCK_SIZE;
+    void *bloom = calloc(1, bloom_size);
+    if (!bloom)
+        return NULL;
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        goto error;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t count;
+        if (type == CX_COLUMN_I32) {
+            const int32_t *values =
+                cx_column_cursor_next_batch_i32(cursor, &count);
+            for (size_t i = 0; i < count; i++)
+                cx_bloom_insert(bloom, bloom_size,
+                                cx_bloom_hash_i64(values[i]));
+        } else if (type == CX_COLUMN_I64) {
+            const int64_t *values =
+                cx_column_cursor_next_batch_i64(cursor, &count);
+            for (size_t i = 0; i < count; i++)
+                cx_bloom_insert(bloom, bloom_size,
+                                cx_bloom_hash_i64(values[i]));
+        } else {
+            const struct cx_string *values =
+                cx_column_cursor_next_batch_str(cursor, &count);
+            for (size_t i = 0; i < count; i++)
+                cx_bloom_insert(bloom, bloom_size,
+                                cx_bloom_hash_str(&values[i]));
+        }
+        assert(count);
+    }
+    cx_column_cursor_free(cursor);
+    *size = bloom_size;
+    return bloom;
+error:
+    free(bloom);
+    return NULL;
+}
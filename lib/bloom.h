@@ -0,0 +1,30 @@
+#ifndef CX_BLOOM_H_
+#define CX_BLOOM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "column.h"
+
+// a split block Bloom filter is an array of 256-bit blocks. Each value
+// selects a block using the upper half of its hash, and sets one bit in each
+// of the block's eight 32-bit words using the lower half
+#define CX_BLOOM_BLOCK_SIZE 32
+
+// the number of bits per value, which gives a false positive rate of ~1%
+#define CX_BLOOM_BITS_PER_VALUE 10
+
+void *cx_bloom_new(const struct cx_column *, size_t *size);
+
+// I32 values are hashed as I64 values
+uint64_t cx_bloom_hash_i64(int64_t);
+uint64_t cx_bloom_hash_str(const struct cx_string *);
+
+bool cx_bloom_contains(const void *bloom, size_t size, uint64_t hash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,6 +6,8 @@
 #include <unistd.h>
 
 #include "column.h"
+#include "encode.h"
+#include "index.h"
 
 // when SSE4.2 optimizations are enabled, we make sure there are
 // at least 16 initialized bytes after each column value
@@ -16,6 +18,23 @@
 
 static const size_t cx_column_initial_size = 64;
 
+// pooled buffers are aligned to this many bytes and are prefixed with a
+// cx_column_pool_buffer header of the same size
+#define CX_COLUMN_POOL_ALIGN 64
+
+// the maximum number of free buffers the pool holds on to
+#define CX_COLUMN_POOL_MAX 64
+
+struct cx_column_pool_buffer {
+    struct cx_column_pool_buffer *next;
+    size_t size;
+};
+
+struct cx_column_pool {
+    struct cx_column_pool_buffer *free;
+    size_t count;
+};
+
 struct cx_column {
     union {
         void *mutable;
@@ -27,6 +46,12 @@ struct cx_column {
     enum cx_column_type type;
     enum cx_encoding_type encoding;
     bool mmapped;
+    struct cx_column_pool *pool;
+    struct {
+        struct cx_string *strings;
+        size_t count;
+        const void *codes;
+    } dict;
 };
 
 struct cx_column_cursor {
@@ -34,7 +59,28 @@ struct cx_column_cursor {
     const void *start;
     const void *end;
     const void *position;
-    cx_value_t buffer[CX_BATCH_SIZE];
+    size_t row;
+    size_t batch_size;
+    size_t batch_capacity;
+    struct {
+        const uint32_t *ends;
+        const void *values;
+        size_t count;
+        size_t run;
+    } rle;
+    struct {
+        const struct cx_for_block *blocks;
+        const uint64_t *packed;
+    } frame;
+    struct {
+        const uint32_t *offsets;
+        const char *strings;
+    } offsets;
+    struct {
+        const void *values;
+        uint64_t previous;
+    } floats;
+    cx_value_t buffer[];
 };
 
 static struct cx_column *cx_column_new_size(enum cx_column_type type,
@@ -51,9 +97,6 @@ static struct cx_column *cx_column_new_size(enum cx_column_type type,
         column->buffer.mutable = malloc(size);
         if (!column->buffer.mutable)
             goto error;
-#ifdef CX_COLUMN_OVER_ALLOC
-        memset(column->buffer.mutable, 0, size);
-#endif
         column->size = size;
     }
     column->type = type;
@@ -68,7 +111,13 @@ error:
 struct cx_column *cx_column_new(enum cx_column_type type,
                                 enum cx_encoding_type encoding)
 {
-    return cx_column_new_size(type, encoding, cx_column_initial_size, 0);
+    struct cx_column *column =
+        cx_column_new_size(type, encoding, cx_column_initial_size, 0);
+#ifdef CX_COLUMN_OVER_ALLOC
+    if (column)
+        memset(column->buffer.mutable, 0, column->size);
+#endif
+    return column;
 }
 
 struct cx_column *cx_column_new_mmapped(enum cx_column_type type,
@@ -97,14 +146,134 @@ struct cx_column *cx_column_new_compressed(enum cx_column_type type,
     if (!column)
         return NULL;
     column->offset = size;
+#ifdef CX_COLUMN_OVER_ALLOC
+    // the caller fills the buffer, so only the tail needs to be zeroed
+    memset((void *)((uintptr_t)column->buffer.mutable + size), 0,
+           CX_COLUMN_OVER_ALLOC);
+#endif
     *ptr = column->buffer.mutable;
     return column;
 }
 
+struct cx_column_pool *cx_column_pool_new(void)
+{
+    return calloc(1, sizeof(struct cx_column_pool));
+}
+
+void cx_column_pool_free(struct cx_column_pool *pool)
+{
+    struct cx_column_pool_buffer *buffer = pool->free;
+    while (buffer) {
+        struct cx_column_pool_buffer *next = buffer->next;
+        free(buffer);
+        buffer = next;
+    }
+    free(pool);
+}
+
+static void *cx_column_pool_get(struct cx_column_pool *pool, size_t size)
+{
+    // use the smallest free buffer that fits
+    struct cx_column_pool_buffer **best = NULL;
+    for (struct cx_column_pool_buffer **buffer = &pool->free; *buffer;
+         buffer = &(*buffer)->next)
+        if ((*buffer)->size >= size &&
+            (!best || (*buffer)->size < (*best)->size))
+            best = buffer;
+    struct cx_column_pool_buffer *buffer;
+    if (best) {
+        buffer = *best;
+        *best = buffer->next;
+        pool->count--;
+    } else {
+        // leave some room so that the buffer can be reused by row groups
+        // that are slightly larger
+        size_t capacity = (size + size / 8 + 4095) & ~(size_t)4095;
+        void *ptr;
+        if (posix_memalign(&ptr, CX_COLUMN_POOL_ALIGN,
+                           CX_COLUMN_POOL_ALIGN + capacity))
+            return NULL;
+        buffer = ptr;
+        buffer->size = capacity;
+    }
+    buffer->next = NULL;
+    return (void *)((uintptr_t)buffer + CX_COLUMN_POOL_ALIGN);
+}
+
+static void cx_column_pool_put(struct cx_column_pool *pool, const void *ptr)
+{
+    struct cx_column_pool_buffer *buffer =
+        (struct cx_column_pool_buffer *)((uintptr_t)ptr - CX_COLUMN_POOL_ALIGN);
+    if (pool->count == CX_COLUMN_POOL_MAX) {
+        free(buffer);
+        return;
+    }
+    buffer->next = pool->free;
+    pool->free = buffer;
+    pool->count++;
+}
+
+struct cx_column *cx_column_new_pooled(struct cx_column_pool *pool,
+                                       enum cx_column_type type,
+                                       enum cx_encoding_type encoding,
+                                       void **ptr, size_t size, size_t count)
+{
+    if (!size)
+        return NULL;
+    struct cx_column *column = cx_column_new_size(type, encoding, 0, count);
+    if (!column)
+        return NULL;
+#ifdef CX_COLUMN_OVER_ALLOC
+    void *buffer = cx_column_pool_get(pool, size + CX_COLUMN_OVER_ALLOC);
+    if (buffer)
+        memset((void *)((uintptr_t)buffer + size), 0, CX_COLUMN_OVER_ALLOC);
+#else
+    void *buffer = cx_column_pool_get(pool, size);
+#endif
+    if (!buffer) {
+        free(column);
+        return NULL;
+    }
+    // pooled columns are read-only, like mmapped columns
+    column->offset = size;
+    column->size = size;
+    column->mmapped = true;
+    column->buffer.mmapped = buffer;
+    column->pool = pool;
+    *ptr = buffer;
+    return column;
+}
+
+struct cx_column *cx_column_encode(const struct cx_column *column,
+                                   enum cx_encoding_type encoding)
+{
+    if (column->encoding != CX_ENCODING_NONE)
+        return NULL;
+    size_t src_size;
+    const void *src = cx_column_export(column, &src_size);
+    size_t size;
+    void *encoded =
+        cx_encode(column->type, encoding, src, src_size, column->count, &size);
+    if (!encoded)
+        return NULL;
+    void *dest;
+    struct cx_column *encoded_column =
+        cx_column_new_compressed(column->type, encoding, &dest, size,
+                                 column->count);
+    if (encoded_column)
+        memcpy(dest, encoded, size);
+    free(encoded);
+    return encoded_column;
+}
+
 void cx_column_free(struct cx_column *column)
 {
-    if (!column->mmapped)
+    if (column->pool)
+        cx_column_pool_put(column->pool, column->buffer.mmapped);
+    else if (!column->mmapped)
         free(column->buffer.mutable);
+    if (column->dict.strings)
+        free(column->dict.strings);
     free(column);
 }
 
@@ -176,9 +345,15 @@ __attribute__((noinline)) static bool cx_column_resize(struct cx_column *column,
 static bool cx_column_put(struct cx_column *column, enum cx_column_type type,
                           const void *value, size_t size)
 {
-    if (column->mmapped || column->type != type || !value)
+    if (column->mmapped || column->type != type || !value ||
+        column->encoding != CX_ENCODING_NONE)
         return false;
-    if (column->offset + size > column->size)
+    size_t required_size = column->offset + size;
+#ifdef CX_COLUMN_OVER_ALLOC
+    // keep the padding that vectorized reads (e.g. cx_strlen) run into
+    required_size += CX_COLUMN_OVER_ALLOC;
+#endif
+    if (required_size > column->size)
         if (!cx_column_resize(column, size))
             return false;
     void *slot = (void *)cx_column_tail(column);
@@ -193,7 +368,8 @@ bool cx_column_put_bit(struct cx_column *column, bool value)
     if (column->count % 64 == 0) {
         uint64_t bitset = value != 0;
         return cx_column_put(column, CX_COLUMN_BIT, &bitset, sizeof(uint64_t));
-    } else if (column->type != CX_COLUMN_BIT || column->mmapped)
+    } else if (column->type != CX_COLUMN_BIT || column->mmapped ||
+               column->encoding != CX_ENCODING_NONE)
         return false;
     if (value) {
         uint64_t *bitset = (uint64_t *)cx_column_offset(
@@ -250,7 +426,7 @@ bool cx_column_put_unit(struct cx_column *column)
 
 static bool cx_column_madvise(const struct cx_column *column, int advice)
 {
-    if (!column->mmapped || !column->size)
+    if (!column->mmapped || column->pool || !column->size)
         return true;
     size_t page_size = getpagesize();
     uintptr_t addr = (uintptr_t)column->buffer.mmapped;
@@ -258,14 +434,142 @@ static bool cx_column_madvise(const struct cx_column *column, int advice)
     return !madvise((void *)(addr - offset), (column->size + offset), advice);
 }
 
+static bool cx_column_cursor_rle_init(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    size_t value_size = cx_rle_value_size(column->type);
+    if (!value_size || column->offset < sizeof(struct cx_rle_header))
+        return false;
+    const struct cx_rle_header *header = cx_column_head(column);
+    size_t size = column->offset - sizeof(*header);
+    if (header->count > size / (sizeof(uint32_t) + value_size))
+        return false;
+    size_t ends_size = header->count * sizeof(uint32_t);
+    ends_size += (8 - ends_size % 8) % 8;
+    if (ends_size + header->count * value_size > size)
+        return false;
+    cursor->rle.ends = (const uint32_t *)(header + 1);
+    cursor->rle.values = (const char *)cursor->rle.ends + ends_size;
+    cursor->rle.count = header->count;
+    size_t rows = header->count ? cursor->rle.ends[header->count - 1] : 0;
+    return rows == column->count;
+}
+
+static bool cx_column_cursor_for_init(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_I32 && column->type != CX_COLUMN_I64)
+        return false;
+    if (column->offset < sizeof(struct cx_for_header))
+        return false;
+    const struct cx_for_header *header = cx_column_head(column);
+    size_t size = column->offset - sizeof(*header);
+    size_t block_count =
+        (column->count + CX_FOR_BLOCK_SIZE - 1) / CX_FOR_BLOCK_SIZE;
+    if (header->count != block_count ||
+        block_count > size / sizeof(struct cx_for_block))
+        return false;
+    const struct cx_for_block *blocks = (const void *)(header + 1);
+    size -= block_count * sizeof(*blocks);
+    // the packed values are followed by 8 bytes of padding
+    for (size_t i = 0; i < block_count; i++)
+        if (blocks[i].width > 64 ||
+            blocks[i].offset + blocks[i].width * sizeof(uint64_t) + 8 > size)
+            return false;
+    cursor->frame.blocks = blocks;
+    cursor->frame.packed = (const uint64_t *)(blocks + block_count);
+    return true;
+}
+
+static bool cx_column_cursor_offsets_init(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    if (column->type != CX_COLUMN_STR ||
+        column->offset < sizeof(struct cx_offsets_header))
+        return false;
+    const struct cx_offsets_header *header = cx_column_head(column);
+    size_t size = column->offset - sizeof(*header);
+    if (header->count != column->count ||
+        header->count >= size / sizeof(uint32_t))
+        return false;
+    size_t offsets_size = (header->count + 1) * sizeof(uint32_t);
+    offsets_size += (8 - offsets_size % 8) % 8;
+    if (offsets_size > size)
+        return false;
+    const uint32_t *offsets = (const uint32_t *)(header + 1);
+    const char *strings = (const char *)offsets + offsets_size;
+    size_t strings_size = offsets[header->count];
+    if (offsets[0] || strings_size > size - offsets_size)
+        return false;
+    // each string is followed by a NUL, so the offsets are strictly
+    // increasing
+    for (size_t i = 0; i < header->count; i++)
+        if (offsets[i] >= offsets[i + 1] || offsets[i + 1] > strings_size ||
+            strings[offsets[i + 1] - 1])
+            return false;
+    cursor->offsets.offsets = offsets;
+    cursor->offsets.strings = strings;
+    return true;
+}
+
+static bool cx_column_cursor_float_init(struct cx_column_cursor *cursor)
+{
+    const struct cx_column *column = cursor->column;
+    size_t width;
+    if (column->type == CX_COLUMN_FLT)
+        width = sizeof(float);
+    else if (column->type == CX_COLUMN_DBL)
+        width = sizeof(double);
+    else
+        return false;
+    if (column->offset < sizeof(struct cx_float_header))
+        return false;
+    const struct cx_float_header *header = cx_column_head(column);
+    size_t size = column->offset - sizeof(*header);
+    if (header->count != column->count || size / width != header->count)
+        return false;
+    cursor->floats.values = header + 1;
+    return true;
+}
+
 struct cx_column_cursor *cx_column_cursor_new(const struct cx_column *column)
 {
-    struct cx_column_cursor *cursor = malloc(sizeof(*cursor));
+    return cx_column_cursor_new_batch(column, CX_BATCH_SIZE);
+}
+
+struct cx_column_cursor *cx_column_cursor_new_batch(
+    const struct cx_column *column, size_t batch_size)
+{
+    if (!batch_size || batch_size % 64 || batch_size > CX_BATCH_SIZE_MAX)
+        return NULL;
+    struct cx_column_cursor *cursor =
+        malloc(sizeof(*cursor) + batch_size * sizeof(*cursor->buffer));
     if (!cursor)
         return NULL;
     cursor->column = column;
+    cursor->batch_size = batch_size;
+    cursor->batch_capacity = batch_size;
     cursor->start = cx_column_head(column);
     cursor->end = cx_column_tail(column);
+    if (column->encoding == CX_ENCODING_DICT) {
+        size_t dict_count;
+        if (!cx_column_dict(column, &dict_count))
+            goto error;
+        cursor->start = column->dict.codes;
+    } else if (column->encoding == CX_ENCODING_RLE) {
+        if (!cx_column_cursor_rle_init(cursor))
+            goto error;
+    } else if (column->encoding == CX_ENCODING_FOR) {
+        if (!cx_column_cursor_for_init(cursor))
+            goto error;
+    } else if (column->encoding == CX_ENCODING_OFFSETS) {
+        if (!cx_column_cursor_offsets_init(cursor))
+            goto error;
+    } else if (column->encoding == CX_ENCODING_XOR ||
+               column->encoding == CX_ENCODING_SPLIT) {
+        if (!cx_column_cursor_float_init(cursor))
+            goto error;
+    }
     if (!cx_column_madvise(column, MADV_SEQUENTIAL))
         goto error;
     cx_column_cursor_rewind(cursor);
@@ -280,16 +584,309 @@ void cx_column_cursor_free(struct cx_column_cursor *cursor)
     free(cursor);
 }
 
+void cx_column_cursor_set_batch_size(struct cx_column_cursor *cursor,
+                                     size_t batch_size)
+{
+    assert(batch_size && batch_size % 64 == 0);
+    assert(batch_size <= cursor->batch_capacity);
+    cursor->batch_size = batch_size;
+}
+
 void cx_column_cursor_rewind(struct cx_column_cursor *cursor)
 {
     cursor->position = cursor->start;
+    cursor->row = 0;
+    cursor->rle.run = 0;
+    cursor->floats.previous = 0;
+}
+
+static bool cx_column_cursor_row_based(const struct cx_column_cursor *cursor)
+{
+    return cursor->column->encoding == CX_ENCODING_RLE ||
+           cursor->column->encoding == CX_ENCODING_FOR ||
+           cursor->column->encoding == CX_ENCODING_OFFSETS ||
+           cursor->column->encoding == CX_ENCODING_XOR ||
+           cursor->column->encoding == CX_ENCODING_SPLIT;
 }
 
 bool cx_column_cursor_valid(const struct cx_column_cursor *cursor)
 {
+    if (cx_column_cursor_row_based(cursor))
+        return cursor->row < cursor->column->count;
     return cursor->position < cursor->end;
 }
 
+static size_t cx_column_cursor_row_batch_count(
+    const struct cx_column_cursor *cursor)
+{
+    size_t remaining = cursor->column->count - cursor->row;
+    return remaining < cursor->batch_size ? remaining : cursor->batch_size;
+}
+
+static size_t cx_column_cursor_row_skip(struct cx_column_cursor *cursor,
+                                        size_t count)
+{
+    size_t remaining = cursor->column->count - cursor->row;
+    if (remaining < count)
+        count = remaining;
+    cursor->row += count;
+    return count;
+}
+
+static size_t cx_column_cursor_rle_skip(struct cx_column_cursor *cursor,
+                                        size_t count)
+{
+    count = cx_column_cursor_row_skip(cursor, count);
+    while (cursor->rle.run < cursor->rle.count &&
+           cursor->rle.ends[cursor->rle.run] <= cursor->row)
+        cursor->rle.run++;
+    return count;
+}
+
+static size_t cx_column_cursor_float_skip(struct cx_column_cursor *cursor,
+                                          size_t count)
+{
+    size_t remaining = cursor->column->count - cursor->row;
+    if (remaining < count)
+        count = remaining;
+    // the value before the next row is the XOR of all prior deltas
+    if (cursor->column->encoding == CX_ENCODING_XOR) {
+        uint64_t previous = cursor->floats.previous;
+        if (cursor->column->type == CX_COLUMN_FLT) {
+            const uint32_t *values =
+                (const uint32_t *)cursor->floats.values + cursor->row;
+            for (size_t i = 0; i < count; i++)
+                previous ^= values[i];
+        } else {
+            const uint64_t *values =
+                (const uint64_t *)cursor->floats.values + cursor->row;
+            for (size_t i = 0; i < count; i++)
+                previous ^= values[i];
+        }
+        cursor->floats.previous = previous;
+    }
+    return cx_column_cursor_row_skip(cursor, count);
+}
+
+static const void *cx_column_cursor_float_next_batch(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    size_t count = cx_column_cursor_row_batch_count(cursor);
+    bool is_flt = cursor->column->type == CX_COLUMN_FLT;
+    if (cursor->column->encoding == CX_ENCODING_SPLIT) {
+        size_t width = is_flt ? sizeof(float) : sizeof(double);
+        cx_split_decode(cursor->floats.values, width, cursor->column->count,
+                        cursor->row, count, cursor->buffer);
+    } else if (is_flt) {
+        const uint32_t *values = cursor->floats.values;
+        uint32_t *buffer = (uint32_t *)cursor->buffer;
+        cursor->floats.previous = cx_xor_decode32(
+            values + cursor->row, count, cursor->floats.previous, buffer);
+    } else {
+        const uint64_t *values = cursor->floats.values;
+        uint64_t *buffer = (uint64_t *)cursor->buffer;
+        cursor->floats.previous = cx_xor_decode64(
+            values + cursor->row, count, cursor->floats.previous, buffer);
+    }
+    *available = cx_column_cursor_row_skip(cursor, count);
+    return cursor->buffer;
+}
+
+// expand the runs that overlap the next batch into the cursor buffer
+#define CX_RLE_EXPAND(type)                                      \
+    do {                                                         \
+        const type *values = cursor->rle.values;                 \
+        type *buffer = (type *)cursor->buffer;                   \
+        size_t start = cursor->row, end = start + count;         \
+        for (size_t run = cursor->rle.run; start < end; run++) { \
+            size_t run_end = cursor->rle.ends[run];              \
+            if (run_end > end)                                   \
+                run_end = end;                                   \
+            for (; start < run_end; start++)                     \
+                buffer[start - cursor->row] = values[run];       \
+        }                                                        \
+    } while (0)
+
+static void cx_bitset_set_range(uint64_t *bitset, size_t start, size_t end)
+{
+    while (start < end) {
+        size_t bit = start % 64;
+        size_t length = 64 - bit;
+        if (length > end - start)
+            length = end - start;
+        uint64_t mask =
+            length == 64 ? (uint64_t)-1 : ((uint64_t)1 << length) - 1;
+        bitset[start / 64] |= mask << bit;
+        start += length;
+    }
+}
+
+static const void *cx_column_cursor_rle_next_batch(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    size_t count = cx_column_cursor_row_batch_count(cursor);
+    switch (cursor->column->type) {
+        case CX_COLUMN_BIT: {
+            const uint8_t *values = cursor->rle.values;
+            uint64_t *bitset = (uint64_t *)cursor->buffer;
+            memset(bitset, 0, (count + 63) / 64 * sizeof(uint64_t));
+            size_t start = cursor->row, end = start + count;
+            for (size_t run = cursor->rle.run; start < end; run++) {
+                size_t run_end = cursor->rle.ends[run];
+                if (run_end > end)
+                    run_end = end;
+                if (values[run])
+                    cx_bitset_set_range(bitset, start - cursor->row,
+                                        run_end - cursor->row);
+                start = run_end;
+            }
+        } break;
+        case CX_COLUMN_I32:
+            CX_RLE_EXPAND(int32_t);
+            break;
+        case CX_COLUMN_I64:
+            CX_RLE_EXPAND(int64_t);
+            break;
+        default:
+            assert(false);
+    }
+    *available = cx_column_cursor_rle_skip(cursor, count);
+    return cursor->buffer;
+}
+
+static const void *cx_column_cursor_for_next_batch(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    size_t count = cx_column_cursor_row_batch_count(cursor);
+    int64_t values[CX_FOR_BLOCK_SIZE];
+    // batches are usually aligned with blocks, but may start or end part
+    // way through a block if the cursor has skipped a number of rows that
+    // isn't a multiple of the block size
+    for (size_t i = 0; i < count;) {
+        size_t row = cursor->row + i;
+        const struct cx_for_block *block =
+            &cursor->frame.blocks[row / CX_FOR_BLOCK_SIZE];
+        const uint64_t *packed = (const uint64_t *)(
+            (uintptr_t)cursor->frame.packed + block->offset);
+        size_t offset = row % CX_FOR_BLOCK_SIZE;
+        size_t n = CX_FOR_BLOCK_SIZE - offset;
+        if (n > count - i)
+            n = count - i;
+        if (cursor->column->type == CX_COLUMN_I64 && n == CX_FOR_BLOCK_SIZE) {
+            cx_for_decode(block, packed, (int64_t *)cursor->buffer + i);
+            i += n;
+            continue;
+        }
+        cx_for_decode(block, packed, values);
+        if (cursor->column->type == CX_COLUMN_I64) {
+            int64_t *buffer = (int64_t *)cursor->buffer;
+            memcpy(buffer + i, values + offset, n * sizeof(int64_t));
+        } else {
+            int32_t *buffer = (int32_t *)cursor->buffer;
+            for (size_t j = 0; j < n; j++)
+                buffer[i + j] = values[offset + j];
+        }
+        i += n;
+    }
+    *available = cx_column_cursor_row_skip(cursor, count);
+    return cursor->buffer;
+}
+
+static bool cx_column_cursor_for_batch_index(
+    const struct cx_column_cursor *cursor, struct cx_index *index)
+{
+    size_t count = cx_column_cursor_row_batch_count(cursor);
+    int64_t min = INT64_MAX, max = INT64_MIN;
+    if (count) {
+        size_t first = cursor->row / CX_FOR_BLOCK_SIZE;
+        size_t last = (cursor->row + count - 1) / CX_FOR_BLOCK_SIZE;
+        for (size_t i = first; i <= last; i++) {
+            size_t n = cursor->column->count - i * CX_FOR_BLOCK_SIZE;
+            if (n > CX_FOR_BLOCK_SIZE)
+                n = CX_FOR_BLOCK_SIZE;
+            int64_t block_min, block_max;
+            cx_for_bounds(&cursor->frame.blocks[i], n, &block_min, &block_max);
+            if (block_min < min)
+                min = block_min;
+            if (block_max > max)
+                max = block_max;
+        }
+    }
+    index->count = count;
+    if (cursor->column->type == CX_COLUMN_I64) {
+        index->min.i64 = min;
+        index->max.i64 = max;
+    } else {
+        index->min.i32 = min < INT32_MIN ? INT32_MIN
+                                         : min > INT32_MAX ? INT32_MAX : min;
+        index->max.i32 = max < INT32_MIN ? INT32_MIN
+                                         : max > INT32_MAX ? INT32_MAX : max;
+    }
+    return true;
+}
+
+bool cx_column_cursor_batch_index(const struct cx_column_cursor *cursor,
+                                  struct cx_index *index)
+{
+    if (cursor->column->encoding == CX_ENCODING_FOR)
+        return cx_column_cursor_for_batch_index(cursor, index);
+    if (cursor->column->encoding != CX_ENCODING_RLE)
+        return false;
+    size_t count = cx_column_cursor_row_batch_count(cursor);
+    size_t end = cursor->row + count;
+    size_t run = cursor->rle.run;
+    size_t last = run;
+    while (last + 1 < cursor->rle.count && cursor->rle.ends[last] < end)
+        last++;
+    index->count = count;
+    switch (cursor->column->type) {
+        case CX_COLUMN_BIT: {
+            const uint8_t *values = cursor->rle.values;
+            index->min.bit = true;
+            index->max.bit = false;
+            for (; count && run <= last; run++) {
+                index->min.bit = index->min.bit && values[run];
+                index->max.bit = index->max.bit || values[run];
+            }
+        } break;
+        case CX_COLUMN_I32: {
+            const int32_t *values = cursor->rle.values;
+            index->min.i32 = INT32_MAX;
+            index->max.i32 = INT32_MIN;
+            for (; count && run <= last; run++) {
+                if (values[run] < index->min.i32)
+                    index->min.i32 = values[run];
+                if (values[run] > index->max.i32)
+                    index->max.i32 = values[run];
+            }
+        } break;
+        case CX_COLUMN_I64: {
+            const int64_t *values = cursor->rle.values;
+            index->min.i64 = INT64_MAX;
+            index->max.i64 = INT64_MIN;
+            for (; count && run <= last; run++) {
+                if (values[run] < index->min.i64)
+                    index->min.i64 = values[run];
+                if (values[run] > index->max.i64)
+                    index->max.i64 = values[run];
+            }
+        } break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+const uint32_t *cx_column_cursor_rle_runs(
+    const struct cx_column_cursor *cursor, size_t *count, const void **values)
+{
+    if (cursor->column->encoding != CX_ENCODING_RLE)
+        return NULL;
+    *count = cursor->rle.count;
+    *values = cursor->rle.values;
+    return cursor->rle.ends;
+}
+
 static void cx_column_cursor_advance(struct cx_column_cursor *cursor,
                                      size_t size)
 {
@@ -313,6 +910,8 @@ static size_t cx_column_cursor_skip(struct cx_column_cursor *cursor,
 size_t cx_column_cursor_skip_bit(struct cx_column_cursor *cursor, size_t count)
 {
     assert(count % 64 == 0);
+    if (cursor->column->encoding == CX_ENCODING_RLE)
+        return cx_column_cursor_rle_skip(cursor, count);
     size_t skipped = cx_column_cursor_skip(cursor, CX_COLUMN_BIT,
                                            sizeof(uint64_t), count / 64);
     skipped *= 64;
@@ -326,21 +925,33 @@ size_t cx_column_cursor_skip_bit(struct cx_column_cursor *cursor, size_t count)
 
 size_t cx_column_cursor_skip_i32(struct cx_column_cursor *cursor, size_t count)
 {
+    if (cursor->column->encoding == CX_ENCODING_RLE)
+        return cx_column_cursor_rle_skip(cursor, count);
+    if (cursor->column->encoding == CX_ENCODING_FOR)
+        return cx_column_cursor_row_skip(cursor, count);
     return cx_column_cursor_skip(cursor, CX_COLUMN_I32, sizeof(int32_t), count);
 }
 
 size_t cx_column_cursor_skip_i64(struct cx_column_cursor *cursor, size_t count)
 {
+    if (cursor->column->encoding == CX_ENCODING_RLE)
+        return cx_column_cursor_rle_skip(cursor, count);
+    if (cursor->column->encoding == CX_ENCODING_FOR)
+        return cx_column_cursor_row_skip(cursor, count);
     return cx_column_cursor_skip(cursor, CX_COLUMN_I64, sizeof(int64_t), count);
 }
 
 size_t cx_column_cursor_skip_flt(struct cx_column_cursor *cursor, size_t count)
 {
+    if (cx_column_cursor_row_based(cursor))
+        return cx_column_cursor_float_skip(cursor, count);
     return cx_column_cursor_skip(cursor, CX_COLUMN_FLT, sizeof(float), count);
 }
 
 size_t cx_column_cursor_skip_dbl(struct cx_column_cursor *cursor, size_t count)
 {
+    if (cx_column_cursor_row_based(cursor))
+        return cx_column_cursor_float_skip(cursor, count);
     return cx_column_cursor_skip(cursor, CX_COLUMN_DBL, sizeof(double), count);
 }
 
@@ -364,9 +975,68 @@ static inline size_t cx_strlen(const char *string)
 #endif
 }
 
+static bool cx_column_dict_load(struct cx_column *column)
+{
+    size_t size = column->offset;
+    if (size < sizeof(struct cx_dict_header))
+        return false;
+    const struct cx_dict_header *header = cx_column_head(column);
+    size -= sizeof(*header);
+    if (header->size > size || header->count > header->size ||
+        (size - header->size) / sizeof(int32_t) != column->count ||
+        (size - header->size) % sizeof(int32_t))
+        return false;
+    struct cx_string *strings =
+        malloc((header->count ? header->count : 1) * sizeof(*strings));
+    if (!strings)
+        return false;
+    const char *string = (const char *)(header + 1);
+    const char *end = string + header->size;
+    for (size_t i = 0; i < header->count; i++) {
+        if (string >= end)
+            goto error;
+        strings[i].ptr = string;
+        strings[i].len = cx_strlen(string);
+        string += strings[i].len + 1;
+    }
+    if (string > end)
+        goto error;
+    // codes index the dictionary without further checks
+    const int32_t *codes = (const int32_t *)end;
+    for (size_t i = 0; i < column->count; i++)
+        if (codes[i] < 0 || (uint64_t)codes[i] >= header->count)
+            goto error;
+    column->dict.strings = strings;
+    column->dict.count = header->count;
+    column->dict.codes = end;
+    return true;
+error:
+    free(strings);
+    return false;
+}
+
+const struct cx_string *cx_column_dict(const struct cx_column *column,
+                                       size_t *count)
+{
+    if (column->type != CX_COLUMN_STR ||
+        column->encoding != CX_ENCODING_DICT)
+        return NULL;
+    // the dictionary is parsed on first access
+    if (!column->dict.strings &&
+        !cx_column_dict_load((struct cx_column *)column))
+        return NULL;
+    *count = column->dict.count;
+    return column->dict.strings;
+}
+
 size_t cx_column_cursor_skip_str(struct cx_column_cursor *cursor, size_t count)
 {
     assert(cursor->column->type == CX_COLUMN_STR);
+    if (cursor->column->encoding == CX_ENCODING_DICT)
+        return cx_column_cursor_skip(cursor, CX_COLUMN_STR, sizeof(int32_t),
+                                     count);
+    if (cursor->column->encoding == CX_ENCODING_OFFSETS)
+        return cx_column_cursor_row_skip(cursor, count);
     size_t skipped = 0;
     // TODO: vectorise this
     for (; skipped < count && cx_column_cursor_valid(cursor); skipped++)
@@ -377,50 +1047,102 @@ size_t cx_column_cursor_skip_str(struct cx_column_cursor *cursor, size_t count)
 const uint64_t *cx_column_cursor_next_batch_bit(struct cx_column_cursor *cursor,
                                                 size_t *available)
 {
+    if (cursor->column->encoding == CX_ENCODING_RLE)
+        return cx_column_cursor_rle_next_batch(cursor, available);
     const uint64_t *values = cursor->position;
-    *available = cx_column_cursor_skip_bit(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_bit(cursor, cursor->batch_size);
     return values;
 }
 
 const int32_t *cx_column_cursor_next_batch_i32(struct cx_column_cursor *cursor,
                                                size_t *available)
 {
+    if (cursor->column->encoding == CX_ENCODING_RLE)
+        return cx_column_cursor_rle_next_batch(cursor, available);
+    if (cursor->column->encoding == CX_ENCODING_FOR)
+        return cx_column_cursor_for_next_batch(cursor, available);
     const int32_t *values = cursor->position;
-    *available = cx_column_cursor_skip_i32(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_i32(cursor, cursor->batch_size);
     return values;
 }
 
 const int64_t *cx_column_cursor_next_batch_i64(struct cx_column_cursor *cursor,
                                                size_t *available)
 {
+    if (cursor->column->encoding == CX_ENCODING_RLE)
+        return cx_column_cursor_rle_next_batch(cursor, available);
+    if (cursor->column->encoding == CX_ENCODING_FOR)
+        return cx_column_cursor_for_next_batch(cursor, available);
     const int64_t *values = cursor->position;
-    *available = cx_column_cursor_skip_i64(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_i64(cursor, cursor->batch_size);
     return values;
 }
 
 const float *cx_column_cursor_next_batch_flt(struct cx_column_cursor *cursor,
                                              size_t *available)
 {
+    if (cx_column_cursor_row_based(cursor))
+        return cx_column_cursor_float_next_batch(cursor, available);
     const float *values = cursor->position;
-    *available = cx_column_cursor_skip_flt(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_flt(cursor, cursor->batch_size);
     return values;
 }
 
 const double *cx_column_cursor_next_batch_dbl(struct cx_column_cursor *cursor,
                                               size_t *available)
 {
+    if (cx_column_cursor_row_based(cursor))
+        return cx_column_cursor_float_next_batch(cursor, available);
     const double *values = cursor->position;
-    *available = cx_column_cursor_skip_dbl(cursor, CX_BATCH_SIZE);
+    *available = cx_column_cursor_skip_dbl(cursor, cursor->batch_size);
     return values;
 }
 
+const int32_t *cx_column_cursor_next_batch_codes(
+    struct cx_column_cursor *cursor, size_t *available)
+{
+    assert(cursor->column->encoding == CX_ENCODING_DICT);
+    const int32_t *codes = cursor->position;
+    *available = cx_column_cursor_skip_str(cursor, cursor->batch_size);
+    return codes;
+}
+
+const struct cx_string *cx_column_cursor_decode_codes(
+    struct cx_column_cursor *cursor, const int32_t *codes, size_t count)
+{
+    assert(cursor->column->encoding == CX_ENCODING_DICT);
+    assert(count <= cursor->batch_size);
+    const struct cx_string *dict = cursor->column->dict.strings;
+    struct cx_string *strings = (struct cx_string *)cursor->buffer;
+    for (size_t i = 0; i < count; i++) {
+        assert((size_t)codes[i] < cursor->column->dict.count);
+        strings[i] = dict[codes[i]];
+    }
+    return strings;
+}
+
 const struct cx_string *cx_column_cursor_next_batch_str(
     struct cx_column_cursor *cursor, size_t *available)
 {
     assert(cursor->column->type == CX_COLUMN_STR);
+    if (cursor->column->encoding == CX_ENCODING_DICT) {
+        const int32_t *codes =
+            cx_column_cursor_next_batch_codes(cursor, available);
+        return cx_column_cursor_decode_codes(cursor, codes, *available);
+    } else if (cursor->column->encoding == CX_ENCODING_OFFSETS) {
+        size_t count = cx_column_cursor_row_batch_count(cursor);
+        const uint32_t *offsets = cursor->offsets.offsets + cursor->row;
+        struct cx_string *strings = (struct cx_string *)cursor->buffer;
+        for (size_t i = 0; i < count; i++) {
+            strings[i].ptr = cursor->offsets.strings + offsets[i];
+            strings[i].len = offsets[i + 1] - offsets[i] - 1;
+        }
+        *available = cx_column_cursor_row_skip(cursor, count);
+        return strings;
+    }
     size_t i = 0;
     struct cx_string *strings = (struct cx_string *)cursor->buffer;
-    for (; i < CX_BATCH_SIZE && cx_column_cursor_valid(cursor); i++) {
+    for (; i < cursor->batch_size && cx_column_cursor_valid(cursor); i++) {
         strings[i].ptr = cursor->position;
         strings[i].len = cx_strlen(cursor->position);
         cx_column_cursor_advance(cursor, strings[i].len + 1);
@@ -428,3 +1150,106 @@ const struct cx_string *cx_column_cursor_next_batch_str(
     *available = i;
     return strings;
 }
+
+static size_t cx_column_cursor_skip_type(struct cx_column_cursor *cursor,
+                                         size_t count)
+{
+    switch (cursor->column->type) {
+        case CX_COLUMN_BIT:
+            return cx_column_cursor_skip_bit(cursor, count);
+        case CX_COLUMN_I32:
+            return cx_column_cursor_skip_i32(cursor, count);
+        case CX_COLUMN_I64:
+            return cx_column_cursor_skip_i64(cursor, count);
+        case CX_COLUMN_FLT:
+            return cx_column_cursor_skip_flt(cursor, count);
+        case CX_COLUMN_DBL:
+            return cx_column_cursor_skip_dbl(cursor, count);
+        case CX_COLUMN_STR:
+            return cx_column_cursor_skip_str(cursor, count);
+    }
+    return 0;
+}
+
+static bool cx_column_append_batch(struct cx_column *dest,
+                                   struct cx_column_cursor *cursor,
+                                   size_t *count)
+{
+    size_t available = 0;
+    bool ok = true;
+    switch (cursor->column->type) {
+        case CX_COLUMN_BIT: {
+            const uint64_t *values =
+                cx_column_cursor_next_batch_bit(cursor, &available);
+            if (available > *count)
+                available = *count;
+            for (size_t i = 0; ok && i < available; i++)
+                ok = cx_column_put_bit(
+                    dest, values[i / 64] & ((uint64_t)1 << (i % 64)));
+        } break;
+        case CX_COLUMN_I32: {
+            const int32_t *values =
+                cx_column_cursor_next_batch_i32(cursor, &available);
+            if (available > *count)
+                available = *count;
+            for (size_t i = 0; ok && i < available; i++)
+                ok = cx_column_put_i32(dest, values[i]);
+        } break;
+        case CX_COLUMN_I64: {
+            const int64_t *values =
+                cx_column_cursor_next_batch_i64(cursor, &available);
+            if (available > *count)
+                available = *count;
+            for (size_t i = 0; ok && i < available; i++)
+                ok = cx_column_put_i64(dest, values[i]);
+        } break;
+        case CX_COLUMN_FLT: {
+            const float *values =
+                cx_column_cursor_next_batch_flt(cursor, &available);
+            if (available > *count)
+                available = *count;
+            for (size_t i = 0; ok && i < available; i++)
+                ok = cx_column_put_flt(dest, values[i]);
+        } break;
+        case CX_COLUMN_DBL: {
+            const double *values =
+                cx_column_cursor_next_batch_dbl(cursor, &available);
+            if (available > *count)
+                available = *count;
+            for (size_t i = 0; ok && i < available; i++)
+                ok = cx_column_put_dbl(dest, values[i]);
+        } break;
+        case CX_COLUMN_STR: {
+            const struct cx_string *values =
+                cx_column_cursor_next_batch_str(cursor, &available);
+            if (available > *count)
+                available = *count;
+            for (size_t i = 0; ok && i < available; i++)
+                ok = cx_column_put_str(dest, values[i].ptr);
+        } break;
+    }
+    *count -= available;
+    return ok && available;
+}
+
+bool cx_column_append(struct cx_column *dest, const struct cx_column *src,
+                      size_t start, size_t count)
+{
+    if (dest->type != src->type || start + count > src->count ||
+        (src->type == CX_COLUMN_BIT && start % 64))
+        return false;
+    struct cx_column_cursor *cursor =
+        cx_column_cursor_new_batch(src, CX_BATCH_SIZE_MAX);
+    if (!cursor)
+        return false;
+    if (cx_column_cursor_skip_type(cursor, start) != start)
+        goto error;
+    while (count)
+        if (!cx_column_append_batch(dest, cursor, &count))
+            goto error;
+    cx_column_cursor_free(cursor);
+    return true;
+error:
+    cx_column_cursor_free(cursor);
+    return false;
+}
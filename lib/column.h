@@ -9,10 +9,16 @@ extern "C" {
 
 #define CX_BATCH_SIZE 64
 
+// cursors can be created with a larger batch size, which must be a
+// multiple of 64 and no larger than this
+#define CX_BATCH_SIZE_MAX 4096
+
 struct cx_column;
 
 struct cx_column_cursor;
 
+struct cx_index;
+
 struct cx_column *cx_column_new(enum cx_column_type, enum cx_encoding_type);
 
 struct cx_column *cx_column_new_mmapped(enum cx_column_type,
@@ -23,6 +29,22 @@ struct cx_column *cx_column_new_compressed(enum cx_column_type,
                                            enum cx_encoding_type, void **buffer,
                                            size_t size, size_t count);
 
+// a pool recycles the buffers of decompressed columns. Pools are not
+// thread-safe, and must outlive the columns allocated from them
+struct cx_column_pool;
+
+struct cx_column_pool *cx_column_pool_new(void);
+
+void cx_column_pool_free(struct cx_column_pool *);
+
+struct cx_column *cx_column_new_pooled(struct cx_column_pool *,
+                                       enum cx_column_type,
+                                       enum cx_encoding_type, void **buffer,
+                                       size_t size, size_t count);
+
+struct cx_column *cx_column_encode(const struct cx_column *,
+                                   enum cx_encoding_type);
+
 void cx_column_free(struct cx_column *);
 
 const void *cx_column_export(const struct cx_column *, size_t *);
@@ -42,10 +64,26 @@ bool cx_column_put_str(struct cx_column *, const char *);
 
 bool cx_column_put_unit(struct cx_column *);
 
+// decode count rows of src, starting at the specified row (a multiple of 64
+// for BIT columns), and append them to an unencoded column
+bool cx_column_append(struct cx_column *, const struct cx_column *src,
+                      size_t start, size_t count);
+
+const struct cx_string *cx_column_dict(const struct cx_column *,
+                                       size_t *count);
+
 struct cx_column_cursor *cx_column_cursor_new(const struct cx_column *);
 
+struct cx_column_cursor *cx_column_cursor_new_batch(const struct cx_column *,
+                                                    size_t batch_size);
+
 void cx_column_cursor_free(struct cx_column_cursor *);
 
+// limit the size of subsequent batches, which must be a multiple of 64 and
+// no larger than the batch size the cursor was created with
+void cx_column_cursor_set_batch_size(struct cx_column_cursor *,
+                                     size_t batch_size);
+
 void cx_column_cursor_rewind(struct cx_column_cursor *);
 
 bool cx_column_cursor_valid(const struct cx_column_cursor *);
@@ -62,6 +100,19 @@ const double *cx_column_cursor_next_batch_dbl(struct cx_column_cursor *,
                                               size_t *);
 const struct cx_string *cx_column_cursor_next_batch_str(
     struct cx_column_cursor *, size_t *);
+const int32_t *cx_column_cursor_next_batch_codes(struct cx_column_cursor *,
+                                                 size_t *);
+
+const struct cx_string *cx_column_cursor_decode_codes(
+    struct cx_column_cursor *, const int32_t *codes, size_t count);
+
+bool cx_column_cursor_batch_index(const struct cx_column_cursor *,
+                                  struct cx_index *);
+
+// the runs of an RLE encoded column, as the end row (exclusive) of each run
+// and the run values. Returns NULL if the column isn't RLE encoded
+const uint32_t *cx_column_cursor_rle_runs(const struct cx_column_cursor *,
+                                          size_t *count, const void **values);
 
 size_t cx_column_cursor_skip_bit(struct cx_column_cursor *, size_t);
 size_t cx_column_cursor_skip_i32(struct cx_column_cursor *, size_t);
@@ -20,7 +20,16 @@ enum cx_column_type {
     CX_COLUMN_STR
 };
 
-enum cx_encoding_type { CX_ENCODING_NONE };
+enum cx_encoding_type {
+    CX_ENCODING_NONE,
+    CX_ENCODING_DICT,
+    CX_ENCODING_RLE,
+    CX_ENCODING_FOR,
+    CX_ENCODING_OFFSETS,
+    CX_ENCODING_XOR,
+    CX_ENCODING_SPLIT,
+    CX_ENCODING_AUTO
+};
 
 enum cx_compression_type {
     CX_COMPRESSION_NONE,
@@ -0,0 +1,761 @@
+#define __STDC_LIMIT_MACROS
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "encode.h"
+
+#if defined(CX_AVX512) || defined(CX_AVX2)
+#include <immintrin.h>
+#endif
+
+#if CX_SSE42
+#include <smmintrin.h>
+#endif
+
+struct cx_dict_entry {
+    struct cx_string string;
+    size_t id;
+};
+
+static size_t cx_encode_align(size_t size)
+{
+    size_t mod = size % 8;
+    return mod ? size - mod + 8 : size;
+}
+
+static uint64_t cx_encode_hash(const struct cx_string *string)
+{
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325LLU;
+    for (size_t i = 0; i < string->len; i++) {
+        hash ^= (unsigned char)string->ptr[i];
+        hash *= 0x100000001b3LLU;
+    }
+    return hash;
+}
+
+static int cx_dict_entry_cmp(const void *a, const void *b)
+{
+    const struct cx_dict_entry *x = a;
+    const struct cx_dict_entry *y = b;
+    return strcmp(x->string.ptr, y->string.ptr);
+}
+
+static void *cx_encode_dict(const void *src, size_t src_size, size_t count,
+                            size_t *dest_size)
+{
+    struct cx_dict_entry *entries = NULL;
+    size_t *ids = NULL;
+    size_t *slots = NULL;
+    size_t *codes = NULL;
+    void *encoded = NULL;
+
+    size_t slot_count = 16;
+    while (slot_count < count * 2)
+        slot_count *= 2;
+    entries = malloc((count ? count : 1) * sizeof(*entries));
+    ids = malloc((count ? count : 1) * sizeof(*ids));
+    slots = calloc(slot_count, sizeof(*slots));
+    if (!entries || !ids || !slots)
+        goto error;
+
+    // assign each distinct string an id, in order of appearance
+    const char *ptr = src;
+    const char *end = ptr + src_size;
+    size_t entry_count = 0;
+    size_t strings_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (ptr >= end)
+            goto error;
+        struct cx_string string = {ptr, strlen(ptr)};
+        ptr += string.len + 1;
+        size_t slot = cx_encode_hash(&string) & (slot_count - 1);
+        for (;; slot = (slot + 1) & (slot_count - 1)) {
+            size_t id = slots[slot];
+            if (!id) {
+                entries[entry_count].string = string;
+                entries[entry_count].id = entry_count;
+                slots[slot] = ++entry_count;
+                strings_size += string.len + 1;
+                ids[i] = entry_count - 1;
+                break;
+            }
+            const struct cx_string *existing = &entries[id - 1].string;
+            if (existing->len == string.len &&
+                !memcmp(existing->ptr, string.ptr, string.len)) {
+                ids[i] = id - 1;
+                break;
+            }
+        }
+    }
+    if (ptr != end || entry_count > INT32_MAX)
+        goto error;
+
+    // sort the dictionary so that codes preserve the order of the strings
+    qsort(entries, entry_count, sizeof(*entries), cx_dict_entry_cmp);
+    codes = slots;  // reuse
+    for (size_t i = 0; i < entry_count; i++)
+        codes[entries[i].id] = i;
+
+    struct cx_dict_header header = {entry_count,
+                                    cx_encode_align(strings_size)};
+    size_t size = sizeof(header) + header.size + count * sizeof(int32_t);
+    encoded = calloc(1, size);
+    if (!encoded)
+        goto error;
+    memcpy(encoded, &header, sizeof(header));
+    char *strings = (char *)encoded + sizeof(header);
+    for (size_t i = 0; i < entry_count; i++) {
+        memcpy(strings, entries[i].string.ptr, entries[i].string.len + 1);
+        strings += entries[i].string.len + 1;
+    }
+    int32_t *values =
+        (int32_t *)((char *)encoded + sizeof(header) + header.size);
+    for (size_t i = 0; i < count; i++)
+        values[i] = codes[ids[i]];
+
+    *dest_size = size;
+    free(entries);
+    free(ids);
+    free(slots);
+    return encoded;
+error:
+    free(entries);
+    free(ids);
+    free(slots);
+    return NULL;
+}
+
+size_t cx_rle_value_size(enum cx_column_type type)
+{
+    switch (type) {
+        case CX_COLUMN_BIT:
+            return sizeof(uint8_t);
+        case CX_COLUMN_I32:
+            return sizeof(int32_t);
+        case CX_COLUMN_I64:
+            return sizeof(int64_t);
+        default:
+            return 0;
+    }
+}
+
+static uint64_t cx_rle_value(enum cx_column_type type, const void *src,
+                             size_t index)
+{
+    switch (type) {
+        case CX_COLUMN_BIT:
+            return (((const uint64_t *)src)[index / 64] >> (index % 64)) & 1;
+        case CX_COLUMN_I32:
+            return (uint32_t)((const int32_t *)src)[index];
+        case CX_COLUMN_I64:
+            return ((const uint64_t *)src)[index];
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+static size_t cx_rle_runs(enum cx_column_type type, const void *src,
+                          size_t count)
+{
+    size_t runs = 0;
+    for (size_t i = 0; i < count; i++)
+        if (!i || cx_rle_value(type, src, i) != cx_rle_value(type, src, i - 1))
+            runs++;
+    return runs;
+}
+
+static void *cx_encode_rle(enum cx_column_type type, const void *src,
+                           size_t src_size, size_t count, size_t *dest_size)
+{
+    size_t value_size = cx_rle_value_size(type);
+    if (count > UINT32_MAX)
+        return NULL;
+    if (type == CX_COLUMN_BIT) {
+        if (src_size < (count + 63) / 64 * sizeof(uint64_t))
+            return NULL;
+    } else if (src_size < count * value_size) {
+        return NULL;
+    }
+
+    // count the runs first so that the output can be sized exactly
+    size_t run_count = cx_rle_runs(type, src, count);
+
+    struct cx_rle_header header = {run_count};
+    size_t ends_size = cx_encode_align(run_count * sizeof(uint32_t));
+    size_t values_size = cx_encode_align(run_count * value_size);
+    size_t size = sizeof(header) + ends_size + values_size;
+    void *encoded = calloc(1, size);
+    if (!encoded)
+        return NULL;
+    memcpy(encoded, &header, sizeof(header));
+    uint32_t *ends = (uint32_t *)((char *)encoded + sizeof(header));
+    char *values = (char *)ends + ends_size;
+    size_t run = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t value = cx_rle_value(type, src, i);
+        if (i && value == cx_rle_value(type, src, i - 1)) {
+            ends[run - 1]++;
+            continue;
+        }
+        ends[run] = i + 1;
+        if (type == CX_COLUMN_BIT) {
+            values[run] = value;
+        } else if (type == CX_COLUMN_I32) {
+            int32_t i32 = value;
+            memcpy(values + run * value_size, &i32, value_size);
+        } else {
+            memcpy(values + run * value_size, &value, value_size);
+        }
+        run++;
+    }
+    *dest_size = size;
+    return encoded;
+}
+
+static size_t cx_for_width(uint64_t value)
+{
+    return value ? 64 - __builtin_clzll(value) : 0;
+}
+
+static void cx_for_pack(uint64_t *packed, size_t width, size_t index,
+                        uint64_t value)
+{
+    if (!width)
+        return;
+    size_t bit = index * width;
+    size_t word = bit / 64, shift = bit % 64;
+    packed[word] |= value << shift;
+    if (shift + width > 64)
+        packed[word + 1] |= value >> (64 - shift);
+}
+
+// pick a mode and width for the block of n values starting at offset
+static void cx_for_block_plan(enum cx_column_type type, const void *src,
+                              size_t offset, size_t n,
+                              struct cx_for_block *block)
+{
+    uint64_t values[CX_FOR_BLOCK_SIZE];
+    int64_t min = INT64_MAX, max = INT64_MIN;
+    uint64_t min_delta = UINT64_MAX, max_delta = 0;
+    bool sorted = true;
+    for (size_t j = 0; j < n; j++) {
+        int64_t value = type == CX_COLUMN_I32
+                            ? ((const int32_t *)src)[offset + j]
+                            : ((const int64_t *)src)[offset + j];
+        values[j] = value;
+        if (value < min)
+            min = value;
+        if (value > max)
+            max = value;
+        if (j) {
+            sorted = sorted && value >= (int64_t)values[j - 1];
+            uint64_t delta = values[j] - values[j - 1];
+            if (delta < min_delta)
+                min_delta = delta;
+            if (delta > max_delta)
+                max_delta = delta;
+        }
+    }
+    block->mode = CX_FOR_MODE_BASE;
+    block->base = min;
+    block->width = cx_for_width((uint64_t)max - (uint64_t)min);
+    if (sorted && n > 1) {
+        size_t width = cx_for_width(max_delta - min_delta);
+        if (width < block->width) {
+            block->mode = CX_FOR_MODE_DELTA;
+            block->base = values[0];
+            block->step = min_delta;
+            block->width = width;
+        }
+    }
+}
+
+static void *cx_encode_for(enum cx_column_type type, const void *src,
+                           size_t src_size, size_t count, size_t *dest_size)
+{
+    size_t value_size = type == CX_COLUMN_I32 ? sizeof(int32_t)
+                                              : sizeof(int64_t);
+    if (src_size < count * value_size)
+        return NULL;
+    size_t block_count = (count + CX_FOR_BLOCK_SIZE - 1) / CX_FOR_BLOCK_SIZE;
+    struct cx_for_block *blocks =
+        calloc(block_count ? block_count : 1, sizeof(*blocks));
+    if (!blocks)
+        return NULL;
+
+    size_t packed_size = 0;
+    for (size_t i = 0; i < block_count; i++) {
+        size_t offset = i * CX_FOR_BLOCK_SIZE;
+        size_t n = count - offset;
+        if (n > CX_FOR_BLOCK_SIZE)
+            n = CX_FOR_BLOCK_SIZE;
+        struct cx_for_block *block = &blocks[i];
+        cx_for_block_plan(type, src, offset, n, block);
+        if (packed_size > UINT32_MAX)
+            goto error;
+        block->offset = packed_size;
+        packed_size += block->width * sizeof(uint64_t);
+    }
+
+    struct cx_for_header header = {block_count};
+    size_t blocks_size = block_count * sizeof(*blocks);
+    size_t size = sizeof(header) + blocks_size + packed_size + 8;
+    void *encoded = calloc(1, size);
+    if (!encoded)
+        goto error;
+    memcpy(encoded, &header, sizeof(header));
+    memcpy((char *)encoded + sizeof(header), blocks, blocks_size);
+    char *packed = (char *)encoded + sizeof(header) + blocks_size;
+    for (size_t i = 0; i < block_count; i++) {
+        const struct cx_for_block *block = &blocks[i];
+        uint64_t *block_packed = (uint64_t *)(packed + block->offset);
+        size_t offset = i * CX_FOR_BLOCK_SIZE;
+        size_t n = count - offset;
+        if (n > CX_FOR_BLOCK_SIZE)
+            n = CX_FOR_BLOCK_SIZE;
+        uint64_t previous = block->base;
+        for (size_t j = 0; j < n; j++) {
+            uint64_t value = type == CX_COLUMN_I32
+                                 ? (uint64_t)((const int32_t *)src)[offset + j]
+                                 : (uint64_t)((const int64_t *)src)[offset + j];
+            uint64_t packed_value;
+            if (block->mode == CX_FOR_MODE_DELTA) {
+                packed_value = j ? value - previous - block->step : 0;
+                previous = value;
+            } else {
+                packed_value = value - block->base;
+            }
+            cx_for_pack(block_packed, block->width, j, packed_value);
+        }
+    }
+    free(blocks);
+    *dest_size = size;
+    return encoded;
+error:
+    free(blocks);
+    return NULL;
+}
+
+static void cx_for_unpack(const uint64_t *packed, size_t width,
+                          uint64_t values[CX_FOR_BLOCK_SIZE])
+{
+    if (!width) {
+        memset(values, 0, CX_FOR_BLOCK_SIZE * sizeof(uint64_t));
+        return;
+    } else if (width == 64) {
+        memcpy(values, packed, CX_FOR_BLOCK_SIZE * sizeof(uint64_t));
+        return;
+    }
+    uint64_t mask = ((uint64_t)1 << width) - 1;
+    size_t i = 0;
+#if defined(CX_AVX512) || defined(CX_AVX2)
+    // gather 8 bytes starting at the byte containing each value, then
+    // shift and mask. Values wider than 56 bits may span 9 bytes
+    if (width <= 56) {
+        __m256i v_mask = _mm256_set1_epi64x(mask);
+        __m256i v_seven = _mm256_set1_epi64x(7);
+        __m256i v_step = _mm256_set1_epi64x(4 * width);
+        __m256i v_bits = _mm256_set_epi64x(3 * width, 2 * width, width, 0);
+        for (; i < CX_FOR_BLOCK_SIZE; i += 4) {
+            __m256i v_bytes = _mm256_srli_epi64(v_bits, 3);
+            __m256i v_words = _mm256_i64gather_epi64(
+                (const long long *)packed, v_bytes, 1);
+            __m256i v_shift = _mm256_and_si256(v_bits, v_seven);
+            __m256i v_values =
+                _mm256_and_si256(_mm256_srlv_epi64(v_words, v_shift), v_mask);
+            _mm256_storeu_si256((__m256i *)(values + i), v_values);
+            v_bits = _mm256_add_epi64(v_bits, v_step);
+        }
+    }
+#endif
+    for (; i < CX_FOR_BLOCK_SIZE; i++) {
+        size_t bit = i * width;
+        size_t word = bit / 64, shift = bit % 64;
+        uint64_t value = packed[word] >> shift;
+        if (shift + width > 64)
+            value |= packed[word + 1] << (64 - shift);
+        values[i] = value & mask;
+    }
+}
+
+void cx_for_decode(const struct cx_for_block *block, const uint64_t *packed,
+                   int64_t values[CX_FOR_BLOCK_SIZE])
+{
+    uint64_t *unpacked = (uint64_t *)values;
+    cx_for_unpack(packed, block->width, unpacked);
+    uint64_t base = block->base;
+    if (block->mode == CX_FOR_MODE_DELTA) {
+        uint64_t step = block->step;
+        unpacked[0] = base;
+        for (size_t i = 1; i < CX_FOR_BLOCK_SIZE; i++)
+            unpacked[i] += unpacked[i - 1] + step;
+    } else {
+        for (size_t i = 0; i < CX_FOR_BLOCK_SIZE; i++)
+            unpacked[i] += base;
+    }
+}
+
+void cx_for_bounds(const struct cx_for_block *block, size_t count,
+                   int64_t *min, int64_t *max)
+{
+    // the minimum is exact, while the maximum is an upper bound derived
+    // from the packed width
+    uint64_t mask =
+        block->width == 64 ? UINT64_MAX : ((uint64_t)1 << block->width) - 1;
+    uint64_t range = mask;
+    if (block->mode == CX_FOR_MODE_DELTA) {
+        uint64_t delta;
+        if (__builtin_add_overflow((uint64_t)block->step, mask, &delta) ||
+            __builtin_mul_overflow(delta, count ? count - 1 : 0, &range))
+            range = UINT64_MAX;
+    }
+    uint64_t headroom = (uint64_t)INT64_MAX - (uint64_t)block->base;
+    *min = block->base;
+    *max = range > headroom ? INT64_MAX : (int64_t)(block->base + range);
+}
+
+static void *cx_encode_offsets(const void *src, size_t src_size, size_t count,
+                               size_t *dest_size)
+{
+    if (src_size > UINT32_MAX)
+        return NULL;
+    struct cx_offsets_header header = {count};
+    size_t offsets_size = cx_encode_align((count + 1) * sizeof(uint32_t));
+    size_t size = sizeof(header) + offsets_size + src_size;
+    void *encoded = calloc(1, size);
+    if (!encoded)
+        return NULL;
+    memcpy(encoded, &header, sizeof(header));
+    uint32_t *offsets = (uint32_t *)((char *)encoded + sizeof(header));
+    const char *ptr = src;
+    const char *end = ptr + src_size;
+    for (size_t i = 0; i < count; i++) {
+        if (ptr >= end)
+            goto error;
+        offsets[i] = ptr - (const char *)src;
+        ptr += strlen(ptr) + 1;
+    }
+    if (ptr != end)
+        goto error;
+    offsets[count] = src_size;
+    memcpy((char *)offsets + offsets_size, src, src_size);
+    *dest_size = size;
+    return encoded;
+error:
+    free(encoded);
+    return NULL;
+}
+
+static void *cx_encode_float(enum cx_column_type type,
+                             enum cx_encoding_type encoding, const void *src,
+                             size_t src_size, size_t count, size_t *dest_size)
+{
+    size_t width = type == CX_COLUMN_FLT ? sizeof(float) : sizeof(double);
+    if (src_size != count * width)
+        return NULL;
+    struct cx_float_header header = {count};
+    size_t size = sizeof(header) + src_size;
+    void *encoded = malloc(size);
+    if (!encoded)
+        return NULL;
+    memcpy(encoded, &header, sizeof(header));
+    uint8_t *dest = (uint8_t *)encoded + sizeof(header);
+    if (encoding == CX_ENCODING_SPLIT) {
+        const uint8_t *bytes = src;
+        for (size_t i = 0; i < count; i++)
+            for (size_t j = 0; j < width; j++)
+                dest[j * count + i] = bytes[i * width + j];
+    } else if (width == sizeof(uint32_t)) {
+        uint32_t previous = 0, value;
+        for (size_t i = 0; i < count; i++) {
+            memcpy(&value, (const uint32_t *)src + i, sizeof(value));
+            ((uint32_t *)dest)[i] = value ^ previous;
+            previous = value;
+        }
+    } else {
+        uint64_t previous = 0, value;
+        for (size_t i = 0; i < count; i++) {
+            memcpy(&value, (const uint64_t *)src + i, sizeof(value));
+            ((uint64_t *)dest)[i] = value ^ previous;
+            previous = value;
+        }
+    }
+    *dest_size = size;
+    return encoded;
+}
+
+uint32_t cx_xor_decode32(const uint32_t *src, size_t count, uint32_t previous,
+                         uint32_t *dest)
+{
+    size_t i = 0;
+#if CX_SSE42
+    // prefix XOR across the lanes, then carry the last lane forward
+    __m128i v_carry = _mm_set1_epi32(previous);
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        v = _mm_xor_si128(v, _mm_slli_si128(v, 4));
+        v = _mm_xor_si128(v, _mm_slli_si128(v, 8));
+        v = _mm_xor_si128(v, v_carry);
+        _mm_storeu_si128((__m128i *)(dest + i), v);
+        v_carry = _mm_shuffle_epi32(v, 0xFF);
+    }
+    previous = _mm_cvtsi128_si32(v_carry);
+#endif
+    for (; i < count; i++)
+        previous = dest[i] = src[i] ^ previous;
+    return previous;
+}
+
+uint64_t cx_xor_decode64(const uint64_t *src, size_t count, uint64_t previous,
+                         uint64_t *dest)
+{
+    size_t i = 0;
+#if CX_SSE42
+    __m128i v_carry = _mm_set1_epi64x(previous);
+    for (; i + 2 <= count; i += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        v = _mm_xor_si128(v, _mm_slli_si128(v, 8));
+        v = _mm_xor_si128(v, v_carry);
+        _mm_storeu_si128((__m128i *)(dest + i), v);
+        v_carry = _mm_unpackhi_epi64(v, v);
+    }
+    previous = _mm_cvtsi128_si64(v_carry);
+#endif
+    for (; i < count; i++)
+        previous = dest[i] = src[i] ^ previous;
+    return previous;
+}
+
+void cx_split_decode(const uint8_t *streams, size_t width, size_t stride,
+                     size_t row, size_t count, void *dest)
+{
+    uint8_t *bytes = dest;
+    size_t i = 0;
+#if CX_SSE42
+    // transpose 16 rows at a time by interleaving the byte streams
+    if (width == sizeof(double)) {
+        for (; i + 16 <= count; i += 16) {
+            __m128i s[8];
+            for (size_t j = 0; j < 8; j++)
+                s[j] = _mm_loadu_si128(
+                    (const __m128i *)(streams + j * stride + row + i));
+            __m128i b[8], c[8];
+            for (size_t j = 0; j < 4; j++) {
+                b[j] = _mm_unpacklo_epi8(s[2 * j], s[2 * j + 1]);
+                b[j + 4] = _mm_unpackhi_epi8(s[2 * j], s[2 * j + 1]);
+            }
+            for (size_t j = 0; j < 8; j += 4) {
+                c[j] = _mm_unpacklo_epi16(b[j], b[j + 1]);
+                c[j + 1] = _mm_unpackhi_epi16(b[j], b[j + 1]);
+                c[j + 2] = _mm_unpacklo_epi16(b[j + 2], b[j + 3]);
+                c[j + 3] = _mm_unpackhi_epi16(b[j + 2], b[j + 3]);
+            }
+            __m128i *out = (__m128i *)(bytes + i * 8);
+            for (size_t j = 0; j < 8; j += 4) {
+                for (size_t k = 0; k < 2; k++) {
+                    __m128i lo = c[j + k], hi = c[j + k + 2];
+                    _mm_storeu_si128(out++, _mm_unpacklo_epi32(lo, hi));
+                    _mm_storeu_si128(out++, _mm_unpackhi_epi32(lo, hi));
+                }
+            }
+        }
+    } else if (width == sizeof(float)) {
+        for (; i + 16 <= count; i += 16) {
+            __m128i s[4];
+            for (size_t j = 0; j < 4; j++)
+                s[j] = _mm_loadu_si128(
+                    (const __m128i *)(streams + j * stride + row + i));
+            __m128i b0 = _mm_unpacklo_epi8(s[0], s[1]);
+            __m128i b1 = _mm_unpackhi_epi8(s[0], s[1]);
+            __m128i b2 = _mm_unpacklo_epi8(s[2], s[3]);
+            __m128i b3 = _mm_unpackhi_epi8(s[2], s[3]);
+            __m128i *out = (__m128i *)(bytes + i * 4);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(b0, b2));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(b0, b2));
+            _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(b1, b3));
+            _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(b1, b3));
+        }
+    }
+#endif
+    for (; i < count; i++)
+        for (size_t j = 0; j < width; j++)
+            bytes[i * width + j] = streams[j * stride + row + i];
+}
+
+// the estimated size of each candidate encoding must be below this
+// fraction of the plain size before it's worth paying to decode it
+#define CX_SELECT_THRESHOLD(size) ((size) / 4 * 3)
+
+// distinct strings are estimated by hashing into a bitmap of this many
+// bits. Once half the bits are set the estimate is considered too high
+// for a dictionary to pay off
+#define CX_SELECT_DISTINCT_BITS (1 << 14)
+
+static size_t cx_select_rle_size(enum cx_column_type type, size_t runs)
+{
+    return sizeof(struct cx_rle_header) +
+           cx_encode_align(runs * sizeof(uint32_t)) +
+           cx_encode_align(runs * cx_rle_value_size(type));
+}
+
+static enum cx_encoding_type cx_select_int(enum cx_column_type type,
+                                           const void *src, size_t src_size,
+                                           size_t count)
+{
+    size_t value_size = type == CX_COLUMN_I32 ? sizeof(int32_t)
+                                              : sizeof(int64_t);
+    if (src_size < count * value_size)
+        return CX_ENCODING_NONE;
+    size_t rle_size =
+        cx_select_rle_size(type, cx_rle_runs(type, src, count));
+    size_t block_count = (count + CX_FOR_BLOCK_SIZE - 1) / CX_FOR_BLOCK_SIZE;
+    size_t for_size = sizeof(struct cx_for_header) +
+                      block_count * sizeof(struct cx_for_block) + 8;
+    for (size_t i = 0; i < block_count; i++) {
+        size_t offset = i * CX_FOR_BLOCK_SIZE;
+        size_t n = count - offset;
+        if (n > CX_FOR_BLOCK_SIZE)
+            n = CX_FOR_BLOCK_SIZE;
+        struct cx_for_block block;
+        cx_for_block_plan(type, src, offset, n, &block);
+        for_size += block.width * sizeof(uint64_t);
+    }
+    size_t threshold = CX_SELECT_THRESHOLD(count * value_size);
+    if (rle_size <= for_size && rle_size < threshold)
+        return CX_ENCODING_RLE;
+    if (for_size < threshold)
+        return CX_ENCODING_FOR;
+    return CX_ENCODING_NONE;
+}
+
+static enum cx_encoding_type cx_select_str(const void *src, size_t src_size,
+                                           size_t count)
+{
+    uint64_t bitmap[CX_SELECT_DISTINCT_BITS / 64] = {0};
+    size_t distinct = 0;
+    const char *ptr = src;
+    const char *end = ptr + src_size;
+    for (size_t i = 0; i < count && ptr < end; i++) {
+        struct cx_string string = {ptr, strlen(ptr)};
+        uint64_t bit = cx_encode_hash(&string) % CX_SELECT_DISTINCT_BITS;
+        uint64_t mask = (uint64_t)1 << (bit % 64);
+        if (!(bitmap[bit / 64] & mask)) {
+            bitmap[bit / 64] |= mask;
+            if (++distinct > CX_SELECT_DISTINCT_BITS / 2)
+                return CX_ENCODING_NONE;
+        }
+        ptr += string.len + 1;
+    }
+    if (!count)
+        return CX_ENCODING_NONE;
+    // assume distinct strings have the average length
+    size_t dict_size = sizeof(struct cx_dict_header) +
+                       cx_encode_align(src_size / count * distinct) +
+                       count * sizeof(int32_t);
+    if (dict_size < CX_SELECT_THRESHOLD(src_size))
+        return CX_ENCODING_DICT;
+    return CX_ENCODING_NONE;
+}
+
+static enum cx_encoding_type cx_select_float(enum cx_column_type type,
+                                             const void *src, size_t src_size,
+                                             size_t count)
+{
+    size_t width = type == CX_COLUMN_FLT ? sizeof(float) : sizeof(double);
+    if (src_size < count * width || !count)
+        return CX_ENCODING_NONE;
+    // XOR pays off when consecutive values share their leading bytes,
+    // otherwise splitting the bytes still groups the sign and exponent
+    size_t zero_bytes = 0;
+    for (size_t i = 1; i < count; i++) {
+        uint64_t delta;
+        if (type == CX_COLUMN_FLT)
+            delta = (uint64_t)(((const uint32_t *)src)[i] ^
+                               ((const uint32_t *)src)[i - 1])
+                    << 32;
+        else
+            delta = ((const uint64_t *)src)[i] ^ ((const uint64_t *)src)[i - 1];
+        zero_bytes += delta ? __builtin_clzll(delta) / 8 : width;
+    }
+    if (zero_bytes >= count * width / 4)
+        return CX_ENCODING_XOR;
+    return CX_ENCODING_SPLIT;
+}
+
+enum cx_encoding_type cx_encoding_select(enum cx_column_type type,
+                                         const void *src, size_t src_size,
+                                         size_t count, bool compressed)
+{
+    switch (type) {
+        case CX_COLUMN_BIT: {
+            size_t runs = cx_rle_runs(type, src, count);
+            if (cx_select_rle_size(type, runs) < src_size / 2)
+                return CX_ENCODING_RLE;
+        } break;
+        case CX_COLUMN_I32:
+        case CX_COLUMN_I64:
+            return cx_select_int(type, src, src_size, count);
+        case CX_COLUMN_FLT:
+        case CX_COLUMN_DBL:
+            // the float encodings only help the codec
+            if (compressed)
+                return cx_select_float(type, src, src_size, count);
+            break;
+        case CX_COLUMN_STR:
+            return cx_select_str(src, src_size, count);
+    }
+    return CX_ENCODING_NONE;
+}
+
+bool cx_encoding_valid(enum cx_column_type type,
+                       enum cx_encoding_type encoding)
+{
+    switch (encoding) {
+        case CX_ENCODING_NONE:
+            return true;
+        case CX_ENCODING_DICT:
+            return type == CX_COLUMN_STR;
+        case CX_ENCODING_RLE:
+            return type == CX_COLUMN_BIT || type == CX_COLUMN_I32 ||
+                   type == CX_COLUMN_I64;
+        case CX_ENCODING_FOR:
+            return type == CX_COLUMN_I32 || type == CX_COLUMN_I64;
+        case CX_ENCODING_OFFSETS:
+            return type == CX_COLUMN_STR;
+        case CX_ENCODING_XOR:
+        case CX_ENCODING_SPLIT:
+            return type == CX_COLUMN_FLT || type == CX_COLUMN_DBL;
+        case CX_ENCODING_AUTO:
+            // resolved to a concrete encoding by the writer
+            return false;
+    }
+    return false;
+}
+
+void *cx_encode(enum cx_column_type type, enum cx_encoding_type encoding,
+                const void *src, size_t src_size, size_t count,
+                size_t *dest_size)
+{
+    if (!cx_encoding_valid(type, encoding))
+        return NULL;
+    switch (encoding) {
+        case CX_ENCODING_DICT:
+            return cx_encode_dict(src, src_size, count, dest_size);
+        case CX_ENCODING_RLE:
+            return cx_encode_rle(type, src, src_size, count, dest_size);
+        case CX_ENCODING_FOR:
+            return cx_encode_for(type, src, src_size, count, dest_size);
+        case CX_ENCODING_OFFSETS:
+            return cx_encode_offsets(src, src_size, count, dest_size);
+        case CX_ENCODING_XOR:
+        case CX_ENCODING_SPLIT:
+            return cx_encode_float(type, encoding, src, src_size, count,
+                                   dest_size);
+        default:
+            return NULL;
+    }
+}
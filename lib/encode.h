@@ -0,0 +1,100 @@
+#ifndef CX_ENCODE_H_
+#define CX_ENCODE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "common.h"
+
+// a dictionary encoded STR column starts with this header, followed by
+// the sorted and NUL-terminated dictionary strings (padded to 8 bytes),
+// followed by an int32_t code for each value in the column
+struct cx_dict_header {
+    uint64_t count;
+    uint64_t size;
+};
+
+// a run-length encoded column starts with this header, followed by the
+// (exclusive) end row of each run as a uint32_t, followed by the value of
+// each run. Values are one byte for BIT columns. Both arrays are padded to
+// 8 bytes
+struct cx_rle_header {
+    uint64_t count;
+};
+
+size_t cx_rle_value_size(enum cx_column_type);
+
+// a frame-of-reference encoded column starts with this header, followed by
+// a cx_for_block for each block of CX_FOR_BLOCK_SIZE values, followed by
+// the bit-packed values of each block and 8 bytes of padding
+#define CX_FOR_BLOCK_SIZE 64
+
+struct cx_for_header {
+    uint64_t count;
+};
+
+enum cx_for_mode { CX_FOR_MODE_BASE, CX_FOR_MODE_DELTA };
+
+// in BASE mode, values are packed as the difference from the base (the
+// block minimum). In DELTA mode, which is used for non-decreasing blocks,
+// the base is the first value and the difference between consecutive
+// values, less the step (the minimum difference), is packed
+struct cx_for_block {
+    int64_t base;
+    int64_t step;
+    uint32_t offset;
+    uint8_t width;
+    uint8_t mode;
+    uint16_t __padding;
+};
+
+void cx_for_decode(const struct cx_for_block *, const uint64_t *packed,
+                   int64_t values[CX_FOR_BLOCK_SIZE]);
+
+void cx_for_bounds(const struct cx_for_block *, size_t count, int64_t *min,
+                   int64_t *max);
+
+// an offset-indexed STR column starts with this header, followed by the
+// offset of each string (and the end offset) as a uint32_t, padded to
+// 8 bytes, followed by the NUL-terminated strings. Offsets are relative
+// to the start of the strings
+struct cx_offsets_header {
+    uint64_t count;
+};
+
+// XOR and byte-stream-split encoded FLT/DBL columns start with this
+// header. XOR columns are followed by each value XOR'd with the previous
+// value, so that the leading bytes of slowly changing values are zero.
+// SPLIT columns are followed by a stream for each byte of the value, where
+// stream i holds byte i of every value. Both leave the result to the codec
+struct cx_float_header {
+    uint64_t count;
+};
+
+uint32_t cx_xor_decode32(const uint32_t *src, size_t count, uint32_t previous,
+                         uint32_t *dest);
+
+uint64_t cx_xor_decode64(const uint64_t *src, size_t count, uint64_t previous,
+                         uint64_t *dest);
+
+void cx_split_decode(const uint8_t *streams, size_t width, size_t stride,
+                     size_t row, size_t count, void *dest);
+
+bool cx_encoding_valid(enum cx_column_type, enum cx_encoding_type);
+
+// choose an encoding for the column from cheap statistics (the number of
+// runs, the packed width of each block, an estimate of distinct strings,
+// the leading zero bytes of consecutive floats)
+enum cx_encoding_type cx_encoding_select(enum cx_column_type, const void *src,
+                                         size_t src_size, size_t count,
+                                         bool compressed);
+
+void *cx_encode(enum cx_column_type, enum cx_encoding_type, const void *src,
+                size_t src_size, size_t count, size_t *dest_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
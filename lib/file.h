@@ -9,7 +9,7 @@ extern "C" {
 
 #define CX_FILE_MAGIC 0x7863040378630201LLU
 
-#define CX_FILE_VERSION 1
+#define CX_FILE_VERSION 2
 
 #define CX_WRITE_ALIGN 8
 
@@ -19,9 +19,16 @@ struct cx_header {
     uint32_t __padding;
 };
 
+// the file index at index_offset has a pair of indexes (values and nulls)
+// for each column, which summarize the column across all row groups. The
+// stats at stats_offset have the min values of column 0 in each row group,
+// followed by the max values, followed by the min and max values of column
+// 1 and so on (see cx_index_stats)
 struct cx_footer {
     uint64_t strings_offset;
     uint64_t strings_size;
+    uint64_t index_offset;
+    uint64_t stats_offset;
     int32_t metadata;
     uint32_t __padding;
     uint32_t row_group_count;
@@ -38,14 +45,33 @@ struct cx_column_descriptor {
     uint32_t encoding;
     uint32_t compression;
     int32_t compression_level;
-    uint32_t __padding;
+    uint32_t flags;
 };
 
+// the writer builds a Bloom filter for each chunk of the column
+#define CX_COLUMN_FLAG_BLOOM 1
+
+// the writer adds the column to the inverted index sidecar
+#define CX_COLUMN_FLAG_INVERTED 2
+
+// the writer builds a trigram filter for each chunk of the column
+#define CX_COLUMN_FLAG_TRIGRAM 4
+
 struct cx_row_group_header {
     uint64_t size;
     uint64_t offset;
 };
 
+// the number of rows in each page of a column chunk, by default
+#define CX_PAGE_SIZE 8192
+
+// a column chunk with pages is a table of page_count headers (one for each
+// independently encoded and compressed page) located at offset. All pages
+// but the last have the same number of rows, which is a multiple of 64.
+// A chunk can also have a Bloom filter of bloom_size bytes at bloom_offset,
+// and a trigram filter of trigram_size bytes at trigram_offset, which cover
+// all of its pages. A chunk without pages or data (size 0) is constant (see
+// cx_index_constant), and every row has the value from its index
 struct cx_column_header {
     uint64_t offset;
     uint64_t size;
@@ -53,6 +79,12 @@ struct cx_column_header {
     uint32_t compression;
     uint32_t encoding;
     struct cx_index index;
+    uint32_t page_count;
+    uint32_t __padding;
+    uint64_t bloom_offset;
+    uint64_t bloom_size;
+    uint64_t trigram_offset;
+    uint64_t trigram_size;
 };
 
 #ifdef __cplusplus
@@ -1,20 +1,141 @@
 #define __STDC_LIMIT_MACROS
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "bloom.h"
 #include "index.h"
 
+struct cx_index_sampler;
+
 static void cx_index_update_bit(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_i32(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_i64(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_flt(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_dbl(struct cx_index *, struct cx_column_cursor *);
-static void cx_index_update_str(struct cx_index *, struct cx_column_cursor *);
+static void cx_index_update_i32(struct cx_index *, struct cx_column_cursor *,
+                                uint8_t *registers,
+                                struct cx_index_sampler *);
+static void cx_index_update_i64(struct cx_index *, struct cx_column_cursor *,
+                                uint8_t *registers,
+                                struct cx_index_sampler *);
+static void cx_index_update_flt(struct cx_index *, struct cx_column_cursor *,
+                                uint8_t *registers,
+                                struct cx_index_sampler *);
+static void cx_index_update_dbl(struct cx_index *, struct cx_column_cursor *,
+                                uint8_t *registers,
+                                struct cx_index_sampler *);
+static void cx_index_update_str(struct cx_index *, struct cx_column_cursor *,
+                                uint8_t *registers);
+
+// distinct values are estimated with a HyperLogLog sketch of
+// 2^CX_INDEX_HLL_BITS registers, which has a standard error of ~3%
+#define CX_INDEX_HLL_BITS 10
+#define CX_INDEX_HLL_REGISTERS (1 << CX_INDEX_HLL_BITS)
+
+static void cx_index_hll_add(uint8_t *registers, uint64_t hash)
+{
+    size_t i = hash >> (64 - CX_INDEX_HLL_BITS);
+    uint64_t rest = hash << CX_INDEX_HLL_BITS;
+    uint8_t rank =
+        rest ? __builtin_clzll(rest) + 1 : 64 - CX_INDEX_HLL_BITS + 1;
+    if (rank > registers[i])
+        registers[i] = rank;
+}
+
+static uint64_t cx_index_hll_estimate(const uint8_t *registers,
+                                      uint64_t count)
+{
+    double m = CX_INDEX_HLL_REGISTERS;
+    double sum = 0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < CX_INDEX_HLL_REGISTERS; i++) {
+        sum += 1.0 / ((uint64_t)1 << registers[i]);
+        zeros += !registers[i];
+    }
+    double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    // use linear counting for small cardinalities
+    if (estimate <= 2.5 * m && zeros)
+        estimate = m * log(m / zeros);
+    uint64_t distinct = estimate + 0.5;
+    if (distinct > count)
+        distinct = count;
+    if (!distinct && count)
+        distinct = 1;
+    return distinct;
+}
+
+static uint64_t cx_index_hash_flt(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return cx_bloom_hash_i64(bits);
+}
+
+static uint64_t cx_index_hash_dbl(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return cx_bloom_hash_i64(bits);
+}
+
+// histograms are built from up to CX_INDEX_HISTOGRAM_SAMPLES evenly spaced
+// values. Samples are sorted by their value as a double, which preserves
+// their order
+#define CX_INDEX_HISTOGRAM_SAMPLES 1024
+
+struct cx_index_sample {
+    double key;
+    cx_index_value_t value;
+};
+
+struct cx_index_sampler {
+    size_t stride;
+    size_t position;
+    size_t count;
+    struct cx_index_sample samples[CX_INDEX_HISTOGRAM_SAMPLES];
+};
+
+static void cx_index_sampler_add(struct cx_index_sampler *sampler, double key,
+                                 cx_index_value_t value)
+{
+    size_t position = sampler->position++;
+    if (position % sampler->stride || isnan(key) ||
+        sampler->count == CX_INDEX_HISTOGRAM_SAMPLES)
+        return;
+    struct cx_index_sample *sample = &sampler->samples[sampler->count++];
+    sample->key = key;
+    sample->value = value;
+}
+
+static int cx_index_sample_compare(const void *a, const void *b)
+{
+    const struct cx_index_sample *x = a, *y = b;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+static void cx_index_set_histogram(struct cx_index *index,
+                                   struct cx_index_sampler *sampler)
+{
+    if (!sampler->count)
+        return;
+    qsort(sampler->samples, sampler->count, sizeof(*sampler->samples),
+          cx_index_sample_compare);
+    for (size_t i = 1; i < CX_INDEX_HISTOGRAM_BUCKETS; i++) {
+        size_t sample = i * (sampler->count - 1) / CX_INDEX_HISTOGRAM_BUCKETS;
+        index->quantiles[i - 1] = sampler->samples[sample].value;
+    }
+    index->flags |= CX_INDEX_HISTOGRAM;
+}
 
 struct cx_index *cx_index_new(const struct cx_column *column)
 {
+    uint8_t registers[CX_INDEX_HLL_REGISTERS] = {0};
+    struct cx_index_sampler sampler = {0};
+    size_t count = cx_column_count(column);
+    sampler.stride = (count + CX_INDEX_HISTOGRAM_SAMPLES - 1) /
+                     CX_INDEX_HISTOGRAM_SAMPLES;
+    if (!sampler.stride)
+        sampler.stride = 1;
     struct cx_index *index = calloc(1, sizeof(*index));
     if (!index)
         return NULL;
@@ -28,25 +149,34 @@ struct cx_index *cx_index_new(const struct cx_column *column)
             break;
         case CX_COLUMN_I32:
             index->min.i32 = INT32_MAX;
-            cx_index_update_i32(index, cursor);
+            index->max.i32 = INT32_MIN;
+            cx_index_update_i32(index, cursor, registers, &sampler);
             break;
         case CX_COLUMN_I64:
             index->min.i64 = INT64_MAX;
-            cx_index_update_i64(index, cursor);
+            index->max.i64 = INT64_MIN;
+            cx_index_update_i64(index, cursor, registers, &sampler);
             break;
         case CX_COLUMN_FLT:
             index->min.flt = FLT_MAX;
-            cx_index_update_flt(index, cursor);
+            index->max.flt = -FLT_MAX;
+            cx_index_update_flt(index, cursor, registers, &sampler);
             break;
         case CX_COLUMN_DBL:
             index->min.dbl = DBL_MAX;
-            cx_index_update_dbl(index, cursor);
+            index->max.dbl = -DBL_MAX;
+            cx_index_update_dbl(index, cursor, registers, &sampler);
             break;
         case CX_COLUMN_STR:
             index->min.len = UINT64_MAX;
-            cx_index_update_str(index, cursor);
+            cx_index_update_str(index, cursor, registers);
             break;
     }
+    if (cx_column_type(column) != CX_COLUMN_BIT)
+        index->distinct_count = cx_index_hll_estimate(registers, index->count);
+    else if (index->count)
+        index->distinct_count = 1 + (index->min.bit != index->max.bit);
+    cx_index_set_histogram(index, &sampler);
     cx_column_cursor_free(cursor);
     return index;
 error:
@@ -59,6 +189,41 @@ void cx_index_free(struct cx_index *index)
     free(index);
 }
 
+bool cx_index_count_nulls(struct cx_index *index, const struct cx_column *nulls,
+                          size_t start)
+{
+    assert(start % 64 == 0);
+    struct cx_column_cursor *cursor = cx_column_cursor_new(nulls);
+    if (!cursor)
+        return false;
+    size_t remaining = index->count;
+    uint64_t null_count = 0;
+    if (cx_column_cursor_skip_bit(cursor, start) != start)
+        goto error;
+    while (remaining && cx_column_cursor_valid(cursor)) {
+        size_t count;
+        const uint64_t *bitset =
+            cx_column_cursor_next_batch_bit(cursor, &count);
+        if (count > remaining)
+            count = remaining;
+        for (size_t i = 0; i < count; i += 64) {
+            uint64_t word = bitset[i / 64];
+            if (count - i < 64)
+                word &= ((uint64_t)1 << (count - i)) - 1;
+            null_count += __builtin_popcountll(word);
+        }
+        remaining -= count;
+    }
+    if (remaining)
+        goto error;
+    cx_column_cursor_free(cursor);
+    index->null_count = null_count;
+    return true;
+error:
+    cx_column_cursor_free(cursor);
+    return false;
+}
+
 static void cx_index_update_bit(struct cx_index *index,
                                 struct cx_column_cursor *cursor)
 {
@@ -76,81 +241,168 @@ static void cx_index_update_bit(struct cx_index *index,
     }
 }
 
+static void cx_index_set_order(struct cx_index *index, bool ascending,
+                               bool descending)
+{
+    if (!index->count)
+        return;
+    if (ascending)
+        index->flags |= CX_INDEX_ASCENDING;
+    if (descending)
+        index->flags |= CX_INDEX_DESCENDING;
+}
+
 static void cx_index_update_i32(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
+                                struct cx_column_cursor *cursor,
+                                uint8_t *registers,
+                                struct cx_index_sampler *sampler)
 {
+    bool ascending = true, descending = true;
+    int32_t previous = 0;
     while (cx_column_cursor_valid(cursor)) {
         size_t count;
         const int32_t *values = cx_column_cursor_next_batch_i32(cursor, &count);
         assert(count);
         index->count += count;
+        if (index->count == count)
+            previous = values[0];
         for (size_t i = 0; i < count; i++) {
             int32_t value = values[i];
+            ascending &= previous <= value;
+            descending &= previous >= value;
+            previous = value;
+            cx_index_hll_add(registers, cx_bloom_hash_i64(value));
+            cx_index_value_t sample = {.i32 = value};
+            cx_index_sampler_add(sampler, value, sample);
             if (value > index->max.i32)
                 index->max.i32 = value;
             if (value < index->min.i32)
                 index->min.i32 = value;
         }
     }
+    cx_index_set_order(index, ascending, descending);
 }
 
 static void cx_index_update_i64(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
+                                struct cx_column_cursor *cursor,
+                                uint8_t *registers,
+                                struct cx_index_sampler *sampler)
 {
+    bool ascending = true, descending = true;
+    int64_t previous = 0;
     while (cx_column_cursor_valid(cursor)) {
         size_t count;
         const int64_t *values = cx_column_cursor_next_batch_i64(cursor, &count);
         assert(count);
         index->count += count;
+        if (index->count == count)
+            previous = values[0];
         for (size_t i = 0; i < count; i++) {
             int64_t value = values[i];
+            ascending &= previous <= value;
+            descending &= previous >= value;
+            previous = value;
+            cx_index_hll_add(registers, cx_bloom_hash_i64(value));
+            cx_index_value_t sample = {.i64 = value};
+            cx_index_sampler_add(sampler, value, sample);
             if (value > index->max.i64)
                 index->max.i64 = value;
             if (value < index->min.i64)
                 index->min.i64 = value;
         }
     }
+    cx_index_set_order(index, ascending, descending);
 }
 
 static void cx_index_update_flt(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
+                                struct cx_column_cursor *cursor,
+                                uint8_t *registers,
+                                struct cx_index_sampler *sampler)
 {
+    bool ascending = true, descending = true;
+    float previous = 0;
     while (cx_column_cursor_valid(cursor)) {
         size_t count;
         const float *values = cx_column_cursor_next_batch_flt(cursor, &count);
         assert(count);
         index->count += count;
+        if (index->count == count)
+            previous = values[0];
         for (size_t i = 0; i < count; i++) {
             float value = values[i];
+            ascending &= previous <= value;
+            descending &= previous >= value;
+            previous = value;
+            cx_index_hll_add(registers, cx_index_hash_flt(value));
+            cx_index_value_t sample = {.flt = value};
+            cx_index_sampler_add(sampler, value, sample);
             if (value > index->max.flt)
                 index->max.flt = value;
             if (value < index->min.flt)
                 index->min.flt = value;
         }
     }
+    cx_index_set_order(index, ascending, descending);
 }
 
 static void cx_index_update_dbl(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
+                                struct cx_column_cursor *cursor,
+                                uint8_t *registers,
+                                struct cx_index_sampler *sampler)
 {
+    bool ascending = true, descending = true;
+    double previous = 0;
     while (cx_column_cursor_valid(cursor)) {
         size_t count;
         const double *values = cx_column_cursor_next_batch_dbl(cursor, &count);
         assert(count);
         index->count += count;
+        if (index->count == count)
+            previous = values[0];
         for (size_t i = 0; i < count; i++) {
             double value = values[i];
+            ascending &= previous <= value;
+            descending &= previous >= value;
+            previous = value;
+            cx_index_hll_add(registers, cx_index_hash_dbl(value));
+            cx_index_value_t sample = {.dbl = value};
+            cx_index_sampler_add(sampler, value, sample);
             if (value > index->max.dbl)
                 index->max.dbl = value;
             if (value < index->min.dbl)
                 index->min.dbl = value;
         }
     }
+    cx_index_set_order(index, ascending, descending);
+}
+
+// compare a string with a bound, returning <0, 0 or >0 if the string is less
+// than, equal to or greater than the bound
+static int cx_index_compare(const struct cx_string *string, const char *bound,
+                            size_t bound_len)
+{
+    size_t len = string->len < bound_len ? string->len : bound_len;
+    int cmp = memcmp(string->ptr, bound, len);
+    if (cmp)
+        return cmp;
+    return (string->len > bound_len) - (string->len < bound_len);
+}
+
+static void cx_index_set_bound(char *bound, uint8_t *bound_len,
+                               const struct cx_string *prefix)
+{
+    memset(bound, 0, CX_INDEX_PREFIX_SIZE);
+    memcpy(bound, prefix->ptr, prefix->len);
+    *bound_len = prefix->len;
 }
 
 static void cx_index_update_str(struct cx_index *index,
-                                struct cx_column_cursor *cursor)
+                                struct cx_column_cursor *cursor,
+                                uint8_t *registers)
 {
+    // truncating values preserves their order, so the bounds can be found
+    // by comparing prefixes
+    bool truncated = false;
     while (cx_column_cursor_valid(cursor)) {
         size_t count;
         const struct cx_string *values =
@@ -163,10 +415,186 @@ static void cx_index_update_str(struct cx_index *index,
                 index->max.len = value;
             if (value < index->min.len)
                 index->min.len = value;
+            cx_index_hll_add(registers, cx_bloom_hash_str(&values[i]));
+            struct cx_string prefix = values[i];
+            if (prefix.len > CX_INDEX_PREFIX_SIZE)
+                prefix.len = CX_INDEX_PREFIX_SIZE;
+            if (!(index->flags & CX_INDEX_LOWER_BOUND) ||
+                cx_index_compare(&prefix, index->lower, index->lower_len) < 0) {
+                cx_index_set_bound(index->lower, &index->lower_len, &prefix);
+                index->flags |= CX_INDEX_LOWER_BOUND;
+            }
+            int cmp = 1;
+            if (index->flags & CX_INDEX_UPPER_BOUND)
+                cmp = cx_index_compare(&prefix, index->upper, index->upper_len);
+            if (cmp > 0) {
+                cx_index_set_bound(index->upper, &index->upper_len, &prefix);
+                index->flags |= CX_INDEX_UPPER_BOUND;
+                truncated = false;
+            }
+            if (cmp >= 0 && prefix.len < values[i].len)
+                truncated = true;
+        }
+    }
+    if (truncated) {
+        // round the truncated maximum up to the next prefix
+        size_t len = index->upper_len;
+        while (len && (unsigned char)index->upper[len - 1] == 0xFF)
+            index->upper[--len] = 0;
+        if (len) {
+            index->upper[len - 1]++;
+            index->upper_len = len;
+        } else {
+            index->flags &= ~CX_INDEX_UPPER_BOUND;
         }
     }
 }
 
+void cx_index_merge(struct cx_index *index, const struct cx_index *other,
+                    enum cx_column_type type)
+{
+    if (!other->count)
+        return;
+    if (!index->count) {
+        memcpy(index, other, sizeof(*index));
+        return;
+    }
+    switch (type) {
+        case CX_COLUMN_BIT:
+            index->min.bit = index->min.bit && other->min.bit;
+            index->max.bit = index->max.bit || other->max.bit;
+            break;
+        case CX_COLUMN_I32:
+            if (other->min.i32 < index->min.i32)
+                index->min.i32 = other->min.i32;
+            if (other->max.i32 > index->max.i32)
+                index->max.i32 = other->max.i32;
+            break;
+        case CX_COLUMN_I64:
+            if (other->min.i64 < index->min.i64)
+                index->min.i64 = other->min.i64;
+            if (other->max.i64 > index->max.i64)
+                index->max.i64 = other->max.i64;
+            break;
+        case CX_COLUMN_FLT:
+            if (other->min.flt < index->min.flt)
+                index->min.flt = other->min.flt;
+            if (other->max.flt > index->max.flt)
+                index->max.flt = other->max.flt;
+            break;
+        case CX_COLUMN_DBL:
+            if (other->min.dbl < index->min.dbl)
+                index->min.dbl = other->min.dbl;
+            if (other->max.dbl > index->max.dbl)
+                index->max.dbl = other->max.dbl;
+            break;
+        case CX_COLUMN_STR: {
+            if (other->min.len < index->min.len)
+                index->min.len = other->min.len;
+            if (other->max.len > index->max.len)
+                index->max.len = other->max.len;
+            struct cx_string lower = {other->lower, other->lower_len};
+            struct cx_string upper = {other->upper, other->upper_len};
+            if (!(other->flags & CX_INDEX_LOWER_BOUND))
+                index->flags &= ~CX_INDEX_LOWER_BOUND;
+            else if (cx_index_compare(&lower, index->lower,
+                                      index->lower_len) < 0)
+                cx_index_set_bound(index->lower, &index->lower_len, &lower);
+            if (!(other->flags & CX_INDEX_UPPER_BOUND))
+                index->flags &= ~CX_INDEX_UPPER_BOUND;
+            else if (cx_index_compare(&upper, index->upper,
+                                      index->upper_len) > 0)
+                cx_index_set_bound(index->upper, &index->upper_len, &upper);
+        } break;
+    }
+    // the order of rows isn't tracked across row groups, and histograms
+    // can't be merged
+    index->flags &=
+        ~(CX_INDEX_ASCENDING | CX_INDEX_DESCENDING | CX_INDEX_HISTOGRAM);
+    index->count += other->count;
+    index->null_count += other->null_count;
+    if (other->distinct_count > index->distinct_count)
+        index->distinct_count = other->distinct_count;
+}
+
+bool cx_index_constant(const struct cx_index *index, enum cx_column_type type)
+{
+    if (!index->count || index->null_count)
+        return false;
+    switch (type) {
+        case CX_COLUMN_BIT:
+            return index->min.bit == index->max.bit;
+        case CX_COLUMN_I32:
+            return index->min.i32 == index->max.i32;
+        case CX_COLUMN_I64:
+            return index->min.i64 == index->max.i64;
+        // the bounds don't distinguish 0 from -0
+        case CX_COLUMN_FLT:
+            return index->min.flt == index->max.flt && index->min.flt;
+        case CX_COLUMN_DBL:
+            return index->min.dbl == index->max.dbl && index->min.dbl;
+        case CX_COLUMN_STR:
+            // the bounds are the values themselves if none were truncated
+            return index->flags & CX_INDEX_LOWER_BOUND &&
+                   index->flags & CX_INDEX_UPPER_BOUND &&
+                   index->min.len == index->lower_len &&
+                   index->max.len == index->lower_len &&
+                   index->lower_len == index->upper_len &&
+                   !memcmp(index->lower, index->upper, index->lower_len);
+    }
+    return false;
+}
+
+static double cx_index_value_dbl(const cx_index_value_t *value,
+                                 enum cx_column_type type)
+{
+    switch (type) {
+        case CX_COLUMN_I32:
+            return value->i32;
+        case CX_COLUMN_I64:
+            return value->i64;
+        case CX_COLUMN_FLT:
+            return value->flt;
+        case CX_COLUMN_DBL:
+            return value->dbl;
+        default:
+            return 0;
+    }
+}
+
+double cx_index_histogram_fraction(const struct cx_index *index,
+                                   enum cx_column_type type, double value,
+                                   bool inclusive)
+{
+    if (!(index->flags & CX_INDEX_HISTOGRAM) || isnan(value))
+        return -1;
+    double bounds[CX_INDEX_HISTOGRAM_BUCKETS + 1];
+    bounds[0] = cx_index_value_dbl(&index->min, type);
+    for (size_t i = 1; i < CX_INDEX_HISTOGRAM_BUCKETS; i++)
+        bounds[i] = cx_index_value_dbl(&index->quantiles[i - 1], type);
+    bounds[CX_INDEX_HISTOGRAM_BUCKETS] = cx_index_value_dbl(&index->max, type);
+    // values are assumed to be uniformly distributed within each bucket.
+    // Empty buckets hold repeated values
+    double fraction = 0;
+    for (size_t i = 0; i < CX_INDEX_HISTOGRAM_BUCKETS; i++) {
+        double lower = bounds[i], upper = bounds[i + 1];
+        if (upper < value || (inclusive && upper == value))
+            fraction += 1;
+        else if (lower < value || (inclusive && lower == value))
+            fraction += (value - lower) / (upper - lower);
+    }
+    return fraction / CX_INDEX_HISTOGRAM_BUCKETS;
+}
+
+enum cx_index_match cx_index_match_null(const struct cx_index *index)
+{
+    if (!index->null_count)
+        return CX_INDEX_MATCH_NONE;
+    if (index->null_count == index->count)
+        return CX_INDEX_MATCH_ALL;
+    return CX_INDEX_MATCH_UNKNOWN;
+}
+
 enum cx_index_match cx_index_match_bit_eq(const struct cx_index *index,
                                           bool value)
 {
@@ -297,11 +725,56 @@ enum cx_index_match cx_index_match_dbl_gt(const struct cx_index *index,
     return CX_INDEX_MATCH_UNKNOWN;
 }
 
+enum cx_index_match cx_index_match_str_len_eq(const struct cx_index *index,
+                                              uint64_t len)
+{
+    if (index->min.len > len || index->max.len < len)
+        return CX_INDEX_MATCH_NONE;
+    return CX_INDEX_MATCH_UNKNOWN;
+}
+
 enum cx_index_match cx_index_match_str_eq(const struct cx_index *index,
                                           const struct cx_string *string)
 {
-    if (index->min.len > string->len || index->max.len < string->len)
+    if (cx_index_match_str_len_eq(index, string->len) == CX_INDEX_MATCH_NONE)
         return CX_INDEX_MATCH_NONE;
+    if (index->flags & CX_INDEX_LOWER_BOUND &&
+        cx_index_compare(string, index->lower, index->lower_len) < 0)
+        return CX_INDEX_MATCH_NONE;
+    if (index->flags & CX_INDEX_UPPER_BOUND &&
+        cx_index_compare(string, index->upper, index->upper_len) > 0)
+        return CX_INDEX_MATCH_NONE;
+    // the bounds are the values themselves if none were truncated
+    if (index->flags & CX_INDEX_LOWER_BOUND &&
+        index->flags & CX_INDEX_UPPER_BOUND &&
+        index->max.len <= CX_INDEX_PREFIX_SIZE &&
+        index->lower_len == index->upper_len &&
+        !memcmp(index->lower, index->upper, index->lower_len))
+        return CX_INDEX_MATCH_ALL;
+    return CX_INDEX_MATCH_UNKNOWN;
+}
+
+enum cx_index_match cx_index_match_str_lt(const struct cx_index *index,
+                                          const struct cx_string *string)
+{
+    if (index->flags & CX_INDEX_LOWER_BOUND &&
+        cx_index_compare(string, index->lower, index->lower_len) <= 0)
+        return CX_INDEX_MATCH_NONE;
+    if (index->flags & CX_INDEX_UPPER_BOUND &&
+        cx_index_compare(string, index->upper, index->upper_len) > 0)
+        return CX_INDEX_MATCH_ALL;
+    return CX_INDEX_MATCH_UNKNOWN;
+}
+
+enum cx_index_match cx_index_match_str_gt(const struct cx_index *index,
+                                          const struct cx_string *string)
+{
+    if (index->flags & CX_INDEX_UPPER_BOUND &&
+        cx_index_compare(string, index->upper, index->upper_len) >= 0)
+        return CX_INDEX_MATCH_NONE;
+    if (index->flags & CX_INDEX_LOWER_BOUND &&
+        cx_index_compare(string, index->lower, index->lower_len) < 0)
+        return CX_INDEX_MATCH_ALL;
     return CX_INDEX_MATCH_UNKNOWN;
 }
 
@@ -312,3 +785,36 @@ enum cx_index_match cx_index_match_str_contains(const struct cx_index *index,
         return CX_INDEX_MATCH_NONE;
     return CX_INDEX_MATCH_UNKNOWN;
 }
+
+static bool cx_index_bound_starts_with(const char *bound, size_t bound_len,
+                                       const struct cx_string *prefix)
+{
+    return bound_len >= prefix->len &&
+           !memcmp(bound, prefix->ptr, prefix->len);
+}
+
+enum cx_index_match cx_index_match_str_starts_with(
+    const struct cx_index *index, const struct cx_string *prefix)
+{
+    if (index->max.len < prefix->len)
+        return CX_INDEX_MATCH_NONE;
+    bool lower = index->flags & CX_INDEX_LOWER_BOUND;
+    bool upper = index->flags & CX_INDEX_UPPER_BOUND;
+    bool lower_match =
+        lower &&
+        cx_index_bound_starts_with(index->lower, index->lower_len, prefix);
+    bool upper_match =
+        upper &&
+        cx_index_bound_starts_with(index->upper, index->upper_len, prefix);
+    // values with the prefix sort after it, and before any string greater
+    // than it that doesn't have the prefix
+    if (upper && cx_index_compare(prefix, index->upper, index->upper_len) > 0)
+        return CX_INDEX_MATCH_NONE;
+    if (lower && !lower_match &&
+        cx_index_compare(prefix, index->lower, index->lower_len) < 0)
+        return CX_INDEX_MATCH_NONE;
+    // so do values between two strings with the prefix
+    if (lower_match && upper_match)
+        return CX_INDEX_MATCH_ALL;
+    return CX_INDEX_MATCH_UNKNOWN;
+}
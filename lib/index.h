@@ -16,22 +16,84 @@ typedef union {
     uint64_t len;
 } cx_index_value_t;
 
+// STR indexes also have lexicographic bounds of up to CX_INDEX_PREFIX_SIZE
+// bytes. The lower bound is a prefix of the minimum value. The upper bound is
+// the maximum value, or if it's too long, its prefix with the last byte
+// incremented. Bounds are absent if there are no values, or if the maximum
+// starts with CX_INDEX_PREFIX_SIZE 0xFF bytes
+#define CX_INDEX_PREFIX_SIZE 24
+
+// I32, I64, FLT and DBL indexes also record whether the values are sorted
+// in ascending (non-decreasing) or descending (non-increasing) order, and
+// have an equi-depth histogram of CX_INDEX_HISTOGRAM_BUCKETS buckets. The
+// bucket boundaries between min and max are quantiles of a sample of the
+// values. Histograms are absent if there are no values
+enum cx_index_flags {
+    CX_INDEX_LOWER_BOUND = 1,
+    CX_INDEX_UPPER_BOUND = 2,
+    CX_INDEX_ASCENDING = 4,
+    CX_INDEX_DESCENDING = 8,
+    CX_INDEX_HISTOGRAM = 16
+};
+
+#define CX_INDEX_HISTOGRAM_BUCKETS 8
+
 struct cx_index {
     uint64_t count;
     cx_index_value_t min;
     cx_index_value_t max;
+    // the number of nulls, and an estimate of the number of distinct values
+    uint64_t null_count;
+    uint64_t distinct_count;
+    cx_index_value_t quantiles[CX_INDEX_HISTOGRAM_BUCKETS - 1];
+    char lower[CX_INDEX_PREFIX_SIZE];
+    char upper[CX_INDEX_PREFIX_SIZE];
+    uint8_t lower_len;
+    uint8_t upper_len;
+    uint8_t flags;
+    uint8_t __padding[5];
+};
+
+// the bounds of a column in each row group of a file, as contiguous arrays
+struct cx_index_stats {
+    enum cx_column_type type;
+    const cx_index_value_t *min;
+    const cx_index_value_t *max;
 };
 
 struct cx_index *cx_index_new(const struct cx_column *);
 
 void cx_index_free(struct cx_index *);
 
+// merge the index of another set of values of the same type. The distinct
+// count becomes a lower bound, and histograms are dropped
+void cx_index_merge(struct cx_index *, const struct cx_index *,
+                    enum cx_column_type);
+
+// count the nulls of the rows covered by the index, from the null bitmap of
+// the column they start at. The start row must be a multiple of 64
+bool cx_index_count_nulls(struct cx_index *, const struct cx_column *nulls,
+                          size_t start);
+
+// check whether the values are all equal and not null. The value is the
+// minimum, or for STR indexes, the lower bound
+bool cx_index_constant(const struct cx_index *, enum cx_column_type);
+
+// estimate the fraction of values less than the value, or no greater than
+// the value if inclusive, from the histogram. Returns a negative number if
+// the index has no histogram
+double cx_index_histogram_fraction(const struct cx_index *,
+                                   enum cx_column_type, double value,
+                                   bool inclusive);
+
 enum cx_index_match {
     CX_INDEX_MATCH_NONE = -1,
     CX_INDEX_MATCH_UNKNOWN = 0,
     CX_INDEX_MATCH_ALL = 1
 };
 
+enum cx_index_match cx_index_match_null(const struct cx_index *);
+
 enum cx_index_match cx_index_match_bit_eq(const struct cx_index *, bool);
 
 enum cx_index_match cx_index_match_i32_eq(const struct cx_index *, int32_t);
@@ -50,10 +112,20 @@ enum cx_index_match cx_index_match_dbl_eq(const struct cx_index *, double);
 enum cx_index_match cx_index_match_dbl_lt(const struct cx_index *, double);
 enum cx_index_match cx_index_match_dbl_gt(const struct cx_index *, double);
 
+// the str_eq/lt/gt and starts_with functions are case sensitive. The
+// len_eq function can be used for case insensitive equality
 enum cx_index_match cx_index_match_str_eq(const struct cx_index *,
                                           const struct cx_string *);
+enum cx_index_match cx_index_match_str_lt(const struct cx_index *,
+                                          const struct cx_string *);
+enum cx_index_match cx_index_match_str_gt(const struct cx_index *,
+                                          const struct cx_string *);
+enum cx_index_match cx_index_match_str_len_eq(const struct cx_index *,
+                                              uint64_t len);
 enum cx_index_match cx_index_match_str_contains(const struct cx_index *,
                                                 const struct cx_string *);
+enum cx_index_match cx_index_match_str_starts_with(const struct cx_index *,
+                                                   const struct cx_string *);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,364 @@
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bloom.h"
+#include "file.h"
+#include "inverted.h"
+
+struct cx_inverted_writer_column {
+    size_t column;
+    struct cx_inverted_entry *entries;
+    size_t count;
+    size_t size;
+};
+
+struct cx_inverted_writer {
+    struct cx_inverted_writer_column *columns;
+    size_t count;
+};
+
+struct cx_inverted_index {
+    void *mmap_ptr;
+    size_t size;
+    const struct cx_inverted_header *header;
+    const struct cx_inverted_column *columns;
+};
+
+static char *cx_inverted_path(const char *path)
+{
+    size_t path_len = strlen(path);
+    size_t suffix_len = strlen(CX_INVERTED_SUFFIX);
+    char *inverted_path = malloc(path_len + suffix_len + 1);
+    if (!inverted_path)
+        return NULL;
+    memcpy(inverted_path, path, path_len);
+    memcpy(inverted_path + path_len, CX_INVERTED_SUFFIX, suffix_len + 1);
+    return inverted_path;
+}
+
+// find the size of the columnix file, and hash its metadata
+static bool cx_inverted_file_hash(const char *path, uint64_t *size,
+                                  uint64_t *hash)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    char *metadata = NULL;
+    struct stat stat;
+    if (fstat(fileno(file), &stat))
+        goto error;
+    size_t file_size = stat.st_size;
+    struct cx_footer footer;
+    if (file_size < sizeof(footer) ||
+        fseeko(file, file_size - sizeof(footer), SEEK_SET) ||
+        fread(&footer, sizeof(footer), 1, file) != 1)
+        goto error;
+    if (footer.magic != CX_FILE_MAGIC ||
+        footer.strings_offset > file_size - sizeof(footer))
+        goto error;
+    size_t metadata_size = file_size - footer.strings_offset;
+    metadata = malloc(metadata_size);
+    if (!metadata)
+        goto error;
+    if (fseeko(file, footer.strings_offset, SEEK_SET) ||
+        fread(metadata, metadata_size, 1, file) != 1)
+        goto error;
+    struct cx_string string = {metadata, metadata_size};
+    *hash = cx_bloom_hash_str(&string);
+    *size = file_size;
+    free(metadata);
+    fclose(file);
+    return true;
+error:
+    free(metadata);
+    fclose(file);
+    return false;
+}
+
+static int cx_inverted_hash_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int cx_inverted_entry_compare(const void *a, const void *b)
+{
+    const struct cx_inverted_entry *x = a, *y = b;
+    if (x->hash != y->hash)
+        return (x->hash > y->hash) - (x->hash < y->hash);
+    return (x->row_group > y->row_group) - (x->row_group < y->row_group);
+}
+
+struct cx_inverted_writer *cx_inverted_writer_new(void)
+{
+    return calloc(1, sizeof(struct cx_inverted_writer));
+}
+
+void cx_inverted_writer_free(struct cx_inverted_writer *writer)
+{
+    for (size_t i = 0; i < writer->count; i++)
+        free(writer->columns[i].entries);
+    free(writer->columns);
+    free(writer);
+}
+
+static struct cx_inverted_writer_column *cx_inverted_writer_column(
+    struct cx_inverted_writer *writer, size_t column_index)
+{
+    for (size_t i = 0; i < writer->count; i++)
+        if (writer->columns[i].column == column_index)
+            return &writer->columns[i];
+    struct cx_inverted_writer_column *columns = realloc(
+        writer->columns, (writer->count + 1) * sizeof(*writer->columns));
+    if (!columns)
+        return NULL;
+    writer->columns = columns;
+    struct cx_inverted_writer_column *column = &columns[writer->count++];
+    memset(column, 0, sizeof(*column));
+    column->column = column_index;
+    return column;
+}
+
+static uint64_t *cx_inverted_hash_column(const struct cx_column *column,
+                                         size_t *count)
+{
+    enum cx_column_type type = cx_column_type(column);
+    if (type != CX_COLUMN_I32 && type != CX_COLUMN_I64 &&
+        type != CX_COLUMN_STR)
+        return NULL;
+    uint64_t *hashes = malloc((cx_column_count(column) + 1) * sizeof(*hashes));
+    if (!hashes)
+        return NULL;
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        goto error;
+    size_t position = 0;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t batch_count;
+        if (type == CX_COLUMN_I32) {
+            const int32_t *values =
+                cx_column_cursor_next_batch_i32(cursor, &batch_count);
+            for (size_t i = 0; i < batch_count; i++)
+                hashes[position++] = cx_bloom_hash_i64(values[i]);
+        } else if (type == CX_COLUMN_I64) {
+            const int64_t *values =
+                cx_column_cursor_next_batch_i64(cursor, &batch_count);
+            for (size_t i = 0; i < batch_count; i++)
+                hashes[position++] = cx_bloom_hash_i64(values[i]);
+        } else {
+            const struct cx_string *values =
+                cx_column_cursor_next_batch_str(cursor, &batch_count);
+            for (size_t i = 0; i < batch_count; i++)
+                hashes[position++] = cx_bloom_hash_str(&values[i]);
+        }
+        assert(batch_count);
+    }
+    cx_column_cursor_free(cursor);
+    *count = position;
+    return hashes;
+error:
+    free(hashes);
+    return NULL;
+}
+
+bool cx_inverted_writer_add(struct cx_inverted_writer *writer,
+                            size_t column_index,
+                            const struct cx_column *column, size_t row_group)
+{
+    size_t count;
+    uint64_t *hashes = cx_inverted_hash_column(column, &count);
+    if (!hashes)
+        return false;
+    struct cx_inverted_writer_column *inverted_column =
+        cx_inverted_writer_column(writer, column_index);
+    if (!inverted_column)
+        goto error;
+    // only the distinct hashes of each row group are kept
+    qsort(hashes, count, sizeof(*hashes), cx_inverted_hash_compare);
+    for (size_t i = 0; i < count; i++) {
+        if (i && hashes[i] == hashes[i - 1])
+            continue;
+        if (inverted_column->count == inverted_column->size) {
+            size_t new_size =
+                inverted_column->size ? inverted_column->size * 2 : 64;
+            struct cx_inverted_entry *entries =
+                realloc(inverted_column->entries, new_size * sizeof(*entries));
+            if (!entries)
+                goto error;
+            inverted_column->entries = entries;
+            inverted_column->size = new_size;
+        }
+        struct cx_inverted_entry *entry =
+            &inverted_column->entries[inverted_column->count++];
+        entry->hash = hashes[i];
+        entry->row_group = row_group;
+    }
+    free(hashes);
+    return true;
+error:
+    free(hashes);
+    return false;
+}
+
+bool cx_inverted_writer_finish(struct cx_inverted_writer *writer,
+                               const char *path, size_t row_group_count,
+                               size_t row_count)
+{
+    char *inverted_path = cx_inverted_path(path);
+    if (!inverted_path)
+        return false;
+    FILE *file = NULL;
+    if (!writer->count) {
+        // don't leave a stale sidecar behind
+        remove(inverted_path);
+        free(inverted_path);
+        return true;
+    }
+    struct cx_inverted_header header = {.magic = CX_INVERTED_MAGIC,
+                                        .row_count = row_count,
+                                        .row_group_count = row_group_count,
+                                        .column_count = writer->count};
+    if (!cx_inverted_file_hash(path, &header.file_size, &header.file_hash))
+        goto error;
+    file = fopen(inverted_path, "wb");
+    if (!file)
+        goto error;
+    if (fwrite(&header, sizeof(header), 1, file) != 1)
+        goto error;
+    size_t offset =
+        sizeof(header) + writer->count * sizeof(struct cx_inverted_column);
+    for (size_t i = 0; i < writer->count; i++) {
+        struct cx_inverted_writer_column *column = &writer->columns[i];
+        struct cx_inverted_column descriptor = {column->column, offset,
+                                                column->count};
+        if (fwrite(&descriptor, sizeof(descriptor), 1, file) != 1)
+            goto error;
+        offset += column->count * sizeof(struct cx_inverted_entry);
+    }
+    for (size_t i = 0; i < writer->count; i++) {
+        struct cx_inverted_writer_column *column = &writer->columns[i];
+        qsort(column->entries, column->count, sizeof(*column->entries),
+              cx_inverted_entry_compare);
+        if (column->count &&
+            fwrite(column->entries, sizeof(*column->entries), column->count,
+                   file) != column->count)
+            goto error;
+    }
+    int status = fclose(file);
+    file = NULL;
+    if (status)
+        goto error;
+    free(inverted_path);
+    return true;
+error:
+    if (file)
+        fclose(file);
+    remove(inverted_path);
+    free(inverted_path);
+    return false;
+}
+
+struct cx_inverted_index *cx_inverted_index_new(const char *path,
+                                                size_t row_group_count,
+                                                size_t row_count)
+{
+    struct cx_inverted_index *index = calloc(1, sizeof(*index));
+    if (!index)
+        return NULL;
+    FILE *file = NULL;
+    char *inverted_path = cx_inverted_path(path);
+    if (!inverted_path)
+        goto error;
+    file = fopen(inverted_path, "rb");
+    if (!file)
+        goto error;
+    struct stat stat;
+    if (fstat(fileno(file), &stat))
+        goto error;
+    size_t size = stat.st_size;
+    if (size < sizeof(struct cx_inverted_header))
+        goto error;
+    void *mmap_ptr =
+        mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    if (mmap_ptr == MAP_FAILED)
+        goto error;
+    index->mmap_ptr = mmap_ptr;
+    index->size = size;
+
+    // check the header and column table
+    const struct cx_inverted_header *header = mmap_ptr;
+    uint64_t file_size, file_hash;
+    if (header->magic != CX_INVERTED_MAGIC ||
+        header->row_count != row_count ||
+        header->row_group_count != row_group_count ||
+        !cx_inverted_file_hash(path, &file_size, &file_hash) ||
+        header->file_size != file_size || header->file_hash != file_hash)
+        goto error;
+    if (header->column_count >
+        (size - sizeof(*header)) / sizeof(struct cx_inverted_column))
+        goto error;
+    const struct cx_inverted_column *columns =
+        (const void *)((uintptr_t)mmap_ptr + sizeof(*header));
+    for (size_t i = 0; i < header->column_count; i++) {
+        size_t entries_size =
+            columns[i].count * sizeof(struct cx_inverted_entry);
+        if (columns[i].offset % sizeof(uint64_t) ||
+            columns[i].offset > size ||
+            columns[i].count > size / sizeof(struct cx_inverted_entry) ||
+            entries_size > size - columns[i].offset)
+            goto error;
+    }
+    index->header = header;
+    index->columns = columns;
+
+    fclose(file);
+    free(inverted_path);
+    return index;
+error:
+    if (index->mmap_ptr)
+        munmap(index->mmap_ptr, index->size);
+    if (file)
+        fclose(file);
+    free(inverted_path);
+    free(index);
+    return NULL;
+}
+
+void cx_inverted_index_free(struct cx_inverted_index *index)
+{
+    munmap(index->mmap_ptr, index->size);
+    free(index);
+}
+
+bool cx_inverted_index_lookup(const struct cx_inverted_index *index,
+                              size_t column, uint64_t hash, uint8_t *matches)
+{
+    const struct cx_inverted_column *inverted_column = NULL;
+    for (size_t i = 0; i < index->header->column_count; i++)
+        if (index->columns[i].column == column)
+            inverted_column = &index->columns[i];
+    if (!inverted_column)
+        return false;
+    const struct cx_inverted_entry *entries =
+        (const void *)((uintptr_t)index->mmap_ptr + inverted_column->offset);
+    // find the first entry with the hash
+    size_t low = 0, high = inverted_column->count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (entries[middle].hash < hash)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    for (; low < inverted_column->count && entries[low].hash == hash; low++)
+        if (entries[low].row_group < index->header->row_group_count)
+            matches[entries[low].row_group] = 1;
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef CX_INVERTED_H_
+#define CX_INVERTED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "column.h"
+
+// an inverted index is a sidecar file, written alongside the columnix file
+// (at its path with CX_INVERTED_SUFFIX appended), that maps the hash of
+// each value of the indexed columns to the row groups that contain it.
+// The header is followed by a cx_inverted_column for each indexed column,
+// followed by the entries of each column sorted by hash and row group
+#define CX_INVERTED_SUFFIX ".inv"
+
+#define CX_INVERTED_MAGIC 0x7863040378630302LLU
+
+// the row count and row group count of the columnix file are recorded, along
+// with its size and a hash of its metadata (from the string repository to
+// the end of the footer), so that stale sidecars are ignored
+struct cx_inverted_header {
+    uint64_t magic;
+    uint64_t row_count;
+    uint32_t row_group_count;
+    uint32_t column_count;
+    uint64_t file_size;
+    uint64_t file_hash;
+};
+
+struct cx_inverted_column {
+    uint64_t column;
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct cx_inverted_entry {
+    uint64_t hash;
+    uint64_t row_group;
+};
+
+// values are hashed like Bloom filter values (see bloom.h)
+struct cx_inverted_writer;
+
+struct cx_inverted_writer *cx_inverted_writer_new(void);
+
+void cx_inverted_writer_free(struct cx_inverted_writer *);
+
+// add the distinct values of an I32, I64 or STR column chunk
+bool cx_inverted_writer_add(struct cx_inverted_writer *, size_t column_index,
+                            const struct cx_column *, size_t row_group);
+
+// write the sidecar for the columnix file at the path, which must already
+// have been written
+bool cx_inverted_writer_finish(struct cx_inverted_writer *, const char *path,
+                               size_t row_group_count, size_t row_count);
+
+struct cx_inverted_index;
+
+// returns NULL if the sidecar doesn't exist, is invalid, or doesn't match
+// the columnix file at the path
+struct cx_inverted_index *cx_inverted_index_new(const char *path,
+                                                size_t row_group_count,
+                                                size_t row_count);
+
+void cx_inverted_index_free(struct cx_inverted_index *);
+
+// set matches[i] for each row group i that contains the hash. Returns false
+// if the column isn't indexed
+bool cx_inverted_index_lookup(const struct cx_inverted_index *, size_t column,
+                              uint64_t hash, uint8_t *matches);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,5 +1,7 @@
 #define _GNU_SOURCE
 #include <assert.h>
+#include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "match.h"
@@ -31,6 +33,35 @@
         return mask;                                     \
     }
 
+// values between the bounds are matched with both compares, without
+// branching on the first
+#define CX_NAIVE_BETWEEN_DEFINITION(name, type)                      \
+    static uint64_t cx_match_##name##_between_naive(                 \
+        size_t size, const type batch[], type low, type high)        \
+    {                                                                \
+        assert(size <= 64);                                          \
+        uint64_t mask = 0;                                           \
+        for (size_t i = 0; i < size; i++)                            \
+            mask |= (uint64_t)((batch[i] > low) & (batch[i] < high)) \
+                    << i;                                            \
+        return mask;                                                 \
+    }
+
+// values are compared with the value in the same row of the other column,
+// plus the offset. Integer sums wrap, as they do in the SIMD kernels
+#define CX_NAIVE_COLUMN_DEFINITION(name, type, sum_type, match, op)       \
+    static uint64_t cx_match_##name##_##match##_column_naive(             \
+        size_t size, const type batch[], const type other[], type offset) \
+    {                                                                     \
+        assert(size <= 64);                                               \
+        uint64_t mask = 0;                                                \
+        for (size_t i = 0; i < size; i++) {                               \
+            type cmp = (type)((sum_type)other[i] + (sum_type)offset);     \
+            mask |= (uint64_t)(batch[i] op cmp) << i;                     \
+        }                                                                 \
+        return mask;                                                      \
+    }
+
 #ifdef CX_SIMD_WIDTH
 
 #define CX_SIMD_MATCH_DEFINITION(width, name, type, match)                   \
@@ -61,6 +92,60 @@ CX_SIMD_MATCH_SET(i64, int64_t)
 CX_SIMD_MATCH_SET(flt, float)
 CX_SIMD_MATCH_SET(dbl, double)
 
+#define CX_SIMD_BETWEEN_DEFINITION(width, name, type)                        \
+    static inline uint64_t cx_match_##name##_between_simd(                   \
+        size_t size, const type batch[], type low, type high)                \
+    {                                                                        \
+        cx_##name##_vec_t v_low = cx_simd_##name##_set(low);                 \
+        cx_##name##_vec_t v_high = cx_simd_##name##_set(high);               \
+        int partial_mask[64 * sizeof(type) / width];                         \
+        for (size_t i = 0; i < 64 * sizeof(type) / width; i++) {             \
+            cx_##name##_vec_t chunk =                                        \
+                cx_simd_##name##_load(&batch[i * (width / sizeof(type))]);   \
+            partial_mask[i] = cx_simd_##name##_between(v_low, v_high, chunk); \
+        }                                                                    \
+        uint64_t mask = 0;                                                   \
+        for (size_t i = 0; i < 64 * sizeof(type) / width; i++)               \
+            mask |=                                                          \
+                ((uint64_t)partial_mask[i] << (i * (width / sizeof(type)))); \
+        return mask;                                                         \
+    }
+
+CX_SIMD_BETWEEN_DEFINITION(CX_SIMD_WIDTH, i32, int32_t)
+CX_SIMD_BETWEEN_DEFINITION(CX_SIMD_WIDTH, i64, int64_t)
+CX_SIMD_BETWEEN_DEFINITION(CX_SIMD_WIDTH, flt, float)
+CX_SIMD_BETWEEN_DEFINITION(CX_SIMD_WIDTH, dbl, double)
+
+#define CX_SIMD_COLUMN_DEFINITION(width, name, type, match)                    \
+    static inline uint64_t cx_match_##name##_##match##_column_simd(            \
+        size_t size, const type batch[], const type other[], type offset)      \
+    {                                                                          \
+        cx_##name##_vec_t v_offset = cx_simd_##name##_set(offset);             \
+        int partial_mask[64 * sizeof(type) / width];                           \
+        for (size_t i = 0; i < 64 * sizeof(type) / width; i++) {               \
+            size_t position = i * (width / sizeof(type));                      \
+            cx_##name##_vec_t chunk = cx_simd_##name##_load(&batch[position]); \
+            cx_##name##_vec_t v_cmp = cx_simd_##name##_add(                    \
+                cx_simd_##name##_load(&other[position]), v_offset);            \
+            partial_mask[i] = cx_simd_##name##_##match(v_cmp, chunk);          \
+        }                                                                      \
+        uint64_t mask = 0;                                                     \
+        for (size_t i = 0; i < 64 * sizeof(type) / width; i++)                 \
+            mask |=                                                            \
+                ((uint64_t)partial_mask[i] << (i * (width / sizeof(type))));   \
+        return mask;                                                           \
+    }
+
+#define CX_SIMD_COLUMN_SET(name, type)                       \
+    CX_SIMD_COLUMN_DEFINITION(CX_SIMD_WIDTH, name, type, eq) \
+    CX_SIMD_COLUMN_DEFINITION(CX_SIMD_WIDTH, name, type, lt) \
+    CX_SIMD_COLUMN_DEFINITION(CX_SIMD_WIDTH, name, type, gt)
+
+CX_SIMD_COLUMN_SET(i32, int32_t)
+CX_SIMD_COLUMN_SET(i64, int64_t)
+CX_SIMD_COLUMN_SET(flt, float)
+CX_SIMD_COLUMN_SET(dbl, double)
+
 #define CX_MATCH_DEFINITION(name, type, match)                          \
     uint64_t cx_match_##name##_##match(size_t size, const type batch[], \
                                        type cmp)                        \
@@ -70,6 +155,26 @@ CX_SIMD_MATCH_SET(dbl, double)
         return cx_match_##name##_##match##_naive(size, batch, cmp);     \
     }
 
+#define CX_COLUMN_DEFINITION(name, type, match)                             \
+    uint64_t cx_match_##name##_##match##_column(                            \
+        size_t size, const type batch[], const type other[], type offset)   \
+    {                                                                       \
+        if (size == 64)                                                     \
+            return cx_match_##name##_##match##_column_simd(size, batch,     \
+                                                           other, offset);  \
+        return cx_match_##name##_##match##_column_naive(size, batch, other, \
+                                                        offset);            \
+    }
+
+#define CX_BETWEEN_DEFINITION(name, type)                                   \
+    uint64_t cx_match_##name##_between(size_t size, const type batch[],    \
+                                       type low, type high)                \
+    {                                                                      \
+        if (size == 64)                                                    \
+            return cx_match_##name##_between_simd(size, batch, low, high); \
+        return cx_match_##name##_between_naive(size, batch, low, high);    \
+    }
+
 #else
 
 #define CX_MATCH_DEFINITION(name, type, match)                          \
@@ -79,21 +184,92 @@ CX_SIMD_MATCH_SET(dbl, double)
         return cx_match_##name##_##match##_naive(size, batch, cmp);     \
     }
 
+#define CX_COLUMN_DEFINITION(name, type, match)                             \
+    uint64_t cx_match_##name##_##match##_column(                            \
+        size_t size, const type batch[], const type other[], type offset)   \
+    {                                                                       \
+        return cx_match_##name##_##match##_column_naive(size, batch, other, \
+                                                        offset);            \
+    }
+
+#define CX_BETWEEN_DEFINITION(name, type)                                \
+    uint64_t cx_match_##name##_between(size_t size, const type batch[], \
+                                       type low, type high)             \
+    {                                                                   \
+        return cx_match_##name##_between_naive(size, batch, low, high); \
+    }
+
 #endif  // simd
 
+#define CX_SPAN_DEFINITION(name, type, match)                              \
+    void cx_match_##name##_##match##_span(size_t size, const type batch[], \
+                                          type cmp, uint64_t *masks)       \
+    {                                                                      \
+        for (; size >= 64; size -= 64, batch += 64)                        \
+            *masks++ = cx_match_##name##_##match(64, batch, cmp);          \
+        if (size)                                                          \
+            *masks = cx_match_##name##_##match(size, batch, cmp);          \
+    }
+
+#define CX_BETWEEN_SPAN_DEFINITION(name, type)                           \
+    void cx_match_##name##_between_span(size_t size, const type batch[], \
+                                        type low, type high,             \
+                                        uint64_t *masks)                 \
+    {                                                                    \
+        for (; size >= 64; size -= 64, batch += 64)                      \
+            *masks++ = cx_match_##name##_between(64, batch, low, high);  \
+        if (size)                                                        \
+            *masks = cx_match_##name##_between(size, batch, low, high);  \
+    }
+
 #define CX_MATCH_TYPE(name, type)                 \
     CX_NAIVE_MATCH_DEFINITION(name, type, eq, ==) \
     CX_MATCH_DEFINITION(name, type, eq)           \
+    CX_SPAN_DEFINITION(name, type, eq)            \
     CX_NAIVE_MATCH_DEFINITION(name, type, lt, <)  \
     CX_MATCH_DEFINITION(name, type, lt)           \
+    CX_SPAN_DEFINITION(name, type, lt)            \
     CX_NAIVE_MATCH_DEFINITION(name, type, gt, >)  \
-    CX_MATCH_DEFINITION(name, type, gt)
+    CX_MATCH_DEFINITION(name, type, gt)           \
+    CX_SPAN_DEFINITION(name, type, gt)            \
+    CX_NAIVE_BETWEEN_DEFINITION(name, type)       \
+    CX_BETWEEN_DEFINITION(name, type)             \
+    CX_BETWEEN_SPAN_DEFINITION(name, type)
 
 CX_MATCH_TYPE(i32, int32_t)
 CX_MATCH_TYPE(i64, int64_t)
 CX_MATCH_TYPE(flt, float)
 CX_MATCH_TYPE(dbl, double)
 
+#define CX_COLUMN_SPAN_DEFINITION(name, type, match)                        \
+    void cx_match_##name##_##match##_column_span(                           \
+        size_t size, const type batch[], const type other[], type offset,   \
+        uint64_t *masks)                                                    \
+    {                                                                       \
+        for (; size >= 64; size -= 64, batch += 64, other += 64)            \
+            *masks++ = cx_match_##name##_##match##_column(64, batch, other, \
+                                                          offset);          \
+        if (size)                                                           \
+            *masks = cx_match_##name##_##match##_column(size, batch, other, \
+                                                        offset);            \
+    }
+
+#define CX_MATCH_COLUMN_TYPE(name, type, sum_type)           \
+    CX_NAIVE_COLUMN_DEFINITION(name, type, sum_type, eq, ==) \
+    CX_COLUMN_DEFINITION(name, type, eq)                     \
+    CX_COLUMN_SPAN_DEFINITION(name, type, eq)                \
+    CX_NAIVE_COLUMN_DEFINITION(name, type, sum_type, lt, <)  \
+    CX_COLUMN_DEFINITION(name, type, lt)                     \
+    CX_COLUMN_SPAN_DEFINITION(name, type, lt)                \
+    CX_NAIVE_COLUMN_DEFINITION(name, type, sum_type, gt, >)  \
+    CX_COLUMN_DEFINITION(name, type, gt)                     \
+    CX_COLUMN_SPAN_DEFINITION(name, type, gt)
+
+CX_MATCH_COLUMN_TYPE(i32, int32_t, uint32_t)
+CX_MATCH_COLUMN_TYPE(i64, int64_t, uint64_t)
+CX_MATCH_COLUMN_TYPE(flt, float, float)
+CX_MATCH_COLUMN_TYPE(dbl, double, double)
+
 static inline bool cx_str_eq(const struct cx_string *str,
                              const struct cx_string *cmp)
 {
@@ -103,9 +279,10 @@ static inline bool cx_str_eq(const struct cx_string *str,
     if (str->len < 16) {
         __m128i v_str = _mm_loadu_si128((__m128i *)str->ptr);
         __m128i v_cmp = _mm_loadu_si128((__m128i *)cmp->ptr);
-        return _mm_cmpistro(
-            v_cmp, v_str,
-            _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_EACH | _SIDD_BIT_MASK);
+        // the carry flag is set if any byte differs
+        return !_mm_cmpistrc(v_cmp, v_str,
+                             _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_EACH |
+                                 _SIDD_NEGATIVE_POLARITY);
     }
 #endif
     return !memcmp(str->ptr, cmp->ptr, str->len);
@@ -260,3 +437,300 @@ uint64_t cx_match_str_contains(size_t size, const struct cx_string strings[],
     }
     return matches;
 }
+
+#define CX_STR_SPAN(name)                                                    \
+    void cx_match_str_##name##_span(                                         \
+        size_t size, const struct cx_string strings[],                       \
+        const struct cx_string *cmp, bool case_sensitive, uint64_t *masks)   \
+    {                                                                        \
+        for (; size >= 64; size -= 64, strings += 64)                        \
+            *masks++ = cx_match_str_##name(64, strings, cmp, case_sensitive); \
+        if (size)                                                            \
+            *masks = cx_match_str_##name(size, strings, cmp, case_sensitive); \
+    }
+
+CX_STR_SPAN(eq)
+CX_STR_SPAN(lt)
+CX_STR_SPAN(gt)
+
+void cx_match_str_contains_span(size_t size, const struct cx_string strings[],
+                                const struct cx_string *cmp,
+                                bool case_sensitive,
+                                enum cx_str_location location, uint64_t *masks)
+{
+    for (; size >= 64; size -= 64, strings += 64)
+        *masks++ = cx_match_str_contains(64, strings, cmp, case_sensitive,
+                                         location);
+    if (size)
+        *masks = cx_match_str_contains(size, strings, cmp, case_sensitive,
+                                       location);
+}
+
+struct cx_match_set {
+    enum cx_column_type type;
+    bool case_sensitive;
+    size_t count;
+    void *values;
+    // slots hold the index of a value plus one, or zero if empty
+    uint32_t *table;
+    uint64_t mask;
+};
+
+static int cx_match_set_compare_i32(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int cx_match_set_compare_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int cx_match_set_compare_str(const void *a, const void *b)
+{
+    const struct cx_string *x = a, *y = b;
+    return strcmp(x->ptr, y->ptr);
+}
+
+static int cx_match_set_compare_str_ci(const void *a, const void *b)
+{
+    const struct cx_string *x = a, *y = b;
+    return strcasecmp(x->ptr, y->ptr);
+}
+
+static inline uint64_t cx_match_set_mix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdLLU;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static inline uint64_t cx_match_set_hash_str(const struct cx_string *string,
+                                             bool case_sensitive)
+{
+    uint64_t hash = 0xcbf29ce484222325LLU;
+    for (size_t i = 0; i < string->len; i++) {
+        unsigned char c = string->ptr[i];
+        hash ^= case_sensitive ? c : tolower(c);
+        hash *= 0x100000001b3LLU;
+    }
+    return cx_match_set_mix(hash);
+}
+
+static uint64_t cx_match_set_hash(const struct cx_match_set *set, size_t i)
+{
+    switch (set->type) {
+        case CX_COLUMN_I32:
+            return cx_match_set_mix((int64_t)((const int32_t *)set->values)[i]);
+        case CX_COLUMN_I64:
+            return cx_match_set_mix(((const int64_t *)set->values)[i]);
+        default:
+            return cx_match_set_hash_str(
+                &((const struct cx_string *)set->values)[i],
+                set->case_sensitive);
+    }
+}
+
+static bool cx_match_set_init_str(struct cx_match_set *set, size_t count,
+                                  const char *const *strings)
+{
+    struct cx_string *values = calloc(count, sizeof(*values));
+    if (!values)
+        return false;
+    set->values = values;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = strlen(strings[i]);
+        // pad the strings for the SSE4.2 string functions
+        char *ptr = calloc(1, length + 1 + 16);
+        if (!ptr)
+            return false;
+        memcpy(ptr, strings[i], length);
+        values[i].ptr = ptr;
+        values[i].len = length;
+        set->count++;
+    }
+    return true;
+}
+
+struct cx_match_set *cx_match_set_new(enum cx_column_type type, size_t count,
+                                      const void *values, bool case_sensitive)
+{
+    if (!count || count >= UINT32_MAX)
+        return NULL;
+    struct cx_match_set *set = calloc(1, sizeof(*set));
+    if (!set)
+        return NULL;
+    set->type = type;
+    set->case_sensitive = case_sensitive;
+    size_t size = 0;
+    int (*compare)(const void *, const void *) = NULL;
+    switch (type) {
+        case CX_COLUMN_I32:
+            size = sizeof(int32_t);
+            compare = cx_match_set_compare_i32;
+            break;
+        case CX_COLUMN_I64:
+            size = sizeof(int64_t);
+            compare = cx_match_set_compare_i64;
+            break;
+        case CX_COLUMN_STR:
+            size = sizeof(struct cx_string);
+            compare = case_sensitive ? cx_match_set_compare_str
+                                     : cx_match_set_compare_str_ci;
+            break;
+        default:
+            goto error;
+    }
+    if (type == CX_COLUMN_STR) {
+        if (!cx_match_set_init_str(set, count, values))
+            goto error;
+    } else {
+        set->values = malloc(count * size);
+        if (!set->values)
+            goto error;
+        memcpy(set->values, values, count * size);
+        set->count = count;
+    }
+
+    // sort the values and remove duplicates
+    qsort(set->values, count, size, compare);
+    char *bytes = set->values;
+    size_t distinct = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (!compare(bytes + (distinct - 1) * size, bytes + i * size)) {
+            if (type == CX_COLUMN_STR)
+                free((void *)((struct cx_string *)bytes)[i].ptr);
+            continue;
+        }
+        memmove(bytes + distinct++ * size, bytes + i * size, size);
+    }
+    set->count = distinct;
+    if (distinct <= CX_MATCH_SET_SCAN_MAX)
+        return set;
+
+    // build an open addressing table with a load factor of at most 1/2
+    size_t slots = 16;
+    while (slots < distinct * 2)
+        slots *= 2;
+    set->table = calloc(slots, sizeof(*set->table));
+    if (!set->table)
+        goto error;
+    set->mask = slots - 1;
+    for (size_t i = 0; i < distinct; i++) {
+        uint64_t slot = cx_match_set_hash(set, i) & set->mask;
+        while (set->table[slot])
+            slot = (slot + 1) & set->mask;
+        set->table[slot] = i + 1;
+    }
+    return set;
+error:
+    cx_match_set_free(set);
+    return NULL;
+}
+
+void cx_match_set_free(struct cx_match_set *set)
+{
+    if (set->type == CX_COLUMN_STR && set->values) {
+        struct cx_string *values = set->values;
+        for (size_t i = 0; i < set->count; i++)
+            free((void *)values[i].ptr);
+    }
+    free(set->values);
+    free(set->table);
+    free(set);
+}
+
+const void *cx_match_set_values(const struct cx_match_set *set, size_t *count)
+{
+    *count = set->count;
+    return set->values;
+}
+
+#define CX_SET_MATCH_DEFINITION(name, type)                                  \
+    static inline bool cx_match_set_contains_##name(                         \
+        const struct cx_match_set *set, type value)                          \
+    {                                                                        \
+        const type *values = set->values;                                    \
+        uint64_t slot = cx_match_set_mix((int64_t)value) & set->mask;        \
+        for (; set->table[slot]; slot = (slot + 1) & set->mask)              \
+            if (values[set->table[slot] - 1] == value)                       \
+                return true;                                                 \
+        return false;                                                        \
+    }                                                                        \
+                                                                             \
+    uint64_t cx_match_##name##_in(size_t size, const type batch[],           \
+                                  const struct cx_match_set *set)            \
+    {                                                                        \
+        assert(size <= 64);                                                  \
+        const type *values = set->values;                                    \
+        uint64_t mask = 0;                                                   \
+        if (!set->table) {                                                   \
+            for (size_t i = 0; i < set->count; i++)                          \
+                mask |= cx_match_##name##_eq(size, batch, values[i]);        \
+            return mask;                                                     \
+        }                                                                    \
+        type min = values[0], max = values[set->count - 1];                  \
+        for (size_t i = 0; i < size; i++)                                    \
+            if (batch[i] >= min && batch[i] <= max &&                        \
+                cx_match_set_contains_##name(set, batch[i]))                 \
+                mask |= (uint64_t)1 << i;                                    \
+        return mask;                                                         \
+    }                                                                        \
+                                                                             \
+    void cx_match_##name##_in_span(size_t size, const type batch[],          \
+                                   const struct cx_match_set *set,           \
+                                   uint64_t *masks)                          \
+    {                                                                        \
+        for (; size >= 64; size -= 64, batch += 64)                          \
+            *masks++ = cx_match_##name##_in(64, batch, set);                 \
+        if (size)                                                            \
+            *masks = cx_match_##name##_in(size, batch, set);                 \
+    }
+
+CX_SET_MATCH_DEFINITION(i32, int32_t)
+CX_SET_MATCH_DEFINITION(i64, int64_t)
+
+static inline bool cx_match_set_contains_str(const struct cx_match_set *set,
+                                             const struct cx_string *string)
+{
+    const struct cx_string *values = set->values;
+    uint64_t slot =
+        cx_match_set_hash_str(string, set->case_sensitive) & set->mask;
+    for (; set->table[slot]; slot = (slot + 1) & set->mask) {
+        const struct cx_string *value = &values[set->table[slot] - 1];
+        if (set->case_sensitive ? cx_str_eq(string, value)
+                                : cx_str_eq_ci(string, value))
+            return true;
+    }
+    return false;
+}
+
+uint64_t cx_match_str_in(size_t size, const struct cx_string strings[],
+                         const struct cx_match_set *set)
+{
+    assert(size <= 64);
+    uint64_t mask = 0;
+    if (!set->table) {
+        const struct cx_string *values = set->values;
+        for (size_t i = 0; i < set->count; i++)
+            mask |= cx_match_str_eq(size, strings, &values[i],
+                                    set->case_sensitive);
+        return mask;
+    }
+    for (size_t i = 0; i < size; i++)
+        if (cx_match_set_contains_str(set, &strings[i]))
+            mask |= (uint64_t)1 << i;
+    return mask;
+}
+
+void cx_match_str_in_span(size_t size, const struct cx_string strings[],
+                          const struct cx_match_set *set, uint64_t *masks)
+{
+    for (; size >= 64; size -= 64, strings += 64)
+        *masks++ = cx_match_str_in(64, strings, set);
+    if (size)
+        *masks = cx_match_str_in(size, strings, set);
+}
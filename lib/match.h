@@ -23,6 +23,33 @@ uint64_t cx_match_dbl_eq(size_t, const double[], double);
 uint64_t cx_match_dbl_lt(size_t, const double[], double);
 uint64_t cx_match_dbl_gt(size_t, const double[], double);
 
+// match values strictly between two bounds in one pass
+uint64_t cx_match_i32_between(size_t, const int32_t[], int32_t, int32_t);
+uint64_t cx_match_i64_between(size_t, const int64_t[], int64_t, int64_t);
+uint64_t cx_match_flt_between(size_t, const float[], float, float);
+uint64_t cx_match_dbl_between(size_t, const double[], double, double);
+
+// match values against the value in the same row of another column, plus
+// an offset
+uint64_t cx_match_i32_eq_column(size_t, const int32_t[], const int32_t[],
+                                int32_t);
+uint64_t cx_match_i32_lt_column(size_t, const int32_t[], const int32_t[],
+                                int32_t);
+uint64_t cx_match_i32_gt_column(size_t, const int32_t[], const int32_t[],
+                                int32_t);
+uint64_t cx_match_i64_eq_column(size_t, const int64_t[], const int64_t[],
+                                int64_t);
+uint64_t cx_match_i64_lt_column(size_t, const int64_t[], const int64_t[],
+                                int64_t);
+uint64_t cx_match_i64_gt_column(size_t, const int64_t[], const int64_t[],
+                                int64_t);
+uint64_t cx_match_flt_eq_column(size_t, const float[], const float[], float);
+uint64_t cx_match_flt_lt_column(size_t, const float[], const float[], float);
+uint64_t cx_match_flt_gt_column(size_t, const float[], const float[], float);
+uint64_t cx_match_dbl_eq_column(size_t, const double[], const double[], double);
+uint64_t cx_match_dbl_lt_column(size_t, const double[], const double[], double);
+uint64_t cx_match_dbl_gt_column(size_t, const double[], const double[], double);
+
 uint64_t cx_match_str_eq(size_t, const struct cx_string[],
                          const struct cx_string *, bool);
 uint64_t cx_match_str_lt(size_t, const struct cx_string[],
@@ -33,6 +60,96 @@ uint64_t cx_match_str_contains(size_t, const struct cx_string[],
                                const struct cx_string *, bool,
                                enum cx_str_location);
 
+// match a span of any size, writing a mask for each 64 values
+void cx_match_i32_eq_span(size_t, const int32_t[], int32_t, uint64_t *);
+void cx_match_i32_lt_span(size_t, const int32_t[], int32_t, uint64_t *);
+void cx_match_i32_gt_span(size_t, const int32_t[], int32_t, uint64_t *);
+
+void cx_match_i64_eq_span(size_t, const int64_t[], int64_t, uint64_t *);
+void cx_match_i64_lt_span(size_t, const int64_t[], int64_t, uint64_t *);
+void cx_match_i64_gt_span(size_t, const int64_t[], int64_t, uint64_t *);
+
+void cx_match_flt_eq_span(size_t, const float[], float, uint64_t *);
+void cx_match_flt_lt_span(size_t, const float[], float, uint64_t *);
+void cx_match_flt_gt_span(size_t, const float[], float, uint64_t *);
+
+void cx_match_dbl_eq_span(size_t, const double[], double, uint64_t *);
+void cx_match_dbl_lt_span(size_t, const double[], double, uint64_t *);
+void cx_match_dbl_gt_span(size_t, const double[], double, uint64_t *);
+
+void cx_match_i32_between_span(size_t, const int32_t[], int32_t, int32_t,
+                               uint64_t *);
+void cx_match_i64_between_span(size_t, const int64_t[], int64_t, int64_t,
+                               uint64_t *);
+void cx_match_flt_between_span(size_t, const float[], float, float,
+                               uint64_t *);
+void cx_match_dbl_between_span(size_t, const double[], double, double,
+                               uint64_t *);
+
+void cx_match_i32_eq_column_span(size_t, const int32_t[], const int32_t[],
+                                 int32_t, uint64_t *);
+void cx_match_i32_lt_column_span(size_t, const int32_t[], const int32_t[],
+                                 int32_t, uint64_t *);
+void cx_match_i32_gt_column_span(size_t, const int32_t[], const int32_t[],
+                                 int32_t, uint64_t *);
+void cx_match_i64_eq_column_span(size_t, const int64_t[], const int64_t[],
+                                 int64_t, uint64_t *);
+void cx_match_i64_lt_column_span(size_t, const int64_t[], const int64_t[],
+                                 int64_t, uint64_t *);
+void cx_match_i64_gt_column_span(size_t, const int64_t[], const int64_t[],
+                                 int64_t, uint64_t *);
+void cx_match_flt_eq_column_span(size_t, const float[], const float[], float,
+                                 uint64_t *);
+void cx_match_flt_lt_column_span(size_t, const float[], const float[], float,
+                                 uint64_t *);
+void cx_match_flt_gt_column_span(size_t, const float[], const float[], float,
+                                 uint64_t *);
+void cx_match_dbl_eq_column_span(size_t, const double[], const double[], double,
+                                 uint64_t *);
+void cx_match_dbl_lt_column_span(size_t, const double[], const double[], double,
+                                 uint64_t *);
+void cx_match_dbl_gt_column_span(size_t, const double[], const double[], double,
+                                 uint64_t *);
+
+void cx_match_str_eq_span(size_t, const struct cx_string[],
+                          const struct cx_string *, bool, uint64_t *);
+void cx_match_str_lt_span(size_t, const struct cx_string[],
+                          const struct cx_string *, bool, uint64_t *);
+void cx_match_str_gt_span(size_t, const struct cx_string[],
+                          const struct cx_string *, bool, uint64_t *);
+void cx_match_str_contains_span(size_t, const struct cx_string[],
+                                const struct cx_string *, bool,
+                                enum cx_str_location, uint64_t *);
+
+// a set of distinct I32, I64 or STR values for IN predicates. Sets of up to
+// CX_MATCH_SET_SCAN_MAX values are matched by comparing the batch with each
+// value in turn, and larger sets by probing a hash table once per row
+#define CX_MATCH_SET_SCAN_MAX 8
+
+struct cx_match_set;
+
+// STR values are NUL terminated strings
+struct cx_match_set *cx_match_set_new(enum cx_column_type, size_t count,
+                                      const void *values, bool case_sensitive);
+
+void cx_match_set_free(struct cx_match_set *);
+
+// the distinct values of the set in ascending order, as an array of the
+// column type (cx_string for STR sets)
+const void *cx_match_set_values(const struct cx_match_set *, size_t *count);
+
+uint64_t cx_match_i32_in(size_t, const int32_t[], const struct cx_match_set *);
+uint64_t cx_match_i64_in(size_t, const int64_t[], const struct cx_match_set *);
+uint64_t cx_match_str_in(size_t, const struct cx_string[],
+                         const struct cx_match_set *);
+
+void cx_match_i32_in_span(size_t, const int32_t[], const struct cx_match_set *,
+                          uint64_t *);
+void cx_match_i64_in_span(size_t, const int64_t[], const struct cx_match_set *,
+                          uint64_t *);
+void cx_match_str_in_span(size_t, const struct cx_string[],
+                          const struct cx_match_set *, uint64_t *);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,10 +1,17 @@
 #define _GNU_SOURCE
 #include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <regex.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#include "bloom.h"
+#include "inverted.h"
 #include "match.h"
 #include "predicate.h"
+#include "trigram.h"
 
 enum cx_predicate_type {
     CX_PREDICATE_TRUE,
@@ -13,20 +20,42 @@ enum cx_predicate_type {
     CX_PREDICATE_LT,
     CX_PREDICATE_GT,
     CX_PREDICATE_CONTAINS,
+    CX_PREDICATE_LIKE,
+    CX_PREDICATE_REGEX,
+    CX_PREDICATE_IN,
+    CX_PREDICATE_BETWEEN,
+    CX_PREDICATE_COLUMN,
     CX_PREDICATE_AND,
     CX_PREDICATE_OR,
     CX_PREDICATE_CUSTOM
 };
 
 struct cx_predicate {
+    uint64_t id;
     enum cx_predicate_type type;
     enum cx_column_type column_type;
     size_t column;
     cx_value_t value;
+    // the upper bound of BETWEEN predicates, whose value is the lower bound
+    cx_value_t high;
+    // COLUMN predicates compare the column with the other column plus the
+    // value, using the comparison (EQ, LT or GT)
+    size_t other_column;
+    enum cx_predicate_type comparison;
     size_t operand_count;
     struct cx_predicate **operands;
     char *string;
+    struct cx_match_set *set;
     enum cx_str_location location;
+    // LIKE and REGEX predicates keep the pattern (or the compiled regex).
+    // Their value is the longest literal that every match contains (at the
+    // location), which prefilters rows before the pattern is matched, and
+    // the length is the minimum length of a match
+    char *pattern;
+    regex_t *regex;
+    size_t length;
+    // set if the pattern matches exactly the rows that the literal does
+    bool literal_only;
     bool case_sensitive;
     bool negate;
     struct {
@@ -37,11 +66,26 @@ struct cx_predicate {
     } custom;
 };
 
+struct cx_dict_match {
+    size_t dict_count;
+    size_t count;
+    int32_t min;
+    int32_t max;
+    uint64_t codes[];
+};
+
 static const uint64_t cx_full_mask = (uint64_t)-1;
 
+// predicates are assigned a unique ID which is used as a cache key
+static uint64_t cx_predicate_id;
+
 static struct cx_predicate *cx_predicate_new()
 {
-    return calloc(1, sizeof(struct cx_predicate));
+    struct cx_predicate *predicate = calloc(1, sizeof(struct cx_predicate));
+    if (!predicate)
+        return NULL;
+    predicate->id = __sync_add_and_fetch(&cx_predicate_id, 1);
+    return predicate;
 }
 
 void cx_predicate_free(struct cx_predicate *predicate)
@@ -54,6 +98,14 @@ void cx_predicate_free(struct cx_predicate *predicate)
     }
     if (predicate->string)
         free(predicate->string);
+    if (predicate->set)
+        cx_match_set_free(predicate->set);
+    if (predicate->pattern)
+        free(predicate->pattern);
+    if (predicate->regex) {
+        regfree(predicate->regex);
+        free(predicate->regex);
+    }
     free(predicate);
 }
 
@@ -200,6 +252,166 @@ struct cx_predicate *cx_predicate_new_dbl_gt(size_t column, double value)
     return cx_predicate_new_dbl(column, value, CX_PREDICATE_GT);
 }
 
+static struct cx_predicate *cx_predicate_new_between(size_t column,
+                                                     enum cx_column_type type,
+                                                     cx_value_t low,
+                                                     cx_value_t high)
+{
+    struct cx_predicate *predicate = cx_predicate_new();
+    if (!predicate)
+        return NULL;
+    predicate->column = column;
+    predicate->type = CX_PREDICATE_BETWEEN;
+    predicate->column_type = type;
+    predicate->value = low;
+    predicate->high = high;
+    return predicate;
+}
+
+struct cx_predicate *cx_predicate_new_i32_between(size_t column, int32_t low,
+                                                  int32_t high)
+{
+    return cx_predicate_new_between(column, CX_COLUMN_I32,
+                                    (cx_value_t){.i32 = low},
+                                    (cx_value_t){.i32 = high});
+}
+
+struct cx_predicate *cx_predicate_new_i64_between(size_t column, int64_t low,
+                                                  int64_t high)
+{
+    return cx_predicate_new_between(column, CX_COLUMN_I64,
+                                    (cx_value_t){.i64 = low},
+                                    (cx_value_t){.i64 = high});
+}
+
+struct cx_predicate *cx_predicate_new_flt_between(size_t column, float low,
+                                                  float high)
+{
+    return cx_predicate_new_between(column, CX_COLUMN_FLT,
+                                    (cx_value_t){.flt = low},
+                                    (cx_value_t){.flt = high});
+}
+
+struct cx_predicate *cx_predicate_new_dbl_between(size_t column, double low,
+                                                  double high)
+{
+    return cx_predicate_new_between(column, CX_COLUMN_DBL,
+                                    (cx_value_t){.dbl = low},
+                                    (cx_value_t){.dbl = high});
+}
+
+static struct cx_predicate *cx_predicate_new_column(
+    size_t column, size_t other, enum cx_column_type type, cx_value_t offset,
+    enum cx_predicate_type comparison)
+{
+    struct cx_predicate *predicate = cx_predicate_new();
+    if (!predicate)
+        return NULL;
+    predicate->column = column;
+    predicate->type = CX_PREDICATE_COLUMN;
+    predicate->column_type = type;
+    predicate->value = offset;
+    predicate->other_column = other;
+    predicate->comparison = comparison;
+    return predicate;
+}
+
+struct cx_predicate *cx_predicate_new_i32_eq_column(size_t column, size_t other,
+                                                    int32_t offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_I32,
+                                   (cx_value_t){.i32 = offset},
+                                   CX_PREDICATE_EQ);
+}
+
+struct cx_predicate *cx_predicate_new_i32_lt_column(size_t column, size_t other,
+                                                    int32_t offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_I32,
+                                   (cx_value_t){.i32 = offset},
+                                   CX_PREDICATE_LT);
+}
+
+struct cx_predicate *cx_predicate_new_i32_gt_column(size_t column, size_t other,
+                                                    int32_t offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_I32,
+                                   (cx_value_t){.i32 = offset},
+                                   CX_PREDICATE_GT);
+}
+
+struct cx_predicate *cx_predicate_new_i64_eq_column(size_t column, size_t other,
+                                                    int64_t offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_I64,
+                                   (cx_value_t){.i64 = offset},
+                                   CX_PREDICATE_EQ);
+}
+
+struct cx_predicate *cx_predicate_new_i64_lt_column(size_t column, size_t other,
+                                                    int64_t offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_I64,
+                                   (cx_value_t){.i64 = offset},
+                                   CX_PREDICATE_LT);
+}
+
+struct cx_predicate *cx_predicate_new_i64_gt_column(size_t column, size_t other,
+                                                    int64_t offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_I64,
+                                   (cx_value_t){.i64 = offset},
+                                   CX_PREDICATE_GT);
+}
+
+struct cx_predicate *cx_predicate_new_flt_eq_column(size_t column, size_t other,
+                                                    float offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_FLT,
+                                   (cx_value_t){.flt = offset},
+                                   CX_PREDICATE_EQ);
+}
+
+struct cx_predicate *cx_predicate_new_flt_lt_column(size_t column, size_t other,
+                                                    float offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_FLT,
+                                   (cx_value_t){.flt = offset},
+                                   CX_PREDICATE_LT);
+}
+
+struct cx_predicate *cx_predicate_new_flt_gt_column(size_t column, size_t other,
+                                                    float offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_FLT,
+                                   (cx_value_t){.flt = offset},
+                                   CX_PREDICATE_GT);
+}
+
+struct cx_predicate *cx_predicate_new_dbl_eq_column(size_t column, size_t other,
+                                                    double offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_DBL,
+                                   (cx_value_t){.dbl = offset},
+                                   CX_PREDICATE_EQ);
+}
+
+struct cx_predicate *cx_predicate_new_dbl_lt_column(size_t column, size_t other,
+                                                    double offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_DBL,
+                                   (cx_value_t){.dbl = offset},
+                                   CX_PREDICATE_LT);
+}
+
+struct cx_predicate *cx_predicate_new_dbl_gt_column(size_t column, size_t other,
+                                                    double offset)
+{
+    return cx_predicate_new_column(column, other, CX_COLUMN_DBL,
+                                   (cx_value_t){.dbl = offset},
+                                   CX_PREDICATE_GT);
+}
+
 static struct cx_predicate *cx_predicate_new_str(size_t column,
                                                  const char *value,
                                                  enum cx_predicate_type type,
@@ -259,6 +471,287 @@ struct cx_predicate *cx_predicate_new_str_contains(
     return predicate;
 }
 
+// the literals of a pattern are the runs of characters that every match
+// contains. The longest run is kept, along with its location
+struct cx_pattern_literals {
+    char *buffer;
+    size_t size;
+    size_t run;
+    bool run_start;
+    size_t count;
+    size_t offset;
+    size_t length;
+    enum cx_str_location location;
+};
+
+static void cx_pattern_literals_end(struct cx_pattern_literals *literals,
+                                    bool at_end)
+{
+    size_t length = literals->size - literals->run;
+    if (length) {
+        literals->count++;
+        if (length > literals->length) {
+            literals->offset = literals->run;
+            literals->length = length;
+            if (literals->run_start)
+                literals->location = CX_STR_LOCATION_START;
+            else if (at_end)
+                literals->location = CX_STR_LOCATION_END;
+            else
+                literals->location = CX_STR_LOCATION_ANY;
+        }
+    }
+    literals->run = literals->size;
+    literals->run_start = false;
+}
+
+// LIKE patterns match any run of characters with % and any character with
+// _. A backslash escapes the following character
+static void cx_like_literals(const char *pattern,
+                             struct cx_pattern_literals *literals,
+                             size_t *length, bool *literal_only)
+{
+    bool percent = false, underscore = false;
+    literals->run_start = true;
+    for (const char *p = pattern; *p; p++) {
+        if (*p == '%' || *p == '_') {
+            cx_pattern_literals_end(literals, false);
+            if (*p == '%') {
+                percent = true;
+            } else {
+                underscore = true;
+                (*length)++;
+            }
+            continue;
+        }
+        if (*p == '\\' && p[1])
+            p++;
+        literals->buffer[literals->size++] = *p;
+        (*length)++;
+    }
+    cx_pattern_literals_end(literals, true);
+    *literal_only = percent && !underscore && literals->count <= 1;
+}
+
+static bool cx_regex_quantifier(char c)
+{
+    return c == '*' || c == '+' || c == '?' || c == '{';
+}
+
+// the literals of a POSIX extended regex are found conservatively. Only
+// characters outside of groups are used, and characters that are repeated
+// zero or more times are dropped
+static void cx_regex_literals(const char *pattern,
+                              struct cx_pattern_literals *literals)
+{
+    // alternation can make any literal optional
+    for (const char *p = pattern; *p; p++) {
+        if (*p == '\\' && p[1])
+            p++;
+        else if (*p == '|')
+            return;
+    }
+    size_t depth = 0;
+    // set if the previous atom is the last character of the run
+    bool literal = false;
+    size_t i = 0;
+    if (pattern[0] == '^') {
+        literals->run_start = true;
+        i++;
+    }
+    while (pattern[i]) {
+        char c = pattern[i];
+        if (cx_regex_quantifier(c)) {
+            bool optional = false;
+            while (pattern[i] && cx_regex_quantifier(pattern[i])) {
+                if (pattern[i] != '+')
+                    optional = true;
+                if (pattern[i] == '{') {
+                    i += strcspn(pattern + i, "}");
+                    if (pattern[i])
+                        i++;
+                } else {
+                    i++;
+                }
+            }
+            if (optional && literal)
+                literals->size--;
+            cx_pattern_literals_end(literals, false);
+            literal = false;
+            continue;
+        }
+        if (c == '[') {
+            i++;
+            if (pattern[i] == '^')
+                i++;
+            if (pattern[i] == ']')
+                i++;
+            while (pattern[i] && pattern[i] != ']') {
+                // skip classes such as [:alpha:]
+                if (pattern[i] == '[' && pattern[i + 1] &&
+                    strchr(":.=", pattern[i + 1])) {
+                    char delimiter = pattern[i + 1];
+                    for (i += 2; pattern[i]; i++)
+                        if (pattern[i] == delimiter && pattern[i + 1] == ']')
+                            break;
+                    if (pattern[i])
+                        i += 2;
+                } else {
+                    i++;
+                }
+            }
+            if (pattern[i])
+                i++;
+            cx_pattern_literals_end(literals, false);
+            literal = false;
+            continue;
+        }
+        if (c == '$' && !pattern[i + 1] && !depth) {
+            cx_pattern_literals_end(literals, true);
+            literal = false;
+            i++;
+            continue;
+        }
+        if (c == '\\') {
+            // escaped letters and digits are classes and back-references
+            if (!pattern[i + 1] || isalnum((unsigned char)pattern[i + 1])) {
+                i += pattern[i + 1] ? 2 : 1;
+                cx_pattern_literals_end(literals, false);
+                literal = false;
+                continue;
+            }
+            c = pattern[++i];
+        } else if (c == '(' || c == ')' || c == '.' || c == '^' || c == '$') {
+            if (c == '(')
+                depth++;
+            else if (c == ')' && depth)
+                depth--;
+            cx_pattern_literals_end(literals, false);
+            literal = false;
+            i++;
+            continue;
+        }
+        i++;
+        if (depth) {
+            literal = false;
+            continue;
+        }
+        literals->buffer[literals->size++] = c;
+        literal = true;
+    }
+    cx_pattern_literals_end(literals, false);
+}
+
+static struct cx_predicate *cx_predicate_new_pattern(
+    size_t column, const char *pattern, enum cx_predicate_type type,
+    bool case_sensitive)
+{
+    struct cx_predicate *predicate = NULL;
+    struct cx_pattern_literals literals = {0};
+    literals.location = CX_STR_LOCATION_ANY;
+    literals.buffer = malloc(strlen(pattern) + 1);
+    if (!literals.buffer)
+        return NULL;
+    size_t length = 0;
+    bool literal_only = false;
+    if (type == CX_PREDICATE_LIKE) {
+        cx_like_literals(pattern, &literals, &length, &literal_only);
+    } else {
+        cx_regex_literals(pattern, &literals);
+        length = literals.length;
+    }
+    literals.buffer[literals.offset + literals.length] = 0;
+    predicate = cx_predicate_new_str(column, literals.buffer + literals.offset,
+                                     type, case_sensitive);
+    if (!predicate)
+        goto error;
+    predicate->location = literals.location;
+    predicate->length = length;
+    predicate->literal_only = literal_only;
+    if (type == CX_PREDICATE_LIKE) {
+        predicate->pattern = strdup(pattern);
+        if (!predicate->pattern)
+            goto error;
+    } else {
+        predicate->regex = malloc(sizeof(regex_t));
+        if (!predicate->regex)
+            goto error;
+        int flags = REG_EXTENDED | REG_NOSUB;
+        if (!case_sensitive)
+            flags |= REG_ICASE;
+        if (regcomp(predicate->regex, pattern, flags)) {
+            free(predicate->regex);
+            predicate->regex = NULL;
+            goto error;
+        }
+    }
+    free(literals.buffer);
+    return predicate;
+error:
+    if (predicate)
+        cx_predicate_free(predicate);
+    free(literals.buffer);
+    return NULL;
+}
+
+struct cx_predicate *cx_predicate_new_str_like(size_t column,
+                                               const char *pattern,
+                                               bool case_sensitive)
+{
+    return cx_predicate_new_pattern(column, pattern, CX_PREDICATE_LIKE,
+                                    case_sensitive);
+}
+
+struct cx_predicate *cx_predicate_new_str_regex(size_t column,
+                                                const char *pattern,
+                                                bool case_sensitive)
+{
+    return cx_predicate_new_pattern(column, pattern, CX_PREDICATE_REGEX,
+                                    case_sensitive);
+}
+
+static struct cx_predicate *cx_predicate_new_in(size_t column,
+                                                enum cx_column_type type,
+                                                size_t count,
+                                                const void *values,
+                                                bool case_sensitive)
+{
+    struct cx_predicate *predicate = cx_predicate_new();
+    if (!predicate)
+        return NULL;
+    predicate->column = column;
+    predicate->type = CX_PREDICATE_IN;
+    predicate->column_type = type;
+    predicate->case_sensitive = case_sensitive;
+    predicate->set = cx_match_set_new(type, count, values, case_sensitive);
+    if (!predicate->set)
+        goto error;
+    return predicate;
+error:
+    free(predicate);
+    return NULL;
+}
+
+struct cx_predicate *cx_predicate_new_i32_in(size_t column, size_t count,
+                                             const int32_t *values)
+{
+    return cx_predicate_new_in(column, CX_COLUMN_I32, count, values, true);
+}
+
+struct cx_predicate *cx_predicate_new_i64_in(size_t column, size_t count,
+                                             const int64_t *values)
+{
+    return cx_predicate_new_in(column, CX_COLUMN_I64, count, values, true);
+}
+
+struct cx_predicate *cx_predicate_new_str_in(size_t column, size_t count,
+                                             const char **values,
+                                             bool case_sensitive)
+{
+    return cx_predicate_new_in(column, CX_COLUMN_STR, count, values,
+                               case_sensitive);
+}
+
 struct cx_predicate *cx_predicate_new_custom(size_t column,
                                              enum cx_column_type type,
                                              cx_index_match_rows_t match_rows,
@@ -379,6 +872,17 @@ static bool cx_predicate_is_operator(const struct cx_predicate *predicate)
            predicate->type == CX_PREDICATE_OR;
 }
 
+static bool cx_predicate_is_comparison(const struct cx_predicate *predicate)
+{
+    return predicate->type == CX_PREDICATE_EQ ||
+           predicate->type == CX_PREDICATE_LT ||
+           predicate->type == CX_PREDICATE_GT ||
+           predicate->type == CX_PREDICATE_CONTAINS ||
+           predicate->type == CX_PREDICATE_LIKE ||
+           predicate->type == CX_PREDICATE_REGEX ||
+           predicate->type == CX_PREDICATE_IN;
+}
+
 bool cx_predicate_valid(const struct cx_predicate *predicate,
                         const struct cx_row_group *row_group)
 {
@@ -403,7 +907,22 @@ bool cx_predicate_valid(const struct cx_predicate *predicate,
         case CX_PREDICATE_GT:
             return column_type != CX_COLUMN_BIT;
         case CX_PREDICATE_CONTAINS:
+        case CX_PREDICATE_LIKE:
+        case CX_PREDICATE_REGEX:
             return column_type == CX_COLUMN_STR;
+        case CX_PREDICATE_IN:
+            return column_type == CX_COLUMN_I32 ||
+                   column_type == CX_COLUMN_I64 ||
+                   column_type == CX_COLUMN_STR;
+        case CX_PREDICATE_BETWEEN:
+            return column_type != CX_COLUMN_BIT &&
+                   column_type != CX_COLUMN_STR;
+        case CX_PREDICATE_COLUMN:
+            return predicate->other_column <
+                       cx_row_group_column_count(row_group) &&
+                   cx_row_group_column_type(row_group,
+                                            predicate->other_column) ==
+                       column_type;
         case CX_PREDICATE_AND:
         case CX_PREDICATE_OR:
             for (size_t i = 0; i < predicate->operand_count; i++)
@@ -415,20 +934,40 @@ bool cx_predicate_valid(const struct cx_predicate *predicate,
     return true;
 }
 
-static inline uint64_t cx_mask_cap(uint64_t mask, size_t count)
+// masks have a bit for each row in the batch, and a word for each 64 rows
+#define CX_MASK_WORDS_MAX (CX_BATCH_SIZE_MAX / 64)
+
+static inline size_t cx_mask_words(size_t count)
+{
+    return (count + 63) / 64;
+}
+
+// clear the bits beyond the last row
+static inline void cx_mask_cap(uint64_t *mask, size_t count)
+{
+    if (count % 64)
+        mask[count / 64] &= ((uint64_t)1 << (count % 64)) - 1;
+}
+
+static inline void cx_mask_fill(uint64_t *mask, size_t count)
+{
+    size_t words = cx_mask_words(count);
+    for (size_t i = 0; i < words; i++)
+        mask[i] = cx_full_mask;
+    cx_mask_cap(mask, count);
+}
+
+static inline void cx_mask_clear(uint64_t *mask, size_t count)
 {
-    assert(count <= 64);
-    if (count < 64)
-        mask &= ((uint64_t)1 << count) - 1;
-    return mask;
+    memset(mask, 0, cx_mask_words(count) * sizeof(uint64_t));
 }
 
+
 static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                                    struct cx_row_group_cursor *cursor,
                                    enum cx_column_type type, uint64_t *matches,
                                    size_t *count)
 {
-    uint64_t mask = 0;
     switch (type) {
         case CX_COLUMN_BIT: {
             assert(predicate->column_type == CX_COLUMN_BIT);
@@ -436,11 +975,13 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_bit(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            if (*count) {
-                if (predicate->value.bit)
-                    mask = *values;
-                else
-                    mask = cx_mask_cap(~*values, *count);
+            size_t words = cx_mask_words(*count);
+            if (predicate->value.bit) {
+                memcpy(matches, values, words * sizeof(uint64_t));
+            } else {
+                for (size_t i = 0; i < words; i++)
+                    matches[i] = ~values[i];
+                cx_mask_cap(matches, *count);
             }
         } break;
         case CX_COLUMN_I32: {
@@ -449,7 +990,8 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i32_eq(*count, values, predicate->value.i32);
+            cx_match_i32_eq_span(*count, values, predicate->value.i32,
+                                 matches);
         } break;
         case CX_COLUMN_I64: {
             assert(predicate->column_type == CX_COLUMN_I64);
@@ -457,7 +999,8 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i64_eq(*count, values, predicate->value.i64);
+            cx_match_i64_eq_span(*count, values, predicate->value.i64,
+                                 matches);
         } break;
         case CX_COLUMN_FLT: {
             assert(predicate->column_type == CX_COLUMN_FLT);
@@ -465,7 +1008,8 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_flt(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_flt_eq(*count, values, predicate->value.flt);
+            cx_match_flt_eq_span(*count, values, predicate->value.flt,
+                                 matches);
         } break;
         case CX_COLUMN_DBL: {
             assert(predicate->column_type == CX_COLUMN_DBL);
@@ -473,7 +1017,8 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_dbl(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_dbl_eq(*count, values, predicate->value.dbl);
+            cx_match_dbl_eq_span(*count, values, predicate->value.dbl,
+                                 matches);
         } break;
         case CX_COLUMN_STR: {
             assert(predicate->column_type == CX_COLUMN_STR);
@@ -481,11 +1026,10 @@ static bool cx_index_match_rows_eq(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_str(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_str_eq(*count, values, &predicate->value.str,
-                                   predicate->case_sensitive);
+            cx_match_str_eq_span(*count, values, &predicate->value.str,
+                                 predicate->case_sensitive, matches);
         } break;
     }
-    *matches = mask;
     return true;
 error:
     return false;
@@ -519,18 +1063,222 @@ static enum cx_index_match cx_index_match_index_eq(
             break;
         case CX_COLUMN_STR:
             assert(predicate->column_type == CX_COLUMN_STR);
-            result = cx_index_match_str_eq(index, &predicate->value.str);
+            if (predicate->case_sensitive)
+                result = cx_index_match_str_eq(index, &predicate->value.str);
+            else
+                result = cx_index_match_str_len_eq(index,
+                                                   predicate->value.str.len);
+            break;
+    }
+    return result;
+}
+
+// hash the value of an equality predicate, as Bloom filters and inverted
+// indexes do. Returns false if the value can't be hashed
+static bool cx_predicate_hash(const struct cx_predicate *predicate,
+                              enum cx_column_type type, uint64_t *hash)
+{
+    switch (type) {
+        case CX_COLUMN_I32:
+            *hash = cx_bloom_hash_i64(predicate->value.i32);
+            return true;
+        case CX_COLUMN_I64:
+            *hash = cx_bloom_hash_i64(predicate->value.i64);
+            return true;
+        case CX_COLUMN_STR:
+            if (!predicate->case_sensitive)
+                return false;
+            *hash = cx_bloom_hash_str(&predicate->value.str);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// check the column chunk's Bloom filter (if it has one) for the value
+static bool cx_index_match_bloom(const struct cx_predicate *predicate,
+                                 enum cx_column_type type,
+                                 const struct cx_row_group *row_group)
+{
+    size_t size;
+    const void *bloom =
+        cx_row_group_column_bloom(row_group, predicate->column, &size);
+    if (!bloom)
+        return true;
+    uint64_t hash;
+    if (!cx_predicate_hash(predicate, type, &hash))
+        return true;
+    return cx_bloom_contains(bloom, size, hash);
+}
+
+// check the column chunk's trigram filter (if it has one) for the trigrams
+// of a substring. Filters are case insensitive
+static bool cx_index_match_trigrams(const struct cx_predicate *predicate,
+                                    const struct cx_row_group *row_group)
+{
+    size_t size;
+    const void *filter =
+        cx_row_group_column_trigrams(row_group, predicate->column, &size);
+    if (!filter)
+        return true;
+    return cx_trigram_filter_contains(filter, size, &predicate->value.str);
+}
+
+// the first value of a sorted set that's no less than the value
+#define CX_SET_LOWER_BOUND(name, type)                                 \
+    static size_t cx_set_lower_bound_##name(const type *values,       \
+                                            size_t count, type value) \
+    {                                                                  \
+        size_t low = 0, high = count;                                  \
+        while (low < high) {                                           \
+            size_t middle = low + (high - low) / 2;                    \
+            if (values[middle] < value)                                \
+                low = middle + 1;                                      \
+            else                                                       \
+                high = middle;                                         \
+        }                                                              \
+        return low;                                                    \
+    }
+
+CX_SET_LOWER_BOUND(i32, int32_t)
+CX_SET_LOWER_BOUND(i64, int64_t)
+
+static enum cx_index_match cx_index_match_index_in(
+    const struct cx_predicate *predicate, enum cx_column_type type,
+    const struct cx_index *index)
+{
+    size_t count;
+    const void *values = cx_match_set_values(predicate->set, &count);
+    enum cx_index_match result = CX_INDEX_MATCH_NONE;
+    switch (type) {
+        case CX_COLUMN_I32: {
+            assert(predicate->column_type == CX_COLUMN_I32);
+            // find the smallest value in the set within the bounds
+            size_t i = cx_set_lower_bound_i32(values, count, index->min.i32);
+            if (i == count || ((const int32_t *)values)[i] > index->max.i32)
+                result = CX_INDEX_MATCH_NONE;
+            else if (index->min.i32 == index->max.i32)
+                result = CX_INDEX_MATCH_ALL;
+            else
+                result = CX_INDEX_MATCH_UNKNOWN;
+        } break;
+        case CX_COLUMN_I64: {
+            assert(predicate->column_type == CX_COLUMN_I64);
+            size_t i = cx_set_lower_bound_i64(values, count, index->min.i64);
+            if (i == count || ((const int64_t *)values)[i] > index->max.i64)
+                result = CX_INDEX_MATCH_NONE;
+            else if (index->min.i64 == index->max.i64)
+                result = CX_INDEX_MATCH_ALL;
+            else
+                result = CX_INDEX_MATCH_UNKNOWN;
+        } break;
+        case CX_COLUMN_STR:
+            assert(predicate->column_type == CX_COLUMN_STR);
+            for (size_t i = 0; result != CX_INDEX_MATCH_ALL && i < count;
+                 i++) {
+                const struct cx_string *value =
+                    &((const struct cx_string *)values)[i];
+                enum cx_index_match value_match =
+                    predicate->case_sensitive
+                        ? cx_index_match_str_eq(index, value)
+                        : cx_index_match_str_len_eq(index, value->len);
+                if (value_match > result)
+                    result = value_match;
+            }
             break;
+        default:
+            result = CX_INDEX_MATCH_UNKNOWN;
     }
     return result;
 }
 
+// hash the value at position i of the set of an IN predicate
+static bool cx_predicate_set_hash(const struct cx_predicate *predicate,
+                                  size_t i, uint64_t *hash)
+{
+    size_t count;
+    const void *values = cx_match_set_values(predicate->set, &count);
+    switch (predicate->column_type) {
+        case CX_COLUMN_I32:
+            *hash = cx_bloom_hash_i64(((const int32_t *)values)[i]);
+            return true;
+        case CX_COLUMN_I64:
+            *hash = cx_bloom_hash_i64(((const int64_t *)values)[i]);
+            return true;
+        case CX_COLUMN_STR:
+            if (!predicate->case_sensitive)
+                return false;
+            *hash = cx_bloom_hash_str(&((const struct cx_string *)values)[i]);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// check the column chunk's Bloom filter (if it has one) for any value of
+// the set
+static bool cx_index_match_bloom_in(const struct cx_predicate *predicate,
+                                    const struct cx_row_group *row_group)
+{
+    size_t size;
+    const void *bloom =
+        cx_row_group_column_bloom(row_group, predicate->column, &size);
+    if (!bloom)
+        return true;
+    size_t count;
+    cx_match_set_values(predicate->set, &count);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t hash;
+        if (!cx_predicate_set_hash(predicate, i, &hash) ||
+            cx_bloom_contains(bloom, size, hash))
+            return true;
+    }
+    return false;
+}
+
+static bool cx_index_match_rows_in(const struct cx_predicate *predicate,
+                                   struct cx_row_group_cursor *cursor,
+                                   enum cx_column_type type, uint64_t *matches,
+                                   size_t *count)
+{
+    switch (type) {
+        case CX_COLUMN_I32: {
+            assert(predicate->column_type == CX_COLUMN_I32);
+            const int32_t *values =
+                cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
+            if (!values)
+                goto error;
+            cx_match_i32_in_span(*count, values, predicate->set, matches);
+        } break;
+        case CX_COLUMN_I64: {
+            assert(predicate->column_type == CX_COLUMN_I64);
+            const int64_t *values =
+                cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
+            if (!values)
+                goto error;
+            cx_match_i64_in_span(*count, values, predicate->set, matches);
+        } break;
+        case CX_COLUMN_STR: {
+            assert(predicate->column_type == CX_COLUMN_STR);
+            const struct cx_string *values =
+                cx_row_group_cursor_batch_str(cursor, predicate->column, count);
+            if (!values)
+                goto error;
+            cx_match_str_in_span(*count, values, predicate->set, matches);
+        } break;
+        default:
+            goto error;  // unsupported
+    }
+    return true;
+error:
+    return false;
+}
+
 static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                                    struct cx_row_group_cursor *cursor,
                                    enum cx_column_type type, uint64_t *matches,
                                    size_t *count)
 {
-    uint64_t mask = 0;
     switch (type) {
         case CX_COLUMN_BIT:
             goto error;  // unsupported
@@ -540,7 +1288,8 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i32_lt(*count, values, predicate->value.i32);
+            cx_match_i32_lt_span(*count, values, predicate->value.i32,
+                                 matches);
         } break;
         case CX_COLUMN_I64: {
             assert(predicate->column_type == CX_COLUMN_I64);
@@ -548,7 +1297,8 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i64_lt(*count, values, predicate->value.i64);
+            cx_match_i64_lt_span(*count, values, predicate->value.i64,
+                                 matches);
         } break;
         case CX_COLUMN_FLT: {
             assert(predicate->column_type == CX_COLUMN_FLT);
@@ -556,7 +1306,8 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_flt(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_flt_lt(*count, values, predicate->value.flt);
+            cx_match_flt_lt_span(*count, values, predicate->value.flt,
+                                 matches);
         } break;
         case CX_COLUMN_DBL: {
             assert(predicate->column_type == CX_COLUMN_DBL);
@@ -564,7 +1315,8 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_dbl(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_dbl_lt(*count, values, predicate->value.dbl);
+            cx_match_dbl_lt_span(*count, values, predicate->value.dbl,
+                                 matches);
         } break;
         case CX_COLUMN_STR: {
             assert(predicate->column_type == CX_COLUMN_STR);
@@ -572,11 +1324,10 @@ static bool cx_index_match_rows_lt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_str(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_str_lt(*count, values, &predicate->value.str,
-                                   predicate->case_sensitive);
+            cx_match_str_lt_span(*count, values, &predicate->value.str,
+                                 predicate->case_sensitive, matches);
         } break;
     }
-    *matches = mask;
     return true;
 error:
     return false;
@@ -607,6 +1358,9 @@ static enum cx_index_match cx_index_match_index_lt(
             result = cx_index_match_dbl_lt(index, predicate->value.dbl);
             break;
         case CX_COLUMN_STR:
+            assert(predicate->column_type == CX_COLUMN_STR);
+            if (predicate->case_sensitive)
+                result = cx_index_match_str_lt(index, &predicate->value.str);
             break;
     }
     return result;
@@ -617,7 +1371,6 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                                    enum cx_column_type type, uint64_t *matches,
                                    size_t *count)
 {
-    uint64_t mask = 0;
     switch (type) {
         case CX_COLUMN_BIT:
             goto error;  // unsupported
@@ -627,7 +1380,8 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i32_gt(*count, values, predicate->value.i32);
+            cx_match_i32_gt_span(*count, values, predicate->value.i32,
+                                 matches);
         } break;
         case CX_COLUMN_I64: {
             assert(predicate->column_type == CX_COLUMN_I64);
@@ -635,7 +1389,8 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_i64_gt(*count, values, predicate->value.i64);
+            cx_match_i64_gt_span(*count, values, predicate->value.i64,
+                                 matches);
         } break;
         case CX_COLUMN_FLT: {
             assert(predicate->column_type == CX_COLUMN_FLT);
@@ -643,7 +1398,8 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_flt(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_flt_gt(*count, values, predicate->value.flt);
+            cx_match_flt_gt_span(*count, values, predicate->value.flt,
+                                 matches);
         } break;
         case CX_COLUMN_DBL: {
             assert(predicate->column_type == CX_COLUMN_DBL);
@@ -651,7 +1407,8 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_dbl(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_dbl_gt(*count, values, predicate->value.dbl);
+            cx_match_dbl_gt_span(*count, values, predicate->value.dbl,
+                                 matches);
         } break;
         case CX_COLUMN_STR: {
             assert(predicate->column_type == CX_COLUMN_STR);
@@ -659,11 +1416,10 @@ static bool cx_index_match_rows_gt(const struct cx_predicate *predicate,
                 cx_row_group_cursor_batch_str(cursor, predicate->column, count);
             if (!values)
                 goto error;
-            mask = cx_match_str_gt(*count, values, &predicate->value.str,
-                                   predicate->case_sensitive);
+            cx_match_str_gt_span(*count, values, &predicate->value.str,
+                                 predicate->case_sensitive, matches);
         } break;
     }
-    *matches = mask;
     return true;
 error:
     return false;
@@ -694,21 +1450,261 @@ static enum cx_index_match cx_index_match_index_gt(
             result = cx_index_match_dbl_gt(index, predicate->value.dbl);
             break;
         case CX_COLUMN_STR:
+            assert(predicate->column_type == CX_COLUMN_STR);
+            if (predicate->case_sensitive)
+                result = cx_index_match_str_gt(index, &predicate->value.str);
             break;
     }
     return result;
 }
 
-static bool cx_index_match_rows_custom(const struct cx_predicate *predicate,
-                                       struct cx_row_group_cursor *cursor,
-                                       enum cx_column_type type,
-                                       uint64_t *matches, size_t *count)
+static bool cx_index_match_rows_between(const struct cx_predicate *predicate,
+                                        struct cx_row_group_cursor *cursor,
+                                        enum cx_column_type type,
+                                        uint64_t *matches, size_t *count)
 {
-    size_t column = predicate->column;
-    const void *values = NULL;
     switch (type) {
-        case CX_COLUMN_BIT:
-            assert(predicate->column_type == CX_COLUMN_BIT);
+        case CX_COLUMN_I32: {
+            assert(predicate->column_type == CX_COLUMN_I32);
+            const int32_t *values =
+                cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
+            if (!values)
+                goto error;
+            cx_match_i32_between_span(*count, values, predicate->value.i32,
+                                      predicate->high.i32, matches);
+        } break;
+        case CX_COLUMN_I64: {
+            assert(predicate->column_type == CX_COLUMN_I64);
+            const int64_t *values =
+                cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
+            if (!values)
+                goto error;
+            cx_match_i64_between_span(*count, values, predicate->value.i64,
+                                      predicate->high.i64, matches);
+        } break;
+        case CX_COLUMN_FLT: {
+            assert(predicate->column_type == CX_COLUMN_FLT);
+            const float *values =
+                cx_row_group_cursor_batch_flt(cursor, predicate->column, count);
+            if (!values)
+                goto error;
+            cx_match_flt_between_span(*count, values, predicate->value.flt,
+                                      predicate->high.flt, matches);
+        } break;
+        case CX_COLUMN_DBL: {
+            assert(predicate->column_type == CX_COLUMN_DBL);
+            const double *values =
+                cx_row_group_cursor_batch_dbl(cursor, predicate->column, count);
+            if (!values)
+                goto error;
+            cx_match_dbl_between_span(*count, values, predicate->value.dbl,
+                                      predicate->high.dbl, matches);
+        } break;
+        default:
+            goto error;  // unsupported
+    }
+    return true;
+error:
+    return false;
+}
+
+// the values in the chunk are all above the lower bound and below the upper
+// bound (ALL), or all outside the range (NONE). Empty ranges match nothing
+static enum cx_index_match cx_index_match_index_between(
+    const struct cx_predicate *predicate, enum cx_column_type type,
+    const struct cx_index *index)
+{
+    const cx_value_t *low = &predicate->value, *high = &predicate->high;
+    enum cx_index_match above = CX_INDEX_MATCH_UNKNOWN;
+    enum cx_index_match below = CX_INDEX_MATCH_UNKNOWN;
+    switch (type) {
+        case CX_COLUMN_I32:
+            assert(predicate->column_type == CX_COLUMN_I32);
+            if (low->i32 >= high->i32 || low->i32 + 1 == high->i32)
+                return CX_INDEX_MATCH_NONE;
+            above = cx_index_match_i32_gt(index, low->i32);
+            below = cx_index_match_i32_lt(index, high->i32);
+            break;
+        case CX_COLUMN_I64:
+            assert(predicate->column_type == CX_COLUMN_I64);
+            if (low->i64 >= high->i64 || low->i64 + 1 == high->i64)
+                return CX_INDEX_MATCH_NONE;
+            above = cx_index_match_i64_gt(index, low->i64);
+            below = cx_index_match_i64_lt(index, high->i64);
+            break;
+        case CX_COLUMN_FLT:
+            assert(predicate->column_type == CX_COLUMN_FLT);
+            if (!(low->flt < high->flt))
+                return CX_INDEX_MATCH_NONE;
+            above = cx_index_match_flt_gt(index, low->flt);
+            below = cx_index_match_flt_lt(index, high->flt);
+            break;
+        case CX_COLUMN_DBL:
+            assert(predicate->column_type == CX_COLUMN_DBL);
+            if (!(low->dbl < high->dbl))
+                return CX_INDEX_MATCH_NONE;
+            above = cx_index_match_dbl_gt(index, low->dbl);
+            below = cx_index_match_dbl_lt(index, high->dbl);
+            break;
+        default:
+            break;
+    }
+    return above < below ? above : below;
+}
+
+#define CX_MATCH_COLUMN_SPAN(name)                                            \
+    switch (predicate->comparison) {                                          \
+        case CX_PREDICATE_EQ:                                                 \
+            cx_match_##name##_eq_column_span(*count, values, other,           \
+                                             predicate->value.name, matches); \
+            break;                                                            \
+        case CX_PREDICATE_LT:                                                 \
+            cx_match_##name##_lt_column_span(*count, values, other,           \
+                                             predicate->value.name, matches); \
+            break;                                                            \
+        default:                                                              \
+            assert(predicate->comparison == CX_PREDICATE_GT);                 \
+            cx_match_##name##_gt_column_span(*count, values, other,           \
+                                             predicate->value.name, matches); \
+    }
+
+static bool cx_index_match_rows_column(const struct cx_predicate *predicate,
+                                       struct cx_row_group_cursor *cursor,
+                                       uint64_t *matches, size_t *count)
+{
+    // each column's batch is buffered separately, so both can be held
+    size_t other_count;
+    switch (predicate->column_type) {
+        case CX_COLUMN_I32: {
+            const int32_t *values =
+                cx_row_group_cursor_batch_i32(cursor, predicate->column, count);
+            const int32_t *other = cx_row_group_cursor_batch_i32(
+                cursor, predicate->other_column, &other_count);
+            if (!values || !other || other_count != *count)
+                goto error;
+            CX_MATCH_COLUMN_SPAN(i32)
+        } break;
+        case CX_COLUMN_I64: {
+            const int64_t *values =
+                cx_row_group_cursor_batch_i64(cursor, predicate->column, count);
+            const int64_t *other = cx_row_group_cursor_batch_i64(
+                cursor, predicate->other_column, &other_count);
+            if (!values || !other || other_count != *count)
+                goto error;
+            CX_MATCH_COLUMN_SPAN(i64)
+        } break;
+        case CX_COLUMN_FLT: {
+            const float *values =
+                cx_row_group_cursor_batch_flt(cursor, predicate->column, count);
+            const float *other = cx_row_group_cursor_batch_flt(
+                cursor, predicate->other_column, &other_count);
+            if (!values || !other || other_count != *count)
+                goto error;
+            CX_MATCH_COLUMN_SPAN(flt)
+        } break;
+        case CX_COLUMN_DBL: {
+            const double *values =
+                cx_row_group_cursor_batch_dbl(cursor, predicate->column, count);
+            const double *other = cx_row_group_cursor_batch_dbl(
+                cursor, predicate->other_column, &other_count);
+            if (!values || !other || other_count != *count)
+                goto error;
+            CX_MATCH_COLUMN_SPAN(dbl)
+        } break;
+        default:
+            goto error;  // unsupported
+    }
+    return true;
+error:
+    return false;
+}
+
+#define CX_COLUMN_BOUNDS_MATCH(min, max, low, high)           \
+    switch (predicate->comparison) {                          \
+        case CX_PREDICATE_EQ:                                 \
+            if (max < low || min > high)                      \
+                result = CX_INDEX_MATCH_NONE;                 \
+            else if (min == max && low == high && min == low) \
+                result = CX_INDEX_MATCH_ALL;                  \
+            break;                                            \
+        case CX_PREDICATE_LT:                                 \
+            if (max < low)                                    \
+                result = CX_INDEX_MATCH_ALL;                  \
+            else if (min >= high)                             \
+                result = CX_INDEX_MATCH_NONE;                 \
+            break;                                            \
+        default:                                              \
+            if (min > high)                                   \
+                result = CX_INDEX_MATCH_ALL;                  \
+            else if (max <= low)                              \
+                result = CX_INDEX_MATCH_NONE;                 \
+    }
+
+// compare the bounds of a chunk with the bounds of the other column's
+// chunk, shifted by the offset. Integer bounds that overflow when shifted
+// can't be compared, since the sums wrap when matching rows
+static enum cx_index_match cx_index_match_column_bounds(
+    const struct cx_predicate *predicate, const cx_index_value_t *min,
+    const cx_index_value_t *max, const cx_index_value_t *other_min,
+    const cx_index_value_t *other_max)
+{
+    enum cx_index_match result = CX_INDEX_MATCH_UNKNOWN;
+    switch (predicate->column_type) {
+        case CX_COLUMN_I32: {
+            int32_t low, high;
+            if (__builtin_add_overflow(other_min->i32, predicate->value.i32,
+                                       &low) ||
+                __builtin_add_overflow(other_max->i32, predicate->value.i32,
+                                       &high))
+                break;
+            CX_COLUMN_BOUNDS_MATCH(min->i32, max->i32, low, high)
+        } break;
+        case CX_COLUMN_I64: {
+            int64_t low, high;
+            if (__builtin_add_overflow(other_min->i64, predicate->value.i64,
+                                       &low) ||
+                __builtin_add_overflow(other_max->i64, predicate->value.i64,
+                                       &high))
+                break;
+            CX_COLUMN_BOUNDS_MATCH(min->i64, max->i64, low, high)
+        } break;
+        case CX_COLUMN_FLT: {
+            float low = other_min->flt + predicate->value.flt;
+            float high = other_max->flt + predicate->value.flt;
+            CX_COLUMN_BOUNDS_MATCH(min->flt, max->flt, low, high)
+        } break;
+        case CX_COLUMN_DBL: {
+            double low = other_min->dbl + predicate->value.dbl;
+            double high = other_max->dbl + predicate->value.dbl;
+            CX_COLUMN_BOUNDS_MATCH(min->dbl, max->dbl, low, high)
+        } break;
+        default:
+            break;
+    }
+    return result;
+}
+
+static enum cx_index_match cx_index_match_index_column(
+    const struct cx_predicate *predicate, const struct cx_row_group *row_group)
+{
+    const struct cx_index *index =
+        cx_row_group_column_index(row_group, predicate->column);
+    const struct cx_index *other =
+        cx_row_group_column_index(row_group, predicate->other_column);
+    return cx_index_match_column_bounds(predicate, &index->min, &index->max,
+                                        &other->min, &other->max);
+}
+
+static bool cx_index_match_rows_custom(const struct cx_predicate *predicate,
+                                       struct cx_row_group_cursor *cursor,
+                                       enum cx_column_type type,
+                                       uint64_t *matches, size_t *count)
+{
+    size_t column = predicate->column;
+    const void *values = NULL;
+    switch (type) {
+        case CX_COLUMN_BIT:
+            assert(predicate->column_type == CX_COLUMN_BIT);
             values = cx_row_group_cursor_batch_bit(cursor, column, count);
             break;
         case CX_COLUMN_I32:
@@ -734,12 +1730,256 @@ static bool cx_index_match_rows_custom(const struct cx_predicate *predicate,
     }
     if (!values)
         return false;
+    cx_mask_clear(matches, *count);
     if (!predicate->custom.match_rows)
         return true;
     return predicate->custom.match_rows(type, *count, values, matches,
                                         predicate->custom.data);
 }
 
+static inline bool cx_like_char_eq(char a, char b, bool case_sensitive)
+{
+    return a == b ||
+           (!case_sensitive && tolower((unsigned char)a) ==
+                                   tolower((unsigned char)b));
+}
+
+// on a mismatch, the last % is retried one character further along
+static bool cx_like_match(const char *pattern, const struct cx_string *value,
+                          bool case_sensitive)
+{
+    const char *retry = NULL;
+    size_t retry_position = 0;
+    for (size_t i = 0; i < value->len;) {
+        if (*pattern == '%') {
+            retry = ++pattern;
+            retry_position = i;
+            continue;
+        }
+        const char *next = pattern;
+        if (*next == '\\' && next[1])
+            next++;
+        if (*pattern &&
+            (*pattern == '_' ||
+             cx_like_char_eq(*next, value->ptr[i], case_sensitive))) {
+            pattern = next + 1;
+            i++;
+            continue;
+        }
+        if (!retry)
+            return false;
+        pattern = retry;
+        i = ++retry_position;
+    }
+    while (*pattern == '%')
+        pattern++;
+    return !*pattern;
+}
+
+static bool cx_predicate_pattern_match(const struct cx_predicate *predicate,
+                                       const struct cx_string *value)
+{
+    if (predicate->regex)
+        return !regexec(predicate->regex, value->ptr, 0, NULL, 0);
+    return cx_like_match(predicate->pattern, value,
+                         predicate->case_sensitive);
+}
+
+// rows are prefiltered with the literal, and the pattern is only matched
+// against the rows that contain it
+static void cx_match_str_pattern(const struct cx_predicate *predicate,
+                                 size_t count, const struct cx_string *values,
+                                 uint64_t *matches)
+{
+    if (predicate->value.str.len)
+        cx_match_str_contains_span(count, values, &predicate->value.str,
+                                   predicate->case_sensitive,
+                                   predicate->location, matches);
+    else
+        cx_mask_fill(matches, count);
+    if (predicate->literal_only)
+        return;
+    for (size_t i = 0; i < cx_mask_words(count); i++) {
+        uint64_t mask = matches[i];
+        while (mask) {
+            int bit = __builtin_ctzll(mask);
+            mask &= mask - 1;
+            if (!cx_predicate_pattern_match(predicate, &values[i * 64 + bit]))
+                matches[i] &= ~((uint64_t)1 << bit);
+        }
+    }
+}
+
+static void cx_match_str(const struct cx_predicate *predicate, size_t count,
+                         const struct cx_string *values, uint64_t *matches)
+{
+    switch (predicate->type) {
+        case CX_PREDICATE_EQ:
+            cx_match_str_eq_span(count, values, &predicate->value.str,
+                                 predicate->case_sensitive, matches);
+            break;
+        case CX_PREDICATE_LT:
+            cx_match_str_lt_span(count, values, &predicate->value.str,
+                                 predicate->case_sensitive, matches);
+            break;
+        case CX_PREDICATE_GT:
+            cx_match_str_gt_span(count, values, &predicate->value.str,
+                                 predicate->case_sensitive, matches);
+            break;
+        case CX_PREDICATE_CONTAINS:
+            cx_match_str_contains_span(count, values, &predicate->value.str,
+                                       predicate->case_sensitive,
+                                       predicate->location, matches);
+            break;
+        case CX_PREDICATE_LIKE:
+        case CX_PREDICATE_REGEX:
+            cx_match_str_pattern(predicate, count, values, matches);
+            break;
+        case CX_PREDICATE_IN:
+            cx_match_str_in_span(count, values, predicate->set, matches);
+            break;
+        default:
+            assert(false);
+    }
+}
+
+static const struct cx_dict_match *cx_dict_match(
+    const struct cx_predicate *predicate, const struct cx_row_group *row_group)
+{
+    struct cx_dict_match *match = cx_row_group_column_cache_get(
+        row_group, predicate->column, predicate->id);
+    if (match)
+        return match;
+    size_t dict_count;
+    const struct cx_string *dict =
+        cx_row_group_column_dict(row_group, predicate->column, &dict_count);
+    if (!dict)
+        return NULL;
+    size_t words = cx_mask_words(dict_count);
+    match = calloc(1, sizeof(*match) + (words ? words : 1) * sizeof(uint64_t));
+    if (!match)
+        return NULL;
+    match->dict_count = dict_count;
+    // match the predicate against each distinct string once, and then
+    // record the set of matching codes
+    cx_match_str(predicate, dict_count, dict, match->codes);
+    for (size_t i = 0; i < words; i++) {
+        uint64_t mask = match->codes[i];
+        if (!mask)
+            continue;
+        if (!match->count)
+            match->min = i * 64 + __builtin_ctzll(mask);
+        match->max = i * 64 + 63 - __builtin_clzll(mask);
+        match->count += __builtin_popcountll(mask);
+    }
+    if (!cx_row_group_column_cache_put(row_group, predicate->column,
+                                       predicate->id, match))
+        goto error;
+    return match;
+error:
+    free(match);
+    return NULL;
+}
+
+static bool cx_predicate_match_dict(const struct cx_predicate *predicate,
+                                    const struct cx_row_group *row_group)
+{
+    switch (predicate->type) {
+        case CX_PREDICATE_EQ:
+        case CX_PREDICATE_LT:
+        case CX_PREDICATE_GT:
+        case CX_PREDICATE_CONTAINS:
+        case CX_PREDICATE_LIKE:
+        case CX_PREDICATE_REGEX:
+        case CX_PREDICATE_IN:
+            return predicate->column_type == CX_COLUMN_STR &&
+                   cx_row_group_column_encoding(row_group, predicate->column) ==
+                       CX_ENCODING_DICT;
+        default:
+            return false;
+    }
+}
+
+static bool cx_index_match_rows_dict(const struct cx_predicate *predicate,
+                                     const struct cx_row_group *row_group,
+                                     struct cx_row_group_cursor *cursor,
+                                     uint64_t *matches, size_t *count)
+{
+    const struct cx_dict_match *match = cx_dict_match(predicate, row_group);
+    if (!match)
+        return false;
+    if (!match->count) {
+        *count = cx_row_group_cursor_batch_count(cursor);
+        cx_mask_clear(matches, *count);
+    } else if (match->count == match->dict_count) {
+        *count = cx_row_group_cursor_batch_count(cursor);
+        cx_mask_fill(matches, *count);
+    } else {
+        const int32_t *codes =
+            cx_row_group_cursor_batch_codes(cursor, predicate->column, count);
+        if (!codes)
+            return false;
+        // the dictionary is sorted, so the matching codes are often
+        // a single code or a contiguous range of codes
+        if (match->count == 1) {
+            cx_match_i32_eq_span(*count, codes, match->min, matches);
+        } else if ((size_t)(match->max - match->min) + 1 == match->count) {
+            uint64_t lt[CX_MASK_WORDS_MAX];
+            cx_match_i32_gt_span(*count, codes, match->min - 1, matches);
+            cx_match_i32_lt_span(*count, codes, match->max + 1, lt);
+            for (size_t i = 0; i < cx_mask_words(*count); i++)
+                matches[i] &= lt[i];
+        } else {
+            cx_mask_clear(matches, *count);
+            for (size_t i = 0; i < *count; i++)
+                if (match->codes[codes[i] / 64] &
+                    ((uint64_t)1 << (codes[i] % 64)))
+                    matches[i / 64] |= (uint64_t)1 << (i % 64);
+        }
+    }
+    return true;
+}
+
+static bool cx_index_match_batch(const struct cx_predicate *predicate,
+                                 enum cx_column_type type,
+                                 struct cx_row_group_cursor *cursor,
+                                 uint64_t *matches, size_t *count)
+{
+    // some encodings (e.g. RLE) can summarize a batch without decoding
+    // it, which often resolves the whole batch with one comparison
+    struct cx_index index;
+    if (!cx_row_group_cursor_batch_index(cursor, predicate->column, &index))
+        return false;
+    enum cx_index_match match = CX_INDEX_MATCH_UNKNOWN;
+    switch (predicate->type) {
+        case CX_PREDICATE_EQ:
+            match = cx_index_match_index_eq(predicate, type, &index);
+            break;
+        case CX_PREDICATE_LT:
+            match = cx_index_match_index_lt(predicate, type, &index);
+            break;
+        case CX_PREDICATE_GT:
+            match = cx_index_match_index_gt(predicate, type, &index);
+            break;
+        case CX_PREDICATE_IN:
+            match = cx_index_match_index_in(predicate, type, &index);
+            break;
+        case CX_PREDICATE_BETWEEN:
+            match = cx_index_match_index_between(predicate, type, &index);
+            break;
+        default:
+            break;
+    }
+    if (match == CX_INDEX_MATCH_UNKNOWN)
+        return false;
+    *count = index.count;
+    if (match == CX_INDEX_MATCH_ALL)
+        cx_mask_fill(matches, *count);
+    else
+        cx_mask_clear(matches, *count);
+    return true;
+}
+
 bool cx_index_match_rows(const struct cx_predicate *predicate,
                          const struct cx_row_group *row_group,
                          struct cx_row_group_cursor *cursor, uint64_t *matches,
@@ -747,81 +1987,328 @@ bool cx_index_match_rows(const struct cx_predicate *predicate,
 {
     enum cx_column_type column_type =
         cx_row_group_column_type(row_group, predicate->column);
-    uint64_t mask = 0;
+    if (cx_predicate_match_dict(predicate, row_group)) {
+        if (!cx_index_match_rows_dict(predicate, row_group, cursor, matches,
+                                      count))
+            goto error;
+        goto done;
+    }
     switch (predicate->type) {
         case CX_PREDICATE_TRUE:
             *count = cx_row_group_cursor_batch_count(cursor);
-            mask = cx_mask_cap(cx_full_mask, *count);
+            cx_mask_fill(matches, *count);
             break;
         case CX_PREDICATE_NULL: {
             const uint64_t *nulls = cx_row_group_cursor_batch_nulls(
                 cursor, predicate->column, count);
             if (!nulls)
                 goto error;
-            mask = *count ? *nulls : 0;
+            memcpy(matches, nulls, cx_mask_words(*count) * sizeof(uint64_t));
         } break;
         case CX_PREDICATE_EQ:
-            if (!cx_index_match_rows_eq(predicate, cursor, column_type, &mask,
-                                        count))
+            if (cx_index_match_batch(predicate, column_type, cursor, matches,
+                                     count))
+                break;
+            if (!cx_index_match_rows_eq(predicate, cursor, column_type,
+                                        matches, count))
                 goto error;
             break;
         case CX_PREDICATE_LT:
-            if (!cx_index_match_rows_lt(predicate, cursor, column_type, &mask,
-                                        count))
+            if (cx_index_match_batch(predicate, column_type, cursor, matches,
+                                     count))
+                break;
+            if (!cx_index_match_rows_lt(predicate, cursor, column_type,
+                                        matches, count))
                 goto error;
             break;
         case CX_PREDICATE_GT:
-            if (!cx_index_match_rows_gt(predicate, cursor, column_type, &mask,
-                                        count))
+            if (cx_index_match_batch(predicate, column_type, cursor, matches,
+                                     count))
+                break;
+            if (!cx_index_match_rows_gt(predicate, cursor, column_type,
+                                        matches, count))
                 goto error;
             break;
         case CX_PREDICATE_CONTAINS:
+        case CX_PREDICATE_LIKE:
+        case CX_PREDICATE_REGEX:
             assert(column_type == CX_COLUMN_STR);
             {
                 const struct cx_string *values = cx_row_group_cursor_batch_str(
                     cursor, predicate->column, count);
                 if (!values)
                     goto error;
-                mask = cx_match_str_contains(
-                    *count, values, &predicate->value.str,
-                    predicate->case_sensitive, predicate->location);
+                cx_match_str(predicate, *count, values, matches);
             }
             break;
+        case CX_PREDICATE_IN:
+            if (cx_index_match_batch(predicate, column_type, cursor, matches,
+                                     count))
+                break;
+            if (!cx_index_match_rows_in(predicate, cursor, column_type,
+                                        matches, count))
+                goto error;
+            break;
+        case CX_PREDICATE_BETWEEN:
+            if (cx_index_match_batch(predicate, column_type, cursor, matches,
+                                     count))
+                break;
+            if (!cx_index_match_rows_between(predicate, cursor, column_type,
+                                             matches, count))
+                goto error;
+            break;
+        case CX_PREDICATE_COLUMN:
+            if (!cx_index_match_rows_column(predicate, cursor, matches, count))
+                goto error;
+            break;
         case CX_PREDICATE_CUSTOM:
             if (!cx_index_match_rows_custom(predicate, cursor, column_type,
-                                            &mask, count))
+                                            matches, count))
                 goto error;
             break;
-        case CX_PREDICATE_AND:
-            mask = cx_full_mask;
+        case CX_PREDICATE_AND: {
+            uint64_t operand_mask[CX_MASK_WORDS_MAX];
+            *count = cx_row_group_cursor_batch_count(cursor);
+            cx_mask_fill(matches, *count);
             // short-circuit the remaining predicates once the mask is empty
-            for (size_t i = 0; mask && i < predicate->operand_count; i++) {
-                uint64_t operand_mask;
+            for (size_t i = 0; i < predicate->operand_count; i++) {
                 if (!cx_index_match_rows(predicate->operands[i], row_group,
-                                         cursor, &operand_mask, count))
+                                         cursor, operand_mask, count))
                     goto error;
-                mask &= operand_mask;
+                bool empty = true;
+                for (size_t j = 0; j < cx_mask_words(*count); j++)
+                    if ((matches[j] &= operand_mask[j]))
+                        empty = false;
+                if (empty)
+                    break;
             }
-            break;
-        case CX_PREDICATE_OR:
-            mask = 0;
+        } break;
+        case CX_PREDICATE_OR: {
+            uint64_t operand_mask[CX_MASK_WORDS_MAX];
+            *count = cx_row_group_cursor_batch_count(cursor);
+            cx_mask_clear(matches, *count);
             // short-circuit the remaining predicates once the mask is full
-            for (size_t i = 0;
-                 mask != cx_full_mask && i < predicate->operand_count; i++) {
-                uint64_t operand_mask;
+            for (size_t i = 0; i < predicate->operand_count; i++) {
                 if (!cx_index_match_rows(predicate->operands[i], row_group,
-                                         cursor, &operand_mask, count))
+                                         cursor, operand_mask, count))
                     goto error;
-                mask |= operand_mask;
+                bool full = true;
+                for (size_t j = 0; j < cx_mask_words(*count); j++)
+                    if ((matches[j] |= operand_mask[j]) != cx_full_mask)
+                        full = false;
+                if (full)
+                    break;
             }
-            break;
+        } break;
+    }
+done:
+    if (predicate->negate) {
+        for (size_t i = 0; i < cx_mask_words(*count); i++)
+            matches[i] = ~matches[i];
+        cx_mask_cap(matches, *count);
     }
-    *matches = predicate->negate ? cx_mask_cap(~mask, *count) : mask;
     return true;
 error:
     return false;
 }
 
+// the operands of AND and OR predicates are sampled every N batches
+#define CX_PROFILE_SAMPLE_INTERVAL 16
+
+struct cx_predicate_profile_sample {
+    uint64_t rows;
+    uint64_t matches;
+    uint64_t nanos;
+};
+
+struct cx_predicate_profile {
+    size_t count;
+    size_t batches;
+    size_t *order;
+    struct cx_predicate_profile_sample *samples;
+    struct cx_predicate_profile **operands;
+};
+
+struct cx_predicate_profile *cx_predicate_profile_new(
+    const struct cx_predicate *predicate)
+{
+    struct cx_predicate_profile *profile = calloc(1, sizeof(*profile));
+    if (!profile)
+        return NULL;
+    if (!cx_predicate_is_operator(predicate))
+        return profile;
+    profile->order = malloc(predicate->operand_count * sizeof(size_t));
+    if (!profile->order)
+        goto error;
+    profile->samples = calloc(predicate->operand_count,
+                              sizeof(struct cx_predicate_profile_sample));
+    if (!profile->samples)
+        goto error;
+    profile->operands = calloc(predicate->operand_count,
+                               sizeof(struct cx_predicate_profile *));
+    if (!profile->operands)
+        goto error;
+    for (; profile->count < predicate->operand_count; profile->count++) {
+        size_t i = profile->count;
+        profile->order[i] = i;
+        profile->operands[i] = cx_predicate_profile_new(predicate->operands[i]);
+        if (!profile->operands[i])
+            goto error;
+    }
+    return profile;
+error:
+    cx_predicate_profile_free(profile);
+    return NULL;
+}
+
+void cx_predicate_profile_free(struct cx_predicate_profile *profile)
+{
+    for (size_t i = 0; i < profile->count; i++)
+        cx_predicate_profile_free(profile->operands[i]);
+    free(profile->order);
+    free(profile->samples);
+    free(profile->operands);
+    free(profile);
+}
+
+const size_t *cx_predicate_profile_order(
+    const struct cx_predicate_profile *profile, size_t *count)
+{
+    *count = profile->count;
+    return profile->order;
+}
+
+static uint64_t cx_predicate_profile_nanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// the time an operand spends per row it decides, i.e. per row it rejects
+// in an AND or accepts in an OR
+static double cx_predicate_profile_rank(
+    const struct cx_predicate_profile_sample *sample, bool or)
+{
+    if (!sample->rows)
+        return 0;
+    double pass_rate = (double)sample->matches / sample->rows;
+    double decided = or ? pass_rate : 1 - pass_rate;
+    if (!decided)
+        return HUGE_VAL;
+    return (double)sample->nanos / sample->rows / decided;
+}
+
+static void cx_predicate_profile_reorder(struct cx_predicate_profile *profile,
+                                         bool or)
+{
+    // the operand count is small, and a stable sort keeps ties in place
+    for (size_t i = 1; i < profile->count; i++) {
+        size_t operand = profile->order[i];
+        double rank = cx_predicate_profile_rank(&profile->samples[operand], or);
+        size_t j = i;
+        for (; j && cx_predicate_profile_rank(
+                        &profile->samples[profile->order[j - 1]], or) > rank;
+             j--)
+            profile->order[j] = profile->order[j - 1];
+        profile->order[j] = operand;
+    }
+    // decay the samples so that the order follows changes in the data
+    for (size_t i = 0; i < profile->count; i++) {
+        profile->samples[i].rows /= 2;
+        profile->samples[i].matches /= 2;
+        profile->samples[i].nanos /= 2;
+    }
+}
+
+bool cx_index_match_rows_profiled(const struct cx_predicate *predicate,
+                                  struct cx_predicate_profile *profile,
+                                  const struct cx_row_group *row_group,
+                                  struct cx_row_group_cursor *cursor,
+                                  uint64_t *matches, size_t *count)
+{
+    if (!profile || !profile->count)
+        return cx_index_match_rows(predicate, row_group, cursor, matches,
+                                   count);
+    bool or = predicate->type == CX_PREDICATE_OR;
+    // sampled batches evaluate every operand, rather than short-circuiting
+    bool sample = !(profile->batches++ % CX_PROFILE_SAMPLE_INTERVAL);
+    uint64_t operand_mask[CX_MASK_WORDS_MAX];
+    *count = cx_row_group_cursor_batch_count(cursor);
+    if (or)
+        cx_mask_clear(matches, *count);
+    else
+        cx_mask_fill(matches, *count);
+    for (size_t i = 0; i < profile->count; i++) {
+        size_t operand = profile->order[i];
+        uint64_t start = sample ? cx_predicate_profile_nanos() : 0;
+        if (!cx_index_match_rows_profiled(
+                predicate->operands[operand], profile->operands[operand],
+                row_group, cursor, operand_mask, count))
+            return false;
+        bool done = true;
+        size_t operand_matches = 0;
+        for (size_t j = 0; j < cx_mask_words(*count); j++) {
+            if (or) {
+                if ((matches[j] |= operand_mask[j]) != cx_full_mask)
+                    done = false;
+            } else if ((matches[j] &= operand_mask[j])) {
+                done = false;
+            }
+            operand_matches += __builtin_popcountll(operand_mask[j]);
+        }
+        if (sample) {
+            struct cx_predicate_profile_sample *operand_sample =
+                &profile->samples[operand];
+            operand_sample->nanos += cx_predicate_profile_nanos() - start;
+            operand_sample->rows += *count;
+            operand_sample->matches += operand_matches;
+        } else if (done) {
+            break;
+        }
+    }
+    if (sample)
+        cx_predicate_profile_reorder(profile, or);
+    if (predicate->negate) {
+        for (size_t i = 0; i < cx_mask_words(*count); i++)
+            matches[i] = ~matches[i];
+        cx_mask_cap(matches, *count);
+    }
+    return true;
+}
+
+// matches contain the literal, and are no shorter than the pattern's
+// fixed characters
+static enum cx_index_match cx_index_match_index_pattern(
+    const struct cx_predicate *predicate, const struct cx_row_group *row_group)
+{
+    const struct cx_index *index =
+        cx_row_group_column_index(row_group, predicate->column);
+    if (index->max.len < predicate->length)
+        return CX_INDEX_MATCH_NONE;
+    if (predicate->location == CX_STR_LOCATION_START &&
+        predicate->case_sensitive &&
+        cx_index_match_str_starts_with(index, &predicate->value.str) ==
+            CX_INDEX_MATCH_NONE)
+        return CX_INDEX_MATCH_NONE;
+    if (!cx_index_match_trigrams(predicate, row_group))
+        return CX_INDEX_MATCH_NONE;
+    return CX_INDEX_MATCH_UNKNOWN;
+}
+
+static enum cx_index_match cx_index_match_constant_str(
+    const struct cx_predicate *predicate, const struct cx_index *index)
+{
+    // the value is followed by enough zeroed bytes for the SSE4.2 string
+    // functions
+    char buffer[CX_INDEX_PREFIX_SIZE + 17] = {0};
+    memcpy(buffer, index->lower, index->lower_len);
+    struct cx_string value = {buffer, index->lower_len};
+    uint64_t matches = 0;
+    cx_match_str(predicate, 1, &value, &matches);
+    return matches & 1 ? CX_INDEX_MATCH_ALL : CX_INDEX_MATCH_NONE;
+}
+
 enum cx_index_match cx_index_match_indexes(const struct cx_predicate *predicate,
                                            const struct cx_row_group *row_group)
 {
@@ -838,11 +2325,13 @@ enum cx_index_match cx_index_match_indexes(const struct cx_predicate *predicate,
             result = CX_INDEX_MATCH_ALL;
             break;
         case CX_PREDICATE_NULL:
-            index = cx_row_group_null_index(row_group, predicate->column);
-            result = cx_index_match_bit_eq(index, true);
+            result = cx_index_match_null(index);
             break;
         case CX_PREDICATE_EQ:
             result = cx_index_match_index_eq(predicate, type, index);
+            if (result == CX_INDEX_MATCH_UNKNOWN &&
+                !cx_index_match_bloom(predicate, type, row_group))
+                result = CX_INDEX_MATCH_NONE;
             break;
         case CX_PREDICATE_LT:
             result = cx_index_match_index_lt(predicate, type, index);
@@ -851,7 +2340,32 @@ enum cx_index_match cx_index_match_indexes(const struct cx_predicate *predicate,
             result = cx_index_match_index_gt(predicate, type, index);
             break;
         case CX_PREDICATE_CONTAINS:
-            result = cx_index_match_str_contains(index, &predicate->value.str);
+            if (predicate->location == CX_STR_LOCATION_START &&
+                predicate->case_sensitive)
+                result = cx_index_match_str_starts_with(index,
+                                                        &predicate->value.str);
+            else
+                result =
+                    cx_index_match_str_contains(index, &predicate->value.str);
+            if (result == CX_INDEX_MATCH_UNKNOWN &&
+                !cx_index_match_trigrams(predicate, row_group))
+                result = CX_INDEX_MATCH_NONE;
+            break;
+        case CX_PREDICATE_LIKE:
+        case CX_PREDICATE_REGEX:
+            result = cx_index_match_index_pattern(predicate, row_group);
+            break;
+        case CX_PREDICATE_IN:
+            result = cx_index_match_index_in(predicate, type, index);
+            if (result == CX_INDEX_MATCH_UNKNOWN &&
+                !cx_index_match_bloom_in(predicate, row_group))
+                result = CX_INDEX_MATCH_NONE;
+            break;
+        case CX_PREDICATE_BETWEEN:
+            result = cx_index_match_index_between(predicate, type, index);
+            break;
+        case CX_PREDICATE_COLUMN:
+            result = cx_index_match_index_column(predicate, row_group);
             break;
         case CX_PREDICATE_AND:
             result = CX_INDEX_MATCH_ALL;
@@ -884,9 +2398,466 @@ enum cx_index_match cx_index_match_indexes(const struct cx_predicate *predicate,
             }
             break;
     }
+    // the value of a constant STR chunk can be matched directly
+    if (result == CX_INDEX_MATCH_UNKNOWN && type == CX_COLUMN_STR &&
+        predicate->column_type == CX_COLUMN_STR &&
+        cx_predicate_is_comparison(predicate) &&
+        cx_index_constant(index, type))
+        result = cx_index_match_constant_str(predicate, index);
     return predicate->negate ? -result : result;
 }
 
+static bool cx_inverted_match(const struct cx_predicate *predicate,
+                              const struct cx_inverted_index *index,
+                              size_t count, uint8_t *matches)
+{
+    if (predicate->negate)
+        goto unknown;
+    switch (predicate->type) {
+        case CX_PREDICATE_EQ: {
+            uint64_t hash;
+            if (!cx_predicate_hash(predicate, predicate->column_type, &hash))
+                goto unknown;
+            memset(matches, 0, count);
+            if (!cx_inverted_index_lookup(index, predicate->column, hash,
+                                          matches))
+                goto unknown;
+        } break;
+        case CX_PREDICATE_IN: {
+            size_t set_count;
+            cx_match_set_values(predicate->set, &set_count);
+            memset(matches, 0, count);
+            for (size_t i = 0; i < set_count; i++) {
+                uint64_t hash;
+                if (!cx_predicate_set_hash(predicate, i, &hash) ||
+                    !cx_inverted_index_lookup(index, predicate->column, hash,
+                                              matches))
+                    goto unknown;
+            }
+        } break;
+        case CX_PREDICATE_AND:
+        case CX_PREDICATE_OR: {
+            bool and = predicate->type == CX_PREDICATE_AND;
+            uint8_t *operand = malloc(count);
+            if (!operand)
+                return false;
+            memset(matches, and, count);
+            for (size_t i = 0; i < predicate->operand_count; i++) {
+                if (!cx_inverted_match(predicate->operands[i], index, count,
+                                       operand)) {
+                    free(operand);
+                    return false;
+                }
+                for (size_t j = 0; j < count; j++)
+                    matches[j] = and ? matches[j] & operand[j]
+                                     : matches[j] | operand[j];
+            }
+            free(operand);
+        } break;
+        default:
+            goto unknown;
+    }
+    return true;
+unknown:
+    memset(matches, 1, count);
+    return true;
+}
+
+bool cx_index_match_inverted(const struct cx_predicate *predicate,
+                             const struct cx_inverted_index *index,
+                             size_t count, uint8_t *matches)
+{
+    if (!count)
+        return true;
+    uint8_t *candidates = malloc(count);
+    if (!candidates)
+        return false;
+    if (!cx_inverted_match(predicate, index, count, candidates)) {
+        free(candidates);
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+        matches[i] &= candidates[i];
+    free(candidates);
+    return true;
+}
+
+struct cx_range_search {
+    enum cx_column_type type;
+    const cx_value_t *value;
+    bool descending;
+    bool inclusive;
+};
+
+// compare a value of a sorted column with the predicate's value, returning
+// true while the column hasn't yet reached it (or passed it, if inclusive)
+static bool cx_range_before(const cx_index_value_t *value, const void *ptr)
+{
+    const struct cx_range_search *search = ptr;
+    int cmp = 0;
+    switch (search->type) {
+        case CX_COLUMN_I32:
+            cmp = (value->i32 > search->value->i32) -
+                  (value->i32 < search->value->i32);
+            break;
+        case CX_COLUMN_I64:
+            cmp = (value->i64 > search->value->i64) -
+                  (value->i64 < search->value->i64);
+            break;
+        case CX_COLUMN_FLT:
+            cmp = (value->flt > search->value->flt) -
+                  (value->flt < search->value->flt);
+            break;
+        case CX_COLUMN_DBL:
+            cmp = (value->dbl > search->value->dbl) -
+                  (value->dbl < search->value->dbl);
+            break;
+        default:
+            assert(false);
+    }
+    if (search->descending)
+        cmp = -cmp;
+    return cmp < 0 || (search->inclusive && !cmp);
+}
+
+static bool cx_predicate_sorted(const struct cx_predicate *predicate,
+                                const struct cx_row_group *row_group)
+{
+    const struct cx_index *index =
+        cx_row_group_column_index(row_group, predicate->column);
+    if (!(index->flags & (CX_INDEX_ASCENDING | CX_INDEX_DESCENDING)))
+        return false;
+    switch (cx_row_group_column_type(row_group, predicate->column)) {
+        case CX_COLUMN_I32:
+        case CX_COLUMN_I64:
+            return true;
+        case CX_COLUMN_FLT:
+            return !isnan(predicate->value.flt) &&
+                   !isnan(predicate->high.flt);
+        case CX_COLUMN_DBL:
+            return !isnan(predicate->value.dbl) &&
+                   !isnan(predicate->high.dbl);
+        default:
+            return false;
+    }
+}
+
+static bool cx_predicate_match_range_sorted(
+    const struct cx_predicate *predicate, const struct cx_row_group *row_group,
+    size_t *start, size_t *end)
+{
+    const struct cx_index *index =
+        cx_row_group_column_index(row_group, predicate->column);
+    struct cx_range_search search = {
+        cx_row_group_column_type(row_group, predicate->column),
+        &predicate->value, !(index->flags & CX_INDEX_ASCENDING), false};
+    // rows before the first partition are less than the value (or greater,
+    // if descending), and rows after the second are greater
+    size_t first, second;
+    if (!cx_row_group_column_partition(row_group, predicate->column,
+                                       cx_range_before, &search, &first))
+        return false;
+    search.inclusive = true;
+    if (!cx_row_group_column_partition(row_group, predicate->column,
+                                       cx_range_before, &search, &second))
+        return false;
+    size_t row_count = cx_row_group_row_count(row_group);
+    switch (predicate->type) {
+        case CX_PREDICATE_EQ:
+            *start = first;
+            *end = second;
+            break;
+        case CX_PREDICATE_BETWEEN: {
+            // partition the rows around the upper bound too
+            size_t high_first, high_second;
+            search.value = &predicate->high;
+            search.inclusive = false;
+            if (!cx_row_group_column_partition(row_group, predicate->column,
+                                               cx_range_before, &search,
+                                               &high_first))
+                return false;
+            search.inclusive = true;
+            if (!cx_row_group_column_partition(row_group, predicate->column,
+                                               cx_range_before, &search,
+                                               &high_second))
+                return false;
+            *start = search.descending ? high_second : second;
+            *end = search.descending ? first : high_first;
+        } break;
+        case CX_PREDICATE_LT:
+            *start = search.descending ? second : 0;
+            *end = search.descending ? row_count : first;
+            break;
+        default:
+            assert(predicate->type == CX_PREDICATE_GT);
+            *start = search.descending ? 0 : second;
+            *end = search.descending ? first : row_count;
+    }
+    return true;
+}
+
+bool cx_predicate_match_range(const struct cx_predicate *predicate,
+                              const struct cx_row_group *row_group,
+                              size_t *start, size_t *end, bool *exact)
+{
+    *start = 0;
+    *end = cx_row_group_row_count(row_group);
+    *exact = false;
+    if (predicate->negate)
+        return true;
+    switch (predicate->type) {
+        case CX_PREDICATE_TRUE:
+            *exact = true;
+            break;
+        case CX_PREDICATE_EQ:
+        case CX_PREDICATE_LT:
+        case CX_PREDICATE_GT:
+        case CX_PREDICATE_BETWEEN:
+            if (!cx_predicate_sorted(predicate, row_group))
+                break;
+            if (!cx_predicate_match_range_sorted(predicate, row_group, start,
+                                                 end))
+                return false;
+            *exact = true;
+            break;
+        case CX_PREDICATE_AND:
+            *exact = true;
+            for (size_t i = 0; i < predicate->operand_count; i++) {
+                size_t operand_start, operand_end;
+                bool operand_exact;
+                if (!cx_predicate_match_range(predicate->operands[i],
+                                              row_group, &operand_start,
+                                              &operand_end, &operand_exact))
+                    return false;
+                if (operand_start > *start)
+                    *start = operand_start;
+                if (operand_end < *end)
+                    *end = operand_end;
+                *exact = *exact && operand_exact;
+            }
+            break;
+        case CX_PREDICATE_OR:
+            // the union of the ranges may have gaps, so it's never exact
+            *end = 0;
+            *start = cx_row_group_row_count(row_group);
+            for (size_t i = 0; i < predicate->operand_count; i++) {
+                size_t operand_start, operand_end;
+                bool operand_exact;
+                if (!cx_predicate_match_range(predicate->operands[i],
+                                              row_group, &operand_start,
+                                              &operand_end, &operand_exact))
+                    return false;
+                if (operand_start >= operand_end)
+                    continue;
+                if (operand_start < *start)
+                    *start = operand_start;
+                if (operand_end > *end)
+                    *end = operand_end;
+            }
+            break;
+        default:
+            break;
+    }
+    if (*end < *start)
+        *end = *start;
+    return true;
+}
+
+// a row group can match any[i] of its rows, or must match all[i] of them.
+// Each loop is branch free so that it can be vectorized
+#define CX_STATS_MATCH(name, field, value_type)                                \
+    static void cx_stats_match_##name(                                         \
+        const struct cx_predicate *predicate,                                  \
+        const struct cx_index_stats *stats, value_type value, size_t count,    \
+        uint8_t *any, uint8_t *all)                                            \
+    {                                                                          \
+        const cx_index_value_t *min = stats->min;                              \
+        const cx_index_value_t *max = stats->max;                              \
+        switch (predicate->type) {                                             \
+            case CX_PREDICATE_EQ:                                              \
+                for (size_t i = 0; i < count; i++) {                           \
+                    any[i] = (min[i].field <= value) & (max[i].field >= value);\
+                    all[i] = (min[i].field == value) & (max[i].field == value);\
+                }                                                              \
+                break;                                                         \
+            case CX_PREDICATE_LT:                                              \
+                for (size_t i = 0; i < count; i++) {                           \
+                    any[i] = min[i].field < value;                             \
+                    all[i] = max[i].field < value;                             \
+                }                                                              \
+                break;                                                         \
+            case CX_PREDICATE_BETWEEN: {                                       \
+                value_type high = predicate->high.field;                       \
+                for (size_t i = 0; i < count; i++) {                           \
+                    any[i] = (max[i].field > value) & (min[i].field < high) &  \
+                             (value < high);                                   \
+                    all[i] = (min[i].field > value) & (max[i].field < high);   \
+                }                                                              \
+            } break;                                                           \
+            default:                                                           \
+                assert(predicate->type == CX_PREDICATE_GT);                    \
+                for (size_t i = 0; i < count; i++) {                           \
+                    any[i] = max[i].field > value;                             \
+                    all[i] = min[i].field > value;                             \
+                }                                                              \
+        }                                                                      \
+    }
+
+CX_STATS_MATCH(i32, i32, int32_t)
+CX_STATS_MATCH(i64, i64, int64_t)
+CX_STATS_MATCH(flt, flt, float)
+CX_STATS_MATCH(dbl, dbl, double)
+
+// row groups can match a set if their bounds overlap the set's range
+#define CX_STATS_MATCH_SET(name, type)                                     \
+    static void cx_stats_match_set_##name(                                 \
+        const struct cx_predicate *predicate,                              \
+        const struct cx_index_stats *stats, size_t count, uint8_t *any)    \
+    {                                                                      \
+        size_t set_count;                                                  \
+        const type *values =                                               \
+            cx_match_set_values(predicate->set, &set_count);               \
+        type low = values[0], high = values[set_count - 1];                \
+        for (size_t i = 0; i < count; i++)                                 \
+            any[i] = (stats->min[i].name <= high) &                        \
+                     (stats->max[i].name >= low);                          \
+    }
+
+CX_STATS_MATCH_SET(i32, int32_t)
+CX_STATS_MATCH_SET(i64, int64_t)
+
+static bool cx_stats_match(const struct cx_predicate *predicate,
+                           const struct cx_index_stats *columns, size_t count,
+                           uint8_t *any, uint8_t *all)
+{
+    // by default, row groups may match some of their rows
+    memset(any, 1, count);
+    memset(all, 0, count);
+    const struct cx_index_stats *stats = &columns[predicate->column];
+    switch (predicate->type) {
+        case CX_PREDICATE_TRUE:
+            memset(all, 1, count);
+            break;
+        case CX_PREDICATE_EQ:
+        case CX_PREDICATE_LT:
+        case CX_PREDICATE_GT:
+        case CX_PREDICATE_BETWEEN:
+            switch (stats->type) {
+                case CX_COLUMN_BIT:
+                    if (predicate->type != CX_PREDICATE_EQ)
+                        break;
+                    for (size_t i = 0; i < count; i++) {
+                        bool min = stats->min[i].bit, max = stats->max[i].bit;
+                        any[i] = predicate->value.bit ? max : !min;
+                        all[i] = predicate->value.bit ? min : !max;
+                    }
+                    break;
+                case CX_COLUMN_I32:
+                    cx_stats_match_i32(predicate, stats, predicate->value.i32,
+                                       count, any, all);
+                    break;
+                case CX_COLUMN_I64:
+                    cx_stats_match_i64(predicate, stats, predicate->value.i64,
+                                       count, any, all);
+                    break;
+                case CX_COLUMN_FLT:
+                    cx_stats_match_flt(predicate, stats, predicate->value.flt,
+                                       count, any, all);
+                    break;
+                case CX_COLUMN_DBL:
+                    cx_stats_match_dbl(predicate, stats, predicate->value.dbl,
+                                       count, any, all);
+                    break;
+                case CX_COLUMN_STR:
+                    break;
+            }
+            break;
+        case CX_PREDICATE_COLUMN: {
+            const struct cx_index_stats *other =
+                &columns[predicate->other_column];
+            if (stats->type != predicate->column_type ||
+                other->type != predicate->column_type)
+                break;
+            for (size_t i = 0; i < count; i++) {
+                enum cx_index_match match = cx_index_match_column_bounds(
+                    predicate, &stats->min[i], &stats->max[i], &other->min[i],
+                    &other->max[i]);
+                any[i] = match != CX_INDEX_MATCH_NONE;
+                all[i] = match == CX_INDEX_MATCH_ALL;
+            }
+        } break;
+        case CX_PREDICATE_IN:
+            switch (stats->type) {
+                case CX_COLUMN_I32:
+                    cx_stats_match_set_i32(predicate, stats, count, any);
+                    break;
+                case CX_COLUMN_I64:
+                    cx_stats_match_set_i64(predicate, stats, count, any);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case CX_PREDICATE_AND:
+        case CX_PREDICATE_OR: {
+            bool and = predicate->type == CX_PREDICATE_AND;
+            uint8_t *operand = malloc(count * 2);
+            if (!operand)
+                return false;
+            memset(any, and, count);
+            memset(all, and, count);
+            for (size_t i = 0; i < predicate->operand_count; i++) {
+                if (!cx_stats_match(predicate->operands[i], columns, count,
+                                    operand, operand + count)) {
+                    free(operand);
+                    return false;
+                }
+                if (and) {
+                    for (size_t j = 0; j < count; j++) {
+                        any[j] &= operand[j];
+                        all[j] &= operand[count + j];
+                    }
+                } else {
+                    for (size_t j = 0; j < count; j++) {
+                        any[j] |= operand[j];
+                        all[j] |= operand[count + j];
+                    }
+                }
+            }
+            free(operand);
+        } break;
+        default:
+            break;
+    }
+    if (predicate->negate) {
+        for (size_t i = 0; i < count; i++) {
+            uint8_t negated = !all[i];
+            all[i] = !any[i];
+            any[i] = negated;
+        }
+    }
+    return true;
+}
+
+bool cx_index_match_stats(const struct cx_predicate *predicate,
+                          const struct cx_index_stats *columns, size_t count,
+                          uint8_t *matches)
+{
+    if (!count)
+        return true;
+    uint8_t *any = malloc(count * 2);
+    if (!any)
+        return false;
+    if (!cx_stats_match(predicate, columns, count, any, any + count)) {
+        free(any);
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+        matches[i] &= any[i];
+    free(any);
+    return true;
+}
+
 static int cx_column_cost(enum cx_column_type type)
 {
     int cost = 0;
@@ -909,13 +2880,26 @@ static int cx_column_cost(enum cx_column_type type)
     return cost;
 }
 
+static int cx_predicate_column_cost(const struct cx_predicate *predicate,
+                                    const struct cx_row_group *row_group)
+{
+    enum cx_column_type type =
+        cx_row_group_column_type(row_group, predicate->column);
+    // dictionary encoded strings are matched using their int32 codes
+    if (type == CX_COLUMN_STR &&
+        cx_row_group_column_encoding(row_group, predicate->column) ==
+            CX_ENCODING_DICT)
+        type = CX_COLUMN_I32;
+    return cx_column_cost(type);
+}
+
 static int cx_predicate_cost(const struct cx_predicate *predicate,
                              const struct cx_row_group *row_group)
 {
     // in future, this function should look at more than just the
-    // column type to determine the cost of evaluating the predicate.
-    // for example, it could check the size of each column, whether
-    // it's compressed and/or encoded, and the compression ratio
+    // column type and encoding to determine the cost of evaluating the
+    // predicate. for example, it could check the size of each column,
+    // whether it's compressed, and the compression ratio
     int cost = 0;
     switch (predicate->type) {
         case CX_PREDICATE_TRUE:
@@ -927,8 +2911,15 @@ static int cx_predicate_cost(const struct cx_predicate *predicate,
         case CX_PREDICATE_LT:
         case CX_PREDICATE_GT:
         case CX_PREDICATE_CONTAINS:
-            cost = cx_column_cost(
-                cx_row_group_column_type(row_group, predicate->column));
+        case CX_PREDICATE_LIKE:
+        case CX_PREDICATE_REGEX:
+        case CX_PREDICATE_IN:
+        case CX_PREDICATE_BETWEEN:
+            cost = cx_predicate_column_cost(predicate, row_group);
+            break;
+        case CX_PREDICATE_COLUMN:
+            // both columns are read
+            cost = 2 * cx_predicate_column_cost(predicate, row_group);
             break;
         case CX_PREDICATE_AND:
         case CX_PREDICATE_OR:
@@ -946,6 +2937,138 @@ static int cx_predicate_cost(const struct cx_predicate *predicate,
     return cost;
 }
 
+// estimate the fraction of values in the column chunk less than, and no
+// greater than, a value of a numeric predicate from the chunk's histogram
+static bool cx_predicate_fractions(const struct cx_predicate *predicate,
+                                   const cx_value_t *predicate_value,
+                                   const struct cx_row_group *row_group,
+                                   double *below, double *at_most)
+{
+    double value;
+    switch (predicate->column_type) {
+        case CX_COLUMN_I32:
+            value = predicate_value->i32;
+            break;
+        case CX_COLUMN_I64:
+            value = predicate_value->i64;
+            break;
+        case CX_COLUMN_FLT:
+            value = predicate_value->flt;
+            break;
+        case CX_COLUMN_DBL:
+            value = predicate_value->dbl;
+            break;
+        default:
+            return false;
+    }
+    const struct cx_index *index =
+        cx_row_group_column_index(row_group, predicate->column);
+    *below = cx_index_histogram_fraction(index, predicate->column_type, value,
+                                         false);
+    *at_most = cx_index_histogram_fraction(index, predicate->column_type,
+                                           value, true);
+    return *below >= 0 && *at_most >= 0;
+}
+
+// estimate the fraction of rows that match the predicate, using the null
+// and distinct counts and histogram of the column chunk where possible
+static double cx_predicate_selectivity(const struct cx_predicate *predicate,
+                                       const struct cx_row_group *row_group)
+{
+    double below, at_most;
+    double selectivity = 0.5;
+    switch (predicate->type) {
+        case CX_PREDICATE_TRUE:
+            selectivity = 1;
+            break;
+        case CX_PREDICATE_NULL: {
+            const struct cx_index *index =
+                cx_row_group_column_index(row_group, predicate->column);
+            if (index->count)
+                selectivity = (double)index->null_count / index->count;
+        } break;
+        case CX_PREDICATE_EQ: {
+            const struct cx_index *index =
+                cx_row_group_column_index(row_group, predicate->column);
+            if (index->distinct_count)
+                selectivity = 1.0 / index->distinct_count;
+            // values repeated across buckets are more frequent
+            if (cx_predicate_fractions(predicate, &predicate->value,
+                                       row_group, &below, &at_most) &&
+                at_most - below > selectivity)
+                selectivity = at_most - below;
+        } break;
+        case CX_PREDICATE_IN: {
+            const struct cx_index *index =
+                cx_row_group_column_index(row_group, predicate->column);
+            size_t count;
+            cx_match_set_values(predicate->set, &count);
+            if (index->distinct_count && count < index->distinct_count)
+                selectivity = (double)count / index->distinct_count;
+            else if (index->distinct_count)
+                selectivity = 1;
+        } break;
+        case CX_PREDICATE_LT:
+            if (cx_predicate_fractions(predicate, &predicate->value,
+                                       row_group, &below, &at_most))
+                selectivity = below;
+            break;
+        case CX_PREDICATE_GT:
+            if (cx_predicate_fractions(predicate, &predicate->value,
+                                       row_group, &below, &at_most))
+                selectivity = 1 - at_most;
+            break;
+        case CX_PREDICATE_BETWEEN: {
+            double high_below, high_at_most;
+            if (cx_predicate_fractions(predicate, &predicate->value,
+                                       row_group, &below, &at_most) &&
+                cx_predicate_fractions(predicate, &predicate->high,
+                                       row_group, &high_below,
+                                       &high_at_most))
+                selectivity =
+                    high_below > at_most ? high_below - at_most : 0;
+            else
+                selectivity = 0.25;  // as estimated for a GT and LT pair
+        } break;
+        case CX_PREDICATE_AND:
+            selectivity = 1;
+            for (size_t i = 0; i < predicate->operand_count; i++)
+                selectivity *= cx_predicate_selectivity(predicate->operands[i],
+                                                        row_group);
+            break;
+        case CX_PREDICATE_OR:
+            selectivity = 1;
+            for (size_t i = 0; i < predicate->operand_count; i++)
+                selectivity *= 1 - cx_predicate_selectivity(
+                                       predicate->operands[i], row_group);
+            selectivity = 1 - selectivity;
+            break;
+        default:
+            break;
+    }
+    return predicate->negate ? 1 - selectivity : selectivity;
+}
+
+struct cx_predicate_order {
+    const struct cx_row_group *row_group;
+    bool disjunction;
+};
+
+// operands are ordered by their cost for each row they resolve. The
+// operands of an AND resolve the rows they don't match, and the operands of
+// an OR resolve the rows they do match
+static double cx_predicate_rank(const struct cx_predicate *predicate,
+                                const struct cx_predicate_order *order)
+{
+    int cost = cx_predicate_cost(predicate, order->row_group);
+    if (!cost)
+        return 0;
+    double selectivity =
+        cx_predicate_selectivity(predicate, order->row_group);
+    double resolved = order->disjunction ? selectivity : 1 - selectivity;
+    return resolved > 0 ? cost / resolved : HUGE_VAL;
+}
+
 // qsort_r() differs on OS X and Linux..
 #ifdef __APPLE__
 static int cx_predicate_cmp(void *ctx, const void *a, const void *b)
@@ -953,21 +3076,74 @@ static int cx_predicate_cmp(void *ctx, const void *a, const void *b)
 static int cx_predicate_cmp(const void *a, const void *b, void *ctx)
 #endif
 {
-    const struct cx_row_group *row_group = (const struct cx_row_group *)ctx;
-    // sort by cost asc
-    return cx_predicate_cost(*(struct cx_predicate **)a, row_group) -
-           cx_predicate_cost(*(struct cx_predicate **)b, row_group);
+    const struct cx_predicate_order *order = ctx;
+    // sort by rank asc
+    double a_rank = cx_predicate_rank(*(struct cx_predicate **)a, order);
+    double b_rank = cx_predicate_rank(*(struct cx_predicate **)b, order);
+    return (a_rank > b_rank) - (a_rank < b_rank);
+}
+
+static bool cx_predicate_is_bound(const struct cx_predicate *predicate,
+                                  enum cx_predicate_type type)
+{
+    if (predicate->type != type || predicate->negate)
+        return false;
+    switch (predicate->column_type) {
+        case CX_COLUMN_I32:
+        case CX_COLUMN_I64:
+        case CX_COLUMN_FLT:
+        case CX_COLUMN_DBL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// replace GT and LT operands of an AND on the same column with a BETWEEN
+// predicate, so that the column is only scanned once
+static void cx_predicate_merge_ranges(struct cx_predicate *predicate)
+{
+    for (size_t i = 0; i < predicate->operand_count; i++) {
+        struct cx_predicate *gt = predicate->operands[i];
+        if (!cx_predicate_is_bound(gt, CX_PREDICATE_GT))
+            continue;
+        for (size_t j = 0; j < predicate->operand_count; j++) {
+            struct cx_predicate *lt = predicate->operands[j];
+            if (!cx_predicate_is_bound(lt, CX_PREDICATE_LT) ||
+                lt->column != gt->column ||
+                lt->column_type != gt->column_type)
+                continue;
+            struct cx_predicate *between = cx_predicate_new_between(
+                gt->column, gt->column_type, gt->value, lt->value);
+            if (!between)
+                return;
+            cx_predicate_free(gt);
+            cx_predicate_free(lt);
+            predicate->operands[i] = between;
+            memmove(&predicate->operands[j], &predicate->operands[j + 1],
+                    (predicate->operand_count - j - 1) *
+                        sizeof(*predicate->operands));
+            predicate->operand_count--;
+            if (j < i)
+                i--;
+            break;
+        }
+    }
 }
 
 void cx_predicate_optimize(struct cx_predicate *predicate,
                            const struct cx_row_group *row_group)
 {
+    if (predicate->type == CX_PREDICATE_AND)
+        cx_predicate_merge_ranges(predicate);
+    struct cx_predicate_order order = {
+        row_group, predicate->type == CX_PREDICATE_OR};
 #ifdef __APPLE__
     qsort_r(predicate->operands, predicate->operand_count,
-            sizeof(struct cx_predicate *), (void *)row_group, cx_predicate_cmp);
+            sizeof(struct cx_predicate *), &order, cx_predicate_cmp);
 #else
     qsort_r(predicate->operands, predicate->operand_count,
-            sizeof(struct cx_predicate *), cx_predicate_cmp, (void *)row_group);
+            sizeof(struct cx_predicate *), cx_predicate_cmp, &order);
 #endif
     if (cx_predicate_is_operator(predicate)) {
         for (size_t i = 0; i < predicate->operand_count; i++)
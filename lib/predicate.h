@@ -37,6 +37,48 @@ CX_EXPORT struct cx_predicate *cx_predicate_new_dbl_eq(size_t, double);
 CX_EXPORT struct cx_predicate *cx_predicate_new_dbl_lt(size_t, double);
 CX_EXPORT struct cx_predicate *cx_predicate_new_dbl_gt(size_t, double);
 
+// match values strictly between the bounds, i.e. an AND of a GT predicate
+// on the lower bound and an LT predicate on the upper bound
+CX_EXPORT struct cx_predicate *cx_predicate_new_i32_between(size_t, int32_t,
+                                                            int32_t);
+CX_EXPORT struct cx_predicate *cx_predicate_new_i64_between(size_t, int64_t,
+                                                            int64_t);
+CX_EXPORT struct cx_predicate *cx_predicate_new_flt_between(size_t, float,
+                                                            float);
+CX_EXPORT struct cx_predicate *cx_predicate_new_dbl_between(size_t, double,
+                                                            double);
+
+// compare a column with another column of the same type plus an offset,
+// row by row, e.g. cx_predicate_new_i64_lt_column(a, b, x) matches rows
+// where a < b + x. Integer sums wrap on overflow
+CX_EXPORT struct cx_predicate *cx_predicate_new_i32_eq_column(size_t, size_t,
+                                                              int32_t);
+CX_EXPORT struct cx_predicate *cx_predicate_new_i32_lt_column(size_t, size_t,
+                                                              int32_t);
+CX_EXPORT struct cx_predicate *cx_predicate_new_i32_gt_column(size_t, size_t,
+                                                              int32_t);
+
+CX_EXPORT struct cx_predicate *cx_predicate_new_i64_eq_column(size_t, size_t,
+                                                              int64_t);
+CX_EXPORT struct cx_predicate *cx_predicate_new_i64_lt_column(size_t, size_t,
+                                                              int64_t);
+CX_EXPORT struct cx_predicate *cx_predicate_new_i64_gt_column(size_t, size_t,
+                                                              int64_t);
+
+CX_EXPORT struct cx_predicate *cx_predicate_new_flt_eq_column(size_t, size_t,
+                                                              float);
+CX_EXPORT struct cx_predicate *cx_predicate_new_flt_lt_column(size_t, size_t,
+                                                              float);
+CX_EXPORT struct cx_predicate *cx_predicate_new_flt_gt_column(size_t, size_t,
+                                                              float);
+
+CX_EXPORT struct cx_predicate *cx_predicate_new_dbl_eq_column(size_t, size_t,
+                                                              double);
+CX_EXPORT struct cx_predicate *cx_predicate_new_dbl_lt_column(size_t, size_t,
+                                                              double);
+CX_EXPORT struct cx_predicate *cx_predicate_new_dbl_gt_column(size_t, size_t,
+                                                              double);
+
 CX_EXPORT struct cx_predicate *cx_predicate_new_str_eq(size_t, const char *,
                                                        bool);
 CX_EXPORT struct cx_predicate *cx_predicate_new_str_lt(size_t, const char *,
@@ -46,6 +88,22 @@ CX_EXPORT struct cx_predicate *cx_predicate_new_str_gt(size_t, const char *,
 CX_EXPORT struct cx_predicate *cx_predicate_new_str_contains(
     size_t, const char *, bool, enum cx_str_location);
 
+// match SQL LIKE patterns (% matches any run of characters, _ matches any
+// character, and a backslash escapes the next character) or POSIX extended
+// regular expressions. Rows are prefiltered with a literal from the pattern
+CX_EXPORT struct cx_predicate *cx_predicate_new_str_like(size_t, const char *,
+                                                         bool);
+CX_EXPORT struct cx_predicate *cx_predicate_new_str_regex(size_t, const char *,
+                                                          bool);
+
+// match any of a set of values (duplicates are ignored)
+CX_EXPORT struct cx_predicate *cx_predicate_new_i32_in(size_t, size_t count,
+                                                       const int32_t *);
+CX_EXPORT struct cx_predicate *cx_predicate_new_i64_in(size_t, size_t count,
+                                                       const int64_t *);
+CX_EXPORT struct cx_predicate *cx_predicate_new_str_in(size_t, size_t count,
+                                                       const char **, bool);
+
 CX_EXPORT struct cx_predicate *cx_predicate_new_and(size_t, ...);
 CX_EXPORT struct cx_predicate *cx_predicate_new_vand(size_t, va_list);
 CX_EXPORT struct cx_predicate *cx_predicate_new_aand(size_t,
@@ -66,15 +124,63 @@ const struct cx_predicate **cx_predicate_operands(const struct cx_predicate *,
 enum cx_index_match cx_index_match_indexes(const struct cx_predicate *,
                                            const struct cx_row_group *);
 
+// match the predicate against the bounds of many row groups in one pass,
+// clearing matches[i] if row group i can't match. The stats have an entry
+// for each column
+bool cx_index_match_stats(const struct cx_predicate *,
+                          const struct cx_index_stats *, size_t count,
+                          uint8_t *matches);
+
+// find the range of rows [start, end) that may match the predicate, by
+// binary searching sorted columns. Rows outside the range don't match, and if
+// exact is set, all rows inside the range match
+bool cx_predicate_match_range(const struct cx_predicate *,
+                              const struct cx_row_group *, size_t *start,
+                              size_t *end, bool *exact);
+
+struct cx_inverted_index;
+
+// clear matches[i] if the inverted index shows that row group i can't match
+bool cx_index_match_inverted(const struct cx_predicate *,
+                             const struct cx_inverted_index *, size_t count,
+                             uint8_t *matches);
+
+// matches must have room for a word for every 64 rows in the cursor's batch
 bool cx_index_match_rows(const struct cx_predicate *predicate,
                          const struct cx_row_group *row_group,
                          struct cx_row_group_cursor *cursor, uint64_t *matches,
                          size_t *count);
 
+// a profile samples the pass rate and evaluation time of the operands of
+// AND and OR predicates as rows are matched, and periodically reorders
+// them so that matching short-circuits as early as the data allows. The
+// predicate isn't modified, so threads sharing a predicate can each use
+// their own profile. Profiles aren't thread-safe
+struct cx_predicate_profile;
+
+struct cx_predicate_profile *cx_predicate_profile_new(
+    const struct cx_predicate *);
+
+void cx_predicate_profile_free(struct cx_predicate_profile *);
+
+// the current order of the predicate's operands
+const size_t *cx_predicate_profile_order(const struct cx_predicate_profile *,
+                                         size_t *count);
+
+// like cx_index_match_rows(), but evaluates operands in the profile's
+// order. The profile may be NULL
+bool cx_index_match_rows_profiled(const struct cx_predicate *,
+                                  struct cx_predicate_profile *,
+                                  const struct cx_row_group *,
+                                  struct cx_row_group_cursor *,
+                                  uint64_t *matches, size_t *count);
+
 typedef enum cx_index_match (*cx_index_match_index_t)(enum cx_column_type,
                                                       const struct cx_index *,
                                                       void *data);
 
+// custom predicates receive up to a batch of values at a time, and set a
+// bit in matches (a word for every 64 values) for each matching value
 typedef bool (*cx_index_match_rows_t)(enum cx_column_type, size_t count,
                                       const void *values, uint64_t *matches,
                                       void *data);
@@ -10,6 +10,7 @@
 
 #include "compress.h"
 #include "file.h"
+#include "inverted.h"
 #include "reader.h"
 #include "row.h"
 
@@ -18,8 +19,14 @@ struct cx_reader {
     struct cx_predicate *predicate;
     struct cx_row_group *row_group;
     struct cx_row_cursor *row_cursor;
+    struct cx_column_pool *pool;
+    // the operand order of the predicate, adapted as rows are matched
+    struct cx_predicate_profile *profile;
+    // row groups that may match, according to the row group stats
+    uint8_t *candidates;
     size_t row_group_count;
     size_t position;
+    size_t batch_size;
     bool match_all_rows;
     bool error;
 };
@@ -38,14 +45,18 @@ struct cx_row_group_reader {
         const struct cx_row_group_header *headers;
         size_t count;
     } row_groups;
+    const struct cx_index *indexes;
+    const cx_index_value_t *stats;
     int32_t metadata;
 };
 
 struct cx_reader_query_context {
     struct cx_row_group_reader *reader;
     struct cx_predicate *predicate;
+    const uint8_t *candidates;
     size_t position;
     size_t row_group_count;
+    size_t batch_size;
     void (*iter)(struct cx_row_cursor *, pthread_mutex_t *, void *);
     void *data;
     bool error;
@@ -64,25 +75,80 @@ static struct cx_reader *cx_reader_new_impl(const char *path,
     reader->reader = cx_row_group_reader_new(path);
     if (!reader->reader)
         goto error;
+    reader->pool = cx_column_pool_new();
+    if (!reader->pool)
+        goto error;
     reader->predicate = predicate;
     reader->match_all_rows = match_all_rows;
+    reader->batch_size = CX_BATCH_SIZE;
     reader->row_group_count =
         cx_row_group_reader_row_group_count(reader->reader);
-    // validate and optimize the predicate
+    if (reader->row_group_count && !match_all_rows) {
+        // validate the predicate, and skip the file if its index shows
+        // that no rows can match
+        struct cx_row_group *summary =
+            cx_row_group_reader_summary(reader->reader);
+        if (!summary)
+            goto error;
+        bool valid = cx_predicate_valid(predicate, summary);
+        if (valid && cx_index_match_indexes(predicate, summary) ==
+                         CX_INDEX_MATCH_NONE)
+            reader->row_group_count = 0;
+        cx_row_group_free(summary);
+        if (!valid)
+            goto error;
+    }
+    // prune row groups with the row group stats, in one pass
+    if (reader->row_group_count && !match_all_rows) {
+        struct cx_index_stats *stats =
+            cx_row_group_reader_stats(reader->reader);
+        if (!stats)
+            goto error;
+        reader->candidates = malloc(reader->row_group_count);
+        if (!reader->candidates) {
+            free(stats);
+            goto error;
+        }
+        memset(reader->candidates, 1, reader->row_group_count);
+        bool ok = cx_index_match_stats(predicate, stats,
+                                       reader->row_group_count,
+                                       reader->candidates);
+        free(stats);
+        if (!ok)
+            goto error;
+        // and with the inverted index sidecar, if there is one
+        struct cx_inverted_index *inverted = cx_inverted_index_new(
+            path, reader->row_group_count,
+            cx_row_group_reader_row_count(reader->reader));
+        if (inverted) {
+            ok = cx_index_match_inverted(predicate, inverted,
+                                         reader->row_group_count,
+                                         reader->candidates);
+            cx_inverted_index_free(inverted);
+            if (!ok)
+                goto error;
+        }
+    }
+    // optimize the predicate for the first row group
     if (reader->row_group_count && !match_all_rows) {
         struct cx_row_group *row_group =
             cx_row_group_reader_get(reader->reader, 0);
         if (!row_group)
             goto error;
-        if (!cx_predicate_valid(predicate, row_group)) {
-            cx_row_group_free(row_group);
-            goto error;
-        }
         cx_predicate_optimize(predicate, row_group);
         cx_row_group_free(row_group);
+        reader->profile = cx_predicate_profile_new(predicate);
+        if (!reader->profile)
+            goto error;
     }
     return reader;
 error:
+    if (reader->candidates)
+        free(reader->candidates);
+    if (reader->pool)
+        cx_column_pool_free(reader->pool);
+    if (reader->reader)
+        cx_row_group_reader_free(reader->reader);
     free(reader);
     return NULL;
 }
@@ -104,8 +170,13 @@ void cx_reader_free(struct cx_reader *reader)
         cx_row_cursor_free(reader->row_cursor);
     if (reader->row_group)
         cx_row_group_free(reader->row_group);
+    if (reader->profile)
+        cx_predicate_profile_free(reader->profile);
     cx_predicate_free(reader->predicate);
     cx_row_group_reader_free(reader->reader);
+    cx_column_pool_free(reader->pool);
+    if (reader->candidates)
+        free(reader->candidates);
     free(reader);
 }
 
@@ -132,10 +203,12 @@ static bool cx_reader_load_cursor(struct cx_reader *reader)
         cx_row_group_reader_get(reader->reader, reader->position);
     if (!reader->row_group)
         goto error;
-    reader->row_cursor =
-        cx_row_cursor_new(reader->row_group, reader->predicate);
+    cx_row_group_set_pool(reader->row_group, reader->pool);
+    reader->row_cursor = cx_row_cursor_new_batch(
+        reader->row_group, reader->predicate, reader->batch_size);
     if (!reader->row_cursor)
         goto error;
+    cx_row_cursor_set_profile(reader->row_cursor, reader->profile);
     return true;
 error:
     if (reader->row_group)
@@ -149,6 +222,11 @@ static bool cx_reader_valid(const struct cx_reader *reader)
     return reader->position < reader->row_group_count;
 }
 
+static bool cx_reader_candidate(const struct cx_reader *reader)
+{
+    return !reader->candidates || reader->candidates[reader->position];
+}
+
 static void cx_reader_advance(struct cx_reader *reader)
 {
     if (reader->row_cursor) {
@@ -167,6 +245,8 @@ bool cx_reader_next(struct cx_reader *reader)
     if (reader->error)
         return false;
     for (; cx_reader_valid(reader); cx_reader_advance(reader)) {
+        if (!cx_reader_candidate(reader))
+            continue;
         if (!reader->row_cursor)
             if (!cx_reader_load_cursor(reader))
                 goto error;
@@ -181,6 +261,11 @@ error:
     return false;
 }
 
+bool cx_reader_may_match(const struct cx_reader *reader)
+{
+    return reader->row_group_count > 0;
+}
+
 bool cx_reader_error(const struct cx_reader *reader)
 {
     return reader->error;
@@ -194,6 +279,8 @@ size_t cx_reader_row_count(struct cx_reader *reader)
     cx_reader_rewind(reader);
     size_t count = 0;
     for (; cx_reader_valid(reader); cx_reader_advance(reader)) {
+        if (!cx_reader_candidate(reader))
+            continue;
         if (!cx_reader_load_cursor(reader))
             goto error;
         count += cx_row_cursor_count(reader->row_cursor);
@@ -211,18 +298,32 @@ static void *cx_reader_query_thread(void *ptr)
     struct cx_reader_query_context *context = ptr;
     struct cx_row_group *row_group = NULL;
     struct cx_row_cursor *cursor = NULL;
+    struct cx_predicate_profile *profile = NULL;
+    // each thread recycles decompression buffers across its row groups
+    struct cx_column_pool *pool = cx_column_pool_new();
+    if (!pool)
+        goto error;
+    // and adapts its own operand order
+    profile = cx_predicate_profile_new(context->predicate);
+    if (!profile)
+        goto error;
     for (;;) {
         pthread_mutex_lock(&context->mutex);
         size_t position = context->position++;
         pthread_mutex_unlock(&context->mutex);
         if (position >= context->row_group_count)
             break;
+        if (context->candidates && !context->candidates[position])
+            continue;
         row_group = cx_row_group_reader_get(context->reader, position);
         if (!row_group)
             goto error;
-        cursor = cx_row_cursor_new(row_group, context->predicate);
+        cx_row_group_set_pool(row_group, pool);
+        cursor = cx_row_cursor_new_batch(row_group, context->predicate,
+                                         context->batch_size);
         if (!cursor)
             goto error;
+        cx_row_cursor_set_profile(cursor, profile);
         context->iter(cursor, &context->mutex, context->data);
         if (cx_row_cursor_error(cursor))
             goto error;
@@ -231,18 +332,32 @@ static void *cx_reader_query_thread(void *ptr)
         row_group = NULL;
         cursor = NULL;
     }
+    cx_predicate_profile_free(profile);
+    cx_column_pool_free(pool);
     return NULL;
 error:
     if (row_group)
         cx_row_group_free(row_group);
     if (cursor)
         cx_row_cursor_free(cursor);
+    if (profile)
+        cx_predicate_profile_free(profile);
+    if (pool)
+        cx_column_pool_free(pool);
     pthread_mutex_lock(&context->mutex);
     context->error = true;
     pthread_mutex_unlock(&context->mutex);
     return NULL;
 }
 
+bool cx_reader_set_batch_size(struct cx_reader *reader, size_t batch_size)
+{
+    if (!batch_size || batch_size % 64 || batch_size > CX_BATCH_SIZE_MAX)
+        return false;
+    reader->batch_size = batch_size;
+    return true;
+}
+
 bool cx_reader_query(struct cx_reader *reader, int thread_count, void *data,
                      void (*iter)(struct cx_row_cursor *, pthread_mutex_t *,
                                   void *))
@@ -255,8 +370,10 @@ bool cx_reader_query(struct cx_reader *reader, int thread_count, void *data,
     struct cx_reader_query_context query_context = {
         .reader = reader->reader,
         .predicate = reader->predicate,
+        .candidates = reader->candidates,
         .position = 0,
         .row_group_count = reader->row_group_count,
+        .batch_size = reader->batch_size,
         .iter = iter,
         .data = data,
         .error = false};
@@ -429,6 +546,19 @@ struct cx_row_group_reader *cx_row_group_reader_new(const char *path)
     if (!reader->strings)
         goto error;
 
+    // check the file index
+    size_t index_size = 2 * footer->column_count * sizeof(struct cx_index);
+    if (footer->index_offset % CX_WRITE_ALIGN ||
+        footer->index_offset + index_size > file_size)
+        goto error;
+
+    // check the row group stats
+    size_t stats_size = 2 * footer->column_count * footer->row_group_count *
+                        sizeof(cx_index_value_t);
+    if (footer->stats_offset % CX_WRITE_ALIGN ||
+        footer->stats_offset + stats_size > file_size)
+        goto error;
+
     // cache counts and header locations
     reader->row_count = footer->row_count;
     reader->columns.count = footer->column_count;
@@ -437,6 +567,8 @@ struct cx_row_group_reader *cx_row_group_reader_new(const char *path)
         reader, file_size - footer->size - descriptors_size);
     reader->row_groups.headers =
         cx_row_group_reader_at(reader, file_size - headers_size);
+    reader->indexes = cx_row_group_reader_at(reader, footer->index_offset);
+    reader->stats = cx_row_group_reader_at(reader, footer->stats_offset);
     reader->metadata = footer->metadata;
 
     return reader;
@@ -545,6 +677,7 @@ struct cx_row_group *cx_row_group_reader_get(
     struct cx_row_group *row_group = cx_row_group_new();
     if (!row_group)
         return NULL;
+    struct cx_lazy_column *pages = NULL;
     for (size_t i = 0; i < reader->columns.count; i++) {
         const struct cx_column_descriptor *descriptor =
             &reader->columns.descriptors[i];
@@ -555,6 +688,10 @@ struct cx_row_group *cx_row_group_reader_get(
             &columns_headers[i * 2 + 1];
         if (null_header->offset + null_header->size > reader->file_size)
             goto error;
+        if (header->bloom_offset + header->bloom_size > reader->file_size)
+            goto error;
+        if (header->trigram_offset + header->trigram_size > reader->file_size)
+            goto error;
 
         struct cx_lazy_column column = {
             .type = descriptor->type,
@@ -565,6 +702,43 @@ struct cx_row_group *cx_row_group_reader_get(
             .size = header->size,
             .decompressed_size = header->decompressed_size};
 
+        if (header->bloom_size) {
+            column.bloom = cx_row_group_reader_at(reader, header->bloom_offset);
+            column.bloom_size = header->bloom_size;
+        }
+
+        if (header->trigram_size) {
+            column.trigrams =
+                cx_row_group_reader_at(reader, header->trigram_offset);
+            column.trigrams_size = header->trigram_size;
+        }
+
+        if (header->page_count) {
+            if (header->size != header->page_count * sizeof(*header))
+                goto error;
+            pages = malloc(header->page_count * sizeof(*pages));
+            if (!pages)
+                goto error;
+            const struct cx_column_header *page_headers = column.ptr;
+            for (size_t j = 0; j < header->page_count; j++) {
+                const struct cx_column_header *page_header = &page_headers[j];
+                if (page_header->offset + page_header->size > reader->file_size)
+                    goto error;
+                struct cx_lazy_column page = {
+                    .type = descriptor->type,
+                    .encoding = page_header->encoding,
+                    .compression = page_header->compression,
+                    .index = &page_header->index,
+                    .ptr = cx_row_group_reader_at(reader, page_header->offset),
+                    .size = page_header->size,
+                    .decompressed_size = page_header->decompressed_size,
+                    .page_count = page_header->page_count};
+                pages[j] = page;
+            }
+            column.pages = pages;
+            column.page_count = header->page_count;
+        }
+
         struct cx_lazy_column nulls = {
             .type = CX_COLUMN_BIT,
             .encoding = null_header->encoding,
@@ -576,13 +750,60 @@ struct cx_row_group *cx_row_group_reader_get(
 
         if (!cx_row_group_add_lazy_column(row_group, &column, &nulls))
             goto error;
+        if (pages)
+            free(pages);
+        pages = NULL;
     }
     return row_group;
 error:
+    if (pages)
+        free(pages);
     cx_row_group_free(row_group);
     return NULL;
 }
 
+struct cx_row_group *cx_row_group_reader_summary(
+    const struct cx_row_group_reader *reader)
+{
+    struct cx_row_group *row_group = cx_row_group_new();
+    if (!row_group)
+        return NULL;
+    for (size_t i = 0; i < reader->columns.count; i++) {
+        const struct cx_column_descriptor *descriptor =
+            &reader->columns.descriptors[i];
+        struct cx_lazy_column column = {.type = descriptor->type,
+                                        .encoding = CX_ENCODING_NONE,
+                                        .compression = CX_COMPRESSION_NONE,
+                                        .index = &reader->indexes[i * 2]};
+        struct cx_lazy_column nulls = {.type = CX_COLUMN_BIT,
+                                       .encoding = CX_ENCODING_NONE,
+                                       .compression = CX_COMPRESSION_NONE,
+                                       .index = &reader->indexes[i * 2 + 1]};
+        if (!cx_row_group_add_lazy_column(row_group, &column, &nulls))
+            goto error;
+    }
+    return row_group;
+error:
+    cx_row_group_free(row_group);
+    return NULL;
+}
+
+struct cx_index_stats *cx_row_group_reader_stats(
+    const struct cx_row_group_reader *reader)
+{
+    struct cx_index_stats *stats =
+        malloc(reader->columns.count * sizeof(*stats));
+    if (!stats)
+        return NULL;
+    size_t row_group_count = reader->row_groups.count;
+    for (size_t i = 0; i < reader->columns.count; i++) {
+        stats[i].type = reader->columns.descriptors[i].type;
+        stats[i].min = &reader->stats[i * 2 * row_group_count];
+        stats[i].max = &reader->stats[(i * 2 + 1) * row_group_count];
+    }
+    return stats;
+}
+
 void cx_row_group_reader_free(struct cx_row_group_reader *reader)
 {
     if (reader->mmap_ptr)
@@ -24,12 +24,20 @@ CX_EXPORT void cx_reader_rewind(struct cx_reader *);
 
 CX_EXPORT bool cx_reader_next(struct cx_reader *);
 
+// false if the file's index shows that no rows match the predicate, in
+// which case the reader skips the file without reading any row groups
+CX_EXPORT bool cx_reader_may_match(const struct cx_reader *);
+
 CX_EXPORT bool cx_reader_error(const struct cx_reader *);
 
 CX_EXPORT size_t cx_reader_column_count(const struct cx_reader *);
 
 CX_EXPORT size_t cx_reader_row_count(struct cx_reader *);
 
+// takes effect from the next row group. The batch size must be a multiple
+// of 64, up to CX_BATCH_SIZE_MAX
+CX_EXPORT bool cx_reader_set_batch_size(struct cx_reader *, size_t);
+
 CX_EXPORT bool cx_reader_query(struct cx_reader *, int thread_count, void *data,
                                void (*iter)(struct cx_row_cursor *,
                                             pthread_mutex_t *, void *));
@@ -88,6 +96,15 @@ enum cx_compression_type cx_row_group_reader_column_compression(
 struct cx_row_group *cx_row_group_reader_get(const struct cx_row_group_reader *,
                                              size_t);
 
+// a row group with the file index of each column, but no values
+struct cx_row_group *cx_row_group_reader_summary(
+    const struct cx_row_group_reader *);
+
+// the min and max of each column in each row group, as an array with an
+// entry for each column. The caller must free the array
+struct cx_index_stats *cx_row_group_reader_stats(
+    const struct cx_row_group_reader *);
+
 void cx_row_group_reader_free(struct cx_row_group_reader *reader);
 
 #ifdef __cplusplus
@@ -7,30 +7,63 @@ struct cx_row_cursor {
     struct cx_row_group *row_group;
     struct cx_row_group_cursor *cursor;
     const struct cx_predicate *predicate;
+    struct cx_predicate_profile *profile;
     size_t column_count;
-    uint64_t row_mask;
+    size_t batch_size;
+    size_t count;
     size_t position;
     enum cx_index_match index_match;
+    // rows outside the range don't match (see cx_predicate_match_range)
+    struct {
+        size_t start;
+        size_t end;
+        bool exact;
+    } range;
     bool implicit_predicate;
     bool error;
+    uint64_t row_mask[];
 };
 
 struct cx_row_cursor *cx_row_cursor_new(struct cx_row_group *row_group,
                                         const struct cx_predicate *predicate)
 {
-    struct cx_row_cursor *cursor = calloc(1, sizeof(*cursor));
+    return cx_row_cursor_new_batch(row_group, predicate, CX_BATCH_SIZE);
+}
+
+struct cx_row_cursor *cx_row_cursor_new_batch(
+    struct cx_row_group *row_group, const struct cx_predicate *predicate,
+    size_t batch_size)
+{
+    struct cx_row_cursor *cursor =
+        calloc(1, sizeof(*cursor) + batch_size / 64 * sizeof(uint64_t));
     if (!cursor)
         return NULL;
     cursor->row_group = row_group;
-    cursor->cursor = cx_row_group_cursor_new(row_group);
+    cursor->batch_size = batch_size;
+    cursor->cursor = cx_row_group_cursor_new_batch(row_group, batch_size);
     if (!cursor->cursor)
         goto error;
     cursor->predicate = predicate;
     cursor->index_match =
         cx_index_match_indexes(cursor->predicate, cursor->row_group);
+    size_t row_count = cx_row_group_row_count(row_group);
+    cursor->range.end = row_count;
+    if (cursor->index_match == CX_INDEX_MATCH_UNKNOWN) {
+        if (!cx_predicate_match_range(predicate, row_group,
+                                      &cursor->range.start, &cursor->range.end,
+                                      &cursor->range.exact))
+            goto error;
+        if (cursor->range.start == cursor->range.end)
+            cursor->index_match = CX_INDEX_MATCH_NONE;
+        else if (cursor->range.exact && !cursor->range.start &&
+                 cursor->range.end == row_count)
+            cursor->index_match = CX_INDEX_MATCH_ALL;
+    }
     cx_row_cursor_rewind(cursor);
     return cursor;
 error:
+    if (cursor->cursor)
+        cx_row_group_cursor_free(cursor->cursor);
     free(cursor);
     return NULL;
 }
@@ -41,48 +74,89 @@ void cx_row_cursor_free(struct cx_row_cursor *cursor)
     free(cursor);
 }
 
+void cx_row_cursor_set_profile(struct cx_row_cursor *cursor,
+                               struct cx_predicate_profile *profile)
+{
+    cursor->profile = profile;
+}
+
 void cx_row_cursor_rewind(struct cx_row_cursor *cursor)
 {
-    cursor->row_mask = 0;
-    cursor->position = 64;
+    cursor->count = 0;
+    cursor->position = 0;
     cx_row_group_cursor_rewind(cursor->cursor);
+    if (cursor->range.start)
+        cx_row_group_cursor_seek(cursor->cursor, cursor->range.start);
     cursor->error = false;
 }
 
-static uint64_t cx_row_cursor_load_row_mask(struct cx_row_cursor *cursor)
+// move to the first matching row at or after the specified position
+static bool cx_row_cursor_seek(struct cx_row_cursor *cursor, size_t position)
+{
+    size_t words = (cursor->count + 63) / 64;
+    for (size_t word = position / 64; word < words; word++) {
+        uint64_t mask = cursor->row_mask[word];
+        if (word == position / 64)
+            mask &= (uint64_t)-1 << (position % 64);
+        if (mask) {
+            cursor->position = word * 64 + __builtin_ctzll(mask);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void cx_row_cursor_clear(uint64_t *mask, size_t start, size_t end)
+{
+    for (size_t row = start; row < end; row++)
+        mask[row / 64] &= ~((uint64_t)1 << (row % 64));
+}
+
+static bool cx_row_cursor_load_row_mask(struct cx_row_cursor *cursor)
 {
-    uint64_t row_mask = 0;
-    while (!row_mask && cx_row_group_cursor_next(cursor->cursor)) {
+    if (cursor->index_match == CX_INDEX_MATCH_NONE)
+        goto done;
+    while (cx_row_group_cursor_next(cursor->cursor)) {
+        size_t start = cx_row_group_cursor_batch_start(cursor->cursor);
+        if (start >= cursor->range.end)
+            break;
         size_t count;
-        if (cursor->index_match == CX_INDEX_MATCH_ALL) {
+        if (cursor->index_match == CX_INDEX_MATCH_ALL || cursor->range.exact) {
             count = cx_row_group_cursor_batch_count(cursor->cursor);
-            row_mask = (uint64_t)-1;
-            if (count < 64)
-                row_mask &= ((uint64_t)1 << count) - 1;
-        } else if (!cx_index_match_rows(cursor->predicate, cursor->row_group,
-                                        cursor->cursor, &row_mask, &count))
+            for (size_t i = 0; i < (count + 63) / 64; i++)
+                cursor->row_mask[i] = (uint64_t)-1;
+            if (count % 64)
+                cursor->row_mask[count / 64] &=
+                    ((uint64_t)1 << (count % 64)) - 1;
+        } else if (!cx_index_match_rows_profiled(
+                       cursor->predicate, cursor->profile, cursor->row_group,
+                       cursor->cursor, cursor->row_mask, &count))
             goto error;
+        // rows outside the range aren't evaluated, and can't match
+        if (start < cursor->range.start)
+            cx_row_cursor_clear(cursor->row_mask, 0,
+                                cursor->range.start - start);
+        if (start + count > cursor->range.end)
+            cx_row_cursor_clear(cursor->row_mask, cursor->range.end - start,
+                                count);
+        cursor->count = count;
+        if (cx_row_cursor_seek(cursor, 0))
+            return true;
     }
-    return row_mask;
+done:
+    cursor->count = 0;
+    return false;
 error:
+    cursor->count = 0;
     cursor->error = true;
-    return 0;
+    return false;
 }
 
 bool cx_row_cursor_next(struct cx_row_cursor *cursor)
 {
-    if (cursor->position < 63) {
-        uint64_t mask = cursor->row_mask >> (cursor->position + 1);
-        if (mask) {
-            cursor->position += __builtin_ctzll(mask) + 1;
-            return true;
-        }
-    }
-    cursor->row_mask = cx_row_cursor_load_row_mask(cursor);
-    if (!cursor->row_mask)
-        return false;
-    cursor->position = __builtin_ctzll(cursor->row_mask);
-    return true;
+    if (cursor->count && cx_row_cursor_seek(cursor, cursor->position + 1))
+        return true;
+    return cx_row_cursor_load_row_mask(cursor);
 }
 
 bool cx_row_cursor_error(const struct cx_row_cursor *cursor)
@@ -96,49 +170,48 @@ size_t cx_row_cursor_count(struct cx_row_cursor *cursor)
         return 0;
     else if (cursor->index_match == CX_INDEX_MATCH_ALL)
         return cx_row_group_row_count(cursor->row_group);
+    else if (cursor->range.exact)
+        return cursor->range.end - cursor->range.start;
     cx_row_cursor_rewind(cursor);
     size_t count = 0;
-    for (;;) {
-        uint64_t row_mask = cx_row_cursor_load_row_mask(cursor);
-        if (!row_mask)
-            break;
-        count += __builtin_popcountll(row_mask);
-    }
+    while (cx_row_cursor_load_row_mask(cursor))
+        for (size_t i = 0; i < (cursor->count + 63) / 64; i++)
+            count += __builtin_popcountll(cursor->row_mask[i]);
     return count;
 }
 
 bool cx_row_cursor_get_null(const struct cx_row_cursor *cursor,
                             size_t column_index, bool *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->count);
     size_t count;
     const uint64_t *nulls =
         cx_row_group_cursor_batch_nulls(cursor->cursor, column_index, &count);
-    uint64_t row_bit = (uint64_t)1 << cursor->position;
+    uint64_t row_bit = (uint64_t)1 << (cursor->position % 64);
     if (!count || !nulls)
         return false;
-    *value = *nulls & row_bit;
+    *value = nulls[cursor->position / 64] & row_bit;
     return true;
 }
 
 bool cx_row_cursor_get_bit(const struct cx_row_cursor *cursor,
                            size_t column_index, bool *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->count);
     size_t count;
     const uint64_t *bitset =
         cx_row_group_cursor_batch_bit(cursor->cursor, column_index, &count);
-    uint64_t row_bit = (uint64_t)1 << cursor->position;
+    uint64_t row_bit = (uint64_t)1 << (cursor->position % 64);
     if (!count || !bitset)
         return false;
-    *value = *bitset & row_bit;
+    *value = bitset[cursor->position / 64] & row_bit;
     return true;
 }
 
 bool cx_row_cursor_get_i32(const struct cx_row_cursor *cursor,
                            size_t column_index, int32_t *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->count);
     size_t count;
     const int32_t *batch =
         cx_row_group_cursor_batch_i32(cursor->cursor, column_index, &count);
@@ -151,7 +224,7 @@ bool cx_row_cursor_get_i32(const struct cx_row_cursor *cursor,
 bool cx_row_cursor_get_i64(const struct cx_row_cursor *cursor,
                            size_t column_index, int64_t *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->count);
     size_t count;
     const int64_t *batch =
         cx_row_group_cursor_batch_i64(cursor->cursor, column_index, &count);
@@ -164,7 +237,7 @@ bool cx_row_cursor_get_i64(const struct cx_row_cursor *cursor,
 bool cx_row_cursor_get_flt(const struct cx_row_cursor *cursor,
                            size_t column_index, float *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->count);
     size_t count;
     const float *batch =
         cx_row_group_cursor_batch_flt(cursor->cursor, column_index, &count);
@@ -177,7 +250,7 @@ bool cx_row_cursor_get_flt(const struct cx_row_cursor *cursor,
 bool cx_row_cursor_get_dbl(const struct cx_row_cursor *cursor,
                            size_t column_index, double *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->count);
     size_t count;
     const double *batch =
         cx_row_group_cursor_batch_dbl(cursor->cursor, column_index, &count);
@@ -190,7 +263,7 @@ bool cx_row_cursor_get_dbl(const struct cx_row_cursor *cursor,
 bool cx_row_cursor_get_str(const struct cx_row_cursor *cursor,
                            size_t column_index, struct cx_string *value)
 {
-    assert(cursor->row_mask);
+    assert(cursor->count);
     size_t count;
     const struct cx_string *batch =
         cx_row_group_cursor_batch_str(cursor->cursor, column_index, &count);
@@ -12,8 +12,17 @@ struct cx_row_cursor;
 CX_EXPORT struct cx_row_cursor *cx_row_cursor_new(struct cx_row_group *,
                                                   const struct cx_predicate *);
 
+// batch_size must be a multiple of 64, up to CX_BATCH_SIZE_MAX
+CX_EXPORT struct cx_row_cursor *cx_row_cursor_new_batch(
+    struct cx_row_group *, const struct cx_predicate *, size_t batch_size);
+
 CX_EXPORT void cx_row_cursor_free(struct cx_row_cursor *);
 
+// order the predicate's operands with the profile, which must outlive the
+// cursor (see cx_predicate_profile_new)
+void cx_row_cursor_set_profile(struct cx_row_cursor *,
+                               struct cx_predicate_profile *);
+
 CX_EXPORT void cx_row_cursor_rewind(struct cx_row_cursor *);
 
 CX_EXPORT bool cx_row_cursor_next(struct cx_row_cursor *);
@@ -2,11 +2,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "bloom.h"
 #include "compress.h"
 #include "row_group.h"
+#include "trigram.h"
 
 static const size_t cx_row_group_column_initial_size = 8;
 
+// served in place of the null bitmap of columns without nulls
+static const uint64_t cx_row_group_no_nulls[CX_BATCH_SIZE_MAX / 64];
+
+struct cx_row_group_cache_entry {
+    uint64_t key;
+    void *value;
+    struct cx_row_group_cache_entry *next;
+};
+
 struct cx_row_group_physical_column {
     struct cx_index *index;
     struct cx_column *column;
@@ -18,7 +29,13 @@ struct cx_row_group_column {
     enum cx_encoding_type encoding;
     struct cx_row_group_physical_column values;
     struct cx_row_group_physical_column nulls;
+    struct {
+        struct cx_row_group_physical_column *columns;
+        size_t count;
+    } pages;
+    struct cx_row_group_cache_entry *cache;
     bool lazy;
+    bool constant;
 };
 
 struct cx_row_group {
@@ -26,13 +43,18 @@ struct cx_row_group {
     size_t count;
     size_t size;
     size_t row_count;
+    size_t page_size;
+    struct cx_column_pool *pool;
 };
 
 struct cx_row_group_cursor_physical_column {
     struct cx_column_cursor *cursor;
     size_t position;
     const void *batch;
+    const void *decoded;
     size_t count;
+    size_t page;
+    void *constant;
 };
 
 struct cx_row_group_cursor_column {
@@ -44,6 +66,7 @@ struct cx_row_group_cursor {
     struct cx_row_group *row_group;
     size_t column_count;
     size_t row_count;
+    size_t batch_size;
     size_t position;
     bool initialized;
     struct cx_row_group_cursor_column columns[];
@@ -60,6 +83,8 @@ struct cx_row_group *cx_row_group_new()
         goto error;
     row_group->count = 0;
     row_group->size = cx_row_group_column_initial_size;
+    row_group->page_size = 0;
+    row_group->pool = NULL;
     return row_group;
 error:
     free(row_group);
@@ -75,15 +100,32 @@ void cx_row_group_free(struct cx_row_group *row_group)
                 cx_column_free(row_group_column->values.column);
             if (row_group_column->nulls.column)
                 cx_column_free(row_group_column->nulls.column);
+            for (size_t j = 0; j < row_group_column->pages.count; j++)
+                if (row_group_column->pages.columns[j].column)
+                    cx_column_free(row_group_column->pages.columns[j].column);
+            free(row_group_column->pages.columns);
         } else {
             cx_index_free(row_group_column->values.index);
             cx_index_free(row_group_column->nulls.index);
         }
+        struct cx_row_group_cache_entry *entry = row_group_column->cache;
+        while (entry) {
+            struct cx_row_group_cache_entry *next = entry->next;
+            free(entry->value);
+            free(entry);
+            entry = next;
+        }
     }
     free(row_group->columns);
     free(row_group);
 }
 
+void cx_row_group_set_pool(struct cx_row_group *row_group,
+                           struct cx_column_pool *pool)
+{
+    row_group->pool = pool;
+}
+
 static bool cx_row_group_ensure_column_size(struct cx_row_group *row_group)
 {
     if (row_group->count == row_group->size) {
@@ -112,7 +154,7 @@ bool cx_row_group_add_column(struct cx_row_group *row_group,
         return false;
     struct cx_index *index = cx_index_new(column);
     struct cx_index *nulls_index = cx_index_new(nulls);
-    if (!index || !nulls_index)
+    if (!index || !nulls_index || !cx_index_count_nulls(index, nulls, 0))
         goto error;
     if (!cx_row_group_ensure_column_size(row_group))
         goto error;
@@ -123,8 +165,12 @@ bool cx_row_group_add_column(struct cx_row_group *row_group,
     row_group_column->values.column = column;
     row_group_column->values.index = index;
     row_group_column->lazy = false;
+    row_group_column->constant = false;
     row_group_column->nulls.column = nulls;
     row_group_column->nulls.index = nulls_index;
+    row_group_column->pages.columns = NULL;
+    row_group_column->pages.count = 0;
+    row_group_column->cache = NULL;
     row_group->row_count = row_count;
     return true;
 error:
@@ -135,17 +181,64 @@ error:
     return false;
 }
 
+static bool cx_row_group_pages_valid(const struct cx_row_group *row_group,
+                                     const struct cx_lazy_column *column)
+{
+    // pages (except the last) have the same number of rows, and the page
+    // size is shared by all columns in the row group
+    size_t page_size = column->pages[0].index->count;
+    if (!page_size || page_size % 64 ||
+        (row_group->page_size && row_group->page_size != page_size))
+        return false;
+    size_t row_count = 0;
+    for (size_t i = 0; i < column->page_count; i++) {
+        const struct cx_lazy_column *page = &column->pages[i];
+        size_t count = page->index->count;
+        if (page->type != column->type || page->page_count ||
+            count > page_size ||
+            (i + 1 < column->page_count && count != page_size))
+            return false;
+        row_count += count;
+    }
+    return row_count == column->index->count;
+}
+
 bool cx_row_group_add_lazy_column(struct cx_row_group *row_group,
                                   const struct cx_lazy_column *column,
                                   const struct cx_lazy_column *nulls)
 {
     size_t row_count = column->index->count;
-    if (row_count != nulls->index->count || nulls->type != CX_COLUMN_BIT)
+    if (row_count != nulls->index->count || nulls->type != CX_COLUMN_BIT ||
+        nulls->page_count)
         return false;
     if (row_group->count && row_group->row_count != row_count)
         return false;
+    if (column->page_count && !cx_row_group_pages_valid(row_group, column))
+        return false;
+    bool constant = row_count && !column->size && !column->page_count &&
+                    cx_index_constant(column->index, column->type);
+    if (column->bloom &&
+        (!column->bloom_size || column->bloom_size % CX_BLOOM_BLOCK_SIZE))
+        return false;
+    if (column->trigrams &&
+        (column->trigrams_size < CX_TRIGRAM_MIN_SIZE ||
+         column->trigrams_size & (column->trigrams_size - 1)))
+        return false;
     if (!cx_row_group_ensure_column_size(row_group))
         return false;
+    struct cx_row_group_physical_column *pages = NULL;
+    if (column->page_count) {
+        pages = malloc(column->page_count * sizeof(*pages));
+        if (!pages)
+            return false;
+        for (size_t i = 0; i < column->page_count; i++) {
+            pages[i].index = (struct cx_index *)column->pages[i].index;
+            pages[i].column = NULL;
+            memcpy(&pages[i].lazy_column, &column->pages[i],
+                   sizeof(*column));
+        }
+        row_group->page_size = column->pages[0].index->count;
+    }
     struct cx_row_group_column *row_group_column =
         &row_group->columns[row_group->count++];
     row_group_column->type = column->type;
@@ -153,10 +246,15 @@ bool cx_row_group_add_lazy_column(struct cx_row_group *row_group,
     row_group_column->values.index = (struct cx_index *)column->index;
     row_group_column->values.column = NULL;
     memcpy(&row_group_column->values.lazy_column, column, sizeof(*column));
+    row_group_column->values.lazy_column.pages = NULL;
+    row_group_column->pages.columns = pages;
+    row_group_column->pages.count = column->page_count;
     row_group_column->lazy = true;
+    row_group_column->constant = constant;
     row_group_column->nulls.column = NULL;
     row_group_column->nulls.index = (struct cx_index *)nulls->index;
     memcpy(&row_group_column->nulls.lazy_column, nulls, sizeof(*nulls));
+    row_group_column->cache = NULL;
     row_group->row_count = row_count;
     return true;
 }
@@ -202,16 +300,85 @@ const struct cx_index *cx_row_group_null_index(
     return row_group->columns[index].nulls.index;
 }
 
+static struct cx_column *cx_row_group_constant_column(
+    enum cx_column_type type, const struct cx_index *index)
+{
+    if (type == CX_COLUMN_BIT) {
+        void *dest;
+        size_t size = (index->count + 63) / 64 * sizeof(uint64_t);
+        struct cx_column *column = cx_column_new_compressed(
+            type, CX_ENCODING_NONE, &dest, size, index->count);
+        if (!column)
+            return NULL;
+        memset(dest, 0, size);
+        if (index->min.bit) {
+            uint64_t *bitset = dest;
+            for (size_t i = 0; i < index->count; i++)
+                bitset[i / 64] |= (uint64_t)1 << (i % 64);
+        }
+        return column;
+    }
+    struct cx_column *column = cx_column_new(type, CX_ENCODING_NONE);
+    if (!column)
+        return NULL;
+    char string[CX_INDEX_PREFIX_SIZE + 1] = {0};
+    memcpy(string, index->lower, index->lower_len);
+    for (size_t i = 0; i < index->count; i++) {
+        bool ok = false;
+        switch (type) {
+            case CX_COLUMN_I32:
+                ok = cx_column_put_i32(column, index->min.i32);
+                break;
+            case CX_COLUMN_I64:
+                ok = cx_column_put_i64(column, index->min.i64);
+                break;
+            case CX_COLUMN_FLT:
+                ok = cx_column_put_flt(column, index->min.flt);
+                break;
+            case CX_COLUMN_DBL:
+                ok = cx_column_put_dbl(column, index->min.dbl);
+                break;
+            case CX_COLUMN_STR:
+                ok = cx_column_put_str(column, string);
+                break;
+            default:
+                break;
+        }
+        if (!ok)
+            goto error;
+    }
+    return column;
+error:
+    cx_column_free(column);
+    return NULL;
+}
+
 static bool cx_row_group_lazy_column_init(
-    struct cx_row_group_physical_column *row_group_column)
+    struct cx_row_group_physical_column *row_group_column,
+    struct cx_column_pool *pool)
 {
     struct cx_lazy_column *lazy = &row_group_column->lazy_column;
     struct cx_column *column = NULL;
-    if (lazy->compression && lazy->size) {
+    size_t count = row_group_column->index->count;
+    if (!lazy->size && count) {
+        // the writer elides the data of constant chunks, and the null
+        // bitmap of columns without nulls
+        if (!cx_index_constant(row_group_column->index, lazy->type))
+            goto error;
+        column = cx_row_group_constant_column(lazy->type,
+                                              row_group_column->index);
+        if (!column)
+            goto error;
+    } else if (lazy->compression && lazy->size) {
         void *dest;
-        column = cx_column_new_compressed(lazy->type, lazy->encoding, &dest,
-                                          lazy->decompressed_size,
-                                          row_group_column->index->count);
+        if (pool)
+            column = cx_column_new_pooled(pool, lazy->type, lazy->encoding,
+                                          &dest, lazy->decompressed_size,
+                                          count);
+        else
+            column = cx_column_new_compressed(lazy->type, lazy->encoding,
+                                              &dest, lazy->decompressed_size,
+                                              count);
         if (!column)
             goto error;
         if (!cx_decompress(lazy->compression, lazy->ptr, lazy->size, dest,
@@ -220,7 +387,7 @@ static bool cx_row_group_lazy_column_init(
     } else {
         column =
             cx_column_new_mmapped(lazy->type, lazy->encoding, lazy->ptr,
-                                  lazy->size, row_group_column->index->count);
+                                  lazy->size, count);
         if (!column)
             goto error;
     }
@@ -232,31 +399,357 @@ error:
     return false;
 }
 
+static const struct cx_column *cx_row_group_page(
+    const struct cx_row_group *row_group, size_t index, size_t page)
+{
+    struct cx_row_group_column *row_group_column = &row_group->columns[index];
+    assert(page < row_group_column->pages.count);
+    struct cx_row_group_physical_column *page_column =
+        &row_group_column->pages.columns[page];
+    if (!page_column->column)
+        if (!cx_row_group_lazy_column_init(page_column, row_group->pool))
+            return NULL;
+    return page_column->column;
+}
+
+static bool cx_row_group_pages_init(const struct cx_row_group *row_group,
+                                    size_t index)
+{
+    // concatenate the pages into one (unencoded) column
+    struct cx_row_group_column *row_group_column = &row_group->columns[index];
+    struct cx_column *column =
+        cx_column_new(row_group_column->type, CX_ENCODING_NONE);
+    if (!column)
+        return false;
+    for (size_t i = 0; i < row_group_column->pages.count; i++) {
+        const struct cx_column *page = cx_row_group_page(row_group, index, i);
+        if (!page ||
+            !cx_column_append(column, page, 0, cx_column_count(page)))
+            goto error;
+    }
+    row_group_column->values.column = column;
+    return true;
+error:
+    cx_column_free(column);
+    return false;
+}
+
 const struct cx_column *cx_row_group_column(
     const struct cx_row_group *row_group, size_t index)
 {
     assert(index < row_group->count);
     struct cx_row_group_column *row_group_column = &row_group->columns[index];
+    if (row_group_column->pages.count && !row_group_column->values.column)
+        if (!cx_row_group_pages_init(row_group, index))
+            return NULL;
     if (row_group_column->lazy && !row_group_column->values.column)
-        if (!cx_row_group_lazy_column_init(&row_group_column->values))
+        if (!cx_row_group_lazy_column_init(&row_group_column->values,
+                                           row_group->pool))
             return NULL;
     return row_group_column->values.column;
 }
 
+static const void *cx_row_group_next_batch(struct cx_column_cursor *cursor,
+                                           enum cx_column_type type,
+                                           size_t *count)
+{
+    switch (type) {
+        case CX_COLUMN_I32:
+            return cx_column_cursor_next_batch_i32(cursor, count);
+        case CX_COLUMN_I64:
+            return cx_column_cursor_next_batch_i64(cursor, count);
+        case CX_COLUMN_FLT:
+            return cx_column_cursor_next_batch_flt(cursor, count);
+        case CX_COLUMN_DBL:
+            return cx_column_cursor_next_batch_dbl(cursor, count);
+        default:
+            return NULL;
+    }
+}
+
+static void cx_row_group_value(enum cx_column_type type, const void *values,
+                               size_t position, cx_index_value_t *value)
+{
+    switch (type) {
+        case CX_COLUMN_I32:
+            value->i32 = ((const int32_t *)values)[position];
+            break;
+        case CX_COLUMN_I64:
+            value->i64 = ((const int64_t *)values)[position];
+            break;
+        case CX_COLUMN_FLT:
+            value->flt = ((const float *)values)[position];
+            break;
+        case CX_COLUMN_DBL:
+            value->dbl = ((const double *)values)[position];
+            break;
+        default:
+            assert(false);
+    }
+}
+
+// the first of the values where the comparison is false
+static size_t cx_row_group_values_partition(
+    enum cx_column_type type, const void *values, size_t count,
+    bool (*before)(const cx_index_value_t *, const void *), const void *data)
+{
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        cx_index_value_t value;
+        cx_row_group_value(type, values, middle, &value);
+        if (before(&value, data))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+static bool cx_row_group_column_value(struct cx_column_cursor *cursor,
+                                      enum cx_column_type type, size_t row,
+                                      cx_index_value_t *value)
+{
+    cx_column_cursor_rewind(cursor);
+    size_t skipped = 0;
+    switch (type) {
+        case CX_COLUMN_I32:
+            skipped = cx_column_cursor_skip_i32(cursor, row);
+            break;
+        case CX_COLUMN_I64:
+            skipped = cx_column_cursor_skip_i64(cursor, row);
+            break;
+        case CX_COLUMN_FLT:
+            skipped = cx_column_cursor_skip_flt(cursor, row);
+            break;
+        case CX_COLUMN_DBL:
+            skipped = cx_column_cursor_skip_dbl(cursor, row);
+            break;
+        default:
+            return false;
+    }
+    size_t count = 0;
+    const void *values = NULL;
+    if (skipped == row)
+        values = cx_row_group_next_batch(cursor, type, &count);
+    if (!values || !count)
+        return false;
+    cx_row_group_value(type, values, 0, value);
+    return true;
+}
+
+// seek to each probe, for encodings where skipping rows is O(1)
+static bool cx_row_group_partition_search(
+    struct cx_column_cursor *cursor, enum cx_column_type type, size_t count,
+    bool (*before)(const cx_index_value_t *, const void *), const void *data,
+    size_t *row)
+{
+    size_t low = 0, high = count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        cx_index_value_t value;
+        if (!cx_row_group_column_value(cursor, type, middle, &value))
+            return false;
+        if (before(&value, data))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    *row = low;
+    return true;
+}
+
+// search the run values, since the runs of a sorted column are sorted
+static bool cx_row_group_partition_runs(
+    struct cx_column_cursor *cursor, enum cx_column_type type,
+    bool (*before)(const cx_index_value_t *, const void *), const void *data,
+    size_t *row)
+{
+    size_t count;
+    const void *values;
+    const uint32_t *ends = cx_column_cursor_rle_runs(cursor, &count, &values);
+    if (!ends)
+        return false;
+    size_t run = cx_row_group_values_partition(type, values, count, before,
+                                               data);
+    *row = run ? ends[run - 1] : 0;
+    return true;
+}
+
+// values that can only be decoded in order (e.g. XOR) are decoded once, up
+// to the batch that contains the partition
+static bool cx_row_group_partition_scan(
+    struct cx_column_cursor *cursor, enum cx_column_type type,
+    bool (*before)(const cx_index_value_t *, const void *), const void *data,
+    size_t *row)
+{
+    size_t offset = 0;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t count = 0;
+        const void *values = cx_row_group_next_batch(cursor, type, &count);
+        if (!values || !count)
+            return false;
+        cx_index_value_t last;
+        cx_row_group_value(type, values, count - 1, &last);
+        if (!before(&last, data)) {
+            *row = offset + cx_row_group_values_partition(type, values, count,
+                                                          before, data);
+            return true;
+        }
+        offset += count;
+    }
+    *row = offset;
+    return true;
+}
+
+bool cx_row_group_column_partition(const struct cx_row_group *row_group,
+                                   size_t index,
+                                   bool (*before)(const cx_index_value_t *,
+                                                  const void *),
+                                   const void *data, size_t *row)
+{
+    assert(index < row_group->count);
+    struct cx_row_group_column *row_group_column = &row_group->columns[index];
+    const struct cx_index *column_index = row_group_column->values.index;
+    bool ascending = column_index->flags & CX_INDEX_ASCENDING;
+    if (!ascending && !(column_index->flags & CX_INDEX_DESCENDING))
+        return false;
+    if (row_group_column->constant) {
+        *row = before(&column_index->min, data) ? column_index->count : 0;
+        return true;
+    }
+    const struct cx_column *column;
+    size_t offset = 0;
+    if (row_group_column->pages.count) {
+        // skip the pages whose last value precedes the partition
+        size_t page = 0;
+        for (; page + 1 < row_group_column->pages.count; page++) {
+            const struct cx_index *page_index =
+                row_group_column->pages.columns[page].index;
+            if (!before(ascending ? &page_index->max : &page_index->min, data))
+                break;
+        }
+        offset = page * row_group->page_size;
+        column = cx_row_group_page(row_group, index, page);
+    } else {
+        column = cx_row_group_column(row_group, index);
+    }
+    if (!column)
+        return false;
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        return false;
+    bool ok;
+    switch (cx_column_encoding(column)) {
+        case CX_ENCODING_NONE:
+        case CX_ENCODING_FOR:
+        case CX_ENCODING_SPLIT:
+            ok = cx_row_group_partition_search(cursor, row_group_column->type,
+                                               cx_column_count(column),
+                                               before, data, row);
+            break;
+        case CX_ENCODING_RLE:
+            ok = cx_row_group_partition_runs(cursor, row_group_column->type,
+                                             before, data, row);
+            break;
+        default:
+            ok = cx_row_group_partition_scan(cursor, row_group_column->type,
+                                             before, data, row);
+    }
+    cx_column_cursor_free(cursor);
+    *row += offset;
+    return ok;
+}
+
+bool cx_row_group_column_constant(const struct cx_row_group *row_group,
+                                  size_t index)
+{
+    assert(index < row_group->count);
+    return row_group->columns[index].constant;
+}
+
+const void *cx_row_group_column_bloom(const struct cx_row_group *row_group,
+                                      size_t index, size_t *size)
+{
+    assert(index < row_group->count);
+    const struct cx_row_group_column *row_group_column =
+        &row_group->columns[index];
+    if (!row_group_column->lazy || !row_group_column->values.lazy_column.bloom)
+        return NULL;
+    *size = row_group_column->values.lazy_column.bloom_size;
+    return row_group_column->values.lazy_column.bloom;
+}
+
+const void *cx_row_group_column_trigrams(const struct cx_row_group *row_group,
+                                         size_t index, size_t *size)
+{
+    assert(index < row_group->count);
+    const struct cx_row_group_column *row_group_column =
+        &row_group->columns[index];
+    if (!row_group_column->lazy ||
+        !row_group_column->values.lazy_column.trigrams)
+        return NULL;
+    *size = row_group_column->values.lazy_column.trigrams_size;
+    return row_group_column->values.lazy_column.trigrams;
+}
+
 const struct cx_column *cx_row_group_nulls(const struct cx_row_group *row_group,
                                            size_t index)
 {
     assert(index < row_group->count);
     struct cx_row_group_column *row_group_column = &row_group->columns[index];
     if (row_group_column->lazy && !row_group_column->nulls.column)
-        if (!cx_row_group_lazy_column_init(&row_group_column->nulls))
+        if (!cx_row_group_lazy_column_init(&row_group_column->nulls,
+                                           row_group->pool))
             return NULL;
     return row_group_column->nulls.column;
 }
 
+const struct cx_string *cx_row_group_column_dict(
+    const struct cx_row_group *row_group, size_t index, size_t *count)
+{
+    const struct cx_column *column = cx_row_group_column(row_group, index);
+    if (!column)
+        return NULL;
+    return cx_column_dict(column, count);
+}
+
+void *cx_row_group_column_cache_get(const struct cx_row_group *row_group,
+                                    size_t index, uint64_t key)
+{
+    assert(index < row_group->count);
+    struct cx_row_group_cache_entry *entry = row_group->columns[index].cache;
+    for (; entry; entry = entry->next)
+        if (entry->key == key)
+            return entry->value;
+    return NULL;
+}
+
+bool cx_row_group_column_cache_put(const struct cx_row_group *row_group,
+                                   size_t index, uint64_t key, void *value)
+{
+    assert(index < row_group->count);
+    struct cx_row_group_cache_entry *entry = malloc(sizeof(*entry));
+    if (!entry)
+        return false;
+    entry->key = key;
+    entry->value = value;
+    entry->next = row_group->columns[index].cache;
+    row_group->columns[index].cache = entry;
+    return true;
+}
+
 struct cx_row_group_cursor *cx_row_group_cursor_new(
     struct cx_row_group *row_group)
 {
+    return cx_row_group_cursor_new_batch(row_group, CX_BATCH_SIZE);
+}
+
+struct cx_row_group_cursor *cx_row_group_cursor_new_batch(
+    struct cx_row_group *row_group, size_t batch_size)
+{
+    if (!batch_size || batch_size % 64 || batch_size > CX_BATCH_SIZE_MAX)
+        return NULL;
     size_t column_count = cx_row_group_column_count(row_group);
     size_t size = sizeof(struct cx_row_group_cursor) +
                   column_count * sizeof(struct cx_row_group_cursor_column);
@@ -266,12 +759,15 @@ struct cx_row_group_cursor *cx_row_group_cursor_new(
     cursor->row_group = row_group;
     cursor->column_count = column_count;
     cursor->row_count = cx_row_group_row_count(row_group);
+    cursor->batch_size = batch_size;
     return cursor;
 }
 
 void cx_row_group_cursor_free(struct cx_row_group_cursor *cursor)
 {
     cx_row_group_cursor_rewind(cursor);
+    for (size_t i = 0; i < cursor->column_count; i++)
+        free(cursor->columns[i].values.constant);
     free(cursor);
 }
 
@@ -282,6 +778,7 @@ static void cx_row_group_cursor_rewind_columns(
         cx_column_cursor_free(column->cursor);
     column->cursor = NULL;
     column->position = 0;
+    column->decoded = NULL;
 }
 
 void cx_row_group_cursor_rewind(struct cx_row_group_cursor *cursor)
@@ -294,21 +791,81 @@ void cx_row_group_cursor_rewind(struct cx_row_group_cursor *cursor)
     }
 }
 
+// batches end at page boundaries, so column cursors are limited to the
+// rows remaining in the page
+static size_t cx_row_group_cursor_batch_limit(
+    const struct cx_row_group_cursor *cursor)
+{
+    size_t page_size = cursor->row_group->page_size;
+    if (!page_size)
+        return cursor->batch_size;
+    size_t remaining = page_size - cursor->position % page_size;
+    return remaining < cursor->batch_size ? remaining : cursor->batch_size;
+}
+
+static void cx_row_group_cursor_limit(const struct cx_row_group_cursor *cursor,
+                                      struct cx_column_cursor *column_cursor)
+{
+    cx_column_cursor_set_batch_size(column_cursor,
+                                    cx_row_group_cursor_batch_limit(cursor));
+}
+
 bool cx_row_group_cursor_next(struct cx_row_group_cursor *cursor)
 {
     if (!cursor->initialized)
         cursor->initialized = true;
     else
-        cursor->position += CX_BATCH_SIZE;
+        cursor->position += cx_row_group_cursor_batch_count(cursor);
     return cursor->position < cursor->row_count;
 }
 
+void cx_row_group_cursor_seek(struct cx_row_group_cursor *cursor, size_t row)
+{
+    assert(!cursor->initialized && row >= cursor->position);
+    if (row > cursor->row_count)
+        row = cursor->row_count;
+    // batches start at multiples of the batch size within each page
+    size_t page_size = cursor->row_group->page_size;
+    size_t page_start = page_size ? row - row % page_size : 0;
+    size_t offset = row - page_start;
+    cursor->position = page_start + offset - offset % cursor->batch_size;
+}
+
+size_t cx_row_group_cursor_batch_start(const struct cx_row_group_cursor *cursor)
+{
+    return cursor->position;
+}
+
 size_t cx_row_group_cursor_batch_count(const struct cx_row_group_cursor *cursor)
 {
     if (cursor->position >= cursor->row_count)
         return 0;
     size_t remaining = cursor->row_count - cursor->position;
-    return remaining < CX_BATCH_SIZE ? remaining : CX_BATCH_SIZE;
+    size_t limit = cx_row_group_cursor_batch_limit(cursor);
+    return remaining < limit ? remaining : limit;
+}
+
+static bool cx_row_group_cursor_page_init(struct cx_row_group_cursor *cursor,
+                                          size_t column_index)
+{
+    // only the page that contains the batch is decompressed
+    struct cx_row_group_cursor_physical_column *values =
+        &cursor->columns[column_index].values;
+    size_t page = cursor->position / cursor->row_group->page_size;
+    if (values->cursor && values->page == page)
+        return true;
+    if (values->cursor)
+        cx_column_cursor_free(values->cursor);
+    values->cursor = NULL;
+    const struct cx_column *column =
+        cx_row_group_page(cursor->row_group, column_index, page);
+    if (!column)
+        return false;
+    values->cursor = cx_column_cursor_new_batch(column, cursor->batch_size);
+    values->page = page;
+    values->position = page * cursor->row_group->page_size;
+    values->decoded = NULL;
+    return values->cursor != NULL;
 }
 
 static bool cx_row_group_cursor_lazy_column_init(
@@ -316,13 +873,16 @@ static bool cx_row_group_cursor_lazy_column_init(
 {
     if (column_index >= cursor->column_count)
         return false;
+    if (cursor->row_group->columns[column_index].pages.count)
+        return cx_row_group_cursor_page_init(cursor, column_index);
     if (cursor->columns[column_index].values.cursor)
         return true;
     const struct cx_column *column =
         cx_row_group_column(cursor->row_group, column_index);
     if (!column)
         return false;
-    cursor->columns[column_index].values.cursor = cx_column_cursor_new(column);
+    cursor->columns[column_index].values.cursor =
+        cx_column_cursor_new_batch(column, cursor->batch_size);
     return cursor->columns[column_index].values.cursor != NULL;
 }
 
@@ -337,13 +897,157 @@ static bool cx_row_group_cursor_lazy_nulls_init(
         cx_row_group_nulls(cursor->row_group, column_index);
     if (!column)
         return false;
-    cursor->columns[column_index].nulls.cursor = cx_column_cursor_new(column);
+    cursor->columns[column_index].nulls.cursor =
+        cx_column_cursor_new_batch(column, cursor->batch_size);
     return cursor->columns[column_index].nulls.cursor != NULL;
 }
 
+static bool cx_row_group_cursor_constant(
+    const struct cx_row_group_cursor *cursor, size_t column_index)
+{
+    return column_index < cursor->column_count &&
+           cursor->row_group->columns[column_index].constant;
+}
+
+// batches of constant chunks are filled with the value once, and then
+// served for every batch
+static const void *cx_row_group_cursor_batch_constant(
+    struct cx_row_group_cursor *cursor, size_t column_index, size_t *count)
+{
+    struct cx_row_group_cursor_physical_column *values =
+        &cursor->columns[column_index].values;
+    if (!values->constant) {
+        const struct cx_row_group_column *row_group_column =
+            &cursor->row_group->columns[column_index];
+        const struct cx_index *index = row_group_column->values.index;
+        size_t batch_size = cursor->batch_size;
+        // strings share a copy of the value, followed by enough zeroed
+        // bytes for the SSE4.2 string functions
+        size_t size = batch_size * sizeof(cx_value_t);
+        if (row_group_column->type == CX_COLUMN_STR)
+            size = batch_size * sizeof(struct cx_string) +
+                   CX_INDEX_PREFIX_SIZE + 17;
+        void *batch = calloc(1, size);
+        if (!batch)
+            return NULL;
+        switch (row_group_column->type) {
+            case CX_COLUMN_I32:
+                for (size_t i = 0; i < batch_size; i++)
+                    ((int32_t *)batch)[i] = index->min.i32;
+                break;
+            case CX_COLUMN_I64:
+                for (size_t i = 0; i < batch_size; i++)
+                    ((int64_t *)batch)[i] = index->min.i64;
+                break;
+            case CX_COLUMN_FLT:
+                for (size_t i = 0; i < batch_size; i++)
+                    ((float *)batch)[i] = index->min.flt;
+                break;
+            case CX_COLUMN_DBL:
+                for (size_t i = 0; i < batch_size; i++)
+                    ((double *)batch)[i] = index->min.dbl;
+                break;
+            case CX_COLUMN_STR: {
+                struct cx_string *strings = batch;
+                char *string = (char *)(strings + batch_size);
+                memcpy(string, index->lower, index->lower_len);
+                for (size_t i = 0; i < batch_size; i++) {
+                    strings[i].ptr = string;
+                    strings[i].len = index->lower_len;
+                }
+            } break;
+            default:
+                free(batch);
+                return NULL;
+        }
+        values->constant = batch;
+    }
+    *count = cx_row_group_cursor_batch_count(cursor);
+    return values->constant;
+}
+
+static size_t cx_row_group_cursor_skip(struct cx_column_cursor *cursor,
+                                       enum cx_column_type type, size_t count)
+{
+    switch (type) {
+        case CX_COLUMN_BIT:
+            return cx_column_cursor_skip_bit(cursor, count);
+        case CX_COLUMN_I32:
+            return cx_column_cursor_skip_i32(cursor, count);
+        case CX_COLUMN_I64:
+            return cx_column_cursor_skip_i64(cursor, count);
+        case CX_COLUMN_FLT:
+            return cx_column_cursor_skip_flt(cursor, count);
+        case CX_COLUMN_DBL:
+            return cx_column_cursor_skip_dbl(cursor, count);
+        case CX_COLUMN_STR:
+            return cx_column_cursor_skip_str(cursor, count);
+    }
+    return 0;
+}
+
+bool cx_row_group_cursor_batch_index(struct cx_row_group_cursor *cursor,
+                                     size_t column_index,
+                                     struct cx_index *index)
+{
+    if (column_index >= cursor->column_count)
+        return false;
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    const struct cx_row_group_column *row_group_column =
+        &cursor->row_group->columns[column_index];
+    if (row_group_column->constant) {
+        memcpy(index, row_group_column->values.index, sizeof(*index));
+        index->count = cx_row_group_cursor_batch_count(cursor);
+        return true;
+    }
+    bool summarize;
+    // only some encodings can summarize a batch without decoding it
+    switch (row_group_column->encoding) {
+        case CX_ENCODING_RLE:
+        case CX_ENCODING_FOR:
+            summarize = true;
+            break;
+        default:
+            summarize = false;
+    }
+    if (row_group_column->pages.count) {
+        // the page bounds also bound the batch, and don't require the page
+        // to be decompressed
+        size_t page = cursor->position / cursor->row_group->page_size;
+        if (!summarize || !column->values.cursor ||
+            column->values.page != page) {
+            memcpy(index, row_group_column->pages.columns[page].index,
+                   sizeof(*index));
+            index->count = cx_row_group_cursor_batch_count(cursor);
+            return true;
+        }
+    }
+    if (!summarize)
+        return false;
+    if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return false;
+    if (column->values.position > cursor->position)
+        return false;  // the batch has already been loaded
+    size_t skipped = cx_row_group_cursor_skip(
+        column->values.cursor,
+        cx_row_group_column_type(cursor->row_group, column_index),
+        cursor->position - column->values.position);
+    column->values.position += skipped;
+    cx_row_group_cursor_limit(cursor, column->values.cursor);
+    return cx_column_cursor_batch_index(column->values.cursor, index);
+}
+
 const uint64_t *cx_row_group_cursor_batch_nulls(
     struct cx_row_group_cursor *cursor, size_t column_index, size_t *count)
 {
+    if (column_index >= cursor->column_count)
+        return NULL;
+    const struct cx_index *index =
+        cx_row_group_null_index(cursor->row_group, column_index);
+    if (!index->max.bit) {
+        *count = cx_row_group_cursor_batch_count(cursor);
+        return cx_row_group_no_nulls;
+    }
     if (!cx_row_group_cursor_lazy_nulls_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
@@ -351,6 +1055,7 @@ const uint64_t *cx_row_group_cursor_batch_nulls(
         size_t skipped = cx_column_cursor_skip_bit(
             column->nulls.cursor, cursor->position - column->nulls.position);
         column->nulls.position += skipped;
+        cx_row_group_cursor_limit(cursor, column->nulls.cursor);
         column->nulls.batch = cx_column_cursor_next_batch_bit(
             column->nulls.cursor, &column->nulls.count);
         column->nulls.position += column->nulls.count;
@@ -369,6 +1074,7 @@ const uint64_t *cx_row_group_cursor_batch_bit(
         size_t skipped = cx_column_cursor_skip_bit(
             column->values.cursor, cursor->position - column->values.position);
         column->values.position += skipped;
+        cx_row_group_cursor_limit(cursor, column->values.cursor);
         column->values.batch = cx_column_cursor_next_batch_bit(
             column->values.cursor, &column->values.count);
         column->values.position += column->values.count;
@@ -380,6 +1086,8 @@ const uint64_t *cx_row_group_cursor_batch_bit(
 const int32_t *cx_row_group_cursor_batch_i32(struct cx_row_group_cursor *cursor,
                                              size_t column_index, size_t *count)
 {
+    if (cx_row_group_cursor_constant(cursor, column_index))
+        return cx_row_group_cursor_batch_constant(cursor, column_index, count);
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
@@ -387,6 +1095,7 @@ const int32_t *cx_row_group_cursor_batch_i32(struct cx_row_group_cursor *cursor,
         size_t skipped = cx_column_cursor_skip_i32(
             column->values.cursor, cursor->position - column->values.position);
         column->values.position += skipped;
+        cx_row_group_cursor_limit(cursor, column->values.cursor);
         column->values.batch = cx_column_cursor_next_batch_i32(
             column->values.cursor, &column->values.count);
         column->values.position += column->values.count;
@@ -398,6 +1107,8 @@ const int32_t *cx_row_group_cursor_batch_i32(struct cx_row_group_cursor *cursor,
 const int64_t *cx_row_group_cursor_batch_i64(struct cx_row_group_cursor *cursor,
                                              size_t column_index, size_t *count)
 {
+    if (cx_row_group_cursor_constant(cursor, column_index))
+        return cx_row_group_cursor_batch_constant(cursor, column_index, count);
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
@@ -405,6 +1116,7 @@ const int64_t *cx_row_group_cursor_batch_i64(struct cx_row_group_cursor *cursor,
         size_t skipped = cx_column_cursor_skip_i64(
             column->values.cursor, cursor->position - column->values.position);
         column->values.position += skipped;
+        cx_row_group_cursor_limit(cursor, column->values.cursor);
         column->values.batch = cx_column_cursor_next_batch_i64(
             column->values.cursor, &column->values.count);
         column->values.position += column->values.count;
@@ -416,6 +1128,8 @@ const int64_t *cx_row_group_cursor_batch_i64(struct cx_row_group_cursor *cursor,
 const float *cx_row_group_cursor_batch_flt(struct cx_row_group_cursor *cursor,
                                            size_t column_index, size_t *count)
 {
+    if (cx_row_group_cursor_constant(cursor, column_index))
+        return cx_row_group_cursor_batch_constant(cursor, column_index, count);
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
@@ -423,6 +1137,7 @@ const float *cx_row_group_cursor_batch_flt(struct cx_row_group_cursor *cursor,
         size_t skipped = cx_column_cursor_skip_flt(
             column->values.cursor, cursor->position - column->values.position);
         column->values.position += skipped;
+        cx_row_group_cursor_limit(cursor, column->values.cursor);
         column->values.batch = cx_column_cursor_next_batch_flt(
             column->values.cursor, &column->values.count);
         column->values.position += column->values.count;
@@ -434,6 +1149,8 @@ const float *cx_row_group_cursor_batch_flt(struct cx_row_group_cursor *cursor,
 const double *cx_row_group_cursor_batch_dbl(struct cx_row_group_cursor *cursor,
                                             size_t column_index, size_t *count)
 {
+    if (cx_row_group_cursor_constant(cursor, column_index))
+        return cx_row_group_cursor_batch_constant(cursor, column_index, count);
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
@@ -441,6 +1158,7 @@ const double *cx_row_group_cursor_batch_dbl(struct cx_row_group_cursor *cursor,
         size_t skipped = cx_column_cursor_skip_dbl(
             column->values.cursor, cursor->position - column->values.position);
         column->values.position += skipped;
+        cx_row_group_cursor_limit(cursor, column->values.cursor);
         column->values.batch = cx_column_cursor_next_batch_dbl(
             column->values.cursor, &column->values.count);
         column->values.position += column->values.count;
@@ -449,9 +1167,49 @@ const double *cx_row_group_cursor_batch_dbl(struct cx_row_group_cursor *cursor,
     return column->values.batch;
 }
 
+const int32_t *cx_row_group_cursor_batch_codes(
+    struct cx_row_group_cursor *cursor, size_t column_index, size_t *count)
+{
+    if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
+        return NULL;
+    if (cx_row_group_column_encoding(cursor->row_group, column_index) !=
+        CX_ENCODING_DICT)
+        return NULL;
+    struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
+    if (column->values.position <= cursor->position) {
+        size_t skipped = cx_column_cursor_skip_str(
+            column->values.cursor, cursor->position - column->values.position);
+        column->values.position += skipped;
+        cx_row_group_cursor_limit(cursor, column->values.cursor);
+        column->values.batch = cx_column_cursor_next_batch_codes(
+            column->values.cursor, &column->values.count);
+        column->values.decoded = NULL;
+        column->values.position += column->values.count;
+    }
+    *count = column->values.count;
+    return column->values.batch;
+}
+
 const struct cx_string *cx_row_group_cursor_batch_str(
     struct cx_row_group_cursor *cursor, size_t column_index, size_t *count)
 {
+    if (cx_row_group_cursor_constant(cursor, column_index))
+        return cx_row_group_cursor_batch_constant(cursor, column_index, count);
+    if (column_index < cursor->column_count &&
+        cx_row_group_column_encoding(cursor->row_group, column_index) ==
+            CX_ENCODING_DICT) {
+        const int32_t *codes =
+            cx_row_group_cursor_batch_codes(cursor, column_index, count);
+        if (!codes)
+            return NULL;
+        // only decode the batch once, even if it's requested repeatedly
+        struct cx_row_group_cursor_column *column =
+            &cursor->columns[column_index];
+        if (!column->values.decoded)
+            column->values.decoded = cx_column_cursor_decode_codes(
+                column->values.cursor, codes, *count);
+        return column->values.decoded;
+    }
     if (!cx_row_group_cursor_lazy_column_init(cursor, column_index))
         return NULL;
     struct cx_row_group_cursor_column *column = &cursor->columns[column_index];
@@ -459,6 +1217,7 @@ const struct cx_string *cx_row_group_cursor_batch_str(
         size_t skipped = cx_column_cursor_skip_str(
             column->values.cursor, cursor->position - column->values.position);
         column->values.position += skipped;
+        cx_row_group_cursor_limit(cursor, column->values.cursor);
         column->values.batch = cx_column_cursor_next_batch_str(
             column->values.cursor, &column->values.count);
         column->values.position += column->values.count;
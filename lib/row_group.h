@@ -16,6 +16,10 @@ struct cx_row_group *cx_row_group_new(void);
 
 void cx_row_group_free(struct cx_row_group *);
 
+// decompress lazy columns into buffers from the pool, which must outlive
+// the row group
+void cx_row_group_set_pool(struct cx_row_group *, struct cx_column_pool *);
+
 bool cx_row_group_add_column(struct cx_row_group *, struct cx_column *column,
                              struct cx_column *nulls);
 
@@ -27,6 +31,13 @@ struct cx_lazy_column {
     const void *ptr;
     size_t size;
     size_t decompressed_size;
+    // a column chunk can instead be split into pages, which are copied
+    const struct cx_lazy_column *pages;
+    size_t page_count;
+    const void *bloom;
+    size_t bloom_size;
+    const void *trigrams;
+    size_t trigrams_size;
 };
 
 bool cx_row_group_add_lazy_column(struct cx_row_group *,
@@ -49,21 +60,63 @@ const struct cx_index *cx_row_group_column_index(const struct cx_row_group *,
 const struct cx_column *cx_row_group_column(const struct cx_row_group *,
                                             size_t);
 
+// constant column chunks (see file.h) are stored as their index alone, and
+// are served as one batch filled with the value. BIT chunks are expanded
+bool cx_row_group_column_constant(const struct cx_row_group *, size_t);
+
+// returns NULL if the column chunk doesn't have a Bloom filter
+const void *cx_row_group_column_bloom(const struct cx_row_group *, size_t,
+                                      size_t *size);
+
+// returns NULL if the column chunk doesn't have a trigram filter
+const void *cx_row_group_column_trigrams(const struct cx_row_group *, size_t,
+                                         size_t *size);
+
+// binary search a sorted I32, I64, FLT or DBL column (see the index flags)
+// for the first row where the comparison is false, given that it's true for
+// a prefix of the rows. Only the page containing that row is decompressed.
+// RLE encoded pages are searched by run, and XOR encoded pages (which can't
+// seek) are decoded once up to that row
+bool cx_row_group_column_partition(const struct cx_row_group *, size_t,
+                                   bool (*before)(const cx_index_value_t *,
+                                                  const void *),
+                                   const void *data, size_t *row);
+
 const struct cx_index *cx_row_group_null_index(const struct cx_row_group *,
                                                size_t);
 
 const struct cx_column *cx_row_group_nulls(const struct cx_row_group *, size_t);
 
+const struct cx_string *cx_row_group_column_dict(const struct cx_row_group *,
+                                                 size_t, size_t *count);
+
+void *cx_row_group_column_cache_get(const struct cx_row_group *, size_t,
+                                    uint64_t key);
+
+bool cx_row_group_column_cache_put(const struct cx_row_group *, size_t,
+                                   uint64_t key, void *value);
+
 struct cx_row_group_cursor *cx_row_group_cursor_new(struct cx_row_group *);
 
+struct cx_row_group_cursor *cx_row_group_cursor_new_batch(
+    struct cx_row_group *, size_t batch_size);
+
 void cx_row_group_cursor_free(struct cx_row_group_cursor *);
 
 void cx_row_group_cursor_rewind(struct cx_row_group_cursor *);
 
 bool cx_row_group_cursor_next(struct cx_row_group_cursor *);
 
+// move a rewound cursor forward, so that the next batch contains the row
+void cx_row_group_cursor_seek(struct cx_row_group_cursor *, size_t row);
+
+size_t cx_row_group_cursor_batch_start(const struct cx_row_group_cursor *);
+
 size_t cx_row_group_cursor_batch_count(const struct cx_row_group_cursor *);
 
+bool cx_row_group_cursor_batch_index(struct cx_row_group_cursor *,
+                                     size_t column_index, struct cx_index *);
+
 const uint64_t *cx_row_group_cursor_batch_nulls(struct cx_row_group_cursor *,
                                                 size_t column_index,
                                                 size_t *count);
@@ -82,6 +135,9 @@ const double *cx_row_group_cursor_batch_dbl(struct cx_row_group_cursor *,
                                             size_t column_index, size_t *count);
 const struct cx_string *cx_row_group_cursor_batch_str(
     struct cx_row_group_cursor *, size_t column_index, size_t *count);
+const int32_t *cx_row_group_cursor_batch_codes(struct cx_row_group_cursor *,
+                                               size_t column_index,
+                                               size_t *count);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,85 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "bloom.h"
+#include "trigram.h"
+
+// trigrams are first collected in a bitmap with a bit for every possible
+// trigram, which is then folded into the filter
+#define CX_TRIGRAM_COUNT ((size_t)1 << 24)
+
+static unsigned char cx_trigram_fold(char c)
+{
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : (unsigned char)c;
+}
+
+static uint32_t cx_trigram(const char *ptr)
+{
+    return (uint32_t)cx_trigram_fold(ptr[0]) << 16 |
+           (uint32_t)cx_trigram_fold(ptr[1]) << 8 | cx_trigram_fold(ptr[2]);
+}
+
+static uint64_t cx_trigram_bit(uint32_t trigram, size_t size)
+{
+    return cx_bloom_hash_i64(trigram) & (size * 8 - 1);
+}
+
+void *cx_trigram_filter_new(const struct cx_column *column, size_t *size)
+{
+    if (cx_column_type(column) != CX_COLUMN_STR)
+        return NULL;
+    uint64_t *trigrams = calloc(CX_TRIGRAM_COUNT / 64, sizeof(*trigrams));
+    if (!trigrams)
+        return NULL;
+    struct cx_column_cursor *cursor = cx_column_cursor_new(column);
+    if (!cursor)
+        goto error;
+    while (cx_column_cursor_valid(cursor)) {
+        size_t count;
+        const struct cx_string *values =
+            cx_column_cursor_next_batch_str(cursor, &count);
+        assert(count);
+        for (size_t i = 0; i < count; i++) {
+            for (size_t j = 0; j + 3 <= values[i].len; j++) {
+                uint32_t trigram = cx_trigram(values[i].ptr + j);
+                trigrams[trigram / 64] |= (uint64_t)1 << (trigram % 64);
+            }
+        }
+    }
+    cx_column_cursor_free(cursor);
+    size_t distinct = 0;
+    for (size_t i = 0; i < CX_TRIGRAM_COUNT / 64; i++)
+        distinct += __builtin_popcountll(trigrams[i]);
+    size_t filter_size = CX_TRIGRAM_MIN_SIZE;
+    while (filter_size * 8 < distinct * CX_TRIGRAM_BITS_PER_TRIGRAM &&
+           filter_size < CX_TRIGRAM_COUNT / 8)
+        filter_size *= 2;
+    uint64_t *filter = calloc(filter_size / 8, sizeof(*filter));
+    if (!filter)
+        goto error;
+    for (size_t i = 0; i < CX_TRIGRAM_COUNT / 64; i++) {
+        for (uint64_t word = trigrams[i]; word; word &= word - 1) {
+            uint32_t trigram = i * 64 + __builtin_ctzll(word);
+            uint64_t bit = cx_trigram_bit(trigram, filter_size);
+            filter[bit / 64] |= (uint64_t)1 << (bit % 64);
+        }
+    }
+    free(trigrams);
+    *size = filter_size;
+    return filter;
+error:
+    free(trigrams);
+    return NULL;
+}
+
+bool cx_trigram_filter_contains(const void *filter, size_t size,
+                                const struct cx_string *string)
+{
+    const uint64_t *words = filter;
+    for (size_t i = 0; i + 3 <= string->len; i++) {
+        uint64_t bit = cx_trigram_bit(cx_trigram(string->ptr + i), size);
+        if (!(words[bit / 64] & ((uint64_t)1 << (bit % 64))))
+            return false;
+    }
+    return true;
+}
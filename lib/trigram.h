@@ -0,0 +1,30 @@
+#ifndef CX_TRIGRAM_H_
+#define CX_TRIGRAM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "column.h"
+
+// a trigram filter is a bitmap with a bit set for the hash of each distinct
+// trigram (three consecutive bytes, with ASCII letters lowercased) of the
+// values of a STR column chunk. A string of three or more bytes can only
+// occur in the chunk if the bits of all of its trigrams are set. The size
+// of the bitmap is a power of two, of at least CX_TRIGRAM_MIN_SIZE bytes
+#define CX_TRIGRAM_MIN_SIZE 64
+
+// the number of bits per distinct trigram
+#define CX_TRIGRAM_BITS_PER_TRIGRAM 8
+
+void *cx_trigram_filter_new(const struct cx_column *, size_t *size);
+
+// returns true if the string is shorter than three bytes
+bool cx_trigram_filter_contains(const void *filter, size_t size,
+                                const struct cx_string *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
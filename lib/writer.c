@@ -9,8 +9,12 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "bloom.h"
 #include "compress.h"
+#include "encode.h"
+#include "inverted.h"
 #include "file.h"
+#include "trigram.h"
 #include "writer.h"
 
 #define CX_NULL_COMPRESSION_TYPE CX_COMPRESSION_LZ4
@@ -31,6 +35,7 @@ struct cx_writer {
 
 struct cx_row_group_writer {
     FILE *file;
+    char *path;
     struct {
         struct cx_column_descriptor *descriptors;
         size_t count;
@@ -38,6 +43,8 @@ struct cx_row_group_writer {
     } columns;
     struct {
         struct cx_row_group_header *headers;
+        // the min and max of each column, for each row group
+        cx_index_value_t *stats;
         size_t count;
         size_t size;
     } row_groups;
@@ -46,7 +53,10 @@ struct cx_row_group_writer {
         size_t count;
         char *metadata;
     } strings;
+    struct cx_index *indexes;
+    struct cx_inverted_writer *inverted;
     size_t row_count;
+    size_t page_size;
     bool header_written;
     bool footer_written;
 };
@@ -84,6 +94,11 @@ bool cx_writer_metadata(struct cx_writer *writer, const char *metadata)
     return cx_row_group_writer_metadata(writer->writer, metadata);
 }
 
+bool cx_writer_set_page_size(struct cx_writer *writer, size_t page_size)
+{
+    return cx_row_group_writer_set_page_size(writer->writer, page_size);
+}
+
 bool cx_writer_add_column(struct cx_writer *writer, const char *name,
                           enum cx_column_type type,
                           enum cx_encoding_type encoding,
@@ -96,6 +111,25 @@ bool cx_writer_add_column(struct cx_writer *writer, const char *name,
     return true;
 }
 
+bool cx_writer_add_bloom_filter(struct cx_writer *writer, size_t column_index)
+{
+    return cx_row_group_writer_add_bloom_filter(writer->writer, column_index);
+}
+
+bool cx_writer_add_inverted_index(struct cx_writer *writer,
+                                  size_t column_index)
+{
+    return cx_row_group_writer_add_inverted_index(writer->writer,
+                                                  column_index);
+}
+
+bool cx_writer_add_trigram_filter(struct cx_writer *writer,
+                                  size_t column_index)
+{
+    return cx_row_group_writer_add_trigram_filter(writer->writer,
+                                                  column_index);
+}
+
 static bool cx_writer_flush_row_group(struct cx_writer *writer)
 {
     if (!writer->columns)
@@ -132,8 +166,9 @@ static bool cx_writer_ensure_columns(struct cx_writer *writer)
     for (size_t i = 0; i < writer->column_count; i++) {
         struct cx_column_descriptor *descriptor =
             &writer->writer->columns.descriptors[i];
+        // values are encoded when the row group is written
         writer->columns[i].values =
-            cx_column_new(descriptor->type, descriptor->encoding);
+            cx_column_new(descriptor->type, CX_ENCODING_NONE);
         if (!writer->columns[i].values)
             goto error;
         writer->columns[i].nulls =
@@ -272,17 +307,38 @@ struct cx_row_group_writer *cx_row_group_writer_new(const char *path)
     writer->strings.column = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
     if (!writer->strings.column)
         goto error;
+    writer->inverted = cx_inverted_writer_new();
+    if (!writer->inverted)
+        goto error;
+    writer->path = malloc(strlen(path) + 1);
+    if (!writer->path)
+        goto error;
+    strcpy(writer->path, path);
     writer->file = fopen(path, "wb");
     if (!writer->file)
         goto error;
+    writer->page_size = CX_PAGE_SIZE;
     return writer;
 error:
     if (writer->strings.column)
         cx_column_free(writer->strings.column);
+    if (writer->inverted)
+        cx_inverted_writer_free(writer->inverted);
+    if (writer->path)
+        free(writer->path);
     free(writer);
     return NULL;
 }
 
+bool cx_row_group_writer_set_page_size(struct cx_row_group_writer *writer,
+                                       size_t page_size)
+{
+    if (page_size % 64)
+        return false;
+    writer->page_size = page_size;
+    return true;
+}
+
 bool cx_row_group_writer_metadata(struct cx_row_group_writer *writer,
                                   const char *metadata)
 {
@@ -315,7 +371,8 @@ bool cx_row_group_writer_add_column(struct cx_row_group_writer *writer,
                                     enum cx_compression_type compression,
                                     int level)
 {
-    if (writer->header_written)
+    if (writer->header_written ||
+        (encoding != CX_ENCODING_AUTO && !cx_encoding_valid(type, encoding)))
         return false;
 
     if (!writer->columns.count) {
@@ -346,6 +403,47 @@ bool cx_row_group_writer_add_column(struct cx_row_group_writer *writer,
     return cx_row_group_writer_add_string(writer, name, &descriptor->name);
 }
 
+bool cx_row_group_writer_add_bloom_filter(struct cx_row_group_writer *writer,
+                                          size_t column_index)
+{
+    if (column_index >= writer->columns.count)
+        return false;
+    struct cx_column_descriptor *descriptor =
+        &writer->columns.descriptors[column_index];
+    if (descriptor->type != CX_COLUMN_I32 &&
+        descriptor->type != CX_COLUMN_I64 && descriptor->type != CX_COLUMN_STR)
+        return false;
+    descriptor->flags |= CX_COLUMN_FLAG_BLOOM;
+    return true;
+}
+
+bool cx_row_group_writer_add_inverted_index(
+    struct cx_row_group_writer *writer, size_t column_index)
+{
+    if (column_index >= writer->columns.count)
+        return false;
+    struct cx_column_descriptor *descriptor =
+        &writer->columns.descriptors[column_index];
+    if (descriptor->type != CX_COLUMN_I32 &&
+        descriptor->type != CX_COLUMN_I64 && descriptor->type != CX_COLUMN_STR)
+        return false;
+    descriptor->flags |= CX_COLUMN_FLAG_INVERTED;
+    return true;
+}
+
+bool cx_row_group_writer_add_trigram_filter(struct cx_row_group_writer *writer,
+                                            size_t column_index)
+{
+    if (column_index >= writer->columns.count)
+        return false;
+    struct cx_column_descriptor *descriptor =
+        &writer->columns.descriptors[column_index];
+    if (descriptor->type != CX_COLUMN_STR)
+        return false;
+    descriptor->flags |= CX_COLUMN_FLAG_TRIGRAM;
+    return true;
+}
+
 static size_t cx_write_align(size_t offset)
 {
     size_t mod = offset % CX_WRITE_ALIGN;
@@ -392,13 +490,61 @@ error:
     return false;
 }
 
+static bool cx_row_group_writer_ensure_indexes(
+    struct cx_row_group_writer *writer)
+{
+    if (writer->indexes || !writer->columns.count)
+        return true;
+    writer->indexes =
+        calloc(2 * writer->columns.count, sizeof(*writer->indexes));
+    return !!writer->indexes;
+}
+
+static enum cx_encoding_type cx_row_group_writer_select_encoding(
+    const struct cx_column *column, enum cx_compression_type compression)
+{
+    enum cx_encoding_type encoding = cx_column_encoding(column);
+    if (encoding == CX_ENCODING_NONE) {
+        size_t size;
+        const void *src = cx_column_export(column, &size);
+        encoding =
+            cx_encoding_select(cx_column_type(column), src, size,
+                               cx_column_count(column),
+                               compression != CX_COMPRESSION_NONE);
+    }
+    return encoding;
+}
+
 static bool cx_row_group_writer_put_column(struct cx_row_group_writer *writer,
                                            const struct cx_column *column,
                                            const struct cx_index *index,
                                            struct cx_column_header *header,
+                                           enum cx_encoding_type encoding,
+                                           bool automatic,
                                            enum cx_compression_type compression,
                                            int compression_level)
 {
+    struct cx_column *decoded = NULL, *encoded = NULL;
+    void *compressed = NULL;
+    if (encoding != cx_column_encoding(column)) {
+        // columns that are already encoded (e.g. read from another file)
+        // are decoded before they're encoded again
+        if (cx_column_encoding(column) != CX_ENCODING_NONE) {
+            decoded = cx_column_new(cx_column_type(column), CX_ENCODING_NONE);
+            if (!decoded ||
+                !cx_column_append(decoded, column, 0, cx_column_count(column)))
+                goto error;
+            column = decoded;
+        }
+        if (encoding != CX_ENCODING_NONE) {
+            encoded = cx_column_encode(column, encoding);
+            // fall back to the plain column if the selected encoding fails
+            if (encoded)
+                column = encoded;
+            else if (!automatic)
+                goto error;
+        }
+    }
     size_t column_size;
     const void *buffer = cx_column_export(column, &column_size);
     header->decompressed_size = column_size;
@@ -406,7 +552,6 @@ static bool cx_row_group_writer_put_column(struct cx_row_group_writer *writer,
     header->encoding = cx_column_encoding(column);
     memcpy(&header->index, index, sizeof(*index));
     size_t compressed_size = 0;
-    void *compressed = NULL;
     if (compression && column_size) {
         compressed = cx_compress(compression, compression_level, buffer,
                                  column_size, &compressed_size);
@@ -426,13 +571,116 @@ static bool cx_row_group_writer_put_column(struct cx_row_group_writer *writer,
         goto error;
     if (compressed)
         free(compressed);
+    if (encoded)
+        cx_column_free(encoded);
+    if (decoded)
+        cx_column_free(decoded);
     return true;
 error:
     if (compressed)
         free(compressed);
+    if (encoded)
+        cx_column_free(encoded);
+    if (decoded)
+        cx_column_free(decoded);
+    return false;
+}
+
+static bool cx_row_group_writer_put_pages(
+    struct cx_row_group_writer *writer, const struct cx_column *column,
+    const struct cx_column *nulls, const struct cx_index *index,
+    struct cx_column_header *header,
+    enum cx_encoding_type encoding, bool automatic,
+    enum cx_compression_type compression, int compression_level)
+{
+    size_t count = cx_column_count(column);
+    size_t page_size = writer->page_size;
+    size_t page_count = (count + page_size - 1) / page_size;
+    struct cx_column_header *pages = calloc(page_count, sizeof(*pages));
+    if (!pages)
+        return false;
+    struct cx_column *page = NULL;
+    struct cx_index *page_index = NULL;
+    for (size_t i = 0; i < page_count; i++) {
+        size_t start = i * page_size;
+        size_t rows = count - start < page_size ? count - start : page_size;
+        page = cx_column_new(cx_column_type(column), CX_ENCODING_NONE);
+        if (!page || !cx_column_append(page, column, start, rows))
+            goto error;
+        page_index = cx_index_new(page);
+        if (!page_index || !cx_index_count_nulls(page_index, nulls, start))
+            goto error;
+        if (!cx_row_group_writer_put_column(writer, page, page_index,
+                                            &pages[i], encoding, automatic,
+                                            compression, compression_level))
+            goto error;
+        cx_index_free(page_index);
+        cx_column_free(page);
+        page_index = NULL;
+        page = NULL;
+    }
+    // the chunk itself is the (uncompressed) table of page headers
+    size_t size = page_count * sizeof(*pages);
+    header->offset = cx_write_align(cx_row_group_writer_offset(writer));
+    header->size = size;
+    header->decompressed_size = size;
+    header->compression = CX_COMPRESSION_NONE;
+    header->encoding = encoding;
+    header->page_count = page_count;
+    memcpy(&header->index, index, sizeof(*index));
+    if (!cx_row_group_writer_write(writer, pages, size))
+        goto error;
+    free(pages);
+    return true;
+error:
+    if (page_index)
+        cx_index_free(page_index);
+    if (page)
+        cx_column_free(page);
+    free(pages);
     return false;
 }
 
+static void cx_row_group_writer_put_constant(
+    struct cx_row_group_writer *writer, const struct cx_index *index,
+    struct cx_column_header *header)
+{
+    header->offset = cx_write_align(cx_row_group_writer_offset(writer));
+    header->encoding = CX_ENCODING_NONE;
+    memcpy(&header->index, index, sizeof(*index));
+}
+
+static bool cx_row_group_writer_put_bloom(struct cx_row_group_writer *writer,
+                                          const struct cx_column *column,
+                                          struct cx_column_header *header)
+{
+    size_t size;
+    void *bloom = cx_bloom_new(column, &size);
+    if (!bloom)
+        return false;
+    header->bloom_offset = cx_write_align(cx_row_group_writer_offset(writer));
+    header->bloom_size = size;
+    bool ok = cx_row_group_writer_write(writer, bloom, size);
+    free(bloom);
+    return ok;
+}
+
+static bool cx_row_group_writer_put_trigrams(
+    struct cx_row_group_writer *writer, const struct cx_column *column,
+    struct cx_column_header *header)
+{
+    size_t size;
+    void *filter = cx_trigram_filter_new(column, &size);
+    if (!filter)
+        return false;
+    header->trigram_offset =
+        cx_write_align(cx_row_group_writer_offset(writer));
+    header->trigram_size = size;
+    bool ok = cx_row_group_writer_write(writer, filter, size);
+    free(filter);
+    return ok;
+}
+
 bool cx_row_group_writer_put(struct cx_row_group_writer *writer,
                              struct cx_row_group *row_group)
 {
@@ -452,12 +700,19 @@ bool cx_row_group_writer_put(struct cx_row_group_writer *writer,
             return false;
     }
 
-    // make room for the extra row group header
+    // make room for the extra row group header and stats
     if (!writer->row_groups.count) {
         writer->row_groups.headers =
             malloc(sizeof(*writer->row_groups.headers) * 16);
         if (!writer->row_groups.headers)
             return false;
+        writer->row_groups.stats =
+            malloc(sizeof(cx_index_value_t) * 16 * column_count * 2);
+        if (!writer->row_groups.stats) {
+            free(writer->row_groups.headers);
+            writer->row_groups.headers = NULL;
+            return false;
+        }
         writer->row_groups.size = 16;
     } else if (writer->row_groups.count == writer->row_groups.size) {
         size_t new_size = writer->row_groups.size * 2;
@@ -467,11 +722,18 @@ bool cx_row_group_writer_put(struct cx_row_group_writer *writer,
         if (!headers)
             return false;
         writer->row_groups.headers = headers;
+        cx_index_value_t *stats =
+            realloc(writer->row_groups.stats,
+                    new_size * column_count * 2 * sizeof(*stats));
+        if (!stats)
+            return false;
+        writer->row_groups.stats = stats;
         writer->row_groups.size = new_size;
     }
 
     // write the header if it hasn't already been written
-    if (!cx_row_group_writer_ensure_header(writer))
+    if (!cx_row_group_writer_ensure_header(writer) ||
+        !cx_row_group_writer_ensure_indexes(writer))
         return false;
 
     size_t row_group_offset = cx_row_group_writer_offset(writer);
@@ -486,22 +748,81 @@ bool cx_row_group_writer_put(struct cx_row_group_writer *writer,
         const struct cx_column_descriptor *descriptor =
             &writer->columns.descriptors[i];
         const struct cx_column *column = cx_row_group_column(row_group, i);
-        const struct cx_column *nulls = cx_row_group_nulls(row_group, i);
-        if (!column || !nulls)
+        if (!column)
             goto error;
         const struct cx_index *index = cx_row_group_column_index(row_group, i);
         const struct cx_index *nulls_index =
-            cx_row_group_column_index(row_group, i);
-        if (!cx_row_group_writer_put_column(
-                writer, column, index, &headers[i * 2], descriptor->compression,
-                descriptor->compression_level))
+            cx_row_group_null_index(row_group, i);
+        // only the index of constant chunks is kept
+        bool constant = !nulls_index->max.bit &&
+                        cx_index_constant(index, descriptor->type);
+        enum cx_encoding_type encoding = descriptor->encoding;
+        bool automatic = encoding == CX_ENCODING_AUTO;
+        if (automatic && !constant)
+            encoding = cx_row_group_writer_select_encoding(
+                column, descriptor->compression);
+        // split large chunks into pages. Dictionaries span the whole chunk
+        bool paged = writer->page_size && encoding != CX_ENCODING_DICT &&
+                     cx_column_count(column) > writer->page_size;
+        if (constant) {
+            cx_row_group_writer_put_constant(writer, index, &headers[i * 2]);
+        } else if (paged) {
+            const struct cx_column *nulls = cx_row_group_nulls(row_group, i);
+            if (!nulls ||
+                !cx_row_group_writer_put_pages(
+                    writer, column, nulls, index, &headers[i * 2], encoding,
+                    automatic, descriptor->compression,
+                    descriptor->compression_level))
+                goto error;
+        } else if (!cx_row_group_writer_put_column(
+                       writer, column, index, &headers[i * 2], encoding,
+                       automatic, descriptor->compression,
+                       descriptor->compression_level)) {
+            goto error;
+        }
+        // constant chunks are matched by their index alone, so they don't
+        // need filters
+        if (!constant && descriptor->flags & CX_COLUMN_FLAG_BLOOM &&
+            !cx_row_group_writer_put_bloom(writer, column, &headers[i * 2]))
+            goto error;
+        if (!constant && descriptor->flags & CX_COLUMN_FLAG_TRIGRAM &&
+            !cx_row_group_writer_put_trigrams(writer, column,
+                                              &headers[i * 2]))
+            goto error;
+        if (descriptor->flags & CX_COLUMN_FLAG_INVERTED &&
+            !cx_inverted_writer_add(writer->inverted, i, column,
+                                    writer->row_groups.count))
+            goto error;
+        // elide the null bitmap if there are no nulls. The header is kept
+        // (with a size of zero) so that readers still have the index
+        if (!nulls_index->max.bit) {
+            memcpy(&headers[i * 2 + 1].index, nulls_index,
+                   sizeof(*nulls_index));
+            continue;
+        }
+        const struct cx_column *nulls = cx_row_group_nulls(row_group, i);
+        if (!nulls)
             goto error;
         if (!cx_row_group_writer_put_column(
                 writer, nulls, nulls_index, &headers[i * 2 + 1],
-                CX_NULL_COMPRESSION_TYPE, CX_NULL_COMPRESSION_LEVEL))
+                CX_ENCODING_NONE, false, CX_NULL_COMPRESSION_TYPE,
+                CX_NULL_COMPRESSION_LEVEL))
             goto error;
     }
 
+    // update the file index and row group stats
+    cx_index_value_t *stats =
+        &writer->row_groups.stats[writer->row_groups.count * column_count * 2];
+    for (size_t i = 0; i < column_count; i++) {
+        enum cx_column_type type = cx_row_group_column_type(row_group, i);
+        const struct cx_index *index = cx_row_group_column_index(row_group, i);
+        cx_index_merge(&writer->indexes[i * 2], index, type);
+        cx_index_merge(&writer->indexes[i * 2 + 1],
+                       cx_row_group_null_index(row_group, i), CX_COLUMN_BIT);
+        stats[i * 2] = index->min;
+        stats[i * 2 + 1] = index->max;
+    }
+
     // update the row group header
     struct cx_row_group_header *row_group_header =
         &writer->row_groups.headers[writer->row_groups.count++];
@@ -523,6 +844,31 @@ error:
     return false;
 }
 
+static bool cx_row_group_writer_put_stats(struct cx_row_group_writer *writer,
+                                          size_t *offset)
+{
+    *offset = cx_write_align(cx_row_group_writer_offset(writer));
+    size_t row_group_count = writer->row_groups.count;
+    size_t column_count = writer->columns.count;
+    size_t count = row_group_count * column_count * 2;
+    if (!count)
+        return true;
+    // transpose the stats so that each column's min (and max) values are
+    // contiguous across row groups
+    cx_index_value_t *stats = malloc(count * sizeof(*stats));
+    if (!stats)
+        return false;
+    for (size_t i = 0; i < row_group_count; i++) {
+        const cx_index_value_t *row_group_stats =
+            &writer->row_groups.stats[i * column_count * 2];
+        for (size_t j = 0; j < column_count * 2; j++)
+            stats[j * row_group_count + i] = row_group_stats[j];
+    }
+    bool ok = cx_row_group_writer_write(writer, stats, count * sizeof(*stats));
+    free(stats);
+    return ok;
+}
+
 bool cx_row_group_writer_finish(struct cx_row_group_writer *writer, bool sync)
 {
     if (writer->footer_written)
@@ -549,6 +895,19 @@ bool cx_row_group_writer_finish(struct cx_row_group_writer *writer, bool sync)
     if (!cx_row_group_writer_write(writer, strings, strings_size))
         goto error;
 
+    // write the file index
+    if (!cx_row_group_writer_ensure_indexes(writer))
+        goto error;
+    size_t index_offset = cx_write_align(cx_row_group_writer_offset(writer));
+    size_t index_size = 2 * writer->columns.count * sizeof(struct cx_index);
+    if (!cx_row_group_writer_write(writer, writer->indexes, index_size))
+        goto error;
+
+    // write row group stats
+    size_t stats_offset;
+    if (!cx_row_group_writer_put_stats(writer, &stats_offset))
+        goto error;
+
     // write row group headers
     size_t row_group_headers_size =
         writer->row_groups.count * sizeof(struct cx_row_group_header);
@@ -566,6 +925,8 @@ bool cx_row_group_writer_finish(struct cx_row_group_writer *writer, bool sync)
     // write the footer
     struct cx_footer footer = {offset,
                                strings_size,
+                               index_offset,
+                               stats_offset,
                                metadata_id,
                                0,
                                writer->row_groups.count,
@@ -577,9 +938,17 @@ bool cx_row_group_writer_finish(struct cx_row_group_writer *writer, bool sync)
     if (!cx_row_group_writer_write(writer, &footer, sizeof(footer)))
         goto error;
 
-    // set the file size
+    // set the file size, and flush the file so that the sidecar can
+    // hash it
     int fd = fileno(writer->file);
-    if (ftruncate(fd, cx_row_group_writer_offset(writer)))
+    if (fflush(writer->file) ||
+        ftruncate(fd, cx_row_group_writer_offset(writer)))
+        goto error;
+
+    // write the inverted index sidecar, or remove a stale one
+    if (!cx_inverted_writer_finish(writer->inverted, writer->path,
+                                   writer->row_groups.count,
+                                   writer->row_count))
         goto error;
 
     // sync the file
@@ -609,6 +978,12 @@ void cx_row_group_writer_free(struct cx_row_group_writer *writer)
         free(writer->columns.descriptors);
     if (writer->row_groups.headers)
         free(writer->row_groups.headers);
+    if (writer->row_groups.stats)
+        free(writer->row_groups.stats);
+    if (writer->indexes)
+        free(writer->indexes);
+    cx_inverted_writer_free(writer->inverted);
+    free(writer->path);
     fclose(writer->file);
     free(writer);
 }
@@ -15,10 +15,18 @@ CX_EXPORT void cx_writer_free(struct cx_writer *);
 
 CX_EXPORT bool cx_writer_metadata(struct cx_writer *, const char *);
 
+CX_EXPORT bool cx_writer_set_page_size(struct cx_writer *, size_t page_size);
+
 CX_EXPORT bool cx_writer_add_column(struct cx_writer *, const char *name,
                                     enum cx_column_type, enum cx_encoding_type,
                                     enum cx_compression_type, int level);
 
+CX_EXPORT bool cx_writer_add_bloom_filter(struct cx_writer *, size_t);
+
+CX_EXPORT bool cx_writer_add_inverted_index(struct cx_writer *, size_t);
+
+CX_EXPORT bool cx_writer_add_trigram_filter(struct cx_writer *, size_t);
+
 CX_EXPORT bool cx_writer_put_bit(struct cx_writer *, size_t, bool);
 CX_EXPORT bool cx_writer_put_i32(struct cx_writer *, size_t, int32_t);
 CX_EXPORT bool cx_writer_put_i64(struct cx_writer *, size_t, int64_t);
@@ -38,10 +46,32 @@ CX_EXPORT void cx_row_group_writer_free(struct cx_row_group_writer *);
 CX_EXPORT bool cx_row_group_writer_metadata(struct cx_row_group_writer *,
                                             const char *);
 
+// column chunks with more rows than the page size (CX_PAGE_SIZE by default)
+// are split into pages, which can be decompressed independently. The page
+// size must be a multiple of 64, or zero to disable pages
+CX_EXPORT bool cx_row_group_writer_set_page_size(struct cx_row_group_writer *,
+                                                 size_t page_size);
+
 CX_EXPORT bool cx_row_group_writer_add_column(
     struct cx_row_group_writer *, const char *name, enum cx_column_type,
     enum cx_encoding_type, enum cx_compression_type, int level);
 
+// write a Bloom filter with each chunk of an I32, I64 or STR column, so that
+// equality predicates can skip row groups without the value
+CX_EXPORT bool cx_row_group_writer_add_bloom_filter(
+    struct cx_row_group_writer *, size_t column_index);
+
+// index the row groups that contain each value of an I32, I64 or STR column
+// in a sidecar file (see inverted.h), so that equality predicates only visit
+// those row groups
+CX_EXPORT bool cx_row_group_writer_add_inverted_index(
+    struct cx_row_group_writer *, size_t column_index);
+
+// write a trigram filter (see trigram.h) with each chunk of a STR column, so
+// that substring predicates can skip row groups without the substring
+CX_EXPORT bool cx_row_group_writer_add_trigram_filter(
+    struct cx_row_group_writer *, size_t column_index);
+
 CX_EXPORT bool cx_row_group_writer_put(struct cx_row_group_writer *,
                                        struct cx_row_group *);
 
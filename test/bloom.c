@@ -0,0 +1,98 @@
+#include <stdio.h>
+
+#include "bloom.h"
+
+#include "helpers.h"
+
+#define VALUE_COUNT 10000
+
+static MunitResult test_i64(const MunitParameter params[], void *ptr)
+{
+    struct cx_column *column = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    assert_not_null(column);
+    for (int64_t i = 0; i < VALUE_COUNT; i++)
+        assert_true(cx_column_put_i64(column, i * 1000003));
+    size_t size;
+    void *bloom = cx_bloom_new(column, &size);
+    assert_not_null(bloom);
+    size_t remainder = size % CX_BLOOM_BLOCK_SIZE;
+    assert_size(remainder, ==, 0);
+    assert_size(size * 8, >=, VALUE_COUNT * CX_BLOOM_BITS_PER_VALUE);
+    for (int64_t i = 0; i < VALUE_COUNT; i++)
+        assert_true(
+            cx_bloom_contains(bloom, size, cx_bloom_hash_i64(i * 1000003)));
+    size_t false_positives = 0;
+    for (int64_t i = 0; i < VALUE_COUNT; i++)
+        false_positives += cx_bloom_contains(
+            bloom, size, cx_bloom_hash_i64(i * 1000003 + 1));
+    assert_size(false_positives, <, VALUE_COUNT / 50);
+    free(bloom);
+    cx_column_free(column);
+    return MUNIT_OK;
+}
+
+static MunitResult test_i32(const MunitParameter params[], void *ptr)
+{
+    struct cx_column *column = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    assert_not_null(column);
+    for (int32_t i = -100; i < 100; i++)
+        assert_true(cx_column_put_i32(column, i * 3));
+    size_t size;
+    void *bloom = cx_bloom_new(column, &size);
+    assert_not_null(bloom);
+    for (int32_t i = -100; i < 100; i++)
+        assert_true(cx_bloom_contains(bloom, size, cx_bloom_hash_i64(i * 3)));
+    free(bloom);
+    cx_column_free(column);
+    return MUNIT_OK;
+}
+
+static MunitResult test_str(const MunitParameter params[], void *ptr)
+{
+    struct cx_column *column = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(column);
+    char buffer[64];
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        sprintf(buffer, "user%zu@example.com", i);
+        assert_true(cx_column_put_str(column, buffer));
+    }
+    // the filter can be built from an encoded column
+    struct cx_column *encoded = cx_column_encode(column, CX_ENCODING_OFFSETS);
+    assert_not_null(encoded);
+    size_t size;
+    void *bloom = cx_bloom_new(encoded, &size);
+    assert_not_null(bloom);
+    size_t false_positives = 0;
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        struct cx_string string = {buffer, 0};
+        string.len = sprintf(buffer, "user%zu@example.com", i);
+        assert_true(cx_bloom_contains(bloom, size, cx_bloom_hash_str(&string)));
+        string.len = sprintf(buffer, "user%zu@example.org", i);
+        false_positives +=
+            cx_bloom_contains(bloom, size, cx_bloom_hash_str(&string));
+    }
+    assert_size(false_positives, <, VALUE_COUNT / 50);
+    free(bloom);
+    cx_column_free(encoded);
+    cx_column_free(column);
+    return MUNIT_OK;
+}
+
+static MunitResult test_unsupported(const MunitParameter params[], void *ptr)
+{
+    struct cx_column *column = cx_column_new(CX_COLUMN_DBL, CX_ENCODING_NONE);
+    assert_not_null(column);
+    assert_true(cx_column_put_dbl(column, 1.5));
+    size_t size;
+    assert_null(cx_bloom_new(column, &size));
+    cx_column_free(column);
+    return MUNIT_OK;
+}
+
+MunitTest bloom_tests[] = {
+    {"/i64", test_i64, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i32", test_i32, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/str", test_str, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/unsupported", test_unsupported, NULL, NULL, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
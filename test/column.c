@@ -3,6 +3,8 @@
 #include <string.h>
 
 #include "column.h"
+#include "encode.h"
+#include "index.h"
 
 #include "helpers.h"
 
@@ -77,6 +79,108 @@ static void *setup_str(const MunitParameter params[], void *data)
     return col;
 }
 
+static void *encode(struct cx_column *col, enum cx_encoding_type encoding)
+{
+    struct cx_column *encoded = cx_column_encode(col, encoding);
+    assert_not_null(encoded);
+    assert_int(cx_column_type(encoded), ==, cx_column_type(col));
+    assert_int(cx_column_encoding(encoded), ==, encoding);
+    assert_size(cx_column_count(encoded), ==, cx_column_count(col));
+    cx_column_free(col);
+    return encoded;
+}
+
+static void *setup_bit_rle(const MunitParameter params[], void *data)
+{
+    return encode(setup_bit(params, data), CX_ENCODING_RLE);
+}
+
+static void *setup_i32_rle(const MunitParameter params[], void *data)
+{
+    return encode(setup_i32(params, data), CX_ENCODING_RLE);
+}
+
+static void *setup_i64_rle(const MunitParameter params[], void *data)
+{
+    return encode(setup_i64(params, data), CX_ENCODING_RLE);
+}
+
+static void *setup_i32_runs(const MunitParameter params[], void *data)
+{
+    struct cx_column *col = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    assert_not_null(col);
+    for (int32_t i = 0; i < COUNT; i++)
+        assert_true(cx_column_put_i32(col, i / 100));
+    return encode(col, CX_ENCODING_RLE);
+}
+
+static void *setup_i32_for(const MunitParameter params[], void *data)
+{
+    return encode(setup_i32(params, data), CX_ENCODING_FOR);
+}
+
+static void *setup_i64_for(const MunitParameter params[], void *data)
+{
+    return encode(setup_i64(params, data), CX_ENCODING_FOR);
+}
+
+static int64_t timestamp(size_t i)
+{
+    if (i == COUNT)
+        return INT64_MIN;
+    else if (i == COUNT + 1)
+        return INT64_MAX;
+    // mostly increasing, with the occasional jump backwards
+    int64_t value = 1500000000000LL + i * 1000 + (i * 7919) % 97;
+    return i % 300 == 299 ? value - 100000 : value;
+}
+
+static void *setup_timestamps(const MunitParameter params[], void *data)
+{
+    struct cx_column *col = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    assert_not_null(col);
+    for (size_t i = 0; i < COUNT + 2; i++)
+        assert_true(cx_column_put_i64(col, timestamp(i)));
+    return encode(col, CX_ENCODING_FOR);
+}
+
+static void *setup_dict(const MunitParameter params[], void *data)
+{
+    struct cx_column *str = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(str);
+    char buffer[64];
+    for (size_t i = 0; i < COUNT; i++) {
+        sprintf(buffer, "cx %zu", i % 10);
+        assert_true(cx_column_put_str(str, buffer));
+    }
+    return encode(str, CX_ENCODING_DICT);
+}
+
+static void *setup_str_offsets(const MunitParameter params[], void *data)
+{
+    return encode(setup_str(params, data), CX_ENCODING_OFFSETS);
+}
+
+static void *setup_flt_xor(const MunitParameter params[], void *data)
+{
+    return encode(setup_flt(params, data), CX_ENCODING_XOR);
+}
+
+static void *setup_dbl_xor(const MunitParameter params[], void *data)
+{
+    return encode(setup_dbl(params, data), CX_ENCODING_XOR);
+}
+
+static void *setup_flt_split(const MunitParameter params[], void *data)
+{
+    return encode(setup_flt(params, data), CX_ENCODING_SPLIT);
+}
+
+static void *setup_dbl_split(const MunitParameter params[], void *data)
+{
+    return encode(setup_dbl(params, data), CX_ENCODING_SPLIT);
+}
+
 static void teardown(void *fixture)
 {
     cx_column_free((struct cx_column *)fixture);
@@ -141,6 +245,34 @@ static MunitResult test_import_compressed(const MunitParameter params[],
     return MUNIT_OK;
 }
 
+static MunitResult test_import_pooled(const MunitParameter params[],
+                                      void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    size_t size;
+    const void *ptr = cx_column_export(col, &size);
+    assert_not_null(ptr);
+    struct cx_column_pool *pool = cx_column_pool_new();
+    assert_not_null(pool);
+    void *dest, *previous = NULL;
+    for (size_t i = 0; i < 3; i++) {
+        struct cx_column *copy =
+            cx_column_new_pooled(pool, CX_COLUMN_I32, CX_ENCODING_NONE, &dest,
+                                 size - i * 64, cx_column_count(col));
+        assert_not_null(copy);
+        bool aligned = (uintptr_t)dest % 64 == 0;
+        assert_true(aligned);
+        if (previous)
+            assert_ptr_equal(dest, previous);  // recycled
+        previous = dest;
+        memcpy(dest, ptr, size - i * 64);
+        assert_false(cx_column_put_i32(copy, 0));  // immutable
+        cx_column_free(copy);
+    }
+    cx_column_pool_free(pool);
+    return MUNIT_OK;
+}
+
 static MunitResult test_bit_put_mismatch(const MunitParameter params[],
                                          void *fixture)
 {
@@ -360,12 +492,309 @@ static MunitResult test_str_cursor(const MunitParameter params[], void *fixture)
     return MUNIT_OK;
 }
 
+static MunitResult test_dict_put(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    assert_false(cx_column_put_str(col, "cx 1"));  // encoded
+    return MUNIT_OK;
+}
+
+static MunitResult test_dict_cursor(const MunitParameter params[],
+                                    void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    size_t dict_count;
+    const struct cx_string *dict = cx_column_dict(col, &dict_count);
+    assert_not_null(dict);
+    assert_size(dict_count, ==, 10);
+    for (size_t i = 1; i < dict_count; i++)
+        assert_int(strcmp(dict[i - 1].ptr, dict[i].ptr), <, 0);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(col);
+    assert_not_null(cursor);
+
+    char expected[64];
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 8, 13, 64, COUNT - 1, COUNT};
+
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_str(cursor, position), ==, position);
+        while (cx_column_cursor_valid(cursor)) {
+            const struct cx_string *strings =
+                cx_column_cursor_next_batch_str(cursor, &count);
+            for (size_t j = 0; j < count; j++) {
+                sprintf(expected, "cx %zu", (j + position) % 10);
+                assert_int(strings[j].len, ==, strlen(expected));
+                assert_string_equal(expected, strings[j].ptr);
+            }
+            position += count;
+        }
+        assert_size(position, ==, COUNT);
+        cx_column_cursor_rewind(cursor);
+    }
+
+    const int32_t *codes = cx_column_cursor_next_batch_codes(cursor, &count);
+    assert_size(count, ==, CX_BATCH_SIZE);
+    const struct cx_string *strings =
+        cx_column_cursor_decode_codes(cursor, codes, count);
+    for (size_t j = 0; j < count; j++)
+        assert_ptr_equal(dict[codes[j]].ptr, strings[j].ptr);
+
+    cx_column_cursor_free(cursor);
+    return MUNIT_OK;
+}
+
+static MunitResult test_rle_runs(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    size_t size;
+    cx_column_export(col, &size);
+    assert_size(size, <, COUNT * sizeof(int32_t) / 10);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(col);
+    assert_not_null(cursor);
+
+    size_t position = 0, count;
+    while (cx_column_cursor_valid(cursor)) {
+        struct cx_index index;
+        assert_true(cx_column_cursor_batch_index(cursor, &index));
+        const int32_t *values = cx_column_cursor_next_batch_i32(cursor, &count);
+        assert_size(index.count, ==, count);
+        assert_int32(index.min.i32, ==, position / 100);
+        assert_int32(index.max.i32, ==, (position + count - 1) / 100);
+        for (size_t j = 0; j < count; j++)
+            assert_int32(values[j], ==, (j + position) / 100);
+        position += count;
+    }
+    assert_size(position, ==, COUNT);
+
+    cx_column_cursor_free(cursor);
+    return MUNIT_OK;
+}
+
+static MunitResult test_for_timestamps(const MunitParameter params[],
+                                       void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    size_t size;
+    cx_column_export(col, &size);
+    assert_size(size, <, COUNT * sizeof(int64_t) / 3);
+
+    struct cx_column_cursor *cursor = cx_column_cursor_new(col);
+    assert_not_null(cursor);
+
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 64, 100, COUNT - 1};
+
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_i64(cursor, position), ==, position);
+        while (cx_column_cursor_valid(cursor)) {
+            struct cx_index index;
+            assert_true(cx_column_cursor_batch_index(cursor, &index));
+            const int64_t *values =
+                cx_column_cursor_next_batch_i64(cursor, &count);
+            assert_size(index.count, ==, count);
+            for (size_t j = 0; j < count; j++) {
+                assert_int64(values[j], ==, timestamp(j + position));
+                assert_int64(values[j], >=, index.min.i64);
+                assert_int64(values[j], <=, index.max.i64);
+            }
+            position += count;
+        }
+        assert_size(position, ==, COUNT + 2);
+        cx_column_cursor_rewind(cursor);
+    }
+
+    cx_column_cursor_free(cursor);
+    return MUNIT_OK;
+}
+
+static MunitResult test_i32_wide_cursor(const MunitParameter params[],
+                                        void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    assert_null(cx_column_cursor_new_batch(col, 0));
+    assert_null(cx_column_cursor_new_batch(col, 100));
+    assert_null(cx_column_cursor_new_batch(col, CX_BATCH_SIZE_MAX * 2));
+    struct cx_column_cursor *cursor = cx_column_cursor_new_batch(col, 256);
+    assert_not_null(cursor);
+
+    size_t position, count;
+    size_t starting_positions[] = {0, 1, 13, 64, 300, COUNT - 3, COUNT};
+
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_i32(cursor, position), ==, position);
+        while (cx_column_cursor_valid(cursor)) {
+            const int32_t *values =
+                cx_column_cursor_next_batch_i32(cursor, &count);
+            assert_size(count, <=, 256);
+            if (position + 256 <= COUNT)
+                assert_size(count, ==, 256);
+            for (size_t j = 0; j < count; j++)
+                assert_int32(values[j], ==, j + position);
+            position += count;
+        }
+        assert_size(position, ==, COUNT);
+        cx_column_cursor_rewind(cursor);
+    }
+
+    cx_column_cursor_free(cursor);
+    return MUNIT_OK;
+}
+
+static MunitResult test_bit_wide_cursor(const MunitParameter params[],
+                                        void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    struct cx_column_cursor *cursor = cx_column_cursor_new_batch(col, 256);
+    assert_not_null(cursor);
+
+    size_t position, count;
+    size_t starting_positions[] = {0, 64, 320, 1024};
+
+    CX_FOREACH(starting_positions, position)
+    {
+        assert_size(cx_column_cursor_skip_bit(cursor, position), ==, position);
+        while (cx_column_cursor_valid(cursor)) {
+            const uint64_t *bitset =
+                cx_column_cursor_next_batch_bit(cursor, &count);
+            for (size_t j = 0; j < count; j++) {
+                bool bit = bitset[j / 64] & ((uint64_t)1 << (j % 64));
+                bool expected = (position + j) % 5 == 0;
+                assert_int(bit, ==, expected);
+            }
+            position += count;
+        }
+        assert_size(position, ==, COUNT);
+        cx_column_cursor_rewind(cursor);
+    }
+
+    cx_column_cursor_free(cursor);
+    return MUNIT_OK;
+}
+
+static enum cx_encoding_type select_encoding(struct cx_column *col,
+                                             bool compressed)
+{
+    size_t size;
+    const void *src = cx_column_export(col, &size);
+    enum cx_encoding_type encoding = cx_encoding_select(
+        cx_column_type(col), src, size, cx_column_count(col), compressed);
+    cx_column_free(col);
+    return encoding;
+}
+
+static MunitResult test_str_offsets_corrupt(const MunitParameter params[],
+                                            void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    size_t size;
+    const void *ptr = cx_column_export(col, &size);
+    assert_not_null(ptr);
+    void *copy_ptr = malloc(size);
+    assert_not_null(copy_ptr);
+    uint32_t *offsets =
+        (uint32_t *)((char *)copy_ptr + sizeof(struct cx_offsets_header));
+    uint32_t corrupt[] = {UINT32_MAX, 0};
+    for (size_t i = 0; i < sizeof(corrupt) / sizeof(*corrupt); i++) {
+        memcpy(copy_ptr, ptr, size);
+        // an intermediate offset is out of range or out of order
+        offsets[2] = corrupt[i];
+        struct cx_column *copy =
+            cx_column_new_mmapped(CX_COLUMN_STR, CX_ENCODING_OFFSETS, copy_ptr,
+                                  size, cx_column_count(col));
+        assert_not_null(copy);
+        assert_null(cx_column_cursor_new(copy));
+        cx_column_free(copy);
+    }
+    free(copy_ptr);
+    return MUNIT_OK;
+}
+
+static MunitResult test_dict_corrupt(const MunitParameter params[],
+                                     void *fixture)
+{
+    struct cx_column *col = (struct cx_column *)fixture;
+    size_t size, count = cx_column_count(col);
+    const void *ptr = cx_column_export(col, &size);
+    assert_not_null(ptr);
+    void *copy_ptr = malloc(size);
+    assert_not_null(copy_ptr);
+    int32_t *codes = (int32_t *)((char *)copy_ptr + size) - count;
+    int32_t corrupt[] = {10, -1};
+    for (size_t i = 0; i < sizeof(corrupt) / sizeof(*corrupt); i++) {
+        memcpy(copy_ptr, ptr, size);
+        // a code is outside the dictionary
+        codes[count / 2] = corrupt[i];
+        struct cx_column *copy = cx_column_new_mmapped(
+            CX_COLUMN_STR, CX_ENCODING_DICT, copy_ptr, size, count);
+        assert_not_null(copy);
+        assert_null(cx_column_cursor_new(copy));
+        cx_column_free(copy);
+    }
+    // the codes are truncated, or followed by trailing bytes
+    memcpy(copy_ptr, ptr, size);
+    size_t sizes[] = {size - sizeof(int32_t), size - 1};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); i++) {
+        struct cx_column *copy = cx_column_new_mmapped(
+            CX_COLUMN_STR, CX_ENCODING_DICT, copy_ptr, sizes[i], count);
+        assert_not_null(copy);
+        size_t dict_count;
+        assert_null(cx_column_dict(copy, &dict_count));
+        cx_column_free(copy);
+    }
+    struct cx_column *copy = cx_column_new_mmapped(
+        CX_COLUMN_STR, CX_ENCODING_DICT, copy_ptr, size, count - 1);
+    assert_not_null(copy);
+    assert_null(cx_column_cursor_new(copy));
+    cx_column_free(copy);
+    free(copy_ptr);
+    return MUNIT_OK;
+}
+
+static MunitResult test_encoding_select(const MunitParameter params[],
+                                        void *fixture)
+{
+    struct cx_column *runs = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    struct cx_column *timestamps =
+        cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    struct cx_column *repeated = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    struct cx_column *metrics = cx_column_new(CX_COLUMN_DBL, CX_ENCODING_NONE);
+    assert_not_null(runs);
+    assert_not_null(timestamps);
+    assert_not_null(repeated);
+    assert_not_null(metrics);
+    for (size_t i = 0; i < COUNT; i++) {
+        assert_true(cx_column_put_i32(runs, i / 100));
+        assert_true(cx_column_put_i64(timestamps, 1500000000000 + i * 1000));
+        assert_true(cx_column_put_str(
+            repeated, i % 2 ? "http://example.com/" : "http://example.org/"));
+        assert_true(cx_column_put_dbl(metrics, 100 + (double)(i % 8) / 1024));
+    }
+    assert_int(select_encoding(runs, false), ==, CX_ENCODING_RLE);
+    assert_int(select_encoding(timestamps, false), ==, CX_ENCODING_FOR);
+    assert_int(select_encoding(setup_i64(params, fixture), false), ==,
+               CX_ENCODING_FOR);
+    assert_int(select_encoding(repeated, false), ==, CX_ENCODING_DICT);
+    assert_int(select_encoding(setup_str(params, fixture), false), ==,
+               CX_ENCODING_NONE);
+    assert_int(select_encoding(setup_dbl(params, fixture), false), ==,
+               CX_ENCODING_NONE);
+    assert_int(select_encoding(metrics, true), ==, CX_ENCODING_XOR);
+    return MUNIT_OK;
+}
+
 MunitTest column_tests[] = {
     {"/export", test_export, setup_i32, teardown, MUNIT_TEST_OPTION_NONE, NULL},
     {"/import-mmapped", test_import_mmapped, setup_i32, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/import-compressed", test_import_compressed, setup_i32, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
+    {"/import-pooled", test_import_pooled, setup_i32, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
     {"/bit-put-mismatch", test_bit_put_mismatch, setup_bit, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/bit-cursor", test_bit_cursor, setup_bit, teardown,
@@ -390,4 +819,48 @@ MunitTest column_tests[] = {
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/str-cursor", test_str_cursor, setup_str, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
+    {"/bit-rle-cursor", test_bit_cursor, setup_bit_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i32-rle-cursor", test_i32_cursor, setup_i32_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i64-rle-cursor", test_i64_cursor, setup_i64_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/rle-runs", test_rle_runs, setup_i32_runs, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i32-for-cursor", test_i32_cursor, setup_i32_for, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i64-for-cursor", test_i64_cursor, setup_i64_for, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/for-timestamps", test_for_timestamps, setup_timestamps, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/dict-put", test_dict_put, setup_dict, teardown, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {"/dict-cursor", test_dict_cursor, setup_dict, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/str-offsets-cursor", test_str_cursor, setup_str_offsets, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/str-offsets-corrupt", test_str_offsets_corrupt, setup_str_offsets,
+     teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/dict-corrupt", test_dict_corrupt, setup_dict, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/encoding-select", test_encoding_select, NULL, NULL,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i32-wide-cursor", test_i32_wide_cursor, setup_i32, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i32-rle-wide-cursor", test_i32_wide_cursor, setup_i32_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/i32-for-wide-cursor", test_i32_wide_cursor, setup_i32_for, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/bit-wide-cursor", test_bit_wide_cursor, setup_bit, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/bit-rle-wide-cursor", test_bit_wide_cursor, setup_bit_rle, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/flt-xor-cursor", test_flt_cursor, setup_flt_xor, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/dbl-xor-cursor", test_dbl_cursor, setup_dbl_xor, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/flt-split-cursor", test_flt_cursor, setup_flt_split, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/dbl-split-cursor", test_dbl_cursor, setup_dbl_split, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
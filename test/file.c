@@ -1,6 +1,8 @@
 #define _BSD_SOURCE
+#include <inttypes.h>
 #include <stdio.h>
 
+#include "inverted.h"
 #include "reader.h"
 #include "row.h"
 #include "writer.h"
@@ -54,187 +56,999 @@ static void count_rows(struct cx_row_cursor *cursor, pthread_mutex_t *mutex,
     pthread_mutex_unlock(mutex);
 }
 
-static MunitResult test_read_write(const MunitParameter params[], void *ptr)
+static void read_write(const struct cx_file_fixture *fixture,
+                       enum cx_compression_type compression,
+                       const enum cx_encoding_type *encodings)
 {
-    struct cx_file_fixture *fixture = ptr;
-
-    enum cx_compression_type compression;
     int level = 5;
     char buffer[64];
 
     enum cx_column_type types[] = {CX_COLUMN_I32, CX_COLUMN_I64, CX_COLUMN_BIT,
                                    CX_COLUMN_STR, CX_COLUMN_FLT, CX_COLUMN_DBL};
 
-    CX_FOREACH(cx_compression_types, compression)
-    {
-        struct cx_writer *writer =
-            cx_writer_new(fixture->temp_file, ROWS_PER_ROW_GROUP);
-        assert_not_null(writer);
+    struct cx_writer *writer =
+        cx_writer_new(fixture->temp_file, ROWS_PER_ROW_GROUP);
+    assert_not_null(writer);
 
-        for (size_t i = 0; i < COLUMN_COUNT; i++) {
-            sprintf(buffer, "column %zu", i);
-            assert_true(cx_writer_add_column(writer, buffer, types[i], 0,
-                                             compression, level));
-        }
+    for (size_t i = 0; i < COLUMN_COUNT; i++) {
+        sprintf(buffer, "column %zu", i);
+        assert_true(cx_writer_add_column(writer, buffer, types[i],
+                                         encodings[i], compression, level));
+    }
 
-        for (size_t i = 0; i < ROW_COUNT; i++) {
-            assert_true(cx_writer_put_i32(writer, 0, i));
-            assert_true(cx_writer_put_i64(writer, 1, i * 10));
-            assert_true(cx_writer_put_bit(writer, 2, i % 3 == 0));
-            sprintf(buffer, "cx %zu", i);
+    for (size_t i = 0; i < ROW_COUNT; i++) {
+        assert_true(cx_writer_put_i32(writer, 0, i));
+        assert_true(cx_writer_put_i64(writer, 1, i * 10));
+        assert_true(cx_writer_put_bit(writer, 2, i % 3 == 0));
+        sprintf(buffer, "cx %zu", i);
 
-            if (i % 12 == 0)
-                assert_true(cx_writer_put_null(writer, 3));
-            else
-                assert_true(cx_writer_put_str(writer, 3, buffer));
+        if (i % 12 == 0)
+            assert_true(cx_writer_put_null(writer, 3));
+        else
+            assert_true(cx_writer_put_str(writer, 3, buffer));
 
-            assert_true(cx_writer_put_flt(writer, 4, (float)i / 10));
-            assert_true(cx_writer_put_dbl(writer, 5, (double)i / 100));
-        }
+        assert_true(cx_writer_put_flt(writer, 4, (float)i / 10));
+        assert_true(cx_writer_put_dbl(writer, 5, (double)i / 100));
+    }
 
-        assert_true(cx_writer_finish(writer, true));
+    assert_true(cx_writer_finish(writer, true));
 
-        assert_true(cx_writer_finish(writer, true));  // noop
+    assert_true(cx_writer_finish(writer, true));  // noop
 
-        cx_writer_free(writer);
+    cx_writer_free(writer);
 
-        // high-level reader
-        struct cx_reader *reader = cx_reader_new(fixture->temp_file);
-        assert_not_null(reader);
-        assert_size(cx_reader_column_count(reader), ==, COLUMN_COUNT);
-        assert_size(cx_reader_row_count(reader), ==, ROW_COUNT);
-        for (size_t i = 0; i < COLUMN_COUNT; i++) {
-            sprintf(buffer, "column %zu", i);
-            const char *name = cx_reader_column_name(reader, i);
-            assert_not_null(name);
-            assert_string_equal(name, buffer);
-
-            int compression_level = 0;
-            assert_int(cx_reader_column_type(reader, i), ==, types[i]);
-            assert_int(cx_reader_column_encoding(reader, i), ==, 0);
-            assert_int(
-                cx_reader_column_compression(reader, i, &compression_level), ==,
-                compression);
-            assert_int(compression_level, ==, level);
+    // high-level reader
+    struct cx_reader *reader = cx_reader_new(fixture->temp_file);
+    assert_not_null(reader);
+    assert_size(cx_reader_column_count(reader), ==, COLUMN_COUNT);
+    assert_size(cx_reader_row_count(reader), ==, ROW_COUNT);
+    for (size_t i = 0; i < COLUMN_COUNT; i++) {
+        sprintf(buffer, "column %zu", i);
+        const char *name = cx_reader_column_name(reader, i);
+        assert_not_null(name);
+        assert_string_equal(name, buffer);
+
+        int compression_level = 0;
+        assert_int(cx_reader_column_type(reader, i), ==, types[i]);
+        assert_int(cx_reader_column_encoding(reader, i), ==, encodings[i]);
+        assert_int(
+            cx_reader_column_compression(reader, i, &compression_level), ==,
+            compression);
+        assert_int(compression_level, ==, level);
+    }
+    size_t position = 0;
+    for (; cx_reader_next(reader); position++) {
+        cx_value_t value;
+        assert_true(cx_reader_get_i32(reader, 0, &value.i32));
+        assert_int32(value.i32, ==, position);
+        assert_true(cx_reader_get_i64(reader, 1, &value.i64));
+        assert_int64(value.i64, ==, position * 10);
+        assert_true(cx_reader_get_bit(reader, 2, &value.bit));
+        if (position % 3 == 0)
+            assert_true(value.bit);
+        else
+            assert_false(value.bit);
+
+        assert_true(cx_reader_get_null(reader, 3, &value.bit));
+        if (position % 12 == 0) {
+            assert_true(value.bit);
+        } else {
+            assert_false(value.bit);
+            assert_true(cx_reader_get_str(reader, 3, &value.str));
+            sprintf(buffer, "cx %zu", position);
+            assert_int(value.str.len, ==, strlen(buffer));
+            assert_string_equal(buffer, value.str.ptr);
         }
-        size_t position = 0;
-        for (; cx_reader_next(reader); position++) {
+        assert_true(cx_reader_get_flt(reader, 4, &value.flt));
+        assert_float(value.flt, ==, (float)position / 10);
+        assert_true(cx_reader_get_dbl(reader, 5, &value.dbl));
+        assert_float(value.dbl, ==, (double)position / 100);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, ROW_COUNT);
+    size_t count = 0;
+    assert_true(cx_reader_query(reader, 4, (void *)&count, count_rows));
+    assert_size(count, ==, ROW_COUNT);
+    cx_reader_free(reader);
+
+    // high-level reader matching rows
+    struct cx_predicate *predicate = cx_predicate_new_and(
+        5, cx_predicate_new_i32_gt(0, 20), cx_predicate_new_i64_lt(1, 900),
+        cx_predicate_new_bit_eq(2, true),
+        cx_predicate_negate(cx_predicate_new_null(3)),
+        cx_predicate_new_str_contains(3, "0", false, CX_STR_LOCATION_END));
+    assert_not_null(predicate);
+    reader = cx_reader_new_matching(fixture->temp_file, predicate);
+    assert_not_null(reader);
+    assert_false(cx_reader_set_batch_size(reader, 100));
+    assert_true(cx_reader_set_batch_size(reader, 1024));
+    assert_size(cx_reader_column_count(reader), ==, COLUMN_COUNT);
+    assert_size(cx_reader_row_count(reader), ==, 1);
+    assert_false(cx_reader_error(reader));
+    cx_reader_rewind(reader);
+    int32_t value;
+    assert_true(cx_reader_next(reader));
+    assert_true(cx_reader_get_i32(reader, 0, &value));
+    assert_int(value, ==, 30);
+    assert_false(cx_reader_next(reader));
+    assert_false(cx_reader_error(reader));
+    cx_reader_free(reader);
+
+    // low-level reader
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    assert_size(cx_row_group_reader_row_group_count(row_group_reader), ==,
+                ROW_GROUP_COUNT);
+    assert_size(cx_row_group_reader_column_count(row_group_reader), ==,
+                COLUMN_COUNT);
+    assert_size(cx_row_group_reader_row_count(row_group_reader), ==,
+                ROW_COUNT);
+    for (size_t i = 0; i < COLUMN_COUNT; i++) {
+        assert_int(cx_row_group_reader_column_type(row_group_reader, i), ==,
+                   types[i]);
+        assert_int(cx_row_group_reader_column_encoding(row_group_reader, i),
+                   ==, encodings[i]);
+
+        int compression_level = 0;
+        assert_int(cx_row_group_reader_column_compression(
+                       row_group_reader, i, &compression_level),
+                   ==, compression);
+        assert_int(compression_level, ==, level);
+    }
+    position = 0;
+    for (size_t i = 0; i < ROW_GROUP_COUNT; i++) {
+        struct cx_row_group *row_group =
+            cx_row_group_reader_get(row_group_reader, i);
+        assert_not_null(row_group);
+        for (size_t j = 0; j < COLUMN_COUNT; j++) {
+            enum cx_encoding_type encoding =
+                cx_row_group_column_encoding(row_group, j);
+            if (encodings[j] == CX_ENCODING_AUTO)
+                assert_int(encoding, !=, CX_ENCODING_AUTO);
+            else
+                assert_int(encoding, ==, encodings[j]);
+        }
+        // the null bitmap of columns without nulls is elided
+        assert_false(cx_row_group_null_index(row_group, 0)->max.bit);
+        const struct cx_column *nulls = cx_row_group_nulls(row_group, 0);
+        assert_not_null(nulls);
+        assert_size(cx_column_count(nulls), ==,
+                    cx_row_group_row_count(row_group));
+        struct cx_row_cursor *cursor =
+            cx_row_cursor_new(row_group, fixture->true_predicate);
+        assert_not_null(cursor);
+        for (; cx_row_cursor_next(cursor); position++) {
             cx_value_t value;
-            assert_true(cx_reader_get_i32(reader, 0, &value.i32));
+            assert_true(cx_row_cursor_get_null(cursor, 0, &value.bit));
+            assert_false(value.bit);
+            assert_true(cx_row_cursor_get_i32(cursor, 0, &value.i32));
             assert_int32(value.i32, ==, position);
-            assert_true(cx_reader_get_i64(reader, 1, &value.i64));
+            assert_true(cx_row_cursor_get_i64(cursor, 1, &value.i64));
             assert_int64(value.i64, ==, position * 10);
-            assert_true(cx_reader_get_bit(reader, 2, &value.bit));
+            assert_true(cx_row_cursor_get_bit(cursor, 2, &value.bit));
             if (position % 3 == 0)
                 assert_true(value.bit);
             else
                 assert_false(value.bit);
-
-            assert_true(cx_reader_get_null(reader, 3, &value.bit));
+            assert_true(cx_row_cursor_get_null(cursor, 3, &value.bit));
             if (position % 12 == 0) {
                 assert_true(value.bit);
             } else {
                 assert_false(value.bit);
-                assert_true(cx_reader_get_str(reader, 3, &value.str));
+                assert_true(cx_row_cursor_get_str(cursor, 3, &value.str));
                 sprintf(buffer, "cx %zu", position);
                 assert_int(value.str.len, ==, strlen(buffer));
                 assert_string_equal(buffer, value.str.ptr);
             }
-            assert_true(cx_reader_get_flt(reader, 4, &value.flt));
+            assert_true(cx_row_cursor_get_flt(cursor, 4, &value.flt));
             assert_float(value.flt, ==, (float)position / 10);
-            assert_true(cx_reader_get_dbl(reader, 5, &value.dbl));
+            assert_true(cx_row_cursor_get_dbl(cursor, 5, &value.dbl));
             assert_float(value.dbl, ==, (double)position / 100);
         }
-        assert_false(cx_reader_error(reader));
-        assert_size(position, ==, ROW_COUNT);
-        size_t count = 0;
-        assert_true(cx_reader_query(reader, 4, (void *)&count, count_rows));
-        assert_size(count, ==, ROW_COUNT);
-        cx_reader_free(reader);
+        cx_row_cursor_free(cursor);
+        cx_row_group_free(row_group);
+    }
+    assert_size(position, ==, ROW_GROUP_COUNT * ROWS_PER_ROW_GROUP);
+    cx_row_group_reader_free(row_group_reader);
+}
 
-        // high-level reader matching rows
-        struct cx_predicate *predicate = cx_predicate_new_and(
-            5, cx_predicate_new_i32_gt(0, 20), cx_predicate_new_i64_lt(1, 900),
-            cx_predicate_new_bit_eq(2, true),
-            cx_predicate_negate(cx_predicate_new_null(3)),
-            cx_predicate_new_str_contains(3, "0", false, CX_STR_LOCATION_END));
-        assert_not_null(predicate);
-        reader = cx_reader_new_matching(fixture->temp_file, predicate);
-        assert_not_null(reader);
-        assert_size(cx_reader_column_count(reader), ==, COLUMN_COUNT);
-        assert_size(cx_reader_row_count(reader), ==, 1);
-        assert_false(cx_reader_error(reader));
-        cx_reader_rewind(reader);
-        int32_t value;
-        assert_true(cx_reader_next(reader));
-        assert_true(cx_reader_get_i32(reader, 0, &value));
-        assert_int(value, ==, 30);
-        assert_false(cx_reader_next(reader));
-        assert_false(cx_reader_error(reader));
-        cx_reader_free(reader);
+static MunitResult test_read_write(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
 
-        // low-level reader
+    enum cx_compression_type compression;
+
+    enum cx_encoding_type encodings[][COLUMN_COUNT] = {
+        {CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE,
+         CX_ENCODING_NONE, CX_ENCODING_NONE},
+        {CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_DICT,
+         CX_ENCODING_NONE, CX_ENCODING_NONE},
+        {CX_ENCODING_RLE, CX_ENCODING_RLE, CX_ENCODING_RLE, CX_ENCODING_NONE,
+         CX_ENCODING_NONE, CX_ENCODING_NONE},
+        {CX_ENCODING_FOR, CX_ENCODING_FOR, CX_ENCODING_NONE, CX_ENCODING_DICT,
+         CX_ENCODING_NONE, CX_ENCODING_NONE},
+        {CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE,
+         CX_ENCODING_OFFSETS, CX_ENCODING_NONE, CX_ENCODING_NONE},
+        {CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE,
+         CX_ENCODING_XOR, CX_ENCODING_SPLIT},
+        {CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE,
+         CX_ENCODING_SPLIT, CX_ENCODING_XOR},
+        {CX_ENCODING_AUTO, CX_ENCODING_AUTO, CX_ENCODING_AUTO, CX_ENCODING_AUTO,
+         CX_ENCODING_AUTO, CX_ENCODING_AUTO}};
+
+    CX_FOREACH(cx_compression_types, compression)
+    {
+        for (size_t i = 0; i < sizeof(encodings) / sizeof(*encodings); i++)
+            read_write(fixture, compression, encodings[i]);
+    }
+
+    return MUNIT_OK;
+}
+
+// read the rows from start to end (exclusive) that match the predicate
+static void read_pages(const char *path, struct cx_predicate *predicate,
+                       size_t batch_size, size_t start, size_t end)
+{
+    struct cx_reader *reader = cx_reader_new_matching(path, predicate);
+    assert_not_null(reader);
+    assert_true(cx_reader_set_batch_size(reader, batch_size));
+    size_t position = start;
+    cx_value_t value;
+    for (; cx_reader_next(reader); position++) {
+        assert_true(cx_reader_get_i32(reader, 0, &value.i32));
+        assert_int32(value.i32, ==, position);
+        assert_true(cx_reader_get_i64(reader, 1, &value.i64));
+        assert_int64(value.i64, ==, position * 10);
+        assert_true(cx_reader_get_bit(reader, 2, &value.bit));
+        if (position / 100 % 2)
+            assert_true(value.bit);
+        else
+            assert_false(value.bit);
+        assert_true(cx_reader_get_null(reader, 3, &value.bit));
+        if (position % 7 == 0) {
+            assert_true(value.bit);
+        } else {
+            assert_false(value.bit);
+            char buffer[64];
+            sprintf(buffer, "cx %zu", position);
+            assert_true(cx_reader_get_str(reader, 3, &value.str));
+            assert_string_equal(buffer, value.str.ptr);
+        }
+        assert_true(cx_reader_get_dbl(reader, 4, &value.dbl));
+        assert_float(value.dbl, ==, (double)position / 100);
+        assert_true(cx_reader_get_str(reader, 5, &value.str));
+        const char *parity = position % 2 ? "odd" : "even";
+        assert_string_equal(value.str.ptr, parity);
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(position, ==, end);
+    cx_reader_free(reader);
+}
+
+static MunitResult test_pages(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    enum cx_column_type types[] = {CX_COLUMN_I32, CX_COLUMN_I64, CX_COLUMN_BIT,
+                                   CX_COLUMN_STR, CX_COLUMN_DBL, CX_COLUMN_STR};
+    enum cx_encoding_type encodings[] = {CX_ENCODING_NONE, CX_ENCODING_FOR,
+                                         CX_ENCODING_RLE,  CX_ENCODING_NONE,
+                                         CX_ENCODING_XOR,  CX_ENCODING_DICT};
+    size_t row_count = 2500;
+    enum cx_compression_type compression;
+
+    CX_FOREACH(cx_compression_types, compression)
+    {
+        struct cx_writer *writer = cx_writer_new(fixture->temp_file, 1000);
+        assert_not_null(writer);
+        assert_false(cx_writer_set_page_size(writer, 100));
+        assert_true(cx_writer_set_page_size(writer, 256));
+        for (size_t i = 0; i < COLUMN_COUNT; i++)
+            assert_true(cx_writer_add_column(writer, "foo", types[i],
+                                             encodings[i], compression, 5));
+        for (size_t i = 0; i < row_count; i++) {
+            char buffer[64];
+            assert_true(cx_writer_put_i32(writer, 0, i));
+            assert_true(cx_writer_put_i64(writer, 1, i * 10));
+            assert_true(cx_writer_put_bit(writer, 2, i / 100 % 2));
+            sprintf(buffer, "cx %zu", i);
+            if (i % 7 == 0)
+                assert_true(cx_writer_put_null(writer, 3));
+            else
+                assert_true(cx_writer_put_str(writer, 3, buffer));
+            assert_true(cx_writer_put_dbl(writer, 4, (double)i / 100));
+            assert_true(cx_writer_put_str(writer, 5, i % 2 ? "odd" : "even"));
+        }
+        assert_true(cx_writer_finish(writer, true));
+        cx_writer_free(writer);
+
+        // batches that don't divide the page size end at page boundaries
+        size_t batch_sizes[] = {64, 192, 1024};
+        size_t batch_size;
+        CX_FOREACH(batch_sizes, batch_size)
+        {
+            read_pages(fixture->temp_file, cx_predicate_new_true(), batch_size,
+                       0, row_count);
+            struct cx_predicate *predicate =
+                cx_predicate_new_and(2, cx_predicate_new_i32_eq(0, 1234),
+                                     cx_predicate_new_i64_gt(1, 12000));
+            assert_not_null(predicate);
+            read_pages(fixture->temp_file, predicate, batch_size, 1234, 1235);
+            // sorted columns are binary searched across pages
+            predicate = cx_predicate_new_and(
+                2, cx_predicate_new_i64_gt(1, 3000),
+                cx_predicate_new_dbl_lt(4, 5.5));
+            assert_not_null(predicate);
+            read_pages(fixture->temp_file, predicate, batch_size, 301, 550);
+        }
+
+        // the pages of a chunk can be read as one column
         struct cx_row_group_reader *row_group_reader =
             cx_row_group_reader_new(fixture->temp_file);
         assert_not_null(row_group_reader);
-        assert_size(cx_row_group_reader_row_group_count(row_group_reader), ==,
-                    ROW_GROUP_COUNT);
-        assert_size(cx_row_group_reader_column_count(row_group_reader), ==,
-                    COLUMN_COUNT);
-        assert_size(cx_row_group_reader_row_count(row_group_reader), ==,
-                    ROW_COUNT);
-        for (size_t i = 0; i < COLUMN_COUNT; i++) {
-            assert_int(cx_row_group_reader_column_type(row_group_reader, i), ==,
-                       types[i]);
-            assert_int(cx_row_group_reader_column_encoding(row_group_reader, i),
-                       ==, 0);
-
-            int compression_level = 0;
-            assert_int(cx_row_group_reader_column_compression(
-                           row_group_reader, i, &compression_level),
-                       ==, compression);
-            assert_int(compression_level, ==, level);
+        struct cx_row_group *row_group =
+            cx_row_group_reader_get(row_group_reader, 1);
+        assert_not_null(row_group);
+        assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+                   CX_ENCODING_FOR);
+        const struct cx_column *column = cx_row_group_column(row_group, 0);
+        assert_not_null(column);
+        assert_size(cx_column_count(column), ==, 1000);
+        size_t size;
+        const int32_t *values = cx_column_export(column, &size);
+        assert_size(size, ==, 1000 * sizeof(int32_t));
+        for (size_t i = 0; i < 1000; i++)
+            assert_int32(values[i], ==, 1000 + i);
+        cx_row_group_free(row_group);
+        cx_row_group_reader_free(row_group_reader);
+    }
+
+    return MUNIT_OK;
+}
+
+// count the row groups that the predicate can't rule out
+static size_t count_candidate_row_groups(const char *path,
+                                         struct cx_predicate *predicate)
+{
+    assert_not_null(predicate);
+    struct cx_row_group_reader *reader = cx_row_group_reader_new(path);
+    assert_not_null(reader);
+    size_t count = 0;
+    for (size_t i = 0; i < cx_row_group_reader_row_group_count(reader); i++) {
+        struct cx_row_group *row_group = cx_row_group_reader_get(reader, i);
+        assert_not_null(row_group);
+        count += cx_index_match_indexes(predicate, row_group) !=
+                 CX_INDEX_MATCH_NONE;
+        cx_row_group_free(row_group);
+    }
+    cx_row_group_reader_free(reader);
+    cx_predicate_free(predicate);
+    return count;
+}
+
+static MunitResult test_bloom_filters(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 1000);
+    assert_not_null(writer);
+    assert_true(cx_writer_set_page_size(writer, 256));
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_AUTO, CX_COMPRESSION_LZ4, 0));
+    assert_true(cx_writer_add_column(writer, "email", CX_COLUMN_STR,
+                                     CX_ENCODING_AUTO, CX_COMPRESSION_LZ4, 0));
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_AUTO, CX_COMPRESSION_LZ4, 0));
+    assert_true(cx_writer_add_column(writer, "score", CX_COLUMN_DBL,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_bloom_filter(writer, 0));
+    assert_true(cx_writer_add_bloom_filter(writer, 1));
+    assert_false(cx_writer_add_bloom_filter(writer, 3));
+    assert_false(cx_writer_add_bloom_filter(writer, 4));
+    // ids are scattered so that every row group spans the whole range
+    for (size_t i = 0; i < 10000; i++) {
+        int64_t id = (int64_t)(i * 7919 % 10000) * 1000003;
+        char buffer[64];
+        sprintf(buffer, "user%" PRIi64 "@example.com", id);
+        assert_true(cx_writer_put_i64(writer, 0, id));
+        assert_true(cx_writer_put_str(writer, 1, buffer));
+        assert_true(cx_writer_put_i64(writer, 2, id));
+        assert_true(cx_writer_put_dbl(writer, 3, i));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    const char *path = fixture->temp_file;
+    int64_t id = (int64_t)(1234 * 7919 % 10000) * 1000003;
+    char email[64];
+    sprintf(email, "user%" PRIi64 "@example.com", id);
+
+    size_t count =
+        count_candidate_row_groups(path, cx_predicate_new_i64_eq(0, id));
+    assert_size(count, ==, 1);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_eq(1, email, true));
+    assert_size(count, ==, 1);
+    count = count_candidate_row_groups(path, cx_predicate_new_i64_eq(0, 1));
+    assert_size(count, ==, 0);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_or(2, cx_predicate_new_i64_eq(0, id),
+                                  cx_predicate_new_i64_eq(0, id + 1000003)));
+    assert_size(count, <=, 2);
+
+    // columns without a filter, and case insensitive matches, can't be
+    // pruned
+    count = count_candidate_row_groups(path, cx_predicate_new_i64_eq(2, id));
+    assert_size(count, ==, 10);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_eq(1, email, false));
+    assert_size(count, ==, 10);
+
+    struct cx_predicate *predicate = cx_predicate_new_str_eq(1, email, true);
+    assert_not_null(predicate);
+    struct cx_reader *reader = cx_reader_new_matching(path, predicate);
+    assert_not_null(reader);
+    cx_value_t value;
+    assert_true(cx_reader_next(reader));
+    assert_true(cx_reader_get_i64(reader, 0, &value.i64));
+    assert_int64(value.i64, ==, id);
+    assert_true(cx_reader_get_dbl(reader, 3, &value.dbl));
+    assert_double(value.dbl, ==, 1234);
+    assert_false(cx_reader_next(reader));
+    assert_false(cx_reader_error(reader));
+    cx_reader_free(reader);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_trigram_filters(const MunitParameter params[],
+                                        void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 1000);
+    assert_not_null(writer);
+    assert_true(cx_writer_set_page_size(writer, 256));
+    assert_true(cx_writer_add_column(writer, "message", CX_COLUMN_STR,
+                                     CX_ENCODING_AUTO, CX_COMPRESSION_LZ4, 0));
+    assert_true(cx_writer_add_column(writer, "plain", CX_COLUMN_STR,
+                                     CX_ENCODING_AUTO, CX_COMPRESSION_LZ4, 0));
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_trigram_filter(writer, 0));
+    assert_false(cx_writer_add_trigram_filter(writer, 2));
+    assert_false(cx_writer_add_trigram_filter(writer, 3));
+    // one row group in ten logs a distinct error
+    for (size_t i = 0; i < 10000; i++) {
+        char buffer[64];
+        if (i / 1000 == 7)
+            sprintf(buffer, "request %zu failed: disk quota exceeded", i);
+        else
+            sprintf(buffer, "request %zu served in %zums", i, i % 97);
+        assert_true(cx_writer_put_str(writer, 0, buffer));
+        assert_true(cx_writer_put_str(writer, 1, buffer));
+        assert_true(cx_writer_put_i64(writer, 2, i));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    const char *path = fixture->temp_file;
+    size_t count = count_candidate_row_groups(
+        path, cx_predicate_new_str_contains(0, "quota", true,
+                                            CX_STR_LOCATION_ANY));
+    assert_size(count, ==, 1);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_contains(0, "Disk Quota", false,
+                                            CX_STR_LOCATION_ANY));
+    assert_size(count, ==, 1);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_contains(0, "exceeded", true,
+                                            CX_STR_LOCATION_END));
+    assert_size(count, ==, 1);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_contains(0, "timeout", true,
+                                            CX_STR_LOCATION_ANY));
+    assert_size(count, ==, 0);
+    count = count_candidate_row_groups(
+        path, cx_predicate_negate(cx_predicate_new_str_contains(
+                  0, "timeout", true, CX_STR_LOCATION_ANY)));
+    assert_size(count, ==, 10);
+
+    // columns without a filter, and short substrings, can't be pruned
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_contains(1, "quota", true,
+                                            CX_STR_LOCATION_ANY));
+    assert_size(count, ==, 10);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_contains(0, "zz", true,
+                                            CX_STR_LOCATION_ANY));
+    assert_size(count, ==, 10);
+
+    struct cx_predicate *predicate = cx_predicate_new_str_contains(
+        0, "quota", true, CX_STR_LOCATION_ANY);
+    assert_not_null(predicate);
+    struct cx_reader *reader = cx_reader_new_matching(path, predicate);
+    assert_not_null(reader);
+    size_t row_count = 0;
+    while (cx_reader_next(reader)) {
+        cx_value_t value;
+        assert_true(cx_reader_get_i64(reader, 2, &value.i64));
+        assert_int64(value.i64 / 1000, ==, 7);
+        row_count++;
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(row_count, ==, 1000);
+    cx_reader_free(reader);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_constant_columns(const MunitParameter params[],
+                                         void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    const char *long_string = "a string longer than the bounds";
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 1000);
+    assert_not_null(writer);
+    enum cx_column_type types[] = {CX_COLUMN_I64, CX_COLUMN_STR,
+                                   CX_COLUMN_I32, CX_COLUMN_I64,
+                                   CX_COLUMN_DBL, CX_COLUMN_BIT,
+                                   CX_COLUMN_STR, CX_COLUMN_I32};
+    for (size_t i = 0; i < 8; i++)
+        assert_true(cx_writer_add_column(writer, "column", types[i],
+                                         CX_ENCODING_AUTO, CX_COMPRESSION_LZ4,
+                                         0));
+    assert_true(cx_writer_add_bloom_filter(writer, 0));
+    assert_true(cx_writer_add_trigram_filter(writer, 1));
+    for (size_t i = 0; i < 10000; i++) {
+        size_t row_group = i / 1000;
+        assert_true(cx_writer_put_i64(writer, 0, row_group));
+        assert_true(cx_writer_put_str(writer, 1, row_group % 2 ? "eu-west-2"
+                                                               : "us-east-1"));
+        assert_true(cx_writer_put_i32(writer, 2, 3));
+        assert_true(cx_writer_put_i64(writer, 3, i));
+        assert_true(cx_writer_put_dbl(writer, 4, 0.5));
+        assert_true(cx_writer_put_bit(writer, 5, true));
+        assert_true(cx_writer_put_str(writer, 6, long_string));
+        if (i % 100)
+            assert_true(cx_writer_put_i32(writer, 7, 7));
+        else
+            assert_true(cx_writer_put_null(writer, 7));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    const char *path = fixture->temp_file;
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(path);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 3);
+    assert_not_null(row_group);
+    // long strings and chunks with nulls aren't elided
+    bool expected[] = {true, true, true, false, true, true, false, false};
+    for (size_t i = 0; i < 8; i++)
+        assert_int(cx_row_group_column_constant(row_group, i), ==,
+                   expected[i]);
+    size_t size;
+    assert_null(cx_row_group_column_bloom(row_group, 0, &size));
+    assert_null(cx_row_group_column_trigrams(row_group, 1, &size));
+
+    // constant chunks are served as one repeated batch
+    struct cx_row_group_cursor *cursor =
+        cx_row_group_cursor_new_batch(row_group, 64);
+    assert_not_null(cursor);
+    const int64_t *first = NULL;
+    size_t batch_count = 0;
+    while (cx_row_group_cursor_next(cursor)) {
+        size_t count;
+        const int64_t *values =
+            cx_row_group_cursor_batch_i64(cursor, 0, &count);
+        assert_not_null(values);
+        if (!first)
+            first = values;
+        assert_ptr_equal(values, first);
+        for (size_t i = 0; i < count; i++)
+            assert_int64(values[i], ==, 3);
+        const struct cx_string *strings =
+            cx_row_group_cursor_batch_str(cursor, 1, &count);
+        assert_not_null(strings);
+        for (size_t i = 0; i < count; i++)
+            assert_string_equal(strings[i].ptr, "eu-west-2");
+        batch_count += count;
+    }
+    assert_size(batch_count, ==, 1000);
+    cx_row_group_cursor_free(cursor);
+
+    // predicates are answered by the index
+    struct cx_predicate *predicate = cx_predicate_new_str_contains(
+        1, "west", true, CX_STR_LOCATION_ANY);
+    assert_not_null(predicate);
+    assert_int(cx_index_match_indexes(predicate, row_group), ==,
+               CX_INDEX_MATCH_ALL);
+    cx_predicate_free(predicate);
+    predicate = cx_predicate_new_str_lt(1, "eu", true);
+    assert_not_null(predicate);
+    assert_int(cx_index_match_indexes(predicate, row_group), ==,
+               CX_INDEX_MATCH_NONE);
+    cx_predicate_free(predicate);
+    predicate = cx_predicate_new_i32_eq(2, 3);
+    assert_not_null(predicate);
+    assert_int(cx_index_match_indexes(predicate, row_group), ==,
+               CX_INDEX_MATCH_ALL);
+    cx_predicate_free(predicate);
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
+
+    size_t count = count_candidate_row_groups(
+        path, cx_predicate_new_str_contains(1, "east", false,
+                                            CX_STR_LOCATION_ANY));
+    assert_size(count, ==, 5);
+
+    predicate = cx_predicate_new_and(
+        2, cx_predicate_new_str_eq(1, "eu-west-2", true),
+        cx_predicate_new_i64_gt(0, 4));
+    assert_not_null(predicate);
+    struct cx_reader *reader = cx_reader_new_matching(path, predicate);
+    assert_not_null(reader);
+    size_t row_count = 0;
+    while (cx_reader_next(reader)) {
+        cx_value_t value;
+        struct cx_string string;
+        bool null;
+        assert_true(cx_reader_get_i64(reader, 0, &value.i64));
+        assert_true(value.i64 == 5 || value.i64 == 7 || value.i64 == 9);
+        assert_true(cx_reader_get_i64(reader, 3, &value.i64));
+        int64_t parity = value.i64 / 1000 % 2;
+        assert_int64(parity, ==, 1);
+        assert_true(cx_reader_get_str(reader, 1, &string));
+        assert_string_equal(string.ptr, "eu-west-2");
+        assert_true(cx_reader_get_i32(reader, 2, &value.i32));
+        assert_int32(value.i32, ==, 3);
+        assert_true(cx_reader_get_dbl(reader, 4, &value.dbl));
+        assert_double(value.dbl, ==, 0.5);
+        assert_true(cx_reader_get_bit(reader, 5, &value.bit));
+        assert_true(value.bit);
+        assert_true(cx_reader_get_str(reader, 6, &string));
+        assert_string_equal(string.ptr, long_string);
+        assert_true(cx_reader_get_null(reader, 7, &null));
+        if (!null) {
+            assert_true(cx_reader_get_i32(reader, 7, &value.i32));
+            assert_int32(value.i32, ==, 7);
         }
-        position = 0;
-        for (size_t i = 0; i < ROW_GROUP_COUNT; i++) {
-            struct cx_row_group *row_group =
-                cx_row_group_reader_get(row_group_reader, i);
-            assert_not_null(row_group);
-            struct cx_row_cursor *cursor =
-                cx_row_cursor_new(row_group, fixture->true_predicate);
-            assert_not_null(cursor);
-            for (; cx_row_cursor_next(cursor); position++) {
-                cx_value_t value;
-                assert_true(cx_row_cursor_get_i32(cursor, 0, &value.i32));
-                assert_int32(value.i32, ==, position);
-                assert_true(cx_row_cursor_get_i64(cursor, 1, &value.i64));
-                assert_int64(value.i64, ==, position * 10);
-                assert_true(cx_row_cursor_get_bit(cursor, 2, &value.bit));
-                if (position % 3 == 0)
-                    assert_true(value.bit);
-                else
-                    assert_false(value.bit);
-                assert_true(cx_row_cursor_get_null(cursor, 3, &value.bit));
-                if (position % 12 == 0) {
-                    assert_true(value.bit);
-                } else {
-                    assert_false(value.bit);
-                    assert_true(cx_row_cursor_get_str(cursor, 3, &value.str));
-                    sprintf(buffer, "cx %zu", position);
-                    assert_int(value.str.len, ==, strlen(buffer));
-                    assert_string_equal(buffer, value.str.ptr);
-                }
-                assert_true(cx_row_cursor_get_flt(cursor, 4, &value.flt));
-                assert_float(value.flt, ==, (float)position / 10);
-                assert_true(cx_row_cursor_get_dbl(cursor, 5, &value.dbl));
-                assert_float(value.dbl, ==, (double)position / 100);
+        row_count++;
+    }
+    assert_false(cx_reader_error(reader));
+    assert_size(row_count, ==, 3000);
+    cx_reader_free(reader);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_string_bounds(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 1000);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "key", CX_COLUMN_STR,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_LZ4, 0));
+    for (size_t i = 0; i < 10000; i++) {
+        char buffer[64];
+        sprintf(buffer, "/objects/%06zu", i);
+        assert_true(cx_writer_put_str(writer, 0, buffer));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    // row groups of sorted keys can be skipped by range and prefix
+    const char *path = fixture->temp_file;
+    size_t count = count_candidate_row_groups(
+        path, cx_predicate_new_str_eq(0, "/objects/004321", true));
+    assert_size(count, ==, 1);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_gt(0, "/objects/008500", true));
+    assert_size(count, ==, 2);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_and(
+                  2, cx_predicate_new_str_gt(0, "/objects/002000", true),
+                  cx_predicate_new_str_lt(0, "/objects/003999", true)));
+    assert_size(count, ==, 2);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_contains(0, "/objects/0071", true,
+                                            CX_STR_LOCATION_START));
+    assert_size(count, ==, 1);
+    count = count_candidate_row_groups(
+        path, cx_predicate_new_str_gt(0, "/OBJECTS/008500", false));
+    assert_size(count, ==, 10);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_file_index(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 100);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "day", CX_COLUMN_I32,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_column(writer, "event", CX_COLUMN_STR,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    for (size_t i = 0; i < 1000; i++) {
+        assert_true(cx_writer_put_i32(writer, 0, 20240 + i / 100));
+        if (i % 4 == 0)
+            assert_true(cx_writer_put_null(writer, 1));
+        else
+            assert_true(cx_writer_put_str(writer, 1, i % 2 ? "view" : "click"));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *summary =
+        cx_row_group_reader_summary(row_group_reader);
+    assert_not_null(summary);
+    assert_size(cx_row_group_row_count(summary), ==, 1000);
+    const struct cx_index *index = cx_row_group_column_index(summary, 0);
+    assert_int32(index->min.i32, ==, 20240);
+    assert_int32(index->max.i32, ==, 20249);
+    assert_uint64(index->null_count, ==, 0);
+    index = cx_row_group_column_index(summary, 1);
+    assert_uint64(index->null_count, ==, 250);
+    assert_memory_equal(index->upper_len, index->upper, "view");
+    cx_row_group_free(summary);
+    cx_row_group_reader_free(row_group_reader);
+
+    // the file is skipped if its index rules out the predicate
+    struct cx_predicate *predicate = cx_predicate_new_i32_eq(0, 20250);
+    assert_not_null(predicate);
+    struct cx_reader *reader =
+        cx_reader_new_matching(fixture->temp_file, predicate);
+    assert_not_null(reader);
+    assert_false(cx_reader_may_match(reader));
+    assert_false(cx_reader_next(reader));
+    assert_false(cx_reader_error(reader));
+    assert_size(cx_reader_row_count(reader), ==, 0);
+    cx_reader_free(reader);
+
+    predicate = cx_predicate_new_str_eq(1, "purchase", true);
+    assert_not_null(predicate);
+    reader = cx_reader_new_matching(fixture->temp_file, predicate);
+    assert_not_null(reader);
+    assert_false(cx_reader_may_match(reader));
+    cx_reader_free(reader);
+
+    predicate = cx_predicate_new_and(2, cx_predicate_new_i32_gt(0, 20248),
+                                     cx_predicate_new_null(1));
+    assert_not_null(predicate);
+    reader = cx_reader_new_matching(fixture->temp_file, predicate);
+    assert_not_null(reader);
+    assert_true(cx_reader_may_match(reader));
+    assert_size(cx_reader_row_count(reader), ==, 25);
+    cx_reader_free(reader);
+
+    // predicates are still validated
+    predicate = cx_predicate_new_i64_eq(0, 20250);
+    assert_not_null(predicate);
+    assert_null(cx_reader_new_matching(fixture->temp_file, predicate));
+    cx_predicate_free(predicate);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_row_group_stats(const MunitParameter params[],
+                                        void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 10);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_column(writer, "score", CX_COLUMN_DBL,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    for (int64_t i = 0; i < 1000; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i));
+        assert_true(cx_writer_put_dbl(writer, 1, (double)(i % 10) / 10));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    assert_size(cx_row_group_reader_row_group_count(row_group_reader), ==, 100);
+    struct cx_index_stats *stats = cx_row_group_reader_stats(row_group_reader);
+    assert_not_null(stats);
+    assert_int(stats[0].type, ==, CX_COLUMN_I64);
+    assert_int64(stats[0].min[42].i64, ==, 420);
+    assert_int64(stats[0].max[42].i64, ==, 429);
+    assert_double(stats[1].min[42].dbl, ==, 0);
+    assert_double(stats[1].max[42].dbl, ==, 0.9);
+    free(stats);
+    cx_row_group_reader_free(row_group_reader);
+
+    struct cx_predicate *predicate = cx_predicate_new_or(
+        2, cx_predicate_new_i64_lt(0, 15), cx_predicate_new_i64_gt(0, 994));
+    assert_not_null(predicate);
+    struct cx_reader *reader =
+        cx_reader_new_matching(fixture->temp_file, predicate);
+    assert_not_null(reader);
+    int64_t expected = 0, value;
+    while (cx_reader_next(reader)) {
+        assert_true(cx_reader_get_i64(reader, 0, &value));
+        assert_int64(value, ==, expected);
+        expected = expected == 14 ? 995 : expected + 1;
+    }
+    assert_false(cx_reader_error(reader));
+    assert_int64(expected, ==, 1000);
+    assert_size(cx_reader_row_count(reader), ==, 20);
+    cx_reader_free(reader);
+
+    predicate = cx_predicate_new_and(2, cx_predicate_new_i64_gt(0, 500),
+                                     cx_predicate_new_dbl_gt(1, 0.85));
+    assert_not_null(predicate);
+    reader = cx_reader_new_matching(fixture->temp_file, predicate);
+    assert_not_null(reader);
+    assert_size(cx_reader_row_count(reader), ==, 50);
+    cx_reader_free(reader);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_inverted_index(const MunitParameter params[],
+                                       void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 100);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "user", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_column(writer, "score", CX_COLUMN_DBL,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    assert_false(cx_writer_add_inverted_index(writer, 1));
+    assert_false(cx_writer_add_inverted_index(writer, 2));
+    assert_true(cx_writer_add_inverted_index(writer, 0));
+    // user ids are scattered, so every row group spans the whole range
+    for (int64_t i = 0; i < 2000; i++) {
+        assert_true(cx_writer_put_i64(writer, 0, i * 7919 % 2003));
+        assert_true(cx_writer_put_dbl(writer, 1, i));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    size_t len = strlen(fixture->temp_file);
+    char sidecar[64];
+    assert_size(len + sizeof(CX_INVERTED_SUFFIX), <=, sizeof(sidecar));
+    memcpy(sidecar, fixture->temp_file, len);
+    memcpy(sidecar + len, CX_INVERTED_SUFFIX, sizeof(CX_INVERTED_SUFFIX));
+    assert_int(access(sidecar, F_OK), ==, 0);
+
+    struct cx_predicate *predicate = cx_predicate_new_or(
+        2, cx_predicate_new_i64_eq(0, 7919 % 2003),
+        cx_predicate_new_i64_eq(0, 1999 * 7919 % 2003));
+    assert_not_null(predicate);
+    struct cx_reader *reader =
+        cx_reader_new_matching(fixture->temp_file, predicate);
+    assert_not_null(reader);
+    double score;
+    assert_true(cx_reader_next(reader));
+    assert_true(cx_reader_get_dbl(reader, 1, &score));
+    assert_double(score, ==, 1);
+    assert_true(cx_reader_next(reader));
+    assert_true(cx_reader_get_dbl(reader, 1, &score));
+    assert_double(score, ==, 1999);
+    assert_false(cx_reader_next(reader));
+    assert_false(cx_reader_error(reader));
+    cx_reader_free(reader);
+
+    predicate = cx_predicate_new_i64_eq(0, 93);
+    assert_not_null(predicate);
+    reader = cx_reader_new_matching(fixture->temp_file, predicate);
+    assert_not_null(reader);
+    assert_size(cx_reader_row_count(reader), ==, 0);
+    cx_reader_free(reader);
+
+    // rewriting the file without an inverted index removes the sidecar
+    writer = cx_writer_new(fixture->temp_file, 100);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "user", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_put_i64(writer, 0, 1));
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+    assert_int(access(sidecar, F_OK), !=, 0);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rewrite(const MunitParameter params[], void *ptr)
+{
+    struct cx_file_fixture *fixture = ptr;
+
+    struct cx_writer *writer = cx_writer_new(fixture->temp_file, 100);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "a", CX_COLUMN_I32,
+                                     CX_ENCODING_RLE, CX_COMPRESSION_LZ4, 0));
+    assert_true(cx_writer_add_column(writer, "b", CX_COLUMN_STR,
+                                     CX_ENCODING_DICT, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_add_column(writer, "c", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    for (size_t i = 0; i < 100; i++) {
+        char buffer[64];
+        sprintf(buffer, "cx %zu", i % 5);
+        assert_true(cx_writer_put_i32(writer, 0, i / 10));
+        assert_true(cx_writer_put_str(writer, 1, buffer));
+        assert_true(cx_writer_put_i64(writer, 2, i * 3));
+    }
+    assert_true(cx_writer_finish(writer, true));
+    cx_writer_free(writer);
+
+    struct cx_row_group_reader *row_group_reader =
+        cx_row_group_reader_new(fixture->temp_file);
+    assert_not_null(row_group_reader);
+    struct cx_row_group *row_group =
+        cx_row_group_reader_get(row_group_reader, 0);
+    assert_not_null(row_group);
+    assert_int(cx_row_group_column_encoding(row_group, 0), ==,
+               CX_ENCODING_RLE);
+    assert_int(cx_row_group_column_encoding(row_group, 1), ==,
+               CX_ENCODING_DICT);
+
+    // columns read from another file are re-encoded as the descriptor says
+    enum cx_encoding_type encodings[][3] = {
+        {CX_ENCODING_NONE, CX_ENCODING_NONE, CX_ENCODING_NONE},
+        {CX_ENCODING_FOR, CX_ENCODING_OFFSETS, CX_ENCODING_RLE},
+        {CX_ENCODING_RLE, CX_ENCODING_DICT, CX_ENCODING_AUTO}};
+    enum cx_column_type types[] = {CX_COLUMN_I32, CX_COLUMN_STR,
+                                   CX_COLUMN_I64};
+    size_t page_sizes[] = {0, 64};
+    char *path = cx_temp_file_new();
+    assert_not_null(path);
+    for (size_t i = 0; i < sizeof(encodings) / sizeof(*encodings); i++) {
+        for (size_t j = 0; j < sizeof(page_sizes) / sizeof(*page_sizes); j++) {
+            struct cx_row_group_writer *row_group_writer =
+                cx_row_group_writer_new(path);
+            assert_not_null(row_group_writer);
+            assert_true(cx_row_group_writer_set_page_size(row_group_writer,
+                                                          page_sizes[j]));
+            for (size_t k = 0; k < 3; k++)
+                assert_true(cx_row_group_writer_add_column(
+                    row_group_writer, "foo", types[k], encodings[i][k],
+                    CX_COMPRESSION_ZSTD, 0));
+            assert_true(cx_row_group_writer_put(row_group_writer, row_group));
+            assert_true(cx_row_group_writer_finish(row_group_writer, true));
+            cx_row_group_writer_free(row_group_writer);
+
+            struct cx_reader *reader = cx_reader_new(path);
+            assert_not_null(reader);
+            size_t position = 0;
+            cx_value_t value;
+            for (; cx_reader_next(reader); position++) {
+                char buffer[64];
+                sprintf(buffer, "cx %zu", position % 5);
+                assert_true(cx_reader_get_i32(reader, 0, &value.i32));
+                assert_int32(value.i32, ==, position / 10);
+                assert_true(cx_reader_get_str(reader, 1, &value.str));
+                assert_string_equal(value.str.ptr, buffer);
+                assert_true(cx_reader_get_i64(reader, 2, &value.i64));
+                assert_int64(value.i64, ==, position * 3);
             }
-            cx_row_cursor_free(cursor);
-            cx_row_group_free(row_group);
+            assert_false(cx_reader_error(reader));
+            assert_size(position, ==, 100);
+            cx_reader_free(reader);
         }
-        assert_size(position, ==, ROW_GROUP_COUNT * ROWS_PER_ROW_GROUP);
-        cx_row_group_reader_free(row_group_reader);
     }
+    cx_temp_file_free(path);
+
+    cx_row_group_free(row_group);
+    cx_row_group_reader_free(row_group_reader);
 
     return MUNIT_OK;
 }
@@ -419,6 +1233,22 @@ static MunitResult test_metadata(const MunitParameter params[], void *ptr)
 MunitTest file_tests[] = {
     {"/read-write", test_read_write, setup, teardown, MUNIT_TEST_OPTION_NONE,
      NULL},
+    {"/pages", test_pages, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/bloom-filters", test_bloom_filters, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/trigram-filters", test_trigram_filters, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/constant-columns", test_constant_columns, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/string-bounds", test_string_bounds, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/file-index", test_file_index, setup, teardown, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {"/row-group-stats", test_row_group_stats, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/inverted-index", test_inverted_index, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/rewrite", test_rewrite, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
     {"/no-row-groups", test_no_row_groups, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/no-columns", test_no_columns, setup, teardown, MUNIT_TEST_OPTION_NONE,
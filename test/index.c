@@ -1,6 +1,7 @@
 #define __STDC_LIMIT_MACROS
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "index.h"
 
@@ -242,9 +243,226 @@ static MunitResult test_str_index(const MunitParameter params[], void *fixture)
     return MUNIT_OK;
 }
 
+static enum cx_index_match match_str(
+    enum cx_index_match (*match)(const struct cx_index *,
+                                 const struct cx_string *),
+    const struct cx_index *index, const char *value)
+{
+    struct cx_string string = {value, strlen(value)};
+    return match(index, &string);
+}
+
+static MunitResult test_str_bounds(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *col = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(col);
+    assert_true(cx_column_put_str(col, "cherry"));
+    assert_true(cx_column_put_str(col, "banana"));
+    assert_true(cx_column_put_str(col, "date"));
+
+    struct cx_index *index = cx_index_new(col);
+    assert_not_null(index);
+    assert_int(index->flags, ==, CX_INDEX_LOWER_BOUND | CX_INDEX_UPPER_BOUND);
+    assert_memory_equal(index->lower_len, index->lower, "banana");
+    assert_memory_equal(index->upper_len, index->upper, "date");
+
+    assert_int(match_str(cx_index_match_str_eq, index, "apple"), ==,
+               CX_INDEX_MATCH_NONE);
+    assert_int(match_str(cx_index_match_str_eq, index, "cherry"), ==,
+               CX_INDEX_MATCH_UNKNOWN);
+    assert_int(match_str(cx_index_match_str_eq, index, "elder"), ==,
+               CX_INDEX_MATCH_NONE);
+    assert_int(match_str(cx_index_match_str_lt, index, "banana"), ==,
+               CX_INDEX_MATCH_NONE);
+    assert_int(match_str(cx_index_match_str_lt, index, "cherry"), ==,
+               CX_INDEX_MATCH_UNKNOWN);
+    assert_int(match_str(cx_index_match_str_lt, index, "dates"), ==,
+               CX_INDEX_MATCH_ALL);
+    assert_int(match_str(cx_index_match_str_gt, index, "date"), ==,
+               CX_INDEX_MATCH_NONE);
+    assert_int(match_str(cx_index_match_str_gt, index, "cherry"), ==,
+               CX_INDEX_MATCH_UNKNOWN);
+    assert_int(match_str(cx_index_match_str_gt, index, "apple"), ==,
+               CX_INDEX_MATCH_ALL);
+    assert_int(match_str(cx_index_match_str_starts_with, index, "a"), ==,
+               CX_INDEX_MATCH_NONE);
+    assert_int(match_str(cx_index_match_str_starts_with, index, "e"), ==,
+               CX_INDEX_MATCH_NONE);
+    assert_int(match_str(cx_index_match_str_starts_with, index, "ch"), ==,
+               CX_INDEX_MATCH_UNKNOWN);
+    cx_index_free(index);
+    cx_column_free(col);
+
+    // long values are truncated, and the maximum is rounded up
+    col = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(col);
+    assert_true(
+        cx_column_put_str(col, "user/0000/aaaaaaaaaaaaaaaaaaaaaaaaaaaa"));
+    assert_true(cx_column_put_str(col, "user/0000/zzzzzzzzzzzzz\xff\xff\xff"));
+    index = cx_index_new(col);
+    assert_not_null(index);
+    assert_int(index->flags, ==, CX_INDEX_LOWER_BOUND | CX_INDEX_UPPER_BOUND);
+    assert_memory_equal(CX_INDEX_PREFIX_SIZE, index->lower,
+                        "user/0000/aaaaaaaaaaaaaa");
+    assert_memory_equal(index->upper_len, index->upper,
+                        "user/0000/zzzzzzzzzzzz{");
+    assert_int(match_str(cx_index_match_str_eq, index,
+                         "user/0000/zzzzzzzzzzzzzzzzzzzzzzz"),
+               ==, CX_INDEX_MATCH_UNKNOWN);
+    assert_int(
+        match_str(cx_index_match_str_gt, index, "user/0000/zzzzzzzzzzzz{"),
+        ==, CX_INDEX_MATCH_NONE);
+    assert_int(
+        match_str(cx_index_match_str_gt, index, "user/0000/zzzzzzzzzzzzz"),
+        ==, CX_INDEX_MATCH_UNKNOWN);
+    assert_int(match_str(cx_index_match_str_starts_with, index, "user/0000/"),
+               ==, CX_INDEX_MATCH_ALL);
+    assert_int(match_str(cx_index_match_str_starts_with, index, "user/0001/"),
+               ==, CX_INDEX_MATCH_NONE);
+    cx_index_free(index);
+    cx_column_free(col);
+
+    // an equal lower and upper bound matches every value
+    col = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(col);
+    assert_true(cx_column_put_str(col, "foo"));
+    assert_true(cx_column_put_str(col, "foo"));
+    index = cx_index_new(col);
+    assert_not_null(index);
+    assert_int(match_str(cx_index_match_str_eq, index, "foo"), ==,
+               CX_INDEX_MATCH_ALL);
+    assert_int(match_str(cx_index_match_str_eq, index, "bar"), ==,
+               CX_INDEX_MATCH_NONE);
+    cx_index_free(index);
+    cx_column_free(col);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_counts(const MunitParameter params[], void *fixture)
+{
+    struct cx_column *col = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    assert_not_null(col);
+    struct cx_column *nulls = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+    assert_not_null(nulls);
+    for (int64_t i = 0; i < 20000; i++) {
+        assert_true(cx_column_put_i64(col, i % 5000));
+        assert_true(cx_column_put_bit(nulls, i % 10 == 0));
+    }
+
+    struct cx_index *index = cx_index_new(col);
+    assert_not_null(index);
+    assert_uint64(index->null_count, ==, 0);
+    assert_uint64(index->distinct_count, >, 4750);
+    assert_uint64(index->distinct_count, <, 5250);
+    assert_int(cx_index_match_null(index), ==, CX_INDEX_MATCH_NONE);
+
+    assert_true(cx_index_count_nulls(index, nulls, 0));
+    assert_uint64(index->null_count, ==, 2000);
+    assert_int(cx_index_match_null(index), ==, CX_INDEX_MATCH_UNKNOWN);
+    // the null bitmap of a page starts at a multiple of 64 rows
+    index->count = 100;
+    assert_true(cx_index_count_nulls(index, nulls, 640));
+    assert_uint64(index->null_count, ==, 10);
+    index->count = 200;
+    assert_false(cx_index_count_nulls(index, nulls, 19840));
+    cx_index_free(index);
+
+    // small cardinalities are exact
+    struct cx_column *strs = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(strs);
+    const char *values[] = {"foo", "bar", "baz", "foo", "bar"};
+    for (size_t i = 0; i < 5; i++)
+        assert_true(cx_column_put_str(strs, values[i]));
+    index = cx_index_new(strs);
+    assert_not_null(index);
+    assert_uint64(index->distinct_count, ==, 3);
+    cx_index_free(index);
+
+    cx_column_free(strs);
+    cx_column_free(nulls);
+    cx_column_free(col);
+    return MUNIT_OK;
+}
+
+static MunitResult test_histogram(const MunitParameter params[],
+                                  void *fixture)
+{
+    // uniform values
+    struct cx_column *col = cx_column_new(CX_COLUMN_I32, CX_ENCODING_NONE);
+    assert_not_null(col);
+    for (int32_t i = 0; i < 10000; i++)
+        assert_true(cx_column_put_i32(col, i));
+    struct cx_index *index = cx_index_new(col);
+    assert_not_null(index);
+    assert_true(index->flags & CX_INDEX_HISTOGRAM);
+    int32_t previous = index->min.i32;
+    for (size_t i = 0; i < CX_INDEX_HISTOGRAM_BUCKETS - 1; i++) {
+        assert_int32(index->quantiles[i].i32, >, previous);
+        previous = index->quantiles[i].i32;
+    }
+    assert_int32(previous, <, index->max.i32);
+    double fraction =
+        cx_index_histogram_fraction(index, CX_COLUMN_I32, 2500, false);
+    assert_double(fraction, >, 0.24);
+    assert_double(fraction, <, 0.26);
+    fraction = cx_index_histogram_fraction(index, CX_COLUMN_I32, 9000, true);
+    assert_double(fraction, >, 0.89);
+    assert_double(fraction, <, 0.91);
+    assert_double(cx_index_histogram_fraction(index, CX_COLUMN_I32, -1, true),
+                  ==, 0);
+    assert_double(
+        cx_index_histogram_fraction(index, CX_COLUMN_I32, 10000, false), ==,
+        1);
+
+    // histograms aren't merged
+    struct cx_index *merged = cx_index_new(col);
+    assert_not_null(merged);
+    cx_index_merge(merged, index, CX_COLUMN_I32);
+    assert_false(merged->flags & CX_INDEX_HISTOGRAM);
+    assert_double(
+        cx_index_histogram_fraction(merged, CX_COLUMN_I32, 2500, false), <, 0);
+    cx_index_free(merged);
+    cx_index_free(index);
+    cx_column_free(col);
+
+    // skewed values, where the first 90% are zero
+    col = cx_column_new(CX_COLUMN_DBL, CX_ENCODING_NONE);
+    assert_not_null(col);
+    for (size_t i = 0; i < 10000; i++)
+        assert_true(cx_column_put_dbl(col, i < 9000 ? 0 : i));
+    index = cx_index_new(col);
+    assert_not_null(index);
+    assert_true(index->flags & CX_INDEX_HISTOGRAM);
+    double below =
+        cx_index_histogram_fraction(index, CX_COLUMN_DBL, 0, false);
+    double at_most = cx_index_histogram_fraction(index, CX_COLUMN_DBL, 0, true);
+    assert_double(below, ==, 0);
+    assert_double(at_most, >=, 0.85);
+    assert_double(cx_index_histogram_fraction(index, CX_COLUMN_DBL, 5000, true),
+                  >, at_most);
+    cx_index_free(index);
+    cx_column_free(col);
+
+    // there are no histograms for other types
+    col = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(col);
+    assert_true(cx_column_put_str(col, "foo"));
+    index = cx_index_new(col);
+    assert_not_null(index);
+    assert_false(index->flags & CX_INDEX_HISTOGRAM);
+    cx_index_free(index);
+    cx_column_free(col);
+
+    return MUNIT_OK;
+}
+
 MunitTest index_tests[] = {
     {"/bit-index", test_bit_index, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/i32-index", test_i32_index, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/i64-index", test_i64_index, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/str-index", test_str_index, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/str-bounds", test_str_bounds, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/counts", test_counts, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/histogram", test_histogram, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
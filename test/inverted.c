@@ -0,0 +1,197 @@
+#define _BSD_SOURCE
+#include <stdio.h>
+
+#include "bloom.h"
+#include "inverted.h"
+#include "predicate.h"
+#include "writer.h"
+
+#include "helpers.h"
+#include "temp_file.h"
+
+#define ROW_GROUP_COUNT 4
+
+struct cx_inverted_fixture {
+    char *temp_file;
+    char *sidecar;
+};
+
+static void *setup(const MunitParameter params[], void *data)
+{
+    struct cx_inverted_fixture *fixture = malloc(sizeof(*fixture));
+    assert_not_null(fixture);
+    fixture->temp_file = cx_temp_file_new();
+    assert_not_null(fixture->temp_file);
+    size_t len = strlen(fixture->temp_file);
+    fixture->sidecar = malloc(len + sizeof(CX_INVERTED_SUFFIX));
+    assert_not_null(fixture->sidecar);
+    memcpy(fixture->sidecar, fixture->temp_file, len);
+    memcpy(fixture->sidecar + len, CX_INVERTED_SUFFIX,
+           sizeof(CX_INVERTED_SUFFIX));
+    return fixture;
+}
+
+static void teardown(void *ptr)
+{
+    struct cx_inverted_fixture *fixture = ptr;
+    unlink(fixture->sidecar);
+    free(fixture->sidecar);
+    cx_temp_file_free(fixture->temp_file);
+    free(fixture);
+}
+
+// sidecars are tied to the columnix file they were written for
+static void write_file(const char *path, int64_t value)
+{
+    struct cx_writer *writer = cx_writer_new(path, 100);
+    assert_not_null(writer);
+    assert_true(cx_writer_add_column(writer, "id", CX_COLUMN_I64,
+                                     CX_ENCODING_NONE, CX_COMPRESSION_NONE, 0));
+    assert_true(cx_writer_put_i64(writer, 0, value));
+    assert_true(cx_writer_finish(writer, false));
+    cx_writer_free(writer);
+}
+
+// row group i has ids [i * 10, i * 10 + 20) and the name "rg<i / 2>"
+static void write_index(const char *path)
+{
+    write_file(path, 0);
+    struct cx_inverted_writer *writer = cx_inverted_writer_new();
+    assert_not_null(writer);
+    for (size_t i = 0; i < ROW_GROUP_COUNT; i++) {
+        struct cx_column *ids = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+        assert_not_null(ids);
+        struct cx_column *names =
+            cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+        assert_not_null(names);
+        char buffer[16];
+        sprintf(buffer, "rg%zu", i / 2);
+        for (int64_t id = i * 10; id < i * 10 + 20; id++) {
+            assert_true(cx_column_put_i64(ids, id));
+            assert_true(cx_column_put_str(names, buffer));
+        }
+        assert_true(cx_inverted_writer_add(writer, 0, ids, i));
+        assert_true(cx_inverted_writer_add(writer, 2, names, i));
+        cx_column_free(ids);
+        cx_column_free(names);
+    }
+    assert_true(
+        cx_inverted_writer_finish(writer, path, ROW_GROUP_COUNT, 1000));
+    cx_inverted_writer_free(writer);
+}
+
+static MunitResult test_lookup(const MunitParameter params[], void *ptr)
+{
+    struct cx_inverted_fixture *fixture = ptr;
+
+    // there's no sidecar yet
+    assert_null(cx_inverted_index_new(fixture->temp_file, ROW_GROUP_COUNT,
+                                      1000));
+
+    write_index(fixture->temp_file);
+
+    // stale sidecars are ignored
+    assert_null(cx_inverted_index_new(fixture->temp_file, ROW_GROUP_COUNT,
+                                      1001));
+    assert_null(cx_inverted_index_new(fixture->temp_file,
+                                      ROW_GROUP_COUNT + 1, 1000));
+
+    // and so are sidecars written for another file of the same shape
+    char backup[256];
+    snprintf(backup, sizeof(backup), "%s.bak", fixture->sidecar);
+    assert_int(rename(fixture->sidecar, backup), ==, 0);
+    write_file(fixture->temp_file, 1);
+    assert_int(rename(backup, fixture->sidecar), ==, 0);
+    assert_null(cx_inverted_index_new(fixture->temp_file, ROW_GROUP_COUNT,
+                                      1000));
+    write_index(fixture->temp_file);
+
+    struct cx_inverted_index *index =
+        cx_inverted_index_new(fixture->temp_file, ROW_GROUP_COUNT, 1000);
+    assert_not_null(index);
+
+    uint8_t matches[ROW_GROUP_COUNT] = {0};
+    assert_true(cx_inverted_index_lookup(index, 0, cx_bloom_hash_i64(25),
+                                         matches));
+    uint8_t expected[] = {0, 1, 1, 0};
+    assert_memory_equal(ROW_GROUP_COUNT, matches, expected);
+
+    memset(matches, 0, sizeof(matches));
+    struct cx_string name = {"rg1", 3};
+    assert_true(cx_inverted_index_lookup(index, 2, cx_bloom_hash_str(&name),
+                                         matches));
+    uint8_t expected_name[] = {0, 0, 1, 1};
+    assert_memory_equal(ROW_GROUP_COUNT, matches, expected_name);
+
+    memset(matches, 0, sizeof(matches));
+    assert_true(cx_inverted_index_lookup(index, 0, cx_bloom_hash_i64(100),
+                                         matches));
+    uint8_t expected_none[] = {0, 0, 0, 0};
+    assert_memory_equal(ROW_GROUP_COUNT, matches, expected_none);
+
+    // column 1 isn't indexed
+    assert_false(cx_inverted_index_lookup(index, 1, cx_bloom_hash_i64(25),
+                                          matches));
+
+    cx_inverted_index_free(index);
+
+    // writing an empty index removes the sidecar
+    struct cx_inverted_writer *writer = cx_inverted_writer_new();
+    assert_not_null(writer);
+    assert_true(cx_inverted_writer_finish(writer, fixture->temp_file,
+                                          ROW_GROUP_COUNT, 1000));
+    cx_inverted_writer_free(writer);
+    assert_null(cx_inverted_index_new(fixture->temp_file, ROW_GROUP_COUNT,
+                                      1000));
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_match(const MunitParameter params[], void *ptr)
+{
+    struct cx_inverted_fixture *fixture = ptr;
+
+    write_index(fixture->temp_file);
+    struct cx_inverted_index *index =
+        cx_inverted_index_new(fixture->temp_file, ROW_GROUP_COUNT, 1000);
+    assert_not_null(index);
+
+    struct {
+        struct cx_predicate *predicate;
+        uint8_t expected[ROW_GROUP_COUNT];
+    } tests[] = {
+        {cx_predicate_new_i64_eq(0, 5), {1, 0, 0, 0}},
+        {cx_predicate_new_i64_eq(0, 45), {0, 0, 0, 1}},
+        {cx_predicate_new_str_eq(2, "rg0", true), {1, 1, 0, 0}},
+        {cx_predicate_new_str_eq(2, "RG0", false), {1, 1, 1, 1}},
+        {cx_predicate_new_and(2, cx_predicate_new_i64_eq(0, 15),
+                              cx_predicate_new_str_eq(2, "rg0", true)),
+         {1, 1, 0, 0}},
+        {cx_predicate_new_or(2, cx_predicate_new_i64_eq(0, 5),
+                             cx_predicate_new_i64_eq(0, 45)),
+         {1, 0, 0, 1}},
+        {cx_predicate_new_or(2, cx_predicate_new_i64_eq(0, 5),
+                             cx_predicate_new_i64_gt(0, 40)),
+         {1, 1, 1, 1}},
+        // negated and unindexed predicates can't be pruned
+        {cx_predicate_negate(cx_predicate_new_i64_eq(0, 5)), {1, 1, 1, 1}},
+        {cx_predicate_new_i64_eq(1, 5), {1, 1, 1, 1}},
+    };
+
+    for (size_t i = 0; i < sizeof(tests) / sizeof(*tests); i++) {
+        assert_not_null(tests[i].predicate);
+        uint8_t matches[ROW_GROUP_COUNT] = {1, 1, 1, 1};
+        assert_true(cx_index_match_inverted(tests[i].predicate, index,
+                                            ROW_GROUP_COUNT, matches));
+        assert_memory_equal(ROW_GROUP_COUNT, matches, tests[i].expected);
+        cx_predicate_free(tests[i].predicate);
+    }
+
+    cx_inverted_index_free(index);
+    return MUNIT_OK;
+}
+
+MunitTest inverted_tests[] = {
+    {"/lookup", test_lookup, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/match", test_match, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
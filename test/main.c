@@ -7,6 +7,9 @@ extern MunitTest match_tests[];
 extern MunitTest predicate_tests[];
 extern MunitTest row_tests[];
 extern MunitTest compress_tests[];
+extern MunitTest bloom_tests[];
+extern MunitTest trigram_tests[];
+extern MunitTest inverted_tests[];
 extern MunitTest file_tests[];
 
 MunitSuite suites[] = {
@@ -17,6 +20,9 @@ MunitSuite suites[] = {
     {"/predicate", predicate_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
     {"/row", row_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
     {"/compress", compress_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
+    {"/bloom", bloom_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
+    {"/trigram", trigram_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
+    {"/inverted", inverted_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
     {"/file", file_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE},
     {NULL, NULL, NULL, 1, MUNIT_SUITE_OPTION_NONE}};
 
@@ -17,88 +17,207 @@ static float random_flt()
 
 static MunitResult test_i32(const MunitParameter params[], void *fixture)
 {
-    int32_t values[64];
+    int32_t values[64], other[64];
     int32_t cmp = random_i32();
+    int32_t high = random_i32();
     for (size_t i = 0; i < ITERATIONS; i++) {
-        uint64_t eq = 0, lt = 0, gt = 0;
+        uint64_t eq = 0, lt = 0, gt = 0, between = 0;
+        uint64_t eq_column = 0, lt_column = 0, gt_column = 0;
         for (size_t j = 0; j < 64; j++) {
             values[j] = random_i32();
+            // the other column is close enough to values to be equal
+            other[j] = values[j] - cmp + random_i32() / RAND_MOD;
+            int32_t sum = other[j] + cmp;
+            if (values[j] == sum)
+                eq_column |= (uint64_t)1 << j;
+            if (values[j] < sum)
+                lt_column |= (uint64_t)1 << j;
+            if (values[j] > sum)
+                gt_column |= (uint64_t)1 << j;
             if (values[j] == cmp)
                 eq |= (uint64_t)1 << j;
             if (values[j] < cmp)
                 lt |= (uint64_t)1 << j;
             if (values[j] > cmp)
                 gt |= (uint64_t)1 << j;
+            if (values[j] > cmp && values[j] < high)
+                between |= (uint64_t)1 << j;
         }
         assert_uint64(eq, ==, cx_match_i32_eq(64, values, cmp));
         assert_uint64(lt, ==, cx_match_i32_lt(64, values, cmp));
         assert_uint64(gt, ==, cx_match_i32_gt(64, values, cmp));
+        assert_uint64(between, ==,
+                      cx_match_i32_between(64, values, cmp, high));
+        assert_uint64(eq_column, ==,
+                      cx_match_i32_eq_column(64, values, other, cmp));
+        assert_uint64(lt_column, ==,
+                      cx_match_i32_lt_column(64, values, other, cmp));
+        assert_uint64(gt_column, ==,
+                      cx_match_i32_gt_column(64, values, other, cmp));
     }
     return MUNIT_OK;
 }
 
 static MunitResult test_i64(const MunitParameter params[], void *fixture)
 {
-    int64_t values[64];
+    int64_t values[64], other[64];
     int64_t cmp = random_i32();
+    int64_t high = random_i32();
     for (size_t i = 0; i < ITERATIONS; i++) {
-        uint64_t eq = 0, lt = 0, gt = 0;
+        uint64_t eq = 0, lt = 0, gt = 0, between = 0;
+        uint64_t eq_column = 0, lt_column = 0, gt_column = 0;
         for (size_t j = 0; j < 64; j++) {
             values[j] = random_i32();
+            // the other column is close enough to values to be equal
+            other[j] = values[j] - cmp + random_i32() / RAND_MOD;
+            int64_t sum = other[j] + cmp;
+            if (values[j] == sum)
+                eq_column |= (uint64_t)1 << j;
+            if (values[j] < sum)
+                lt_column |= (uint64_t)1 << j;
+            if (values[j] > sum)
+                gt_column |= (uint64_t)1 << j;
             if (values[j] == cmp)
                 eq |= (uint64_t)1 << j;
             if (values[j] < cmp)
                 lt |= (uint64_t)1 << j;
             if (values[j] > cmp)
                 gt |= (uint64_t)1 << j;
+            if (values[j] > cmp && values[j] < high)
+                between |= (uint64_t)1 << j;
         }
         assert_uint64(eq, ==, cx_match_i64_eq(64, values, cmp));
         assert_uint64(lt, ==, cx_match_i64_lt(64, values, cmp));
         assert_uint64(gt, ==, cx_match_i64_gt(64, values, cmp));
+        assert_uint64(between, ==,
+                      cx_match_i64_between(64, values, cmp, high));
+        assert_uint64(eq_column, ==,
+                      cx_match_i64_eq_column(64, values, other, cmp));
+        assert_uint64(lt_column, ==,
+                      cx_match_i64_lt_column(64, values, other, cmp));
+        assert_uint64(gt_column, ==,
+                      cx_match_i64_gt_column(64, values, other, cmp));
     }
     return MUNIT_OK;
 }
 
 static MunitResult test_flt(const MunitParameter params[], void *fixture)
 {
-    float values[64];
+    float values[64], other[64];
     float cmp = random_flt();
+    float high = random_flt();
     for (size_t i = 0; i < ITERATIONS; i++) {
-        uint64_t eq = 0, lt = 0, gt = 0;
+        uint64_t eq = 0, lt = 0, gt = 0, between = 0;
+        uint64_t eq_column = 0, lt_column = 0, gt_column = 0;
         for (size_t j = 0; j < 64; j++) {
             values[j] = random_flt();
+            // the other column is close enough to values to be equal
+            other[j] = values[j] - cmp + random_flt() / RAND_MOD;
+            float sum = other[j] + cmp;
+            if (values[j] == sum)
+                eq_column |= (uint64_t)1 << j;
+            if (values[j] < sum)
+                lt_column |= (uint64_t)1 << j;
+            if (values[j] > sum)
+                gt_column |= (uint64_t)1 << j;
             if (values[j] == cmp)
                 eq |= (uint64_t)1 << j;
             if (values[j] < cmp)
                 lt |= (uint64_t)1 << j;
             if (values[j] > cmp)
                 gt |= (uint64_t)1 << j;
+            if (values[j] > cmp && values[j] < high)
+                between |= (uint64_t)1 << j;
         }
         assert_uint64(eq, ==, cx_match_flt_eq(64, values, cmp));
         assert_uint64(lt, ==, cx_match_flt_lt(64, values, cmp));
         assert_uint64(gt, ==, cx_match_flt_gt(64, values, cmp));
+        assert_uint64(between, ==,
+                      cx_match_flt_between(64, values, cmp, high));
+        assert_uint64(eq_column, ==,
+                      cx_match_flt_eq_column(64, values, other, cmp));
+        assert_uint64(lt_column, ==,
+                      cx_match_flt_lt_column(64, values, other, cmp));
+        assert_uint64(gt_column, ==,
+                      cx_match_flt_gt_column(64, values, other, cmp));
     }
     return MUNIT_OK;
 }
 
 static MunitResult test_dbl(const MunitParameter params[], void *fixture)
 {
-    double values[64];
+    double values[64], other[64];
     double cmp = random_flt();
+    double high = random_flt();
     for (size_t i = 0; i < ITERATIONS; i++) {
-        uint64_t eq = 0, lt = 0, gt = 0;
+        uint64_t eq = 0, lt = 0, gt = 0, between = 0;
+        uint64_t eq_column = 0, lt_column = 0, gt_column = 0;
         for (size_t j = 0; j < 64; j++) {
             values[j] = random_flt();
+            // the other column is close enough to values to be equal
+            other[j] = values[j] - cmp + random_flt() / RAND_MOD;
+            double sum = other[j] + cmp;
+            if (values[j] == sum)
+                eq_column |= (uint64_t)1 << j;
+            if (values[j] < sum)
+                lt_column |= (uint64_t)1 << j;
+            if (values[j] > sum)
+                gt_column |= (uint64_t)1 << j;
             if (values[j] == cmp)
                 eq |= (uint64_t)1 << j;
             if (values[j] < cmp)
                 lt |= (uint64_t)1 << j;
             if (values[j] > cmp)
                 gt |= (uint64_t)1 << j;
+            if (values[j] > cmp && values[j] < high)
+                between |= (uint64_t)1 << j;
         }
         assert_uint64(eq, ==, cx_match_dbl_eq(64, values, cmp));
         assert_uint64(lt, ==, cx_match_dbl_lt(64, values, cmp));
         assert_uint64(gt, ==, cx_match_dbl_gt(64, values, cmp));
+        assert_uint64(between, ==,
+                      cx_match_dbl_between(64, values, cmp, high));
+        assert_uint64(eq_column, ==,
+                      cx_match_dbl_eq_column(64, values, other, cmp));
+        assert_uint64(lt_column, ==,
+                      cx_match_dbl_lt_column(64, values, other, cmp));
+        assert_uint64(gt_column, ==,
+                      cx_match_dbl_gt_column(64, values, other, cmp));
+    }
+    return MUNIT_OK;
+}
+
+static MunitResult test_set(const MunitParameter params[], void *fixture)
+{
+    // small sets are scanned, and large sets are hashed
+    size_t set_sizes[] = {4, 40};
+    for (size_t s = 0; s < 2; s++) {
+        size_t set_size = set_sizes[s];
+        int32_t set_i32[40];
+        int64_t set_i64[40];
+        for (size_t i = 0; i < set_size; i++)
+            set_i32[i] = set_i64[i] = random_i32();
+        struct cx_match_set *i32 =
+            cx_match_set_new(CX_COLUMN_I32, set_size, set_i32, true);
+        assert_not_null(i32);
+        struct cx_match_set *i64 =
+            cx_match_set_new(CX_COLUMN_I64, set_size, set_i64, true);
+        assert_not_null(i64);
+        int32_t values_i32[64];
+        int64_t values_i64[64];
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            uint64_t expected = 0;
+            for (size_t j = 0; j < 64; j++) {
+                values_i32[j] = values_i64[j] = random_i32();
+                for (size_t k = 0; k < set_size; k++)
+                    if (values_i32[j] == set_i32[k])
+                        expected |= (uint64_t)1 << j;
+            }
+            assert_uint64(expected, ==, cx_match_i32_in(64, values_i32, i32));
+            assert_uint64(expected, ==, cx_match_i64_in(64, values_i64, i64));
+        }
+        cx_match_set_free(i32);
+        cx_match_set_free(i64);
     }
     return MUNIT_OK;
 }
@@ -121,6 +240,7 @@ static MunitResult test_str(const MunitParameter params[], void *fixture)
     assert_uint(cx_match_str_eq(size, strings, CX_CMP(""), false), ==, 0);
     assert_uint(cx_match_str_eq(size, strings, CX_CMP("ab"), true), ==, 0x2);
     assert_uint(cx_match_str_eq(size, strings, CX_CMP("ab"), false), ==, 0xA);
+    assert_uint(cx_match_str_eq(size, strings, CX_CMP("aa"), true), ==, 0);
 
     assert_uint(cx_match_str_gt(size, strings, CX_CMP("x"), false), ==, 0x1);
     assert_uint(cx_match_str_lt(size, strings, CX_CMP("x"), false), ==, 0xE);
@@ -175,5 +295,6 @@ MunitTest match_tests[] = {
     {"/i64", test_i64, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/flt", test_flt, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/dbl", test_dbl, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/set", test_set, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {"/str", test_str, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
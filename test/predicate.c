@@ -4,7 +4,7 @@
 
 #include "helpers.h"
 
-#define COLUMN_COUNT 14
+#define COLUMN_COUNT 18
 #define ROW_COUNT 10
 
 static const uint64_t all_rows = (1 << ROW_COUNT) - 1;
@@ -38,7 +38,8 @@ static void *setup(const MunitParameter params[], void *data)
                                    CX_COLUMN_STR, CX_COLUMN_I32, CX_COLUMN_I64,
                                    CX_COLUMN_BIT, CX_COLUMN_BIT, CX_COLUMN_I32,
                                    CX_COLUMN_I32, CX_COLUMN_FLT, CX_COLUMN_FLT,
-                                   CX_COLUMN_DBL, CX_COLUMN_DBL};
+                                   CX_COLUMN_DBL, CX_COLUMN_DBL, CX_COLUMN_STR,
+                                   CX_COLUMN_I32, CX_COLUMN_BIT, CX_COLUMN_I64};
 
     for (size_t i = 0; i < COLUMN_COUNT; i++) {
         fixture->columns[i] = cx_column_new(types[i], CX_ENCODING_NONE);
@@ -47,6 +48,8 @@ static void *setup(const MunitParameter params[], void *data)
         assert_not_null(fixture->nulls[i]);
     }
 
+    const char *dict_strings[] = {"b2", "a1", "b1", "a2"};
+
     char buffer[64];
     for (size_t i = 0; i < ROW_COUNT; i++) {
         assert_true(cx_column_put_i32(fixture->columns[0], i));
@@ -68,6 +71,11 @@ static void *setup(const MunitParameter params[], void *data)
         assert_true(cx_column_put_flt(fixture->columns[11], 5.1));
         assert_true(cx_column_put_dbl(fixture->columns[12], (double)i / 100));
         assert_true(cx_column_put_dbl(fixture->columns[13], 5.1));
+        assert_true(
+            cx_column_put_str(fixture->columns[14], dict_strings[i % 4]));
+        assert_true(cx_column_put_i32(fixture->columns[15], i / 4));
+        assert_true(cx_column_put_bit(fixture->columns[16], true));
+        assert_true(cx_column_put_i64(fixture->columns[17], i * 10));
 
         assert_true(cx_column_put_bit(fixture->nulls[0], i % 2 == 0));
         assert_true(cx_column_put_bit(fixture->nulls[1], i % 3 == 0));
@@ -76,6 +84,16 @@ static void *setup(const MunitParameter params[], void *data)
             assert_true(cx_column_put_bit(fixture->nulls[j], false));
     }
 
+    enum cx_encoding_type encodings[] = {CX_ENCODING_DICT, CX_ENCODING_RLE,
+                                         CX_ENCODING_RLE, CX_ENCODING_FOR};
+    for (size_t i = 0; i < 4; i++) {
+        struct cx_column *encoded =
+            cx_column_encode(fixture->columns[14 + i], encodings[i]);
+        assert_not_null(encoded);
+        cx_column_free(fixture->columns[14 + i]);
+        fixture->columns[14 + i] = encoded;
+    }
+
     for (size_t i = 0; i < COLUMN_COUNT; i++)
         assert_true(cx_row_group_add_column(
             fixture->row_group, fixture->columns[i], fixture->nulls[i]));
@@ -169,7 +187,19 @@ static MunitResult test_valid(const MunitParameter params[], void *ptr)
          false},  // type mismatch
         {cx_predicate_new_or(2, cx_predicate_new_true(),
                              cx_predicate_new_i32_eq(20, 100)),
-         false}  // column doesn't exist
+         false},  // column doesn't exist
+        {cx_predicate_new_i32_in(0, 2, (int32_t[]){1, 2}), true},
+        {cx_predicate_new_i32_in(1, 2, (int32_t[]){1, 2}), false},
+        {cx_predicate_new_str_in(3, 1, (const char *[]){"cx 0"}, true), true},
+        {cx_predicate_new_dbl_between(12, 0, 1), true},
+        {cx_predicate_new_flt_between(12, 0, 1), false},  // type mismatch
+        {cx_predicate_new_i32_lt_column(0, 4, 0), true},
+        {cx_predicate_new_i32_lt_column(0, 1, 0), false},  // type mismatch
+        {cx_predicate_new_i32_lt_column(0, 20, 0),
+         false},  // column doesn't exist
+        {cx_predicate_new_str_like(3, "cx%", true), true},
+        {cx_predicate_new_str_regex(3, "^cx", true), true},
+        {cx_predicate_new_str_like(0, "cx%", true), false}  // type mismatch
     };
 
     for (size_t i = 0; i < sizeof(test_cases) / sizeof(*test_cases); i++) {
@@ -419,12 +449,25 @@ static MunitResult test_str_match_index(const MunitParameter params[],
         {cx_predicate_new_str_eq(3, "foo", true), CX_INDEX_MATCH_NONE},
         {cx_predicate_new_str_eq(3, "cx 0", true), CX_INDEX_MATCH_UNKNOWN},
         {cx_predicate_new_str_eq(3, "cx 10", true), CX_INDEX_MATCH_NONE},
-        {cx_predicate_new_str_lt(3, "foo", true), CX_INDEX_MATCH_UNKNOWN},
-        {cx_predicate_new_str_lt(3, "cx 0", true), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_eq(3, "cx 9", true), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_eq(3, "dx 0", true), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_str_eq(3, "DX 0", false), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_lt(3, "foo", true), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_str_lt(3, "cx 0", true), CX_INDEX_MATCH_NONE},
         {cx_predicate_new_str_lt(3, "cx 10", true), CX_INDEX_MATCH_UNKNOWN},
-        {cx_predicate_new_str_gt(3, "foo", true), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_lt(3, "foo", false), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_gt(3, "foo", true), CX_INDEX_MATCH_NONE},
         {cx_predicate_new_str_gt(3, "cx 0", true), CX_INDEX_MATCH_UNKNOWN},
         {cx_predicate_new_str_gt(3, "cx 10", true), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_gt(3, "abc", true), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_str_contains(3, "cx", true, CX_STR_LOCATION_START),
+         CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_str_contains(3, "cx 5", true, CX_STR_LOCATION_START),
+         CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_contains(3, "dx", true, CX_STR_LOCATION_START),
+         CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_str_contains(3, "dx", false, CX_STR_LOCATION_START),
+         CX_INDEX_MATCH_UNKNOWN},
         {cx_predicate_new_str_contains(3, "foo", true, CX_STR_LOCATION_ANY),
          CX_INDEX_MATCH_UNKNOWN},
         {cx_predicate_new_str_contains(3, "cx 0", true, CX_STR_LOCATION_ANY),
@@ -510,6 +553,69 @@ static MunitResult test_str_match_rows(const MunitParameter params[],
     return test_rows(fixture, test_cases, sizeof(test_cases));
 }
 
+static MunitResult test_dict_match_rows(const MunitParameter params[],
+                                        void *fixture)
+{
+    struct cx_predicate_row_test_case test_cases[] = {
+        {cx_predicate_new_str_eq(14, "c", false), 0},
+        {cx_predicate_new_str_gt(14, "a", false), all_rows},
+        {cx_predicate_new_str_eq(14, "a2", false), 0x88},
+        {cx_predicate_new_str_eq(14, "A1", false), 0x222},
+        {cx_predicate_new_str_eq(14, "A1", true), 0},
+        {cx_predicate_negate(cx_predicate_new_str_eq(14, "a2", false)),
+         all_rows & ~0x88},
+        {cx_predicate_new_str_lt(14, "b", false), 0x2AA},
+        {cx_predicate_new_str_contains(14, "1", false, CX_STR_LOCATION_END),
+         0x266},
+        {cx_predicate_new_and(2, cx_predicate_new_str_gt(14, "a1", false),
+                              cx_predicate_new_str_contains(
+                                  14, "2", false, CX_STR_LOCATION_END)),
+         0x199},
+        {cx_predicate_new_str_like(14, "a_", true), 0x2AA},
+        {cx_predicate_new_str_like(14, "%2", true), 0x199},
+        {cx_predicate_new_str_regex(14, "^b[0-9]$", true), 0x155},
+        {cx_predicate_new_str_regex(14, "A1", false), 0x222},
+    };
+
+    return test_rows(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_rle_match_rows(const MunitParameter params[],
+                                       void *fixture)
+{
+    struct cx_predicate_row_test_case test_cases[] = {
+        {cx_predicate_new_i32_eq(15, 5), 0},
+        {cx_predicate_new_i32_gt(15, -1), all_rows},
+        {cx_predicate_new_i32_lt(15, 3), all_rows},
+        {cx_predicate_new_i32_eq(15, 1), 0xF0},
+        {cx_predicate_new_i32_gt(15, 0), 0x3F0},
+        {cx_predicate_negate(cx_predicate_new_i32_lt(15, 2)), 0x300},
+        {cx_predicate_new_bit_eq(16, true), all_rows},
+        {cx_predicate_new_bit_eq(16, false), 0},
+        {cx_predicate_new_and(2, cx_predicate_new_bit_eq(16, true),
+                              cx_predicate_new_i32_eq(15, 2)),
+         0x300},
+    };
+
+    return test_rows(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_for_match_rows(const MunitParameter params[],
+                                       void *fixture)
+{
+    struct cx_predicate_row_test_case test_cases[] = {
+        {cx_predicate_new_i64_gt(17, 1000), 0},
+        {cx_predicate_new_i64_gt(17, -1), all_rows},
+        {cx_predicate_new_i64_lt(17, 100), all_rows},
+        {cx_predicate_new_i64_lt(17, 0), 0},
+        {cx_predicate_new_i64_eq(17, 50), 0x20},
+        {cx_predicate_new_i64_gt(17, 45), 0x3E0},
+        {cx_predicate_negate(cx_predicate_new_i64_lt(17, 20)), 0x3FC},
+    };
+
+    return test_rows(fixture, test_cases, sizeof(test_cases));
+}
+
 static MunitResult test_null_match_index(const MunitParameter params[],
                                          void *fixture)
 {
@@ -650,10 +756,11 @@ static MunitResult test_optimize(const MunitParameter params[], void *ptr)
         cx_predicate_operands(p_or, &operand_count);
     assert_not_null(operands);
     assert_size(operand_count, ==, 6);
+    // p_i64 matches 1 in 10 rows, and p_and only 1 in 20
     assert_ptr_equal(operands[0], p_true);
     assert_ptr_equal(operands[1], p_custom_i32);
-    assert_ptr_equal(operands[2], p_and);
-    assert_ptr_equal(operands[3], p_i64);
+    assert_ptr_equal(operands[2], p_i64);
+    assert_ptr_equal(operands[3], p_and);
     assert_ptr_equal(operands[4], p_str);
     assert_ptr_equal(operands[5], p_custom_high_cost);
 
@@ -663,6 +770,50 @@ static MunitResult test_optimize(const MunitParameter params[], void *ptr)
     assert_ptr_equal(operands[0], p_bit);
     assert_ptr_equal(operands[1], p_i32);
 
+    // selective operands of an AND go first
+    struct cx_predicate *p_const = cx_predicate_new_i32_eq(4, 5);
+    assert_not_null(p_const);
+    struct cx_predicate *p_unique = cx_predicate_new_i32_eq(0, 5);
+    assert_not_null(p_unique);
+    struct cx_predicate *p_selective =
+        cx_predicate_new_and(2, p_const, p_unique);
+    assert_not_null(p_selective);
+    cx_predicate_optimize(p_selective, fixture->row_group);
+    operands = cx_predicate_operands(p_selective, &operand_count);
+    assert_ptr_equal(operands[0], p_unique);
+    assert_ptr_equal(operands[1], p_const);
+    cx_predicate_free(p_selective);
+
+    // range predicates are estimated from histograms, so the selective
+    // I64 comparison goes before the cheaper I32 one
+    struct cx_predicate *p_wide = cx_predicate_new_i32_lt(0, 8);
+    assert_not_null(p_wide);
+    struct cx_predicate *p_narrow = cx_predicate_new_i64_gt(17, 80);
+    assert_not_null(p_narrow);
+    struct cx_predicate *p_range = cx_predicate_new_and(2, p_wide, p_narrow);
+    assert_not_null(p_range);
+    cx_predicate_optimize(p_range, fixture->row_group);
+    operands = cx_predicate_operands(p_range, &operand_count);
+    assert_ptr_equal(operands[0], p_narrow);
+    assert_ptr_equal(operands[1], p_wide);
+    cx_predicate_free(p_range);
+
+    // GT and LT operands on the same column are merged into a BETWEEN
+    struct cx_predicate *p_merged = cx_predicate_new_and(
+        3, cx_predicate_new_i32_gt(0, 2), cx_predicate_new_bit_eq(2, true),
+        cx_predicate_new_i32_lt(0, 8));
+    assert_not_null(p_merged);
+    cx_predicate_optimize(p_merged, fixture->row_group);
+    operands = cx_predicate_operands(p_merged, &operand_count);
+    assert_size(operand_count, ==, 2);
+    assert_true(cx_predicate_valid(p_merged, fixture->row_group));
+    size_t count;
+    uint64_t matches;
+    assert_true(cx_index_match_rows(p_merged, fixture->row_group,
+                                    fixture->cursor, &matches, &count));
+    assert_uint64(matches, ==, 0x48);
+    cx_predicate_free(p_merged);
+
     // noops:
     cx_predicate_optimize(p_true, fixture->row_group);
     cx_predicate_optimize(p_i32, fixture->row_group);
@@ -673,6 +824,381 @@ static MunitResult test_optimize(const MunitParameter params[], void *ptr)
     return MUNIT_OK;
 }
 
+static MunitResult test_profile(const MunitParameter params[], void *ptr)
+{
+    struct cx_predicate_fixture *fixture = ptr;
+
+    // the first operands never short-circuit, and are moved last once the
+    // profile has sampled a batch
+    struct {
+        struct cx_predicate *predicate;
+        uint64_t expected;
+    } tests[] = {
+        {cx_predicate_new_and(2, cx_predicate_new_i32_gt(0, -1),
+                              cx_predicate_new_i32_eq(0, 3)),
+         0x8},
+        {cx_predicate_new_or(2, cx_predicate_new_i32_lt(0, 0),
+                             cx_predicate_new_i32_gt(0, -1)),
+         all_rows},
+        {cx_predicate_negate(
+             cx_predicate_new_or(2, cx_predicate_new_i32_lt(0, 0),
+                                 cx_predicate_new_i32_gt(0, 8))),
+         0x1FF},
+    };
+
+    for (size_t i = 0; i < sizeof(tests) / sizeof(*tests); i++) {
+        assert_not_null(tests[i].predicate);
+        struct cx_predicate_profile *profile =
+            cx_predicate_profile_new(tests[i].predicate);
+        assert_not_null(profile);
+        size_t count;
+        const size_t *order = cx_predicate_profile_order(profile, &count);
+        assert_size(count, ==, 2);
+        assert_size(order[0], ==, 0);
+        // sampled and unsampled batches match the same rows
+        for (size_t j = 0; j < 20; j++) {
+            uint64_t matches;
+            assert_true(cx_index_match_rows_profiled(
+                tests[i].predicate, profile, fixture->row_group,
+                fixture->cursor, &matches, &count));
+            assert_size(count, ==, ROW_COUNT);
+            assert_uint64(matches, ==, tests[i].expected);
+        }
+        order = cx_predicate_profile_order(profile, &count);
+        assert_size(order[0], ==, 1);
+        assert_size(order[1], ==, 0);
+        cx_predicate_profile_free(profile);
+        cx_predicate_free(tests[i].predicate);
+    }
+
+    // non-operators have nothing to reorder
+    struct cx_predicate *predicate = cx_predicate_new_i32_eq(0, 3);
+    assert_not_null(predicate);
+    struct cx_predicate_profile *profile = cx_predicate_profile_new(predicate);
+    assert_not_null(profile);
+    size_t count;
+    cx_predicate_profile_order(profile, &count);
+    assert_size(count, ==, 0);
+    cx_predicate_profile_free(profile);
+    cx_predicate_free(predicate);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_in_match_index(const MunitParameter params[],
+                                       void *fixture)
+{
+    int32_t wide[100];
+    for (int32_t i = 0; i < 100; i++)
+        wide[i] = i * 100 - 1050;
+
+    struct cx_predicate_index_test_case test_cases[] = {
+        {cx_predicate_new_i32_in(0, 2, (int32_t[]){-5, 20}),
+         CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_i32_in(0, 3, (int32_t[]){-5, 3, 20}),
+         CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_i32_in(4, 2, (int32_t[]){5, 6}), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_i32_in(4, 2, (int32_t[]){4, 6}),
+         CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_i32_in(0, 100, wide), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_i64_in(1, 2, (int64_t[]){-1, 10}),
+         CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_i64_in(5, 3, (int64_t[]){5, 5, 5}),
+         CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_str_in(3, 2, (const char *[]){"foo", "dx 0"}, true),
+         CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_str_in(3, 2, (const char *[]){"foo", "cx 5"}, true),
+         CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_in(3, 1, (const char *[]){"DX 0"}, false),
+         CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_negate(cx_predicate_new_i32_in(
+             0, 2, (int32_t[]){-5, 20})),
+         CX_INDEX_MATCH_ALL},
+    };
+
+    return test_indexes(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_in_match_rows(const MunitParameter params[],
+                                      void *fixture)
+{
+    // large sets are matched with a hash table
+    int32_t wide_i32[100];
+    int64_t wide_i64[100];
+    char buffers[100][16];
+    const char *wide_str[100];
+    for (size_t i = 0; i < 100; i++) {
+        wide_i32[i] = wide_i64[i] = 100 + i;
+        sprintf(buffers[i], "x %zu", i);
+        wide_str[i] = buffers[i];
+    }
+    wide_i32[10] = wide_i64[10] = 3;
+    wide_i32[20] = wide_i64[20] = 70;
+    wide_str[30] = "cx 3";
+    wide_str[40] = "CX 7";
+
+    struct cx_predicate_row_test_case test_cases[] = {
+        {cx_predicate_new_i32_in(0, 3, (int32_t[]){7, 3, 20}), 0x88},
+        {cx_predicate_new_i32_in(0, 4, (int32_t[]){3, 3, 7, 3}), 0x88},
+        {cx_predicate_new_i32_in(0, 100, wide_i32), 0x8},
+        {cx_predicate_negate(cx_predicate_new_i32_in(0, 100, wide_i32)),
+         all_rows & ~0x8},
+        {cx_predicate_new_i32_in(15, 2, (int32_t[]){0, 2}), 0x30F},
+        {cx_predicate_new_i64_in(1, 2, (int64_t[]){3, 7}), 0x88},
+        {cx_predicate_new_i64_in(17, 2, (int64_t[]){30, 70}), 0x88},
+        {cx_predicate_new_i64_in(17, 100, wide_i64), 0x80},
+        {cx_predicate_new_str_in(3, 2, (const char *[]){"cx 3", "cx 7"}, true),
+         0x88},
+        {cx_predicate_new_str_in(3, 2, (const char *[]){"CX 3", "cx 7"}, true),
+         0x80},
+        {cx_predicate_new_str_in(3, 2, (const char *[]){"CX 3", "cx 7"},
+                                 false),
+         0x88},
+        {cx_predicate_new_str_in(3, 100, wide_str, true), 0x8},
+        {cx_predicate_new_str_in(3, 100, wide_str, false), 0x88},
+        {cx_predicate_new_str_in(14, 2, (const char *[]){"a1", "a2"}, true),
+         0x2AA},
+        {cx_predicate_new_str_in(14, 100, wide_str, true), 0},
+    };
+
+    return test_rows(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_match_stats(const MunitParameter params[], void *ptr)
+{
+    // four row groups, with an I32 column (0..9, 10..19, 5..5, 30..39),
+    // a BIT column (all false, mixed, all true, mixed) and another I32
+    // column (20..29, 0..5, 5..5, 0..9)
+    cx_index_value_t i32_min[] = {{.i32 = 0}, {.i32 = 10}, {.i32 = 5},
+                                  {.i32 = 30}};
+    cx_index_value_t i32_max[] = {{.i32 = 9}, {.i32 = 19}, {.i32 = 5},
+                                  {.i32 = 39}};
+    cx_index_value_t other_min[] = {{.i32 = 20}, {.i32 = 0}, {.i32 = 5},
+                                    {.i32 = 0}};
+    cx_index_value_t other_max[] = {{.i32 = 29}, {.i32 = 5}, {.i32 = 5},
+                                    {.i32 = 9}};
+    cx_index_value_t bit_min[] = {{.bit = false}, {.bit = false},
+                                  {.bit = true}, {.bit = false}};
+    cx_index_value_t bit_max[] = {{.bit = false}, {.bit = true},
+                                  {.bit = true}, {.bit = true}};
+    struct cx_index_stats stats[] = {{CX_COLUMN_I32, i32_min, i32_max},
+                                     {CX_COLUMN_BIT, bit_min, bit_max},
+                                     {CX_COLUMN_STR, i32_min, i32_max},
+                                     {CX_COLUMN_I32, other_min, other_max}};
+
+    struct {
+        struct cx_predicate *predicate;
+        uint8_t expected[4];
+    } tests[] = {
+        {cx_predicate_new_true(), {1, 1, 1, 1}},
+        {cx_predicate_new_i32_eq(0, 5), {1, 0, 1, 0}},
+        {cx_predicate_new_i32_lt(0, 10), {1, 0, 1, 0}},
+        {cx_predicate_new_i32_gt(0, 19), {0, 0, 0, 1}},
+        {cx_predicate_new_bit_eq(1, true), {0, 1, 1, 1}},
+        {cx_predicate_new_i32_between(0, 8, 11), {1, 1, 0, 0}},
+        {cx_predicate_new_i32_between(0, 4, 6), {1, 0, 1, 0}},
+        {cx_predicate_new_i32_between(0, 20, 29), {0, 0, 0, 0}},
+        {cx_predicate_negate(cx_predicate_new_i32_between(0, -1, 20)),
+         {0, 0, 0, 1}},
+        {cx_predicate_new_i32_lt_column(0, 3, 0), {1, 0, 0, 0}},
+        {cx_predicate_new_i32_eq_column(0, 3, 0), {0, 0, 1, 0}},
+        {cx_predicate_negate(cx_predicate_new_i32_gt_column(0, 3, 0)),
+         {1, 0, 1, 0}},
+        {cx_predicate_negate(cx_predicate_new_i32_eq(0, 5)), {1, 1, 0, 1}},
+        {cx_predicate_negate(cx_predicate_new_i32_lt(0, 20)), {0, 0, 0, 1}},
+        {cx_predicate_new_and(2, cx_predicate_new_i32_lt(0, 20),
+                              cx_predicate_new_bit_eq(1, false)),
+         {1, 1, 0, 0}},
+        {cx_predicate_new_or(2, cx_predicate_new_i32_eq(0, 35),
+                             cx_predicate_new_bit_eq(1, true)),
+         {0, 1, 1, 1}},
+        {cx_predicate_negate(
+             cx_predicate_new_or(2, cx_predicate_new_i32_lt(0, 10),
+                                 cx_predicate_new_i32_gt(0, 29))),
+         {0, 1, 0, 0}},
+        // predicates without stats can't prune
+        {cx_predicate_new_i32_in(0, 2, (int32_t[]){6, 25}), {1, 1, 0, 0}},
+        {cx_predicate_new_i32_in(0, 2, (int32_t[]){35, 50}), {0, 0, 0, 1}},
+        {cx_predicate_new_str_eq(2, "foo", true), {1, 1, 1, 1}},
+        {cx_predicate_new_null(0), {1, 1, 1, 1}},
+        {cx_predicate_negate(cx_predicate_new_null(0)), {1, 1, 1, 1}},
+    };
+
+    for (size_t i = 0; i < sizeof(tests) / sizeof(*tests); i++) {
+        assert_not_null(tests[i].predicate);
+        uint8_t matches[4] = {1, 1, 1, 1};
+        assert_true(
+            cx_index_match_stats(tests[i].predicate, stats, 4, matches));
+        assert_memory_equal(4, matches, tests[i].expected);
+        cx_predicate_free(tests[i].predicate);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_between_match_index(const MunitParameter params[],
+                                            void *fixture)
+{
+    struct cx_predicate_index_test_case test_cases[] = {
+        {cx_predicate_new_i32_between(0, -1, 10), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_i32_between(0, 2, 8), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_i32_between(0, 9, 20), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_i32_between(0, -5, 0), CX_INDEX_MATCH_NONE},
+        // empty ranges
+        {cx_predicate_new_i32_between(0, 5, 6), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_i32_between(0, 6, 5), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_i32_between(4, 4, 6), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_i64_between(17, -1, 100), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_i64_between(17, 90, 200), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_flt_between(10, -0.1, 1), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_flt_between(10, 0.2, 0.5), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_flt_between(10, 0.5, 0.2), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_dbl_between(12, -0.01, 0.1), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_dbl_between(12, 0.09, 1), CX_INDEX_MATCH_NONE},
+        {cx_predicate_negate(cx_predicate_new_i32_between(0, 9, 20)),
+         CX_INDEX_MATCH_ALL},
+    };
+
+    return test_indexes(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_between_match_rows(const MunitParameter params[],
+                                           void *fixture)
+{
+    struct cx_predicate_row_test_case test_cases[] = {
+        {cx_predicate_new_i32_between(0, 2, 8), 0xF8},
+        {cx_predicate_new_i32_between(0, 5, 6), 0},
+        {cx_predicate_new_i32_between(0, 8, 2), 0},
+        {cx_predicate_new_i64_between(1, 2, 8), 0xF8},
+        {cx_predicate_new_flt_between(10, 0.2, 0.8), 0xF8},
+        {cx_predicate_new_dbl_between(12, 0.02, 0.08), 0xF8},
+        {cx_predicate_new_i32_between(15, 0, 2), 0xF0},
+        {cx_predicate_new_i64_between(17, 20, 70), 0x78},
+        {cx_predicate_negate(cx_predicate_new_i64_between(17, 20, 70)),
+         0x387},
+    };
+
+    return test_rows(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_like_match_index(const MunitParameter params[],
+                                         void *fixture)
+{
+    // invalid regular expressions are rejected
+    assert_null(cx_predicate_new_str_regex(3, "cx (", true));
+
+    struct cx_predicate_index_test_case test_cases[] = {
+        {cx_predicate_new_str_like(3, "cx%", true), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_like(3, "dx%", true), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_str_like(3, "dx%", false), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_like(3, "%cx 10%", true), CX_INDEX_MATCH_NONE},
+        // matches are at least as long as the pattern without its %s
+        {cx_predicate_new_str_like(3, "cx _", true), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_like(3, "cx __", true), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_str_like(3, "%_%_%_%_%_%", true),
+         CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_str_regex(3, "^cx [0-9]+$", true),
+         CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_regex(3, "^dx", true), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_str_regex(3, "cx 10+", true), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_str_regex(3, "cx 10*", true),
+         CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_str_regex(3, "cx 10|foo", true),
+         CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_negate(cx_predicate_new_str_like(3, "dx%", true)),
+         CX_INDEX_MATCH_ALL},
+    };
+
+    return test_indexes(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_like_match_rows(const MunitParameter params[],
+                                        void *fixture)
+{
+    struct cx_predicate_row_test_case test_cases[] = {
+        {cx_predicate_new_str_like(3, "cx%", true), all_rows},
+        {cx_predicate_new_str_like(3, "CX%", true), 0},
+        {cx_predicate_new_str_like(3, "%1", true), 0x2},
+        {cx_predicate_new_str_like(3, "%X 1%", false), 0x2},
+        {cx_predicate_new_str_like(3, "cx _", true), all_rows},
+        {cx_predicate_new_str_like(3, "cx __", true), 0},
+        {cx_predicate_new_str_like(3, "_x _", true), all_rows},
+        {cx_predicate_new_str_like(3, "c%5", true), 0x20},
+        {cx_predicate_new_str_like(3, "C%x%7", false), 0x80},
+        {cx_predicate_new_str_like(3, "cx 1", true), 0x2},
+        {cx_predicate_new_str_like(3, "cx", true), 0},
+        {cx_predicate_new_str_like(3, "%", true), all_rows},
+        {cx_predicate_new_str_like(3, "", true), 0},
+        // % and _ can be escaped
+        {cx_predicate_new_str_like(3, "cx\\%", true), 0},
+        {cx_predicate_new_str_like(3, "%\\_%", true), 0},
+        {cx_predicate_negate(cx_predicate_new_str_like(3, "cx 1%", true)),
+         all_rows & ~0x2},
+
+        {cx_predicate_new_str_regex(3, "^cx [0-4]$", true), 0x1F},
+        {cx_predicate_new_str_regex(3, "[13579]$", true), 0x2AA},
+        {cx_predicate_new_str_regex(3, "CX [2-3]", false), 0xC},
+        {cx_predicate_new_str_regex(3, "CX", true), 0},
+        {cx_predicate_new_str_regex(3, "^cx (1|2)$", true), 0x6},
+        {cx_predicate_new_str_regex(3, "^(cx) 7", true), 0x80},
+        // optional characters aren't part of the literal
+        {cx_predicate_new_str_regex(3, "cx 15*", true), 0x2},
+        {cx_predicate_new_str_regex(3, "cx 15?$", true), 0x2},
+        {cx_predicate_new_str_regex(3, "c+x 3", true), 0x8},
+        {cx_predicate_new_str_regex(3, "cx\\.?[8-9]", true), 0},
+    };
+
+    return test_rows(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_column_match_index(const MunitParameter params[],
+                                           void *fixture)
+{
+    struct cx_predicate_index_test_case test_cases[] = {
+        {cx_predicate_new_i32_lt_column(0, 4, 5), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_i32_lt_column(0, 4, 0), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_i32_lt_column(0, 4, -5), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_i32_gt_column(0, 8, 9), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_i32_gt_column(0, 8, 10), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_i32_eq_column(4, 4, 0), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_i32_eq_column(4, 8, 0), CX_INDEX_MATCH_NONE},
+        // bounds that overflow can't be compared
+        {cx_predicate_new_i32_lt_column(0, 4, INT32_MAX),
+         CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_i64_gt_column(17, 1, 0), CX_INDEX_MATCH_UNKNOWN},
+        {cx_predicate_new_i64_gt_column(17, 5, -6), CX_INDEX_MATCH_ALL},
+        {cx_predicate_new_flt_gt_column(10, 11, 0), CX_INDEX_MATCH_NONE},
+        {cx_predicate_new_dbl_lt_column(12, 13, -5), CX_INDEX_MATCH_ALL},
+        {cx_predicate_negate(cx_predicate_new_i32_eq_column(4, 8, 0)),
+         CX_INDEX_MATCH_ALL},
+    };
+
+    return test_indexes(fixture, test_cases, sizeof(test_cases));
+}
+
+static MunitResult test_column_match_rows(const MunitParameter params[],
+                                          void *fixture)
+{
+    struct cx_predicate_row_test_case test_cases[] = {
+        {cx_predicate_new_i32_lt_column(0, 4, 0), 0x1F},
+        {cx_predicate_new_i32_eq_column(0, 4, 0), 0x20},
+        {cx_predicate_negate(cx_predicate_new_i32_lt_column(0, 4, 0)), 0x3E0},
+        {cx_predicate_new_i32_eq_column(0, 0, 0), all_rows},
+        {cx_predicate_new_i32_lt_column(0, 0, 0), 0},
+        // (col > col15 + 4), where col15 is RLE encoded
+        {cx_predicate_new_i32_gt_column(0, 15, 4), 0x3C0},
+        // sums wrap
+        {cx_predicate_new_i32_gt_column(0, 4, INT32_MAX), all_rows},
+        {cx_predicate_new_i64_gt_column(17, 1, 0), 0x3FE},
+        {cx_predicate_new_i64_eq_column(1, 5, -3), 0x4},
+        {cx_predicate_new_flt_gt_column(11, 10, 4.55), 0x3F},
+        {cx_predicate_new_dbl_lt_column(12, 13, -5), all_rows},
+        {cx_predicate_new_dbl_gt_column(12, 13, -5.045), 0x3C0},
+    };
+
+    return test_rows(fixture, test_cases, sizeof(test_cases));
+}
+
 MunitTest predicate_tests[] = {
     {"/valid", test_valid, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
     {"/bit-match-index", test_bit_match_index, setup, teardown,
@@ -699,6 +1225,28 @@ MunitTest predicate_tests[] = {
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/str-match-rows", test_str_match_rows, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
+    {"/dict-match-rows", test_dict_match_rows, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/in-match-index", test_in_match_index, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/in-match-rows", test_in_match_rows, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/between-match-index", test_between_match_index, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/between-match-rows", test_between_match_rows, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/like-match-index", test_like_match_index, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/like-match-rows", test_like_match_rows, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/column-match-index", test_column_match_index, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/column-match-rows", test_column_match_rows, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/rle-match-rows", test_rle_match_rows, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
+    {"/for-match-rows", test_for_match_rows, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
     {"/null-match-index", test_null_match_index, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/null-match-rows", test_null_match_rows, setup, teardown,
@@ -708,4 +1256,7 @@ MunitTest predicate_tests[] = {
     {"/custom-match-rows", test_custom_match_rows, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/optimize", test_optimize, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/profile", test_profile, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/match-stats", test_match_stats, setup, teardown, MUNIT_TEST_OPTION_NONE,
+     NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
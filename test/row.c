@@ -230,6 +230,203 @@ static MunitResult test_empty_row_group(const MunitParameter params[],
     return MUNIT_OK;
 }
 
+static MunitResult test_wide_batch(const MunitParameter params[], void *ptr)
+{
+    struct cx_row_fixture *fixture = ptr;
+
+    assert_null(cx_row_cursor_new_batch(fixture->row_group,
+                                        fixture->predicate, 100));
+
+    struct cx_predicate *predicate = cx_predicate_new_or(
+        2, cx_predicate_new_i32_lt(0, 10),
+        cx_predicate_new_and(2, cx_predicate_new_i64_gt(1, 700),
+                             cx_predicate_new_bit_eq(2, true)));
+    assert_not_null(predicate);
+
+    size_t batch_size, batch_sizes[] = {64, 128, 1024};
+
+    CX_FOREACH(batch_sizes, batch_size)
+    {
+        struct cx_row_cursor *cursor = cx_row_cursor_new_batch(
+            fixture->row_group, fixture->predicate, batch_size);
+        assert_not_null(cursor);
+        size_t position = 0;
+        for (; cx_row_cursor_next(cursor); position++)
+            test_cursor_position(cursor, position);
+        assert_size(position, ==, ROW_COUNT);
+        assert_size(cx_row_cursor_count(cursor), ==, ROW_COUNT);
+        assert_false(cx_row_cursor_error(cursor));
+        cx_row_cursor_free(cursor);
+
+        cursor =
+            cx_row_cursor_new_batch(fixture->row_group, predicate, batch_size);
+        assert_not_null(cursor);
+        size_t expected = 0;
+        for (position = 0; position < ROW_COUNT; position++) {
+            if (position >= 10 && (position <= 70 || position % 3))
+                continue;
+            assert_true(cx_row_cursor_next(cursor));
+            test_cursor_position(cursor, position);
+            expected++;
+        }
+        assert_false(cx_row_cursor_next(cursor));
+        assert_size(cx_row_cursor_count(cursor), ==, expected);
+        assert_false(cx_row_cursor_error(cursor));
+        cx_row_cursor_free(cursor);
+    }
+
+    cx_predicate_free(predicate);
+    return MUNIT_OK;
+}
+
+static MunitResult test_sorted_range(const MunitParameter params[], void *ptr)
+{
+    struct cx_row_fixture *fixture = ptr;
+
+    const struct cx_index *index =
+        cx_row_group_column_index(fixture->row_group, 0);
+    assert_true(index->flags & CX_INDEX_ASCENDING);
+    assert_false(index->flags & CX_INDEX_DESCENDING);
+    index = cx_row_group_column_index(fixture->row_group, 3);
+    assert_false(index->flags & (CX_INDEX_ASCENDING | CX_INDEX_DESCENDING));
+
+    struct {
+        struct cx_predicate *predicate;
+        size_t first;
+        size_t count;
+    } tests[] = {
+        {cx_predicate_new_i32_gt(0, 70), 71, 29},
+        {cx_predicate_new_i32_lt(0, 5), 0, 5},
+        {cx_predicate_new_i64_eq(1, 650), 65, 1},
+        {cx_predicate_new_i64_eq(1, 655), 0, 0},
+        {cx_predicate_new_flt_lt(4, 0.25), 0, 3},
+        {cx_predicate_new_dbl_gt(5, 0.985), 99, 1},
+        {cx_predicate_new_i32_between(0, 60, 70), 61, 9},
+        {cx_predicate_new_i64_between(1, 95, 305), 10, 21},
+        {cx_predicate_new_and(2, cx_predicate_new_i32_gt(0, 60),
+                              cx_predicate_new_i64_lt(1, 700)),
+         61, 9},
+        {cx_predicate_new_and(2, cx_predicate_new_i32_gt(0, 60),
+                              cx_predicate_new_bit_eq(2, true)),
+         63, 13},
+        {cx_predicate_new_or(2, cx_predicate_new_i32_lt(0, 3),
+                             cx_predicate_new_i32_gt(0, 96)),
+         0, 6},
+        {cx_predicate_negate(cx_predicate_new_i32_lt(0, 90)), 90, 10},
+    };
+
+    size_t batch_size, batch_sizes[] = {64, 128};
+
+    for (size_t i = 0; i < sizeof(tests) / sizeof(*tests); i++) {
+        assert_not_null(tests[i].predicate);
+        CX_FOREACH(batch_sizes, batch_size)
+        {
+            struct cx_row_cursor *cursor = cx_row_cursor_new_batch(
+                fixture->row_group, tests[i].predicate, batch_size);
+            assert_not_null(cursor);
+            size_t count = 0;
+            for (; cx_row_cursor_next(cursor); count++) {
+                int32_t value;
+                assert_true(cx_row_cursor_get_i32(cursor, 0, &value));
+                if (!count)
+                    assert_int32(value, ==, tests[i].first);
+            }
+            assert_false(cx_row_cursor_error(cursor));
+            assert_size(count, ==, tests[i].count);
+            assert_size(cx_row_cursor_count(cursor), ==, tests[i].count);
+            cx_row_cursor_free(cursor);
+        }
+        cx_predicate_free(tests[i].predicate);
+    }
+
+    // descending columns, which are searched by probing (NONE and FOR), by
+    // run (RLE) or in one pass (XOR)
+    enum cx_column_type types[] = {CX_COLUMN_I64, CX_COLUMN_I64,
+                                   CX_COLUMN_I64, CX_COLUMN_DBL};
+    enum cx_encoding_type encodings[] = {CX_ENCODING_NONE, CX_ENCODING_FOR,
+                                         CX_ENCODING_RLE, CX_ENCODING_XOR};
+    struct cx_row_group *row_group = cx_row_group_new();
+    assert_not_null(row_group);
+    struct cx_column *columns[4], *nulls[4];
+    for (size_t i = 0; i < 4; i++) {
+        struct cx_column *column = cx_column_new(types[i], CX_ENCODING_NONE);
+        assert_not_null(column);
+        nulls[i] = cx_column_new(CX_COLUMN_BIT, CX_ENCODING_NONE);
+        assert_not_null(nulls[i]);
+        for (size_t j = 0; j < 1000; j++) {
+            if (types[i] == CX_COLUMN_I64)
+                assert_true(cx_column_put_i64(column, 999 - j / 2 * 2));
+            else
+                assert_true(cx_column_put_dbl(column, 999 - j / 2 * 2));
+            assert_true(cx_column_put_bit(nulls[i], false));
+        }
+        if (encodings[i] == CX_ENCODING_NONE) {
+            columns[i] = column;
+        } else {
+            columns[i] = cx_column_encode(column, encodings[i]);
+            assert_not_null(columns[i]);
+            cx_column_free(column);
+        }
+        assert_true(cx_row_group_add_column(row_group, columns[i], nulls[i]));
+        index = cx_row_group_column_index(row_group, i);
+        assert_true(index->flags & CX_INDEX_DESCENDING);
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+        bool is_dbl = types[i] == CX_COLUMN_DBL;
+        struct cx_predicate *predicate =
+            is_dbl ? cx_predicate_new_dbl_lt(i, 100)
+                   : cx_predicate_new_i64_lt(i, 100);
+        assert_not_null(predicate);
+        size_t start, end;
+        bool exact;
+        assert_true(cx_predicate_match_range(predicate, row_group, &start,
+                                             &end, &exact));
+        assert_size(start, ==, 900);
+        assert_size(end, ==, 1000);
+        assert_true(exact);
+        cx_predicate_free(predicate);
+
+        predicate = is_dbl ? cx_predicate_new_dbl_eq(i, 501)
+                           : cx_predicate_new_i64_eq(i, 501);
+        assert_not_null(predicate);
+        assert_true(cx_predicate_match_range(predicate, row_group, &start,
+                                             &end, &exact));
+        assert_size(start, ==, 498);
+        assert_size(end, ==, 500);
+        struct cx_row_cursor *cursor = cx_row_cursor_new(row_group, predicate);
+        assert_not_null(cursor);
+        assert_size(cx_row_cursor_count(cursor), ==, 2);
+        cx_row_cursor_free(cursor);
+        cx_predicate_free(predicate);
+
+        predicate = is_dbl ? cx_predicate_new_dbl_gt(i, 995)
+                           : cx_predicate_new_i64_gt(i, 995);
+        assert_not_null(predicate);
+        assert_true(cx_predicate_match_range(predicate, row_group, &start,
+                                             &end, &exact));
+        assert_size(start, ==, 0);
+        assert_size(end, ==, 4);
+        cx_predicate_free(predicate);
+
+        predicate = is_dbl ? cx_predicate_new_dbl_lt(i, -1)
+                           : cx_predicate_new_i64_lt(i, -1);
+        assert_not_null(predicate);
+        assert_true(cx_predicate_match_range(predicate, row_group, &start,
+                                             &end, &exact));
+        assert_size(start, ==, end);
+        cx_predicate_free(predicate);
+    }
+
+    cx_row_group_free(row_group);
+    for (size_t i = 0; i < 4; i++) {
+        cx_column_free(columns[i]);
+        cx_column_free(nulls[i]);
+    }
+
+    return MUNIT_OK;
+}
+
 MunitTest row_tests[] = {
     {"/cursor", test_cursor, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
     {"/count", test_count, setup, teardown, MUNIT_TEST_OPTION_NONE, NULL},
@@ -239,4 +436,8 @@ MunitTest row_tests[] = {
      MUNIT_TEST_OPTION_NONE, NULL},
     {"/empty-row-group", test_empty_row_group, setup, teardown,
      MUNIT_TEST_OPTION_NONE, NULL},
+    {"/wide-batch", test_wide_batch, setup, teardown, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {"/sorted-range", test_sorted_range, setup, teardown,
+     MUNIT_TEST_OPTION_NONE, NULL},
     {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};
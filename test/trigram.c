@@ -0,0 +1,71 @@
+#include <stdio.h>
+
+#include "trigram.h"
+
+#include "helpers.h"
+
+#define VALUE_COUNT 1000
+
+static bool contains(const void *filter, size_t size, const char *string)
+{
+    struct cx_string needle = {string, strlen(string)};
+    return cx_trigram_filter_contains(filter, size, &needle);
+}
+
+static MunitResult test_contains(const MunitParameter params[], void *ptr)
+{
+    struct cx_column *column = cx_column_new(CX_COLUMN_STR, CX_ENCODING_NONE);
+    assert_not_null(column);
+    char buffer[64];
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        sprintf(buffer, "GET /api/users/%zu 200", i * 7);
+        assert_true(cx_column_put_str(column, buffer));
+    }
+    assert_true(cx_column_put_str(column, ""));
+    assert_true(cx_column_put_str(column, "ab"));
+    // the filter can be built from an encoded column
+    struct cx_column *encoded = cx_column_encode(column, CX_ENCODING_OFFSETS);
+    assert_not_null(encoded);
+    size_t size;
+    void *filter = cx_trigram_filter_new(encoded, &size);
+    assert_not_null(filter);
+    assert_size(size, >=, CX_TRIGRAM_MIN_SIZE);
+    size_t mask = size & (size - 1);
+    assert_size(mask, ==, 0);
+
+    for (size_t i = 0; i < VALUE_COUNT; i++) {
+        sprintf(buffer, "/users/%zu ", i * 7);
+        assert_true(contains(filter, size, buffer));
+    }
+    assert_true(contains(filter, size, "GET /api"));
+    assert_true(contains(filter, size, "/API/USERS"));
+    // strings without trigrams can't be ruled out
+    assert_true(contains(filter, size, ""));
+    assert_true(contains(filter, size, "xy"));
+
+    assert_false(contains(filter, size, "POST /api"));
+    assert_false(contains(filter, size, "timeout"));
+    assert_false(contains(filter, size, " 404"));
+
+    free(filter);
+    cx_column_free(encoded);
+    cx_column_free(column);
+    return MUNIT_OK;
+}
+
+static MunitResult test_unsupported(const MunitParameter params[], void *ptr)
+{
+    struct cx_column *column = cx_column_new(CX_COLUMN_I64, CX_ENCODING_NONE);
+    assert_not_null(column);
+    assert_true(cx_column_put_i64(column, 1));
+    size_t size;
+    assert_null(cx_trigram_filter_new(column, &size));
+    cx_column_free(column);
+    return MUNIT_OK;
+}
+
+MunitTest trigram_tests[] = {
+    {"/contains", test_contains, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL},
+    {"/unsupported", test_unsupported, NULL, NULL, MUNIT_TEST_OPTION_NONE,
+     NULL},
+    {NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL}};